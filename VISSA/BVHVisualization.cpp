@@ -4,12 +4,16 @@
 #include <algorithm>
 #include <limits>
 #include <cmath>
+#include <chrono>
 
 #include "Engine.h"
 #include "GeometricPrimitiveData.h"
 #include "Renderer.h"
 
 namespace {
+	// below this number of objects, building a subtree is too little work to be handed to another thread
+	const size_t s_uiMinNumObjectReferencesForSubtreeTask = 1024u;
+
 	template <typename T>
 	struct GenericBackup {
 		GenericBackup() :
@@ -64,6 +68,29 @@ BVHVisualization::BVHVisualization(Window* pMainWindow) :
 	m_eConstructionStrategy(TOPDOWN),
 	m_eBVHBoundingVolume(AABB),
 	m_pCurrentlyActiveConstructionStrategy(nullptr),
+	m_tSAHParameters(),
+	m_tObjectMeanLeafParameters(),
+	m_tTaskPool(),
+	m_bIsTopDownConstructedInParallel(true),
+	m_tLBVHParameters(),
+	m_bIsLBVHConstructedInParallel(true),
+	m_tPLOCParameters(),
+	m_bIsPLOCConstructedInParallel(true),
+	m_fRefitRebuildThreshold(1.5f),
+	m_tDynamicAABBTree(),
+	m_fDynamicAABBTreeUpdateTimeInMicroseconds(0.0f),
+	m_fSingleRayBenchmarkRaysPerSecond(0.0f),
+	m_pRayPacketBenchmarkRaysPerSecond{ 0.0f, 0.0f, 0.0f },
+	m_pHierarchyBenchmarkRaysPerSecond{ 0.0f, 0.0f },
+	m_fKDTreeBenchmarkRaysPerSecond(0.0f),
+	m_fKDTreeConstructionTimeInMilliseconds(0.0f),
+	m_uiKDTreeNumObjectReferences(0u),
+	m_vecOverlappingObjectPairs(),
+	m_uiNumOverlappingObjectPairs(0u),
+	m_pOverlappingPairsBenchmarkMilliseconds{ 0.0f, 0.0f, 0.0f },
+	m_vecVisibleObjects(),
+	m_uiNumVisibleObjects(0u),
+	m_fFrustumCullingMicroseconds(0.0f),
 	m_pCurrentlyFocusedObject(nullptr),
 	m_fCrossHairScaling(1.0f),
 	m_fRenderDistance(10000.0f),
@@ -78,6 +105,7 @@ BVHVisualization::BVHVisualization(Window* pMainWindow) :
 	m_bRenderGridYPlane(false),
 	m_bRenderGridZPlane(false),
 	m_bNodeDepthColorGrading(true),
+	m_bFrustumCulling(true),
 	m_bGUICaptureMouse(true),
 	m_bShowSimulationOptions(true),
 	m_bShowObjectCreationWindow(false),
@@ -89,15 +117,13 @@ BVHVisualization::BVHVisualization(Window* pMainWindow) :
 
 	InitPlaybackSpeeds();
 	InitRenderColors();
+	UpdateCurrentlyActiveBVH();
 	ResetSimulation();
 }
 
 BVHVisualization::~BVHVisualization()
 {
-	m_tTopDownAABBs.m_tBVH.DeleteTree();
-	m_tBottomUpAABBs.m_tBVH.DeleteTree();
-	m_tTopDownBoundingSpheres.m_tBVH.DeleteTree();
-	m_tBottomUpBoundingSpheres.m_tBVH.DeleteTree();
+	// the hierarchies free their node memory themselves
 
 	FreeGPUResources();
 	glfwDestroyWindow(m_p2DGraphWindow->m_pGLFWwindow);
@@ -129,6 +155,7 @@ void BVHVisualization::Load()
 	CollisionDetection::ConstructBoundingVolumesForScene(m_tScene);
 	CollisionDetection::UpdateBoundingVolumesForScene(m_tScene);
 	ReconstructAllTrees();
+	RebuildDynamicAABBTree();
 
 	m_tCamera.SetToPosition(glm::vec3(0.0f, 0.0f, 1500.0f));
 }
@@ -374,27 +401,197 @@ void BVHVisualization::LoadDefaultScene(Scene& rSceneToLoadInto)
 void BVHVisualization::ReconstructAllTrees()
 {
 	m_tTopDownAABBs.DeleteAllData();
-	m_tTopDownAABBs = ConstructTopDownAABBBVHandRenderDataForScene(m_tScene);
+	ConstructTopDownAABBBVHandRenderDataForScene(m_tScene, m_tTopDownAABBs);
 
 	m_tBottomUpAABBs.DeleteAllData();
-	m_tBottomUpAABBs = ConstructBottomUpAABBBVHandRenderDataForScene(m_tScene);
+	ConstructBottomUpAABBBVHandRenderDataForScene(m_tScene, m_tBottomUpAABBs);
 
 	m_tTopDownBoundingSpheres.DeleteAllData();
-	m_tTopDownBoundingSpheres = ConstructTopDownBoundingSphereBVHandRenderDataForScene(m_tScene);
+	ConstructTopDownBoundingSphereBVHandRenderDataForScene(m_tScene, m_tTopDownBoundingSpheres);
 
 	m_tBottomUpBoundingSpheres.DeleteAllData();
-	m_tBottomUpBoundingSpheres = ConstructBottomUpBoundingSphereBVHandRenderDataForScene(m_tScene);
+	ConstructBottomUpBoundingSphereBVHandRenderDataForScene(m_tScene, m_tBottomUpBoundingSpheres);
+
+	m_tTopDownSAHAABBs.DeleteAllData();
+	ConstructTopDownSAHAABBBVHandRenderDataForScene(m_tScene, m_tTopDownSAHAABBs);
+
+	m_tTopDownSAHBoundingSpheres.DeleteAllData();
+	ConstructTopDownSAHBoundingSphereBVHandRenderDataForScene(m_tScene, m_tTopDownSAHBoundingSpheres);
+
+	m_tLBVHAABBs.DeleteAllData();
+	ConstructLBVHAABBBVHandRenderDataForScene(m_tScene, m_tLBVHAABBs);
+
+	m_tLBVHBoundingSpheres.DeleteAllData();
+	ConstructLBVHBoundingSphereBVHandRenderDataForScene(m_tScene, m_tLBVHBoundingSpheres);
+
+	m_tPLOCAABBs.DeleteAllData();
+	ConstructPLOCAABBBVHandRenderDataForScene(m_tScene, m_tPLOCAABBs);
+
+	m_tPLOCBoundingSpheres.DeleteAllData();
+	ConstructPLOCBoundingSphereBVHandRenderDataForScene(m_tScene, m_tPLOCBoundingSpheres);
+}
+
+void BVHVisualization::RebuildDynamicAABBTree()
+{
+	assert(m_tScene.m_vecObjects.size() <= std::numeric_limits<uint32_t>::max());
+
+	m_tDynamicAABBTree.Clear();
+	for (size_t uiCurrentObject = 0u; uiCurrentObject < m_tScene.m_vecObjects.size(); uiCurrentObject++)
+		m_tDynamicAABBTree.InsertObject(m_tScene.m_vecObjects.data(), static_cast<uint32_t>(uiCurrentObject));
 }
 
 
 void BVHVisualization::UpdateAfterObjectPropertiesChange()
 {
-	// all updates and reset the sim
-	CollisionDetection::UpdateBoundingVolumesForScene(m_tScene);	// todo: updating all BVS is overkill. improve
-	ReconstructAllTrees();
+	// only the transform of the focused object can be changed, so only its bounding volumes and their paths in the trees are updated
+	assert(m_pCurrentlyFocusedObject);
+	CollisionDetection::UpdateBoundingVolumesForObject(*m_pCurrentlyFocusedObject);
+	const size_t uiMovedObjectIndex = static_cast<size_t>(m_pCurrentlyFocusedObject - m_tScene.m_vecObjects.data());
+
+	const std::chrono::high_resolution_clock::time_point tUpdateStart = std::chrono::high_resolution_clock::now();
+	m_tDynamicAABBTree.UpdateObject(m_tScene.m_vecObjects.data(), static_cast<uint32_t>(uiMovedObjectIndex));
+	m_fDynamicAABBTreeUpdateTimeInMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - tUpdateStart).count();
+
+	RefitOrReconstructTree(m_tTopDownAABBs, uiMovedObjectIndex, CollisionDetection::RefitBVHForObject_AABB, &BVHVisualization::ConstructTopDownAABBBVHandRenderDataForScene);
+	RefitOrReconstructTree(m_tBottomUpAABBs, uiMovedObjectIndex, CollisionDetection::RefitBVHForObject_AABB, &BVHVisualization::ConstructBottomUpAABBBVHandRenderDataForScene);
+	RefitOrReconstructTree(m_tTopDownBoundingSpheres, uiMovedObjectIndex, CollisionDetection::RefitBVHForObject_BoundingSphere, &BVHVisualization::ConstructTopDownBoundingSphereBVHandRenderDataForScene);
+	RefitOrReconstructTree(m_tBottomUpBoundingSpheres, uiMovedObjectIndex, CollisionDetection::RefitBVHForObject_BoundingSphere, &BVHVisualization::ConstructBottomUpBoundingSphereBVHandRenderDataForScene);
+	RefitOrReconstructTree(m_tTopDownSAHAABBs, uiMovedObjectIndex, CollisionDetection::RefitBVHForObject_AABB, &BVHVisualization::ConstructTopDownSAHAABBBVHandRenderDataForScene);
+	RefitOrReconstructTree(m_tTopDownSAHBoundingSpheres, uiMovedObjectIndex, CollisionDetection::RefitBVHForObject_BoundingSphere, &BVHVisualization::ConstructTopDownSAHBoundingSphereBVHandRenderDataForScene);
+	RefitOrReconstructTree(m_tLBVHAABBs, uiMovedObjectIndex, CollisionDetection::RefitBVHForObject_AABB, &BVHVisualization::ConstructLBVHAABBBVHandRenderDataForScene);
+	RefitOrReconstructTree(m_tLBVHBoundingSpheres, uiMovedObjectIndex, CollisionDetection::RefitBVHForObject_BoundingSphere, &BVHVisualization::ConstructLBVHBoundingSphereBVHandRenderDataForScene);
+	RefitOrReconstructTree(m_tPLOCAABBs, uiMovedObjectIndex, CollisionDetection::RefitBVHForObject_AABB, &BVHVisualization::ConstructPLOCAABBBVHandRenderDataForScene);
+	RefitOrReconstructTree(m_tPLOCBoundingSpheres, uiMovedObjectIndex, CollisionDetection::RefitBVHForObject_BoundingSphere, &BVHVisualization::ConstructPLOCBoundingSphereBVHandRenderDataForScene);
+
 	ResetSimulation();
 }
 
+void BVHVisualization::RefitOrReconstructTree(BVHRenderingDataTuple & rBVHRenderDataTuple, size_t uiMovedObjectIndex, void(*pRefitBVHForObject)(CollisionDetection::BoundingVolumeHierarchy&, const SceneObject*, size_t), void(BVHVisualization::* pConstructBVHandRenderData)(Scene&, BVHRenderingDataTuple&))
+{
+	pRefitBVHForObject(rBVHRenderDataTuple.m_tBVH, m_tScene.m_vecObjects.data(), uiMovedObjectIndex);
+
+	if (rBVHRenderDataTuple.m_tBVH.CalcRefitDegradation() > m_fRefitRebuildThreshold)
+	{
+		rBVHRenderDataTuple.DeleteAllData();
+		(this->*pConstructBVHandRenderData)(m_tScene, rBVHRenderDataTuple);
+	}
+	else
+	{
+		// the rendering data points into the tree and is up to date already, only the flattened copy has to follow along the same path
+		CollisionDetection::RefitLinearBVHForObject(rBVHRenderDataTuple.m_tLinearBVH, rBVHRenderDataTuple.m_tBVH, uiMovedObjectIndex);
+	}
+}
+
+void BVHVisualization::RunRayCastBenchmark()
+{
+	// the flattened hierarchies and the packets rely on node AABBs, so they always use the AABB tree
+	const CollisionDetection::BoundingVolumeHierarchy& rAABBBVH = GetBVHRenderingDataTuple(eBVHBoundingVolume::AABB).m_tBVH;
+	const CollisionDetection::BoundingVolumeHierarchy& rBoundingSphereBVH = GetBVHRenderingDataTuple(eBVHBoundingVolume::BOUNDING_SPHERE).m_tBVH;
+	const CollisionDetection::LinearBVH& rLinearBVH = GetBVHRenderingDataTuple(eBVHBoundingVolume::AABB).m_tLinearBVH;
+
+	// rays through a grid over the whole 3D window, just like CursorClick constructs them for a single pixel.
+	// They are ordered in tiles of 4 x 4, so consecutive rays - and thereby the rays of a packet - are neighbours
+	const int iGridSize = 256;
+	const int iTileSize = 4;
+	const glm::mat4 mat4InverseProjection = glm::inverse(m_mat4PerspectiveProjection3DWindow);
+	const glm::mat4 mat4InverseCamera = glm::inverse(m_mat4Camera);
+	const glm::vec3 vec3RayOrigin = m_tCamera.GetCurrentPosition();
+
+	std::vector<CollisionDetection::Ray> vecRays;
+	vecRays.reserve(iGridSize * iGridSize);
+	for (int iTileY = 0; iTileY < iGridSize; iTileY += iTileSize)
+	{
+		for (int iTileX = 0; iTileX < iGridSize; iTileX += iTileSize)
+		{
+			for (int iY = iTileY; iY < iTileY + iTileSize; iY++)
+			{
+				for (int iX = iTileX; iX < iTileX + iTileSize; iX++)
+				{
+					const glm::vec4 vec4RayClipSpace(2.0f * (iX + 0.5f) / iGridSize - 1.0f, 1.0f - 2.0f * (iY + 0.5f) / iGridSize, -1.0f, 1.0f);
+					const glm::vec4 vec4RayEyeSpace = mat4InverseProjection * vec4RayClipSpace;
+					const glm::vec3 vec3RayDirection = glm::normalize(glm::vec3(mat4InverseCamera * glm::vec4(vec4RayEyeSpace.x, vec4RayEyeSpace.y, -1.0f, 0.0f)));
+					vecRays.push_back(CollisionDetection::Ray(vec3RayOrigin, vec3RayDirection));
+				}
+			}
+		}
+	}
+
+	std::vector<CollisionDetection::RayCastIntersectionResult> vecResults(vecRays.size());
+
+	// both trees are traversed the same way, nearer child first, so only their bounding volumes make the difference
+	const std::chrono::high_resolution_clock::time_point tAABBHierarchyStart = std::chrono::high_resolution_clock::now();
+	for (size_t uiCurrentRay = 0u; uiCurrentRay < vecRays.size(); uiCurrentRay++)
+		vecResults[uiCurrentRay] = CollisionDetection::CastRayIntoBVH(rAABBBVH, vecRays[uiCurrentRay], CollisionDetection::STACK_TRAVERSAL);
+	const float fAABBHierarchySeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - tAABBHierarchyStart).count();
+	m_pHierarchyBenchmarkRaysPerSecond[eBVHBoundingVolume::AABB] = static_cast<float>(vecRays.size()) / std::max(fAABBHierarchySeconds, std::numeric_limits<float>::min());
+
+	const std::chrono::high_resolution_clock::time_point tBoundingSphereHierarchyStart = std::chrono::high_resolution_clock::now();
+	for (size_t uiCurrentRay = 0u; uiCurrentRay < vecRays.size(); uiCurrentRay++)
+		vecResults[uiCurrentRay] = CollisionDetection::CastRayIntoBVH_BoundingSphere(rBoundingSphereBVH, vecRays[uiCurrentRay]);
+	const float fBoundingSphereHierarchySeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - tBoundingSphereHierarchyStart).count();
+	m_pHierarchyBenchmarkRaysPerSecond[eBVHBoundingVolume::BOUNDING_SPHERE] = static_cast<float>(vecRays.size()) / std::max(fBoundingSphereHierarchySeconds, std::numeric_limits<float>::min());
+
+	const std::chrono::high_resolution_clock::time_point tSingleRaysStart = std::chrono::high_resolution_clock::now();
+	for (size_t uiCurrentRay = 0u; uiCurrentRay < vecRays.size(); uiCurrentRay++)
+		vecResults[uiCurrentRay] = CollisionDetection::CastRayIntoBVH(rLinearBVH, vecRays[uiCurrentRay]);
+	const float fSingleRaysSeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - tSingleRaysStart).count();
+	m_fSingleRayBenchmarkRaysPerSecond = static_cast<float>(vecRays.size()) / std::max(fSingleRaysSeconds, std::numeric_limits<float>::min());
+
+	const size_t pPacketSizes[3] = { 4u, 8u, 16u };
+	for (size_t uiCurrentPacketSize = 0u; uiCurrentPacketSize < 3u; uiCurrentPacketSize++)
+	{
+		const std::chrono::high_resolution_clock::time_point tPacketsStart = std::chrono::high_resolution_clock::now();
+		CollisionDetection::CastRayPacketsIntoBVH(rLinearBVH, vecRays.data(), vecRays.size(), pPacketSizes[uiCurrentPacketSize], vecResults.data());
+		const float fPacketsSeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - tPacketsStart).count();
+		m_pRayPacketBenchmarkRaysPerSecond[uiCurrentPacketSize] = static_cast<float>(vecRays.size()) / std::max(fPacketsSeconds, std::numeric_limits<float>::min());
+	}
+
+	// the k-d tree subdivides space instead of the objects. It is not part of any strategy, so it is constructed for the benchmark only
+	const std::chrono::high_resolution_clock::time_point tKDTreeConstructionStart = std::chrono::high_resolution_clock::now();
+	const CollisionDetection::KDTree tKDTree = CollisionDetection::ConstructKDTree(m_tScene.m_vecObjects.data(), m_tScene.m_vecObjects.size(), CollisionDetection::KDTreeParameters());
+	m_fKDTreeConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tKDTreeConstructionStart).count();
+	m_uiKDTreeNumObjectReferences = tKDTree.m_vecObjectReferences.size();
+
+	const std::chrono::high_resolution_clock::time_point tKDTreeStart = std::chrono::high_resolution_clock::now();
+	for (size_t uiCurrentRay = 0u; uiCurrentRay < vecRays.size(); uiCurrentRay++)
+		vecResults[uiCurrentRay] = CollisionDetection::CastRayIntoBVH(tKDTree, vecRays[uiCurrentRay]);
+	const float fKDTreeSeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - tKDTreeStart).count();
+	m_fKDTreeBenchmarkRaysPerSecond = static_cast<float>(vecRays.size()) / std::max(fKDTreeSeconds, std::numeric_limits<float>::min());
+}
+
+void BVHVisualization::RunOverlappingPairsBenchmark()
+{
+	const CollisionDetection::BoundingVolumeHierarchy& rAABBBVH = GetBVHRenderingDataTuple(eBVHBoundingVolume::AABB).m_tBVH;
+
+	// a first query sizes the buffer, so none of the timed ones has to allocate
+	const size_t uiNumPairs = CollisionDetection::FindOverlappingObjectPairs_AABB(rAABBBVH, m_vecOverlappingObjectPairs.data(), m_vecOverlappingObjectPairs.size(), &m_tTaskPool);
+	if (uiNumPairs > m_vecOverlappingObjectPairs.size())
+		m_vecOverlappingObjectPairs.resize(uiNumPairs);
+
+	const std::chrono::high_resolution_clock::time_point tBruteForceStart = std::chrono::high_resolution_clock::now();
+	m_uiNumOverlappingObjectPairs = CollisionDetection::BruteForceOverlappingObjectPairs(m_tScene.m_vecObjects, m_vecOverlappingObjectPairs.data(), m_vecOverlappingObjectPairs.size());
+	m_pOverlappingPairsBenchmarkMilliseconds[0] = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tBruteForceStart).count();
+
+	const std::chrono::high_resolution_clock::time_point tHierarchyStart = std::chrono::high_resolution_clock::now();
+	m_uiNumOverlappingObjectPairs = CollisionDetection::FindOverlappingObjectPairs_AABB(rAABBBVH, m_vecOverlappingObjectPairs.data(), m_vecOverlappingObjectPairs.size(), nullptr);
+	m_pOverlappingPairsBenchmarkMilliseconds[1] = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tHierarchyStart).count();
+
+	const std::chrono::high_resolution_clock::time_point tParallelHierarchyStart = std::chrono::high_resolution_clock::now();
+	m_uiNumOverlappingObjectPairs = CollisionDetection::FindOverlappingObjectPairs_AABB(rAABBBVH, m_vecOverlappingObjectPairs.data(), m_vecOverlappingObjectPairs.size(), &m_tTaskPool);
+	m_pOverlappingPairsBenchmarkMilliseconds[2] = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tParallelHierarchyStart).count();
+	assert(m_uiNumOverlappingObjectPairs == uiNumPairs);
+}
+
+CollisionDetection::RayCastIntersectionResult BVHVisualization::CastRayIntoActiveBVH(const CollisionDetection::Ray & rCastedRay) const
+{
+	assert(m_pCurrentlyActiveConstructionStrategy);
+
+	if (m_eBVHBoundingVolume == eBVHBoundingVolume::BOUNDING_SPHERE)
+		return CollisionDetection::CastRayIntoBVH_BoundingSphere(m_pCurrentlyActiveConstructionStrategy->m_tBVH, rCastedRay);
+
+	return CollisionDetection::CastRayIntoBVH(m_pCurrentlyActiveConstructionStrategy->m_tLinearBVH, rCastedRay);
+}
+
 
 void BVHVisualization::Render2DGraph() const
 {
@@ -433,6 +630,30 @@ void BVHVisualization::Render2DGraph() const
 			vec4NodeRenderColor_Gradient = m_vec4BottomUpNodeRenderColor_Gradient;
 			iDeepestDepthOfNodes = m_tBottomUpAABBs.m_tBVH.m_iTDeepestDepthOfNodes;
 		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::TOPDOWN_SAH)
+		{
+			pvecNodeRenderData = &m_tTopDownSAHAABBs.m_vecTreeNodeDataForRendering;
+			pvecLeafRenderData = &m_tTopDownSAHAABBs.m_vecTreeLeafDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4TopDownSAHNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4TopDownSAHNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tTopDownSAHAABBs.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::LBVH)
+		{
+			pvecNodeRenderData = &m_tLBVHAABBs.m_vecTreeNodeDataForRendering;
+			pvecLeafRenderData = &m_tLBVHAABBs.m_vecTreeLeafDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4LBVHNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4LBVHNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tLBVHAABBs.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::PLOC)
+		{
+			pvecNodeRenderData = &m_tPLOCAABBs.m_vecTreeNodeDataForRendering;
+			pvecLeafRenderData = &m_tPLOCAABBs.m_vecTreeLeafDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4PLOCNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4PLOCNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tPLOCAABBs.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
 	}
 	else if (GetCurrentBVHBoundingVolume() == eBVHBoundingVolume::BOUNDING_SPHERE)
 	{
@@ -452,6 +673,30 @@ void BVHVisualization::Render2DGraph() const
 			vec4NodeRenderColor_Gradient = m_vec4BottomUpNodeRenderColor_Gradient;
 			iDeepestDepthOfNodes = m_tBottomUpBoundingSpheres.m_tBVH.m_iTDeepestDepthOfNodes;
 		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::TOPDOWN_SAH)
+		{
+			pvecNodeRenderData = &m_tTopDownSAHBoundingSpheres.m_vecTreeNodeDataForRendering;
+			pvecLeafRenderData = &m_tTopDownSAHBoundingSpheres.m_vecTreeLeafDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4TopDownSAHNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4TopDownSAHNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tTopDownSAHBoundingSpheres.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::LBVH)
+		{
+			pvecNodeRenderData = &m_tLBVHBoundingSpheres.m_vecTreeNodeDataForRendering;
+			pvecLeafRenderData = &m_tLBVHBoundingSpheres.m_vecTreeLeafDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4LBVHNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4LBVHNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tLBVHBoundingSpheres.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::PLOC)
+		{
+			pvecNodeRenderData = &m_tPLOCBoundingSpheres.m_vecTreeNodeDataForRendering;
+			pvecLeafRenderData = &m_tPLOCBoundingSpheres.m_vecTreeLeafDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4PLOCNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4PLOCNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tPLOCBoundingSpheres.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
 	}
 	else
 	{
@@ -489,7 +734,7 @@ void BVHVisualization::Render2DGraph() const
 	{
 		for (const TreeNodeForRendering& rCurrentRendered2DLeaf : *pvecLeafRenderData)
 		{
-			Draw2DObjectAtPosition(rCurrentRendered2DLeaf.m_vec2_2DNodeDrawPosition, vec4LeafDrawColor);
+			Draw2DLeafAtPosition(rCurrentRendered2DLeaf.m_vec2_2DNodeDrawPosition, vec4LeafDrawColor, rCurrentRendered2DLeaf.m_pNodeToBeRendered->m_uiNumOjbects);
 			DrawLineFromTo(rCurrentRendered2DLeaf.m_vec2_2DLineToParentOrigin, rCurrentRendered2DLeaf.m_vec2_2DLineToParentTarget);
 		}
 	}
@@ -545,6 +790,8 @@ void BVHVisualization::Render3DVisualization()
 
 	glAssert();
 
+	if (m_bFrustumCulling)
+		CullObjectsOutsideOfFrustum();
 	RenderRealObjects();
 	RenderDataStructureObjects();
 	Render3DSceneConstants();
@@ -570,6 +817,23 @@ void BVHVisualization::RenderVisualizationGUI()
 		RenderObjectPropertiesWindow();
 }
 
+void BVHVisualization::CullObjectsOutsideOfFrustum()
+{
+	assert(m_pCurrentlyActiveConstructionStrategy);
+
+	const std::chrono::high_resolution_clock::time_point tQueryStart = std::chrono::high_resolution_clock::now();
+	const CollisionDetection::Frustum tFrustum = CollisionDetection::CreateFrustum(m_mat4PerspectiveProjection3DWindow * m_mat4Camera);
+	// the flattened copy holds node AABBs for Bounding Sphere hierarchies as well
+	const CollisionDetection::LinearBVH& rLinearBVH = m_pCurrentlyActiveConstructionStrategy->m_tLinearBVH;
+	m_uiNumVisibleObjects = CollisionDetection::FindObjectsInFrustum(rLinearBVH, tFrustum, m_vecVisibleObjects.data(), m_vecVisibleObjects.size());
+	if (m_uiNumVisibleObjects > m_vecVisibleObjects.size())
+	{
+		m_vecVisibleObjects.resize(m_uiNumVisibleObjects);
+		m_uiNumVisibleObjects = CollisionDetection::FindObjectsInFrustum(rLinearBVH, tFrustum, m_vecVisibleObjects.data(), m_vecVisibleObjects.size());
+	}
+	m_fFrustumCullingMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - tQueryStart).count();
+}
+
 void BVHVisualization::RenderRealObjects() const
 {
 	assert(glfwGetCurrentContext() == m_pMainWindow->m_pGLFWwindow); // set the right context before calling this funtion
@@ -583,40 +847,51 @@ void BVHVisualization::RenderRealObjects() const
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, m_uiObjectDiffuseTexture);
 
-	for (const SceneObject& rCurrentSceneObject : m_tScene.m_vecObjects)
+	if (m_bFrustumCulling)
+	{
+		for (size_t uiCurrentVisibleObject = 0u; uiCurrentVisibleObject < m_uiNumVisibleObjects; uiCurrentVisibleObject++)
+			RenderRealObject(*m_vecVisibleObjects[uiCurrentVisibleObject]);
+	}
+	else
 	{
-		const SceneObject::Transform& rCurrentTransform = rCurrentSceneObject.m_tTransform;
+		for (const SceneObject& rCurrentSceneObject : m_tScene.m_vecObjects)
+			RenderRealObject(rCurrentSceneObject);
+	}
+}
 
-		// calculate the model matrix for each object and pass it to shader before drawing
-		glm::mat4 world = glm::mat4(1.0f); // starting with identity matrix
-		// translation
-		world = glm::translate(world, rCurrentTransform.m_vec3Position);
-		// rotation
-		world = glm::rotate(world, glm::radians(rCurrentTransform.m_tRotation.m_fAngle), rCurrentTransform.m_tRotation.m_vec3Axis);
-		// scale
-		world = glm::scale(world, rCurrentTransform.m_vec3Scale);
-		m_tFlatTextureShader.setMat4("world", world);
+void BVHVisualization::RenderRealObject(const SceneObject & rSceneObject) const
+{
+	const SceneObject::Transform& rCurrentTransform = rSceneObject.m_tTransform;
 
-		glAssert();
+	// calculate the model matrix for each object and pass it to shader before drawing
+	glm::mat4 world = glm::mat4(1.0f); // starting with identity matrix
+	// translation
+	world = glm::translate(world, rCurrentTransform.m_vec3Position);
+	// rotation
+	world = glm::rotate(world, glm::radians(rCurrentTransform.m_tRotation.m_fAngle), rCurrentTransform.m_tRotation.m_vec3Axis);
+	// scale
+	world = glm::scale(world, rCurrentTransform.m_vec3Scale);
+	m_tFlatTextureShader.setMat4("world", world);
 
-		// render
-		if (rCurrentSceneObject.m_eType == SceneObject::eType::CUBE)
-		{
-			glBindVertexArray(m_uiTexturedCubeVAO);
-			glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(sizeof(Primitives::Cube::IndexData) / sizeof(GLuint)), GL_UNSIGNED_INT, 0);
-		}
-		else if (rCurrentSceneObject.m_eType == SceneObject::eType::SPHERE)
-		{
-			glBindVertexArray(m_uiTexturedSphereVAO);
-			glDrawArrays(GL_TRIANGLES, 0, Primitives::Sphere::NumberOfTrianglesInSphere * 3);
-		}
-		else
-		{
-			assert(!"disaster :)");
-		}
+	glAssert();
 
-		glAssert();
+	// render
+	if (rSceneObject.m_eType == SceneObject::eType::CUBE)
+	{
+		glBindVertexArray(m_uiTexturedCubeVAO);
+		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(sizeof(Primitives::Cube::IndexData) / sizeof(GLuint)), GL_UNSIGNED_INT, 0);
+	}
+	else if (rSceneObject.m_eType == SceneObject::eType::SPHERE)
+	{
+		glBindVertexArray(m_uiTexturedSphereVAO);
+		glDrawArrays(GL_TRIANGLES, 0, Primitives::Sphere::NumberOfTrianglesInSphere * 3);
 	}
+	else
+	{
+		assert(!"disaster :)");
+	}
+
+	glAssert();
 }
 
 void BVHVisualization::RenderHUDComponents() const
@@ -710,6 +985,27 @@ void BVHVisualization::RenderDataStructureObjects() const
 			vec4NodeRenderColor_Gradient = m_vec4BottomUpNodeRenderColor_Gradient;
 			iDeepestDepthOfNodes = m_tBottomUpAABBs.m_tBVH.m_iTDeepestDepthOfNodes;
 		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::TOPDOWN_SAH)
+		{
+			pvecNodeRenderData = &m_tTopDownSAHAABBs.m_vecTreeNodeDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4TopDownSAHNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4TopDownSAHNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tTopDownSAHAABBs.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::LBVH)
+		{
+			pvecNodeRenderData = &m_tLBVHAABBs.m_vecTreeNodeDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4LBVHNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4LBVHNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tLBVHAABBs.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::PLOC)
+		{
+			pvecNodeRenderData = &m_tPLOCAABBs.m_vecTreeNodeDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4PLOCNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4PLOCNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tPLOCAABBs.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
 	}
 	else if (GetCurrentBVHBoundingVolume() == eBVHBoundingVolume::BOUNDING_SPHERE)
 	{
@@ -727,6 +1023,27 @@ void BVHVisualization::RenderDataStructureObjects() const
 			vec4NodeRenderColor_Gradient = m_vec4BottomUpNodeRenderColor_Gradient;
 			iDeepestDepthOfNodes = m_tBottomUpBoundingSpheres.m_tBVH.m_iTDeepestDepthOfNodes;
 		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::TOPDOWN_SAH)
+		{
+			pvecNodeRenderData = &m_tTopDownSAHBoundingSpheres.m_vecTreeNodeDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4TopDownSAHNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4TopDownSAHNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tTopDownSAHBoundingSpheres.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::LBVH)
+		{
+			pvecNodeRenderData = &m_tLBVHBoundingSpheres.m_vecTreeNodeDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4LBVHNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4LBVHNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tLBVHBoundingSpheres.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
+		if (GetCurrenBVHConstructionStrategy() == eBVHConstructionStrategy::PLOC)
+		{
+			pvecNodeRenderData = &m_tPLOCBoundingSpheres.m_vecTreeNodeDataForRendering;
+			vec4NodeRenderColor_Base = m_vec4PLOCNodeRenderColor;
+			vec4NodeRenderColor_Gradient = m_vec4PLOCNodeRenderColor_Gradient;
+			iDeepestDepthOfNodes = m_tPLOCBoundingSpheres.m_tBVH.m_iTDeepestDepthOfNodes;
+		}
 	}
 	else
 	{
@@ -816,8 +1133,9 @@ void BVHVisualization::MoveToPreviousSimulationStep()
 
 	// bounds checks
 	m_iNumberStepsRendered = std::max<int>(0, iNextNumberOfConstructionStepsRendered);
-	assert(m_tTopDownAABBs.m_vecTreeNodeDataForRendering.size() <= std::numeric_limits<int>::max());	// make sure that number fits or chaos might ensue. This assertion will probably never fire... but it doesnt hurt either
-	m_iNumberStepsRendered = std::min<int>(m_iNumberStepsRendered, static_cast<int>(m_tTopDownAABBs.m_vecTreeNodeDataForRendering.size())); // todo: rework to dynamically work with current set BVH
+	assert(m_pCurrentlyActiveConstructionStrategy);
+	assert(m_pCurrentlyActiveConstructionStrategy->m_vecTreeNodeDataForRendering.size() <= std::numeric_limits<int>::max());	// make sure that number fits or chaos might ensue. This assertion will probably never fire... but it doesnt hurt either
+	m_iNumberStepsRendered = std::min<int>(m_iNumberStepsRendered, static_cast<int>(m_pCurrentlyActiveConstructionStrategy->m_vecTreeNodeDataForRendering.size()));
 }
 
 void BVHVisualization::MoveToNextSimulationStep()
@@ -826,8 +1144,9 @@ void BVHVisualization::MoveToNextSimulationStep()
 
 	// bounds checks
 	m_iNumberStepsRendered = std::max<int>(0, iNextNumberOfConstructionStepsRendered);
-	assert(m_tTopDownAABBs.m_vecTreeNodeDataForRendering.size() <= std::numeric_limits<int>::max());	// make sure that number fits or chaos might ensue. This assertion will probably never fire... but it doesnt hurt either
-	m_iNumberStepsRendered = std::min<int>(m_iNumberStepsRendered, static_cast<int>(m_tTopDownAABBs.m_vecTreeNodeDataForRendering.size())); // todo: rework to dynamically work with current set BVH
+	assert(m_pCurrentlyActiveConstructionStrategy);
+	assert(m_pCurrentlyActiveConstructionStrategy->m_vecTreeNodeDataForRendering.size() <= std::numeric_limits<int>::max());	// make sure that number fits or chaos might ensue. This assertion will probably never fire... but it doesnt hurt either
+	m_iNumberStepsRendered = std::min<int>(m_iNumberStepsRendered, static_cast<int>(m_pCurrentlyActiveConstructionStrategy->m_vecTreeNodeDataForRendering.size()));
 }
 
 void BVHVisualization::AdvanceSimulationInCurrentDirection()
@@ -850,6 +1169,7 @@ void BVHVisualization::SetNewBVHConstructionStrategy(eBVHConstructionStrategy eN
 	if (m_eConstructionStrategy != eNewStrategy)
 	{
 		m_eConstructionStrategy = eNewStrategy;
+		UpdateCurrentlyActiveBVH();
 		ResetSimulation();
 	}
 }
@@ -864,37 +1184,80 @@ void BVHVisualization::SetNewBVHBoundingVolume(eBVHBoundingVolume eNewBoundingVo
 	if (m_eBVHBoundingVolume != eNewBoundingVolume)
 	{
 		m_eBVHBoundingVolume = eNewBoundingVolume;
+		UpdateCurrentlyActiveBVH();
 		ResetSimulation();
 	}
 }
 
-void BVHVisualization::DeleteGivenObject(SceneObject* pToBeDeletedObject)
+void BVHVisualization::UpdateCurrentlyActiveBVH()
 {
-	assert(pToBeDeletedObject);
+	m_pCurrentlyActiveConstructionStrategy = &GetBVHRenderingDataTuple(m_eBVHBoundingVolume);
+}
+
+BVHVisualization::BVHRenderingDataTuple & BVHVisualization::GetBVHRenderingDataTuple(eBVHBoundingVolume eBoundingVolume)
+{
+	const bool bIsAABB = (eBoundingVolume == eBVHBoundingVolume::AABB);
+	assert(bIsAABB || eBoundingVolume == eBVHBoundingVolume::BOUNDING_SPHERE);
 
-	for (auto it = m_tScene.m_vecObjects.begin(); it != m_tScene.m_vecObjects.end(); it++)
+	switch (m_eConstructionStrategy)
 	{
-		if (&(*it) == pToBeDeletedObject)
-		{
-			m_tScene.m_vecObjects.erase(it);
-			break;
-		}
+	case eBVHConstructionStrategy::TOPDOWN:
+		return bIsAABB ? m_tTopDownAABBs : m_tTopDownBoundingSpheres;
+	case eBVHConstructionStrategy::BOTTOMUP:
+		return bIsAABB ? m_tBottomUpAABBs : m_tBottomUpBoundingSpheres;
+	case eBVHConstructionStrategy::TOPDOWN_SAH:
+		return bIsAABB ? m_tTopDownSAHAABBs : m_tTopDownSAHBoundingSpheres;
+	case eBVHConstructionStrategy::LBVH:
+		return bIsAABB ? m_tLBVHAABBs : m_tLBVHBoundingSpheres;
+	case eBVHConstructionStrategy::PLOC:
+		return bIsAABB ? m_tPLOCAABBs : m_tPLOCBoundingSpheres;
+	default:
+		assert(!"disaster");
+		return m_tTopDownAABBs;
 	}
+}
+
+void BVHVisualization::DeleteGivenObject(SceneObject* pToBeDeletedObject)
+{
+	assert(pToBeDeletedObject);
+	const size_t uiDeletedObjectIndex = static_cast<size_t>(pToBeDeletedObject - m_tScene.m_vecObjects.data());
+	assert(uiDeletedObjectIndex < m_tScene.m_vecObjects.size());
+	const size_t uiLastObjectIndex = m_tScene.m_vecObjects.size() - 1u;
+
+	// the last object fills the gap, so no other object changes its index
+	const std::chrono::high_resolution_clock::time_point tUpdateStart = std::chrono::high_resolution_clock::now();
+	m_tDynamicAABBTree.RemoveObject(static_cast<uint32_t>(uiDeletedObjectIndex));
+	if (uiDeletedObjectIndex != uiLastObjectIndex)
+		m_tDynamicAABBTree.ChangeObjectIndex(static_cast<uint32_t>(uiLastObjectIndex), static_cast<uint32_t>(uiDeletedObjectIndex));
+	m_fDynamicAABBTreeUpdateTimeInMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - tUpdateStart).count();
+
+	if (uiDeletedObjectIndex != uiLastObjectIndex)
+		m_tScene.m_vecObjects[uiDeletedObjectIndex] = m_tScene.m_vecObjects[uiLastObjectIndex];
+	m_tScene.m_vecObjects.pop_back();
 
 	// all updates and reset the sim
 	//CollisionDetection::UpdateBoundingVolumesForScene(*this);
 	ResetSimulation();
 	if (!m_tScene.m_vecObjects.empty())
 		ReconstructAllTrees();
+	else
+		ClearCurrentScene();	// no objects left, the trees would only reference the deleted one
 }
 
 void BVHVisualization::AddNewSceneObject(SceneObject & rNewSceneObject)
 {
+	assert(m_tScene.m_vecObjects.size() < std::numeric_limits<uint32_t>::max());
 	m_tScene.m_vecObjects.push_back(rNewSceneObject);
+	const size_t uiNewObjectIndex = m_tScene.m_vecObjects.size() - 1u;
+
+	// updating the data structures. Only the new object's bounding volumes are missing
+	CollisionDetection::ConstructBoundingVolumesForObject(m_tScene.m_vecObjects[uiNewObjectIndex]);
+	CollisionDetection::UpdateBoundingVolumesForObject(m_tScene.m_vecObjects[uiNewObjectIndex]);
+
+	const std::chrono::high_resolution_clock::time_point tUpdateStart = std::chrono::high_resolution_clock::now();
+	m_tDynamicAABBTree.InsertObject(m_tScene.m_vecObjects.data(), static_cast<uint32_t>(uiNewObjectIndex));
+	m_fDynamicAABBTreeUpdateTimeInMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - tUpdateStart).count();
 
-	// updating the data structures
-	CollisionDetection::ConstructBoundingVolumesForScene(m_tScene);	// todo: improve this: only need to construct the BVS for the new object
-	CollisionDetection::UpdateBoundingVolumesForScene(m_tScene);		// todo: same as above
 	ReconstructAllTrees();
 	ResetSimulation();
 }
@@ -908,6 +1271,13 @@ void BVHVisualization::ClearCurrentScene()
 	m_tBottomUpAABBs.DeleteAllData();
 	m_tTopDownBoundingSpheres.DeleteAllData();
 	m_tBottomUpBoundingSpheres.DeleteAllData();
+	m_tTopDownSAHAABBs.DeleteAllData();
+	m_tTopDownSAHBoundingSpheres.DeleteAllData();
+	m_tLBVHAABBs.DeleteAllData();
+	m_tLBVHBoundingSpheres.DeleteAllData();
+	m_tPLOCAABBs.DeleteAllData();
+	m_tPLOCBoundingSpheres.DeleteAllData();
+	m_tDynamicAABBTree.Clear();
 }
 
 void BVHVisualization::InitPlaybackSpeeds()
@@ -942,180 +1312,306 @@ void BVHVisualization::InitRenderColors()
 	m_vec4TopDownNodeRenderColor_Gradient = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // black
 	m_vec4BottomUpNodeRenderColor = glm::vec4(1.0f, 0.0f, 1.0f, 1.0f); // purple
 	m_vec4BottomUpNodeRenderColor_Gradient = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // black
+	m_vec4TopDownSAHNodeRenderColor = glm::vec4(1.0f, 0.5f, 0.0f, 1.0f); // orange
+	m_vec4TopDownSAHNodeRenderColor_Gradient = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // black
+	m_vec4LBVHNodeRenderColor = glm::vec4(0.0f, 0.8f, 0.8f, 1.0f); // cyan
+	m_vec4LBVHNodeRenderColor_Gradient = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // black
+	m_vec4PLOCNodeRenderColor = glm::vec4(0.0f, 0.8f, 0.0f, 1.0f); // green
+	m_vec4PLOCNodeRenderColor_Gradient = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // black
 }
 
-void BVHVisualization::RecursiveTopDownTree_AABB(CollisionDetection::BVHTreeNode ** pTree, SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+void BVHVisualization::RecursiveTopDownTree_AABB(CollisionDetection::BVHTreeNode * pNewNode, const SceneObject * pSceneObjects, CollisionDetection::ObjectReference * pObjectReferences, size_t uiFirstObjectReference, size_t uiNumObjectReferences, TaskPool * pTaskPool)
 {
-	assert(pTree);
+	assert(pNewNode);
 	assert(pSceneObjects);
-	assert(uiNumSceneObjects > 0);
+	assert(pObjectReferences);
+	assert(uiNumObjectReferences > 0);
+
+	CollisionDetection::ObjectReference* pCurrentObjectReferences = pObjectReferences + uiFirstObjectReference;
+
+	// create AABB bounding volume for the current set of objects. Leaves need their own too, since they might hold several objects
+	if (uiNumObjectReferences == 1)
+		pNewNode->m_tAABBForNode = pSceneObjects[pCurrentObjectReferences->m_uiObjectIndex].m_tWorldSpaceAABB;
+	else
+		pNewNode->m_tAABBForNode = CollisionDetection::CreateAABBForMultipleObjects(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences);
 
-	const uint8_t uiNumberOfObjectsPerLeaf = 1u;
-	CollisionDetection::BVHTreeNode* pNewNode = new CollisionDetection::BVHTreeNode;
-	*pTree = pNewNode;
+	// partition current set into subsets IN PLACE!!! Small enough sets become a leaf, unless the SAH is asked and considers splitting them cheaper
+	const bool bIsLeafAllowed = (uiNumObjectReferences <= m_tObjectMeanLeafParameters.m_uiMaxObjectsPerLeaf);
+	size_t uiNumLeftchildren = 0u;
+	if (!bIsLeafAllowed || (m_tObjectMeanLeafParameters.m_bTerminateBySAH && uiNumObjectReferences > 1))
+	{
+		if (pTaskPool)
+			uiNumLeftchildren = CollisionDetection::PartitionObjectReferencesInPlace_AABB(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences, *pTaskPool);
+		else
+			uiNumLeftchildren = CollisionDetection::PartitionObjectReferencesInPlace_AABB(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences);
 
-	if (uiNumSceneObjects <= uiNumberOfObjectsPerLeaf) // is a leaf
+		if (bIsLeafAllowed && CollisionDetection::IsLeafCheaperThanSplit_AABB(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences, uiNumLeftchildren, m_tObjectMeanLeafParameters))
+			uiNumLeftchildren = 0u;
+	}
+
+	if (uiNumLeftchildren == 0u) // is a leaf
 	{
-		assert(uiNumSceneObjects == 1); // needs reconsideration for >1 objects per leaf
-		// bounding volumes for single objects is already done, no need to compute that here
-		pNewNode->m_uiNumOjbects = static_cast<uint8_t>(uiNumSceneObjects);
-		pNewNode->m_pObjects = pSceneObjects;
+		assert(uiNumObjectReferences <= std::numeric_limits<uint32_t>::max());
+		pNewNode->m_uiNumOjbects = static_cast<uint32_t>(uiNumObjectReferences);
+		pNewNode->m_uiFirstObject = static_cast<uint32_t>(uiFirstObjectReference);
 	}
 	else // is a node
 	{
-		// create AABB bounding volume for the current set of objects
-		pNewNode->m_tAABBForNode = CollisionDetection::CreateAABBForMultipleObjects(pSceneObjects, uiNumSceneObjects);
+		// the left subtree's reserved nodes directly follow this node, the right subtree's ones follow those
+		pNewNode->m_pLeft = pNewNode + 1;
+		pNewNode->m_pRight = pNewNode + 2u * uiNumLeftchildren;
 
-		// partition current set into subsets IN PLACE!!!
-		size_t uiNumLeftchildren = CollisionDetection::PartitionSceneObjectsInPlace_AABB(pSceneObjects, uiNumSceneObjects);
+		if (pTaskPool && uiNumObjectReferences >= s_uiMinNumObjectReferencesForSubtreeTask)
+		{
+			// both sides are independent of each other now. The "left" side is offered to idle threads, the "right" side is built right here
+			TaskPool::TaskGroup tLeftSubtree;
+			pTaskPool->Submit(tLeftSubtree, [=]() {
+				RecursiveTopDownTree_AABB(pNewNode->m_pLeft, pSceneObjects, pObjectReferences, uiFirstObjectReference, uiNumLeftchildren, pTaskPool);
+			});
 
-		// move on with "left" side
-		RecursiveTopDownTree_AABB(&(pNewNode->m_pLeft), pSceneObjects, uiNumLeftchildren);
+			RecursiveTopDownTree_AABB(pNewNode->m_pRight, pSceneObjects, pObjectReferences, uiFirstObjectReference + uiNumLeftchildren, uiNumObjectReferences - uiNumLeftchildren, pTaskPool);
 
-		// move on with "right" side
-		RecursiveTopDownTree_AABB(&(pNewNode->m_pRight), pSceneObjects + uiNumLeftchildren, uiNumSceneObjects - uiNumLeftchildren);
+			pTaskPool->Wait(tLeftSubtree);
+		}
+		else
+		{
+			// move on with "left" side
+			RecursiveTopDownTree_AABB(pNewNode->m_pLeft, pSceneObjects, pObjectReferences, uiFirstObjectReference, uiNumLeftchildren, pTaskPool);
+
+			// move on with "right" side
+			RecursiveTopDownTree_AABB(pNewNode->m_pRight, pSceneObjects, pObjectReferences, uiFirstObjectReference + uiNumLeftchildren, uiNumObjectReferences - uiNumLeftchildren, pTaskPool);
+		}
 	}
 }
 
-CollisionDetection::BVHTreeNode * BVHVisualization::BottomUpTree_AABB(SceneObject * pSceneObjects, size_t uiNumSceneObjects, BVHRenderingDataTuple& rBVHRenderDataTuple)
+CollisionDetection::BVHTreeNode * BVHVisualization::BottomUpTree_AABB(SceneObject * pSceneObjects, size_t uiNumSceneObjects, const std::vector<CollisionDetection::BottomUpMerge>& rvecMerges, BVHRenderingDataTuple& rBVHRenderDataTuple)
 {
 	assert(uiNumSceneObjects > 0);
+	assert(rvecMerges.size() == uiNumSceneObjects - 1u);
 
-	CollisionDetection::BVHTreeNode** pTempNodes = new CollisionDetection::BVHTreeNode*[uiNumSceneObjects]; // careful: these are pointers to pointers
+	// every leaf and every node is addressed by its index in the merge order
+	std::vector<CollisionDetection::BVHTreeNode*> vecNodes;
+	vecNodes.reserve(2u * uiNumSceneObjects - 1u);
 
 	// creating all leaf nodes: number leaves == number objects
 	for (size_t uiCurrentNewLeafNode = 0u; uiCurrentNewLeafNode < uiNumSceneObjects; uiCurrentNewLeafNode++)
 	{
-		pTempNodes[uiCurrentNewLeafNode] = new CollisionDetection::BVHTreeNode;	// assigning the adress of the new leaf node to the pointer pointed at by pTempNodes[current]
-		pTempNodes[uiCurrentNewLeafNode]->m_uiNumOjbects = 1u;
-		pTempNodes[uiCurrentNewLeafNode]->m_pObjects = &pSceneObjects[uiCurrentNewLeafNode];
-		pTempNodes[uiCurrentNewLeafNode]->m_tAABBForNode = pTempNodes[uiCurrentNewLeafNode]->m_pObjects->m_tWorldSpaceAABB;
+		CollisionDetection::BVHTreeNode* pNewLeafNode = rBVHRenderDataTuple.m_tBVH.AllocateNode();
+		pNewLeafNode->m_uiNumOjbects = 1u;
+		pNewLeafNode->m_uiFirstObject = static_cast<uint32_t>(uiCurrentNewLeafNode);	// bottom up construction never reorders objects, leaf i references object i
+		pNewLeafNode->m_tAABBForNode = pSceneObjects[uiCurrentNewLeafNode].m_tWorldSpaceAABB;
+		vecNodes.push_back(pNewLeafNode);
 	}
 
 	// for visualization purposes
 	int16_t iNumConstructedNodes = 0;
 
-	// merging leaves into nodes until root node is constructed
-	while (uiNumSceneObjects > 1) {
-		// Pick two volumes to pair together
-		size_t uiMergedNodeIndex1 = 0, uiMergedNodeIndex2 = 0;
-		CollisionDetection::FindBottomUpNodesToMerge_AABB(pTempNodes, uiNumSceneObjects, uiMergedNodeIndex1, uiMergedNodeIndex2);
-
+	// merging leaves into nodes in the given order, until root node is constructed
+	for (const CollisionDetection::BottomUpMerge& rCurrentMerge : rvecMerges)
+	{
 		// Pair them in new parent node
-		CollisionDetection::BVHTreeNode* pParentNode = new CollisionDetection::BVHTreeNode;
-		pParentNode->m_pLeft = pTempNodes[uiMergedNodeIndex1];
-		pParentNode->m_pRight = pTempNodes[uiMergedNodeIndex2];
+		CollisionDetection::BVHTreeNode* pParentNode = rBVHRenderDataTuple.m_tBVH.AllocateNode();
+		pParentNode->m_pLeft = vecNodes[rCurrentMerge.m_uiMergePartnerIndex1];
+		pParentNode->m_pRight = vecNodes[rCurrentMerge.m_uiMergePartnerIndex2];
 		// construct AABB for that parent node (adaption from orginal code)
-		pParentNode->m_tAABBForNode = CollisionDetection::MergeTwoAABBs(pTempNodes[uiMergedNodeIndex1]->m_tAABBForNode, pTempNodes[uiMergedNodeIndex2]->m_tAABBForNode);
+		pParentNode->m_tAABBForNode = CollisionDetection::MergeTwoAABBs(pParentNode->m_pLeft->m_tAABBForNode, pParentNode->m_pRight->m_tAABBForNode);
 
 		// for visualization/rendering purposes
-		TreeNodeForRendering tNewAABBNodeForRendering;
-		tNewAABBNodeForRendering.m_iRenderingOrder = iNumConstructedNodes++;
-		tNewAABBNodeForRendering.m_pNodeToBeRendered = pParentNode;
-		rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.push_back(tNewAABBNodeForRendering);
-
-		//Updating the current set of nodes accordingly
-		size_t uiMinIndex = uiMergedNodeIndex1, uiMaxIndex = uiMergedNodeIndex2;
-		if (uiMergedNodeIndex1 > uiMergedNodeIndex2)
-		{
-			uiMinIndex = uiMergedNodeIndex2;
-			uiMaxIndex = uiMergedNodeIndex1;
-		}
-		pTempNodes[uiMinIndex] = pParentNode;
-		pTempNodes[uiMaxIndex] = pTempNodes[uiNumSceneObjects - 1];
-		uiNumSceneObjects--;
+		TreeNodeForRendering tNewNodeForRendering;
+		tNewNodeForRendering.m_iRenderingOrder = iNumConstructedNodes++;
+		tNewNodeForRendering.m_pNodeToBeRendered = pParentNode;
+		rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.push_back(tNewNodeForRendering);
+
+		vecNodes.push_back(pParentNode);
 	}
 
-	CollisionDetection::BVHTreeNode* pRootNode = pTempNodes[0]; // careful: getting the pointer to root by dereferencing the pointer to pointer
-	delete[] pTempNodes;
-	return pRootNode;
+	return vecNodes.back();	// the last merged node is the root. For a single object, that is its leaf
 }
 
-void BVHVisualization::RecursiveTopDownTree_BoundingSphere(CollisionDetection::BVHTreeNode ** pNode, SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+void BVHVisualization::RecursiveTopDownTree_BoundingSphere(CollisionDetection::BVHTreeNode * pNewNode, const SceneObject * pSceneObjects, CollisionDetection::ObjectReference * pObjectReferences, size_t uiFirstObjectReference, size_t uiNumObjectReferences, TaskPool * pTaskPool)
 {
-	assert(pNode);
+	assert(pNewNode);
 	assert(pSceneObjects);
-	assert(uiNumSceneObjects > 0);
+	assert(pObjectReferences);
+	assert(uiNumObjectReferences > 0);
 
-	const uint8_t uiNumberOfObjectsPerLeaf = 1u;
-	CollisionDetection::BVHTreeNode* pNewNode = new CollisionDetection::BVHTreeNode;
-	*pNode = pNewNode;
+	CollisionDetection::ObjectReference* pCurrentObjectReferences = pObjectReferences + uiFirstObjectReference;
 
-	if (uiNumSceneObjects <= uiNumberOfObjectsPerLeaf) // is a leaf
+	// create Bounding Sphere volume for the current set of objects. Leaves need their own too, since they might hold several objects
+	if (uiNumObjectReferences == 1)
+		pNewNode->m_tBoundingSphereForNode = pSceneObjects[pCurrentObjectReferences->m_uiObjectIndex].m_tWorldSpaceBoundingSphere;
+	else
+		pNewNode->m_tBoundingSphereForNode = CollisionDetection::CreateBoundingSphereForMultipleObjects(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences);
+
+	// partition current set into subsets IN PLACE!!! Small enough sets become a leaf, unless the SAH is asked and considers splitting them cheaper
+	const bool bIsLeafAllowed = (uiNumObjectReferences <= m_tObjectMeanLeafParameters.m_uiMaxObjectsPerLeaf);
+	size_t uiPartitioningIndex = 0u;
+	if (!bIsLeafAllowed || (m_tObjectMeanLeafParameters.m_bTerminateBySAH && uiNumObjectReferences > 1))
 	{
-		assert(uiNumSceneObjects == 1); // needs reconsideration for >1 objects per leaf
-		// bounding volumes for single objects is already done, no need to compute that here
-		pNewNode->m_uiNumOjbects = static_cast<uint8_t>(uiNumSceneObjects);
-		pNewNode->m_pObjects = pSceneObjects;
+		if (pTaskPool)
+			uiPartitioningIndex = CollisionDetection::PartitionObjectReferencesInPlace_BoundingSphere(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences, *pTaskPool);
+		else
+			uiPartitioningIndex = CollisionDetection::PartitionObjectReferencesInPlace_BoundingSphere(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences);
+
+		if (bIsLeafAllowed && CollisionDetection::IsLeafCheaperThanSplit_BoundingSphere(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences, uiPartitioningIndex, m_tObjectMeanLeafParameters))
+			uiPartitioningIndex = 0u;
+	}
+
+	if (uiPartitioningIndex == 0u) // is a leaf
+	{
+		assert(uiNumObjectReferences <= std::numeric_limits<uint32_t>::max());
+		pNewNode->m_uiNumOjbects = static_cast<uint32_t>(uiNumObjectReferences);
+		pNewNode->m_uiFirstObject = static_cast<uint32_t>(uiFirstObjectReference);
 	}
 	else // is a node
 	{
-		// create Bounding Sphere volume for the current set of objects
-		pNewNode->m_tBoundingSphereForNode = CollisionDetection::CreateBoundingSphereForMultipleObjects(pSceneObjects, uiNumSceneObjects);
+		// the left subtree's reserved nodes directly follow this node, the right subtree's ones follow those
+		pNewNode->m_pLeft = pNewNode + 1;
+		pNewNode->m_pRight = pNewNode + 2u * uiPartitioningIndex;
 
-		// partition current set into subsets IN PLACE!!!
-		size_t uiPartitioningIndex = CollisionDetection::PartitionSceneObjectsInPlace_BoundingSphere(pSceneObjects, uiNumSceneObjects);
+		if (pTaskPool && uiNumObjectReferences >= s_uiMinNumObjectReferencesForSubtreeTask)
+		{
+			// both sides are independent of each other now. The "left" side is offered to idle threads, the "right" side is built right here
+			TaskPool::TaskGroup tLeftSubtree;
+			pTaskPool->Submit(tLeftSubtree, [=]() {
+				RecursiveTopDownTree_BoundingSphere(pNewNode->m_pLeft, pSceneObjects, pObjectReferences, uiFirstObjectReference, uiPartitioningIndex, pTaskPool);
+			});
 
-		// move on with "left" side
-		RecursiveTopDownTree_BoundingSphere(&(pNewNode->m_pLeft), pSceneObjects, uiPartitioningIndex);
+			RecursiveTopDownTree_BoundingSphere(pNewNode->m_pRight, pSceneObjects, pObjectReferences, uiFirstObjectReference + uiPartitioningIndex, uiNumObjectReferences - uiPartitioningIndex, pTaskPool);
 
-		// move on with "right" side
-		RecursiveTopDownTree_BoundingSphere(&(pNewNode->m_pRight), pSceneObjects + uiPartitioningIndex, uiNumSceneObjects - uiPartitioningIndex);
+			pTaskPool->Wait(tLeftSubtree);
+		}
+		else
+		{
+			// move on with "left" side
+			RecursiveTopDownTree_BoundingSphere(pNewNode->m_pLeft, pSceneObjects, pObjectReferences, uiFirstObjectReference, uiPartitioningIndex, pTaskPool);
+
+			// move on with "right" side
+			RecursiveTopDownTree_BoundingSphere(pNewNode->m_pRight, pSceneObjects, pObjectReferences, uiFirstObjectReference + uiPartitioningIndex, uiNumObjectReferences - uiPartitioningIndex, pTaskPool);
+		}
 	}
 }
 
-CollisionDetection::BVHTreeNode * BVHVisualization::BottomUpTree_BoundingSphere(SceneObject * pSceneObjects, size_t uiNumSceneObjects, BVHRenderingDataTuple& rBVHRenderDataTuple)
+CollisionDetection::BVHTreeNode * BVHVisualization::BottomUpTree_BoundingSphere(SceneObject * pSceneObjects, size_t uiNumSceneObjects, const std::vector<CollisionDetection::BottomUpMerge>& rvecMerges, BVHRenderingDataTuple& rBVHRenderDataTuple)
 {
 	assert(uiNumSceneObjects > 0);
+	assert(rvecMerges.size() == uiNumSceneObjects - 1u);
 
-	CollisionDetection::BVHTreeNode** pTempNodes = new CollisionDetection::BVHTreeNode*[uiNumSceneObjects]; // careful: these are pointers to pointers
+	// every leaf and every node is addressed by its index in the merge order
+	std::vector<CollisionDetection::BVHTreeNode*> vecNodes;
+	vecNodes.reserve(2u * uiNumSceneObjects - 1u);
 
 	// creating all leaf nodes: number leaves == number objects
 	for (size_t uiCurrentNewLeafNode = 0u; uiCurrentNewLeafNode < uiNumSceneObjects; uiCurrentNewLeafNode++)
 	{
-		pTempNodes[uiCurrentNewLeafNode] = new CollisionDetection::BVHTreeNode;	// assigning the adress of the new leaf node to the pointer pointed at by pTempNodes[current]
-		pTempNodes[uiCurrentNewLeafNode]->m_uiNumOjbects = 1u;
-		pTempNodes[uiCurrentNewLeafNode]->m_pObjects = &pSceneObjects[uiCurrentNewLeafNode];
-		pTempNodes[uiCurrentNewLeafNode]->m_tBoundingSphereForNode = pTempNodes[uiCurrentNewLeafNode]->m_pObjects->m_tWorldSpaceBoundingSphere;
+		CollisionDetection::BVHTreeNode* pNewLeafNode = rBVHRenderDataTuple.m_tBVH.AllocateNode();
+		pNewLeafNode->m_uiNumOjbects = 1u;
+		pNewLeafNode->m_uiFirstObject = static_cast<uint32_t>(uiCurrentNewLeafNode);	// bottom up construction never reorders objects, leaf i references object i
+		pNewLeafNode->m_tBoundingSphereForNode = pSceneObjects[uiCurrentNewLeafNode].m_tWorldSpaceBoundingSphere;
+		vecNodes.push_back(pNewLeafNode);
 	}
 
 	// for visualization purposes
 	int16_t iNumConstructedNodes = 0;
 
-	// merging leaves into nodes until root node is constructed
-	while (uiNumSceneObjects > 1) {
-		// Pick two volumes to pair together
-		size_t uiMergedNodeIndex1 = 0, uiMergedNodeIndex2 = 0;
-		CollisionDetection::FindBottomUpNodesToMerge_BoundingSphere(pTempNodes, uiNumSceneObjects, uiMergedNodeIndex1, uiMergedNodeIndex2);
-
+	// merging leaves into nodes in the given order, until root node is constructed
+	for (const CollisionDetection::BottomUpMerge& rCurrentMerge : rvecMerges)
+	{
 		// Pair them in new parent node
-		CollisionDetection::BVHTreeNode* pParentNode = new CollisionDetection::BVHTreeNode;
-		pParentNode->m_pLeft = pTempNodes[uiMergedNodeIndex1];
-		pParentNode->m_pRight = pTempNodes[uiMergedNodeIndex2];
+		CollisionDetection::BVHTreeNode* pParentNode = rBVHRenderDataTuple.m_tBVH.AllocateNode();
+		pParentNode->m_pLeft = vecNodes[rCurrentMerge.m_uiMergePartnerIndex1];
+		pParentNode->m_pRight = vecNodes[rCurrentMerge.m_uiMergePartnerIndex2];
 		// construct Bounding Sphere for that parent node (adaption from orginal code)
-		pParentNode->m_tBoundingSphereForNode = CollisionDetection::MergeTwoBoundingSpheres(pTempNodes[uiMergedNodeIndex1]->m_tBoundingSphereForNode, pTempNodes[uiMergedNodeIndex2]->m_tBoundingSphereForNode);
+		pParentNode->m_tBoundingSphereForNode = CollisionDetection::MergeTwoBoundingSpheres(pParentNode->m_pLeft->m_tBoundingSphereForNode, pParentNode->m_pRight->m_tBoundingSphereForNode);
 
 		// for visualization/rendering purposes
-		TreeNodeForRendering tNewBoundingSphereNodeForRendering;
-		tNewBoundingSphereNodeForRendering.m_iRenderingOrder = iNumConstructedNodes++;
-		tNewBoundingSphereNodeForRendering.m_pNodeToBeRendered = pParentNode;
-		rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.push_back(tNewBoundingSphereNodeForRendering);
-
-		//Updating the current set of nodes accordingly
-		size_t uiMinIndex = uiMergedNodeIndex1, uiMaxIndex = uiMergedNodeIndex2;
-		if (uiMergedNodeIndex1 > uiMergedNodeIndex2)
-		{
-			uiMinIndex = uiMergedNodeIndex2;
-			uiMaxIndex = uiMergedNodeIndex1;
-		}
-		pTempNodes[uiMinIndex] = pParentNode;
-		pTempNodes[uiMaxIndex] = pTempNodes[uiNumSceneObjects - 1];
-		uiNumSceneObjects--;
+		TreeNodeForRendering tNewNodeForRendering;
+		tNewNodeForRendering.m_iRenderingOrder = iNumConstructedNodes++;
+		tNewNodeForRendering.m_pNodeToBeRendered = pParentNode;
+		rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.push_back(tNewNodeForRendering);
+
+		vecNodes.push_back(pParentNode);
 	}
 
-	CollisionDetection::BVHTreeNode* pRootNode = pTempNodes[0]; // careful: getting the pointer to root by dereferencing the pointer to pointer
-	delete[] pTempNodes;
-	return pRootNode;
+	return vecNodes.back();	// the last merged node is the root. For a single object, that is its leaf
+}
+
+void BVHVisualization::RecursiveTopDownTree_SAH_AABB(CollisionDetection::BoundingVolumeHierarchy & rBVH, CollisionDetection::BVHTreeNode ** pNode, const SceneObject * pSceneObjects, CollisionDetection::ObjectReference * pObjectReferences, size_t uiFirstObjectReference, size_t uiNumObjectReferences)
+{
+	assert(pNode);
+	assert(pSceneObjects);
+	assert(pObjectReferences);
+	assert(uiNumObjectReferences > 0);
+
+	CollisionDetection::ObjectReference* pCurrentObjectReferences = pObjectReferences + uiFirstObjectReference;
+
+	CollisionDetection::BVHTreeNode* pNewNode = rBVH.AllocateNode();
+	*pNode = pNewNode;
+
+	// create AABB bounding volume for the current set of objects. Leaves need their own too, since they might hold several objects
+	if (uiNumObjectReferences == 1)
+		pNewNode->m_tAABBForNode = pSceneObjects[pCurrentObjectReferences->m_uiObjectIndex].m_tWorldSpaceAABB;
+	else
+		pNewNode->m_tAABBForNode = CollisionDetection::CreateAABBForMultipleObjects(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences);
+
+	// partition current set into subsets IN PLACE!!! The SAH decides whether this becomes a leaf
+	size_t uiNumLeftchildren = 0u;
+	if (uiNumObjectReferences > 1)
+		uiNumLeftchildren = CollisionDetection::PartitionObjectReferencesInPlace_SAH(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences, m_tSAHParameters);
+
+	if (uiNumLeftchildren == 0u) // is a leaf
+	{
+		assert(uiNumObjectReferences <= std::numeric_limits<uint32_t>::max());
+		pNewNode->m_uiNumOjbects = static_cast<uint32_t>(uiNumObjectReferences);
+		pNewNode->m_uiFirstObject = static_cast<uint32_t>(uiFirstObjectReference);
+	}
+	else // is a node
+	{
+		// move on with "left" side
+		RecursiveTopDownTree_SAH_AABB(rBVH, &(pNewNode->m_pLeft), pSceneObjects, pObjectReferences, uiFirstObjectReference, uiNumLeftchildren);
+
+		// move on with "right" side
+		RecursiveTopDownTree_SAH_AABB(rBVH, &(pNewNode->m_pRight), pSceneObjects, pObjectReferences, uiFirstObjectReference + uiNumLeftchildren, uiNumObjectReferences - uiNumLeftchildren);
+	}
+}
+
+void BVHVisualization::RecursiveTopDownTree_SAH_BoundingSphere(CollisionDetection::BoundingVolumeHierarchy & rBVH, CollisionDetection::BVHTreeNode ** pNode, const SceneObject * pSceneObjects, CollisionDetection::ObjectReference * pObjectReferences, size_t uiFirstObjectReference, size_t uiNumObjectReferences)
+{
+	assert(pNode);
+	assert(pSceneObjects);
+	assert(pObjectReferences);
+	assert(uiNumObjectReferences > 0);
+
+	CollisionDetection::ObjectReference* pCurrentObjectReferences = pObjectReferences + uiFirstObjectReference;
+
+	CollisionDetection::BVHTreeNode* pNewNode = rBVH.AllocateNode();
+	*pNode = pNewNode;
+
+	// create Bounding Sphere volume for the current set of objects. Leaves need their own too, since they might hold several objects
+	if (uiNumObjectReferences == 1)
+		pNewNode->m_tBoundingSphereForNode = pSceneObjects[pCurrentObjectReferences->m_uiObjectIndex].m_tWorldSpaceBoundingSphere;
+	else
+		pNewNode->m_tBoundingSphereForNode = CollisionDetection::CreateBoundingSphereForMultipleObjects(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences);
+
+	// partition current set into subsets IN PLACE!!! The SAH decides whether this becomes a leaf
+	size_t uiNumLeftchildren = 0u;
+	if (uiNumObjectReferences > 1)
+		uiNumLeftchildren = CollisionDetection::PartitionObjectReferencesInPlace_SAH(pSceneObjects, pCurrentObjectReferences, uiNumObjectReferences, m_tSAHParameters);
+
+	if (uiNumLeftchildren == 0u) // is a leaf
+	{
+		assert(uiNumObjectReferences <= std::numeric_limits<uint32_t>::max());
+		pNewNode->m_uiNumOjbects = static_cast<uint32_t>(uiNumObjectReferences);
+		pNewNode->m_uiFirstObject = static_cast<uint32_t>(uiFirstObjectReference);
+	}
+	else // is a node
+	{
+		// move on with "left" side
+		RecursiveTopDownTree_SAH_BoundingSphere(rBVH, &(pNewNode->m_pLeft), pSceneObjects, pObjectReferences, uiFirstObjectReference, uiNumLeftchildren);
+
+		// move on with "right" side
+		RecursiveTopDownTree_SAH_BoundingSphere(rBVH, &(pNewNode->m_pRight), pSceneObjects, pObjectReferences, uiFirstObjectReference + uiNumLeftchildren, uiNumObjectReferences - uiNumLeftchildren);
+	}
 }
 
 void BVHVisualization::Render3DSceneConstants() const
@@ -1799,83 +2295,241 @@ void BVHVisualization::SetInitialRenderStates()
 	glEnable(GL_LINE_SMOOTH);
 }
 
-BVHVisualization::BVHRenderingDataTuple BVHVisualization::ConstructTopDownAABBBVHandRenderDataForScene(Scene & rScene)
+void BVHVisualization::ConstructTopDownAABBBVHandRenderDataForScene(Scene & rScene, BVHRenderingDataTuple& rBVHRenderDataTuple)
 {
 	assert(rScene.m_vecObjects.size() > 0);
+	assert(rBVHRenderDataTuple.m_tBVH.m_pRootNode == nullptr);	// delete all data of the previous construction first
 
-	BVHRenderingDataTuple tResult;
-
-	// the construction
-	tResult.m_tBVH.m_pRootNode = new CollisionDetection::BVHTreeNode;
-	RecursiveTopDownTree_AABB(&(tResult.m_tBVH.m_pRootNode), rScene.m_vecObjects.data(), rScene.m_vecObjects.size());
+	// the construction. Partitioning works on compact references, the scene's objects stay where they are
+	std::vector<CollisionDetection::ObjectReference> vecObjectReferences = CollisionDetection::CreateObjectReferences(rScene.m_vecObjects.data(), rScene.m_vecObjects.size());
+	const std::chrono::high_resolution_clock::time_point tConstructionStart = std::chrono::high_resolution_clock::now();
+	rBVHRenderDataTuple.m_tBVH.m_pRootNode = rBVHRenderDataTuple.m_tBVH.AllocateNodes(2u * vecObjectReferences.size() - 1u);	// a binary tree never needs more nodes, with single object leaves it needs exactly that many
+	RecursiveTopDownTree_AABB(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rScene.m_vecObjects.data(), vecObjectReferences.data(), 0u, vecObjectReferences.size(), m_bIsTopDownConstructedInParallel ? &m_tTaskPool : nullptr);
+	rBVHRenderDataTuple.m_fConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tConstructionStart).count();
+	rBVHRenderDataTuple.m_tBVH.m_vecObjectPermutation = CollisionDetection::CreateObjectPermutation(rScene.m_vecObjects.data(), vecObjectReferences);
+	CollisionDetection::PrepareBVHForRefitting_AABB(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data());
 
 	// first traversal to gather data for rendering. In theory, it is possible to traverse the tree every frame for BV rendering.
 	// But that is terrible, so data is fetched into a linear vector
-	tResult.m_vecTreeNodeDataForRendering.reserve(100);
-	TraverseTreeForDataForTopDownRendering_AABB(tResult.m_tBVH.m_pRootNode, tResult, 0);
+	rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.reserve(100);
+	TraverseTreeForDataForTopDownRendering_AABB(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rBVHRenderDataTuple, 0);
 
 	// now for the rendering data of the 2d window
-	ConstructBVHTreeGraphRenderData(tResult);
+	ConstructBVHTreeGraphRenderData(rBVHRenderDataTuple);
 
-	return tResult;
+	// the flattened hierarchy for ray casts
+	rBVHRenderDataTuple.m_tLinearBVH = CollisionDetection::CreateLinearBVH(rBVHRenderDataTuple.m_tBVH);
 }
 
-BVHVisualization::BVHRenderingDataTuple BVHVisualization::ConstructBottomUpAABBBVHandRenderDataForScene(Scene & rScene)
+void BVHVisualization::ConstructBottomUpAABBBVHandRenderDataForScene(Scene & rScene, BVHRenderingDataTuple& rBVHRenderDataTuple)
 {
 	assert(rScene.m_vecObjects.size() > 0);
-
-	BVHRenderingDataTuple tResult;
-	tResult.m_vecTreeNodeDataForRendering.reserve(100);
+	assert(rBVHRenderDataTuple.m_tBVH.m_pRootNode == nullptr);	// delete all data of the previous construction first
+	rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.reserve(100);
 
 	// the construction INCLUDING HALF THE PREPARATION OF AABB RENDERING DATA
-	tResult.m_tBVH.m_pRootNode = BottomUpTree_AABB(rScene.m_vecObjects.data(), rScene.m_vecObjects.size(), tResult);
+	const std::chrono::high_resolution_clock::time_point tConstructionStart = std::chrono::high_resolution_clock::now();
+	const std::vector<CollisionDetection::BottomUpMerge> vecMerges = CollisionDetection::CalcBottomUpMergeOrder_AABB(rScene.m_vecObjects.data(), rScene.m_vecObjects.size());
+	rBVHRenderDataTuple.m_tBVH.m_pRootNode = BottomUpTree_AABB(rScene.m_vecObjects.data(), rScene.m_vecObjects.size(), vecMerges, rBVHRenderDataTuple);
+	rBVHRenderDataTuple.m_fConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tConstructionStart).count();
+	rBVHRenderDataTuple.m_tBVH.m_vecObjectPermutation = CollisionDetection::CreateObjectPermutation(rScene.m_vecObjects.data(), CollisionDetection::CreateObjectReferences(rScene.m_vecObjects.data(), rScene.m_vecObjects.size()));
+	CollisionDetection::PrepareBVHForRefitting_AABB(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data());
 	// the other half of the rendering data
-	TraverseTreeForDataForBottomUpRendering_AABB(tResult.m_tBVH.m_pRootNode, tResult, 0);
+	TraverseTreeForDataForBottomUpRendering_AABB(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rBVHRenderDataTuple, 0);
 
 	// now for the rendering data of the 2d window
-	ConstructBVHTreeGraphRenderData(tResult);
+	ConstructBVHTreeGraphRenderData(rBVHRenderDataTuple);
 
-	return tResult;
+	// the flattened hierarchy for ray casts
+	rBVHRenderDataTuple.m_tLinearBVH = CollisionDetection::CreateLinearBVH(rBVHRenderDataTuple.m_tBVH);
 }
 
-BVHVisualization::BVHRenderingDataTuple BVHVisualization::ConstructTopDownBoundingSphereBVHandRenderDataForScene(Scene & rScene)
+void BVHVisualization::ConstructTopDownBoundingSphereBVHandRenderDataForScene(Scene & rScene, BVHRenderingDataTuple& rBVHRenderDataTuple)
 {
 	assert(rScene.m_vecObjects.size() > 0);
+	assert(rBVHRenderDataTuple.m_tBVH.m_pRootNode == nullptr);	// delete all data of the previous construction first
 
-	BVHRenderingDataTuple tResult;
-
-	// the construction
-	tResult.m_tBVH.m_pRootNode = new CollisionDetection::BVHTreeNode;
-	RecursiveTopDownTree_BoundingSphere(&(tResult.m_tBVH.m_pRootNode), rScene.m_vecObjects.data(), rScene.m_vecObjects.size());
+	// the construction. Partitioning works on compact references, the scene's objects stay where they are
+	std::vector<CollisionDetection::ObjectReference> vecObjectReferences = CollisionDetection::CreateObjectReferences(rScene.m_vecObjects.data(), rScene.m_vecObjects.size());
+	const std::chrono::high_resolution_clock::time_point tConstructionStart = std::chrono::high_resolution_clock::now();
+	rBVHRenderDataTuple.m_tBVH.m_pRootNode = rBVHRenderDataTuple.m_tBVH.AllocateNodes(2u * vecObjectReferences.size() - 1u);	// a binary tree never needs more nodes, with single object leaves it needs exactly that many
+	RecursiveTopDownTree_BoundingSphere(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rScene.m_vecObjects.data(), vecObjectReferences.data(), 0u, vecObjectReferences.size(), m_bIsTopDownConstructedInParallel ? &m_tTaskPool : nullptr);
+	rBVHRenderDataTuple.m_fConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tConstructionStart).count();
+	rBVHRenderDataTuple.m_tBVH.m_vecObjectPermutation = CollisionDetection::CreateObjectPermutation(rScene.m_vecObjects.data(), vecObjectReferences);
+	CollisionDetection::PrepareBVHForRefitting_BoundingSphere(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data());
 
 	// first traversal to gather data for rendering. In theory, it is possible to traverse the tree every frame for BV rendering.
 	// But that is terrible, so data is fetched into a linear vector
-	tResult.m_vecTreeNodeDataForRendering.reserve(100);
+	rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.reserve(100);
 
-	TraverseTreeForDataForTopDownRendering_BoundingSphere(tResult.m_tBVH.m_pRootNode, tResult, 0);
+	TraverseTreeForDataForTopDownRendering_BoundingSphere(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rBVHRenderDataTuple, 0);
 
 	// now for the rendering data of the 2d window
-	ConstructBVHTreeGraphRenderData(tResult);
+	ConstructBVHTreeGraphRenderData(rBVHRenderDataTuple);
 
-	return tResult;
+	// the flattened hierarchy for ray casts
+	rBVHRenderDataTuple.m_tLinearBVH = CollisionDetection::CreateLinearBVH(rBVHRenderDataTuple.m_tBVH);
 }
 
-BVHVisualization::BVHRenderingDataTuple BVHVisualization::ConstructBottomUpBoundingSphereBVHandRenderDataForScene(Scene & rScene)
+void BVHVisualization::ConstructBottomUpBoundingSphereBVHandRenderDataForScene(Scene & rScene, BVHRenderingDataTuple& rBVHRenderDataTuple)
 {
 	assert(rScene.m_vecObjects.size() > 0);
-
-	BVHRenderingDataTuple tResult;
-	tResult.m_vecTreeNodeDataForRendering.reserve(100);
+	assert(rBVHRenderDataTuple.m_tBVH.m_pRootNode == nullptr);	// delete all data of the previous construction first
+	rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.reserve(100);
 
 	// the construction INCLUDING HALF THE PREPARATION OF BOUNDING SPHERE RENDERING DATA
-	tResult.m_tBVH.m_pRootNode = BottomUpTree_BoundingSphere(rScene.m_vecObjects.data(), rScene.m_vecObjects.size(), tResult);
+	const std::chrono::high_resolution_clock::time_point tConstructionStart = std::chrono::high_resolution_clock::now();
+	const std::vector<CollisionDetection::BottomUpMerge> vecMerges = CollisionDetection::CalcBottomUpMergeOrder_BoundingSphere(rScene.m_vecObjects.data(), rScene.m_vecObjects.size());
+	rBVHRenderDataTuple.m_tBVH.m_pRootNode = BottomUpTree_BoundingSphere(rScene.m_vecObjects.data(), rScene.m_vecObjects.size(), vecMerges, rBVHRenderDataTuple);
+	rBVHRenderDataTuple.m_fConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tConstructionStart).count();
+	rBVHRenderDataTuple.m_tBVH.m_vecObjectPermutation = CollisionDetection::CreateObjectPermutation(rScene.m_vecObjects.data(), CollisionDetection::CreateObjectReferences(rScene.m_vecObjects.data(), rScene.m_vecObjects.size()));
+	CollisionDetection::PrepareBVHForRefitting_BoundingSphere(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data());
+	// the other half of the rendering data
+	TraverseTreeForDataForBottomUpRendering_BoundingSphere(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rBVHRenderDataTuple, 0);
+
+	// now for the rendering data of the 2d window
+	ConstructBVHTreeGraphRenderData(rBVHRenderDataTuple);
+
+	// the flattened hierarchy for ray casts
+	rBVHRenderDataTuple.m_tLinearBVH = CollisionDetection::CreateLinearBVH(rBVHRenderDataTuple.m_tBVH);
+}
+
+void BVHVisualization::ConstructTopDownSAHAABBBVHandRenderDataForScene(Scene & rScene, BVHRenderingDataTuple& rBVHRenderDataTuple)
+{
+	assert(rScene.m_vecObjects.size() > 0);
+	assert(rBVHRenderDataTuple.m_tBVH.m_pRootNode == nullptr);	// delete all data of the previous construction first
+
+	// the construction. Partitioning works on compact references, the scene's objects stay where they are
+	std::vector<CollisionDetection::ObjectReference> vecObjectReferences = CollisionDetection::CreateObjectReferences(rScene.m_vecObjects.data(), rScene.m_vecObjects.size());
+	const std::chrono::high_resolution_clock::time_point tConstructionStart = std::chrono::high_resolution_clock::now();
+	RecursiveTopDownTree_SAH_AABB(rBVHRenderDataTuple.m_tBVH, &(rBVHRenderDataTuple.m_tBVH.m_pRootNode), rScene.m_vecObjects.data(), vecObjectReferences.data(), 0u, vecObjectReferences.size());
+	rBVHRenderDataTuple.m_fConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tConstructionStart).count();
+	rBVHRenderDataTuple.m_tBVH.m_vecObjectPermutation = CollisionDetection::CreateObjectPermutation(rScene.m_vecObjects.data(), vecObjectReferences);
+	CollisionDetection::PrepareBVHForRefitting_AABB(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data());
+
+	// the tree is built top down as well, so the rendering data is gathered the very same way
+	rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.reserve(100);
+	TraverseTreeForDataForTopDownRendering_AABB(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rBVHRenderDataTuple, 0);
+
+	// now for the rendering data of the 2d window
+	ConstructBVHTreeGraphRenderData(rBVHRenderDataTuple);
+
+	// the flattened hierarchy for ray casts
+	rBVHRenderDataTuple.m_tLinearBVH = CollisionDetection::CreateLinearBVH(rBVHRenderDataTuple.m_tBVH);
+}
+
+void BVHVisualization::ConstructTopDownSAHBoundingSphereBVHandRenderDataForScene(Scene & rScene, BVHRenderingDataTuple& rBVHRenderDataTuple)
+{
+	assert(rScene.m_vecObjects.size() > 0);
+	assert(rBVHRenderDataTuple.m_tBVH.m_pRootNode == nullptr);	// delete all data of the previous construction first
+
+	// the construction. Partitioning works on compact references, the scene's objects stay where they are
+	std::vector<CollisionDetection::ObjectReference> vecObjectReferences = CollisionDetection::CreateObjectReferences(rScene.m_vecObjects.data(), rScene.m_vecObjects.size());
+	const std::chrono::high_resolution_clock::time_point tConstructionStart = std::chrono::high_resolution_clock::now();
+	RecursiveTopDownTree_SAH_BoundingSphere(rBVHRenderDataTuple.m_tBVH, &(rBVHRenderDataTuple.m_tBVH.m_pRootNode), rScene.m_vecObjects.data(), vecObjectReferences.data(), 0u, vecObjectReferences.size());
+	rBVHRenderDataTuple.m_fConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tConstructionStart).count();
+	rBVHRenderDataTuple.m_tBVH.m_vecObjectPermutation = CollisionDetection::CreateObjectPermutation(rScene.m_vecObjects.data(), vecObjectReferences);
+	CollisionDetection::PrepareBVHForRefitting_BoundingSphere(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data());
+
+	// the tree is built top down as well, so the rendering data is gathered the very same way
+	rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.reserve(100);
+	TraverseTreeForDataForTopDownRendering_BoundingSphere(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rBVHRenderDataTuple, 0);
+
+	// now for the rendering data of the 2d window
+	ConstructBVHTreeGraphRenderData(rBVHRenderDataTuple);
+
+	// the flattened hierarchy for ray casts
+	rBVHRenderDataTuple.m_tLinearBVH = CollisionDetection::CreateLinearBVH(rBVHRenderDataTuple.m_tBVH);
+}
+
+void BVHVisualization::ConstructLBVHAABBBVHandRenderDataForScene(Scene & rScene, BVHRenderingDataTuple& rBVHRenderDataTuple)
+{
+	assert(rScene.m_vecObjects.size() > 0);
+	assert(rBVHRenderDataTuple.m_tBVH.m_pRootNode == nullptr);	// delete all data of the previous construction first
+
+	// the construction. Sorting the objects along a space filling curve already determines the whole hierarchy
+	const std::chrono::high_resolution_clock::time_point tConstructionStart = std::chrono::high_resolution_clock::now();
+	CollisionDetection::ConstructLBVH_AABB(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data(), rScene.m_vecObjects.size(), m_tLBVHParameters, m_bIsLBVHConstructedInParallel ? &m_tTaskPool : nullptr);
+	rBVHRenderDataTuple.m_fConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tConstructionStart).count();
+	CollisionDetection::PrepareBVHForRefitting_AABB(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data());
+
+	// the nodes are emitted top down, so the rendering data is gathered the very same way
+	rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.reserve(100);
+	TraverseTreeForDataForTopDownRendering_AABB(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rBVHRenderDataTuple, 0);
+
+	// now for the rendering data of the 2d window
+	ConstructBVHTreeGraphRenderData(rBVHRenderDataTuple);
+
+	// the flattened hierarchy for ray casts
+	rBVHRenderDataTuple.m_tLinearBVH = CollisionDetection::CreateLinearBVH(rBVHRenderDataTuple.m_tBVH);
+}
+
+void BVHVisualization::ConstructLBVHBoundingSphereBVHandRenderDataForScene(Scene & rScene, BVHRenderingDataTuple& rBVHRenderDataTuple)
+{
+	assert(rScene.m_vecObjects.size() > 0);
+	assert(rBVHRenderDataTuple.m_tBVH.m_pRootNode == nullptr);	// delete all data of the previous construction first
+
+	// the construction. Sorting the objects along a space filling curve already determines the whole hierarchy
+	const std::chrono::high_resolution_clock::time_point tConstructionStart = std::chrono::high_resolution_clock::now();
+	CollisionDetection::ConstructLBVH_BoundingSphere(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data(), rScene.m_vecObjects.size(), m_tLBVHParameters, m_bIsLBVHConstructedInParallel ? &m_tTaskPool : nullptr);
+	rBVHRenderDataTuple.m_fConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tConstructionStart).count();
+	CollisionDetection::PrepareBVHForRefitting_BoundingSphere(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data());
+
+	// the nodes are emitted top down, so the rendering data is gathered the very same way
+	rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.reserve(100);
+	TraverseTreeForDataForTopDownRendering_BoundingSphere(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rBVHRenderDataTuple, 0);
+
+	// now for the rendering data of the 2d window
+	ConstructBVHTreeGraphRenderData(rBVHRenderDataTuple);
+
+	// the flattened hierarchy for ray casts
+	rBVHRenderDataTuple.m_tLinearBVH = CollisionDetection::CreateLinearBVH(rBVHRenderDataTuple.m_tBVH);
+}
+
+void BVHVisualization::ConstructPLOCAABBBVHandRenderDataForScene(Scene & rScene, BVHRenderingDataTuple& rBVHRenderDataTuple)
+{
+	assert(rScene.m_vecObjects.size() > 0);
+	assert(rBVHRenderDataTuple.m_tBVH.m_pRootNode == nullptr);	// delete all data of the previous construction first
+	rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.reserve(100);
+
+	// the construction INCLUDING HALF THE PREPARATION OF AABB RENDERING DATA. Only the merge order differs from the BOTTOM UP trees
+	const std::chrono::high_resolution_clock::time_point tConstructionStart = std::chrono::high_resolution_clock::now();
+	const std::vector<CollisionDetection::BottomUpMerge> vecMerges = CollisionDetection::CalcPLOCMergeOrder_AABB(rScene.m_vecObjects.data(), rScene.m_vecObjects.size(), m_tPLOCParameters, m_bIsPLOCConstructedInParallel ? &m_tTaskPool : nullptr);
+	rBVHRenderDataTuple.m_tBVH.m_pRootNode = BottomUpTree_AABB(rScene.m_vecObjects.data(), rScene.m_vecObjects.size(), vecMerges, rBVHRenderDataTuple);
+	rBVHRenderDataTuple.m_fConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tConstructionStart).count();
+	rBVHRenderDataTuple.m_tBVH.m_vecObjectPermutation = CollisionDetection::CreateObjectPermutation(rScene.m_vecObjects.data(), CollisionDetection::CreateObjectReferences(rScene.m_vecObjects.data(), rScene.m_vecObjects.size()));
+	CollisionDetection::PrepareBVHForRefitting_AABB(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data());
+	// the other half of the rendering data
+	TraverseTreeForDataForBottomUpRendering_AABB(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rBVHRenderDataTuple, 0);
+
+	// now for the rendering data of the 2d window
+	ConstructBVHTreeGraphRenderData(rBVHRenderDataTuple);
+
+	// the flattened hierarchy for ray casts
+	rBVHRenderDataTuple.m_tLinearBVH = CollisionDetection::CreateLinearBVH(rBVHRenderDataTuple.m_tBVH);
+}
+
+void BVHVisualization::ConstructPLOCBoundingSphereBVHandRenderDataForScene(Scene & rScene, BVHRenderingDataTuple& rBVHRenderDataTuple)
+{
+	assert(rScene.m_vecObjects.size() > 0);
+	assert(rBVHRenderDataTuple.m_tBVH.m_pRootNode == nullptr);	// delete all data of the previous construction first
+	rBVHRenderDataTuple.m_vecTreeNodeDataForRendering.reserve(100);
+
+	// the construction INCLUDING HALF THE PREPARATION OF BOUNDING SPHERE RENDERING DATA. Only the merge order differs from the BOTTOM UP trees
+	const std::chrono::high_resolution_clock::time_point tConstructionStart = std::chrono::high_resolution_clock::now();
+	const std::vector<CollisionDetection::BottomUpMerge> vecMerges = CollisionDetection::CalcPLOCMergeOrder_BoundingSphere(rScene.m_vecObjects.data(), rScene.m_vecObjects.size(), m_tPLOCParameters, m_bIsPLOCConstructedInParallel ? &m_tTaskPool : nullptr);
+	rBVHRenderDataTuple.m_tBVH.m_pRootNode = BottomUpTree_BoundingSphere(rScene.m_vecObjects.data(), rScene.m_vecObjects.size(), vecMerges, rBVHRenderDataTuple);
+	rBVHRenderDataTuple.m_fConstructionTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tConstructionStart).count();
+	rBVHRenderDataTuple.m_tBVH.m_vecObjectPermutation = CollisionDetection::CreateObjectPermutation(rScene.m_vecObjects.data(), CollisionDetection::CreateObjectReferences(rScene.m_vecObjects.data(), rScene.m_vecObjects.size()));
+	CollisionDetection::PrepareBVHForRefitting_BoundingSphere(rBVHRenderDataTuple.m_tBVH, rScene.m_vecObjects.data());
 	// the other half of the rendering data
-	TraverseTreeForDataForBottomUpRendering_BoundingSphere(tResult.m_tBVH.m_pRootNode, tResult, 0);
+	TraverseTreeForDataForBottomUpRendering_BoundingSphere(rBVHRenderDataTuple.m_tBVH.m_pRootNode, rBVHRenderDataTuple, 0);
 
 	// now for the rendering data of the 2d window
-	ConstructBVHTreeGraphRenderData(tResult);
+	ConstructBVHTreeGraphRenderData(rBVHRenderDataTuple);
 
-	return tResult;
+	// the flattened hierarchy for ray casts
+	rBVHRenderDataTuple.m_tLinearBVH = CollisionDetection::CreateLinearBVH(rBVHRenderDataTuple.m_tBVH);
 }
 
 void BVHVisualization::ConstructBVHTreeGraphRenderData(BVHRenderingDataTuple& rBVHRenderDataTuple)
@@ -2021,7 +2675,7 @@ void BVHVisualization::DrawLineFromTo(glm::vec2 vec2From, glm::vec2 vec2To) cons
 	glDrawArrays(GL_LINES, 0, 2);
 }
 
-void BVHVisualization::Draw2DObjectAtPosition(glm::vec2 vec2ScreenSpacePosition, const glm::vec4& rvec4DrawColor) const
+void BVHVisualization::Draw2DObjectAtPosition(glm::vec2 vec2ScreenSpacePosition, const glm::vec4& rvec4DrawColor, float fDrawSize) const
 {
 	glAssert();
 	const Shader& rCurrentShader = m_tMaskedColorShader2D;
@@ -2038,7 +2692,7 @@ void BVHVisualization::Draw2DObjectAtPosition(glm::vec2 vec2ScreenSpacePosition,
 	glm::mat4 mat4World = glm::mat4(1.0f); // init to identity
 	glm::vec3 vec3CircleTranslationVector(vec2ScreenSpacePosition.x, vec2ScreenSpacePosition.y, 0.0f); // in the middle of the window, within the near plane of the view frustum
 	mat4World = glm::translate(mat4World, vec3CircleTranslationVector);
-	mat4World = glm::scale(mat4World, glm::vec3(m_f2DGraphNodeSize, m_f2DGraphNodeSize, 1.0f));
+	mat4World = glm::scale(mat4World, glm::vec3(fDrawSize, fDrawSize, 1.0f));
 	rCurrentShader.setMat4("world", mat4World);
 
 	// projection matrix
@@ -2050,6 +2704,21 @@ void BVHVisualization::Draw2DObjectAtPosition(glm::vec2 vec2ScreenSpacePosition,
 	glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(sizeof(Primitives::Plane::IndexData) / sizeof(GLuint)), GL_UNSIGNED_INT, 0);
 }
 
+void BVHVisualization::Draw2DLeafAtPosition(glm::vec2 vec2ScreenSpacePosition, const glm::vec4 & rvec4DrawColor, uint32_t uiNumObjects) const
+{
+	assert(uiNumObjects > 0u);
+
+	// the objects of a leaf share the space of a single node: they are shrunk and placed next to each other
+	const float fObjectDrawSize = m_f2DGraphNodeSize / static_cast<float>(uiNumObjects);
+	const float fFirstObjectOffset = (fObjectDrawSize - m_f2DGraphNodeSize) * 0.5f;
+
+	for (uint32_t uiCurrentObject = 0u; uiCurrentObject < uiNumObjects; uiCurrentObject++)
+	{
+		const glm::vec2 vec2ObjectDrawPosition(vec2ScreenSpacePosition.x + fFirstObjectOffset + fObjectDrawSize * static_cast<float>(uiCurrentObject), vec2ScreenSpacePosition.y);
+		Draw2DObjectAtPosition(vec2ObjectDrawPosition, rvec4DrawColor, fObjectDrawSize);
+	}
+}
+
 void BVHVisualization::ShowObjectPropertiesWindow(bool bShowIt)
 {
 	m_bShowObjectPropertiesWindow = bShowIt;
@@ -2089,6 +2758,15 @@ void BVHVisualization::RenderSimControlPanel()
 	case eBVHConstructionStrategy::BOTTOMUP:
 		sControlPanelName.append("BOTTOM UP ");
 		break;
+	case eBVHConstructionStrategy::TOPDOWN_SAH:
+		sControlPanelName.append("TOP DOWN SAH ");
+		break;
+	case eBVHConstructionStrategy::LBVH:
+		sControlPanelName.append("LBVH ");
+		break;
+	case eBVHConstructionStrategy::PLOC:
+		sControlPanelName.append("PLOC ");
+		break;
 	default:
 		assert(!"disaster");
 		break;
@@ -2204,6 +2882,7 @@ void BVHVisualization::RenderSimOptions()
 				CollisionDetection::ConstructBoundingVolumesForScene(m_tScene);
 				CollisionDetection::UpdateBoundingVolumesForScene(m_tScene);
 				ReconstructAllTrees();
+				RebuildDynamicAABBTree();
 				ResetSimulation();
 				ImGui::CloseCurrentPopup();
 			}
@@ -2277,7 +2956,7 @@ void BVHVisualization::RenderSimOptions()
 
 	ImGui::Text("Construction Strategy");
 	// The combo box to choose a BVH construction strategy
-	const char* pBVHConstructionStrategyItems[] = { "TOP DOWN", "BOTTOM UP" };
+	const char* pBVHConstructionStrategyItems[] = { "TOP DOWN", "BOTTOM UP", "TOP DOWN SAH", "LBVH", "PLOC" };
 	int iCurrentConstructionStrategyItemIndex = static_cast<int>(m_eConstructionStrategy);
 	const char* sConstructionStrategyComboLabel = pBVHConstructionStrategyItems[iCurrentConstructionStrategyItemIndex];  // Label to preview before opening the combo (technically it could be anything)
 	if (ImGui::BeginCombo("##BVH Construction Strategy", sConstructionStrategyComboLabel))
@@ -2298,6 +2977,36 @@ void BVHVisualization::RenderSimOptions()
 		ImGui::EndCombo();
 	}
 
+	// memory statistics of the currently shown hierarchy
+	assert(m_pCurrentlyActiveConstructionStrategy);
+	const CollisionDetection::BoundingVolumeHierarchy& rActiveBVH = m_pCurrentlyActiveConstructionStrategy->m_tBVH;
+	ImGui::Text("Nodes: %zu (allocated: %zu, peak: %zu)", m_pCurrentlyActiveConstructionStrategy->m_vecTreeNodeDataForRendering.size() + m_pCurrentlyActiveConstructionStrategy->m_vecTreeLeafDataForRendering.size(), rActiveBVH.GetNumNodes(), rActiveBVH.GetPeakNumNodes());
+	ImGui::Text("Construction: %.2f ms", m_pCurrentlyActiveConstructionStrategy->m_fConstructionTimeInMilliseconds);
+	ImGui::Text("Refit degradation: %.2f", rActiveBVH.CalcRefitDegradation());
+	ImGui::SliderFloat("Rebuild Threshold", &m_fRefitRebuildThreshold, 1.0f, 4.0f, "%.2f"); ImGui::SameLine(); GUI::HelpMarker("Moving an object only refits the bounding volumes on its path through the trees. Once the summed surface area of a tree's nodes grew by this factor, the tree is constructed anew.");
+	ImGui::Text("Node memory: %.1f KB", static_cast<float>(rActiveBVH.GetNumReservedBytes()) / 1024.0f); ImGui::SameLine(); GUI::HelpMarker("Memory reserved for the hierarchy's nodes. It is kept between reconstructions, so it only grows with the largest hierarchy built so far.");
+	ImGui::Text("Dynamic AABB tree: %zu nodes, height %d", m_tDynamicAABBTree.GetNumNodes(), m_tDynamicAABBTree.GetHeight()); ImGui::SameLine(); GUI::HelpMarker("A separate AABB tree that is never constructed anew. Adding, deleting or moving an object only inserts or removes a single leaf and refits its ancestors.");
+	ImGui::Text("Last dynamic update: %.1f us", m_fDynamicAABBTreeUpdateTimeInMicroseconds);
+	if (ImGui::Button("Ray Cast Benchmark"))
+		RunRayCastBenchmark();
+	ImGui::SameLine(); GUI::HelpMarker("Casts 256 x 256 rays from the camera through the 3D window into the AABB and the Bounding Sphere hierarchy of the current strategy, then ray by ray and in packets of 4, 8 and 16 neighbouring rays into the flattened AABB hierarchy. Last, the same rays are cast into a k-d tree that splits space at SAH chosen planes, and visits its cells front to back.");
+	if (m_fSingleRayBenchmarkRaysPerSecond > 0.0f)
+	{
+		ImGui::Text("AABB / Bounding Sphere tree: %.2f / %.2f Mrays/s", m_pHierarchyBenchmarkRaysPerSecond[eBVHBoundingVolume::AABB] * 1e-6f, m_pHierarchyBenchmarkRaysPerSecond[eBVHBoundingVolume::BOUNDING_SPHERE] * 1e-6f);
+		ImGui::Text("Single rays: %.2f Mrays/s", m_fSingleRayBenchmarkRaysPerSecond * 1e-6f);
+		ImGui::Text("Packets of 4/8/16: %.2f / %.2f / %.2f Mrays/s", m_pRayPacketBenchmarkRaysPerSecond[0] * 1e-6f, m_pRayPacketBenchmarkRaysPerSecond[1] * 1e-6f, m_pRayPacketBenchmarkRaysPerSecond[2] * 1e-6f);
+		ImGui::Text("k-d tree: %.2f Mrays/s", m_fKDTreeBenchmarkRaysPerSecond * 1e-6f);
+		ImGui::Text("k-d tree construction: %.2f ms, %zu object references", m_fKDTreeConstructionTimeInMilliseconds, m_uiKDTreeNumObjectReferences);
+	}
+	if (ImGui::Button("Overlapping Pairs Benchmark"))
+		RunOverlappingPairsBenchmark();
+	ImGui::SameLine(); GUI::HelpMarker("Finds all pairs of objects whose AABBs overlap, first by testing every object against every other one, then by testing the AABB hierarchy of the current strategy against itself, on one thread and on all cores.");
+	if (m_pOverlappingPairsBenchmarkMilliseconds[0] > 0.0f)
+	{
+		ImGui::Text("Overlapping pairs: %zu", m_uiNumOverlappingObjectPairs);
+		ImGui::Text("Brute force / tree / parallel tree: %.2f / %.2f / %.2f ms", m_pOverlappingPairsBenchmarkMilliseconds[0], m_pOverlappingPairsBenchmarkMilliseconds[1], m_pOverlappingPairsBenchmarkMilliseconds[2]);
+	}
+
 	ImGuiColorEditFlags iColorPickerFlags = ImGuiColorEditFlags_NoAlpha | ImGuiColorEditFlags_NoOptions | ImGuiColorEditFlags_NoInputs;// | ImGuiColorEditFlags_NoLabel;
 
 	// now follow options that are specific to certain construction strategies
@@ -2310,6 +3019,28 @@ void BVHVisualization::RenderSimOptions()
 		ImGui::Checkbox("Gradient##TOPDOWN", &m_bNodeDepthColorGrading); ImGui::SameLine(); GUI::HelpMarker("When active, the BVH's Bounding Volumes will be colou graded depending on their depth in the hierarchy");
 		if (m_bNodeDepthColorGrading)
 			ImGui::ColorEdit3("Node Gradient Color##TOPDOWN", (float*)&m_vec4TopDownNodeRenderColor_Gradient, iColorPickerFlags);
+
+		// changing any leaf parameter rebuilds the trees, but only once the user lets go of the widget
+		bool bLeafParametersChanged = false;
+		bLeafParametersChanged |= ImGui::Checkbox("Parallel Construction##TOPDOWN", &m_bIsTopDownConstructedInParallel); ImGui::SameLine(); GUI::HelpMarker("Builds independent subtrees and partitions large sets of objects on all cores. The resulting trees are identical to the ones built on a single thread.");
+		int iMaxObjectsPerLeaf = static_cast<int>(m_tObjectMeanLeafParameters.m_uiMaxObjectsPerLeaf);
+		ImGui::SliderInt("Max Leaf Size##TOPDOWN", &iMaxObjectsPerLeaf, 1, 16); ImGui::SameLine(); GUI::HelpMarker("Sets of at most this many objects are not partitioned any further and become a leaf.");
+		m_tObjectMeanLeafParameters.m_uiMaxObjectsPerLeaf = static_cast<size_t>(iMaxObjectsPerLeaf);
+		bLeafParametersChanged |= ImGui::IsItemDeactivatedAfterEdit();
+		bLeafParametersChanged |= ImGui::Checkbox("SAH Termination##TOPDOWN", &m_tObjectMeanLeafParameters.m_bTerminateBySAH); ImGui::SameLine(); GUI::HelpMarker("When active, sets small enough for a leaf are still partitioned if the Surface Area Heuristic considers the split cheaper than testing all of their objects.");
+		if (m_tObjectMeanLeafParameters.m_bTerminateBySAH)
+		{
+			ImGui::SliderFloat("Traversal Cost##TOPDOWN", &m_tObjectMeanLeafParameters.m_fNodeTraversalCost, 0.1f, 10.0f, "%.1f");
+			bLeafParametersChanged |= ImGui::IsItemDeactivatedAfterEdit();
+			ImGui::SliderFloat("Intersection Cost##TOPDOWN", &m_tObjectMeanLeafParameters.m_fObjectIntersectionCost, 0.1f, 10.0f, "%.1f");
+			bLeafParametersChanged |= ImGui::IsItemDeactivatedAfterEdit();
+		}
+
+		if (bLeafParametersChanged && !m_tScene.m_vecObjects.empty())
+		{
+			ReconstructAllTrees();
+			ResetSimulation();
+		}
 	}
 
 	// BOTTOM UP OPTIONS
@@ -2322,6 +3053,80 @@ void BVHVisualization::RenderSimOptions()
 			ImGui::ColorEdit3("Node Gradient Color##BOTTOMUP", (float*)&m_vec4BottomUpNodeRenderColor_Gradient, iColorPickerFlags);
 	}
 
+	// TOP DOWN SAH OPTIONS
+	if (iCurrentConstructionStrategyItemIndex == 2)
+	{
+		ImGui::Text("TOP DOWN SAH OPTIONS AND PARAMETERS");
+		ImGui::ColorEdit3("Node Color##TOPDOWNSAH", (float*)&m_vec4TopDownSAHNodeRenderColor, iColorPickerFlags); ImGui::SameLine();
+		ImGui::Checkbox("Gradient##TOPDOWNSAH", &m_bNodeDepthColorGrading); ImGui::SameLine(); GUI::HelpMarker("When active, the BVH's Bounding Volumes will be colou graded depending on their depth in the hierarchy");
+		if (m_bNodeDepthColorGrading)
+			ImGui::ColorEdit3("Node Gradient Color##TOPDOWNSAH", (float*)&m_vec4TopDownSAHNodeRenderColor_Gradient, iColorPickerFlags);
+
+		// changing any parameter of the heuristic rebuilds the trees, but only once the user lets go of the slider
+		bool bSAHParametersChanged = false;
+		int iNumBins = static_cast<int>(m_tSAHParameters.m_uiNumBins);
+		ImGui::SliderInt("Bins##TOPDOWNSAH", &iNumBins, 2, 64); ImGui::SameLine(); GUI::HelpMarker("The number of equally sized bins the objects' centroids are sorted into, per axis. More bins find better splits but take longer to evaluate.");
+		m_tSAHParameters.m_uiNumBins = static_cast<size_t>(iNumBins);
+		bSAHParametersChanged |= ImGui::IsItemDeactivatedAfterEdit();
+		ImGui::SliderFloat("Traversal Cost##TOPDOWNSAH", &m_tSAHParameters.m_fNodeTraversalCost, 0.1f, 10.0f, "%.1f");
+		bSAHParametersChanged |= ImGui::IsItemDeactivatedAfterEdit();
+		ImGui::SliderFloat("Intersection Cost##TOPDOWNSAH", &m_tSAHParameters.m_fObjectIntersectionCost, 0.1f, 10.0f, "%.1f"); ImGui::SameLine(); GUI::HelpMarker("The costs of visiting a node and of testing an object are relative to each other. The higher the traversal cost, the more objects end up in a leaf.");
+		bSAHParametersChanged |= ImGui::IsItemDeactivatedAfterEdit();
+		int iMaxObjectsPerLeaf = static_cast<int>(m_tSAHParameters.m_uiMaxObjectsPerLeaf);
+		ImGui::SliderInt("Max Leaf Size##TOPDOWNSAH", &iMaxObjectsPerLeaf, 1, 16);
+		m_tSAHParameters.m_uiMaxObjectsPerLeaf = static_cast<size_t>(iMaxObjectsPerLeaf);
+		bSAHParametersChanged |= ImGui::IsItemDeactivatedAfterEdit();
+
+		if (bSAHParametersChanged && !m_tScene.m_vecObjects.empty())
+		{
+			ReconstructAllTrees();
+			ResetSimulation();
+		}
+	}
+
+	// LBVH OPTIONS
+	if (iCurrentConstructionStrategyItemIndex == 3)
+	{
+		ImGui::Text("LBVH OPTIONS AND PARAMETERS");
+		ImGui::ColorEdit3("Node Color##LBVH", (float*)&m_vec4LBVHNodeRenderColor, iColorPickerFlags); ImGui::SameLine();
+		ImGui::Checkbox("Gradient##LBVH", &m_bNodeDepthColorGrading); ImGui::SameLine(); GUI::HelpMarker("When active, the BVH's Bounding Volumes will be colou graded depending on their depth in the hierarchy");
+		if (m_bNodeDepthColorGrading)
+			ImGui::ColorEdit3("Node Gradient Color##LBVH", (float*)&m_vec4LBVHNodeRenderColor_Gradient, iColorPickerFlags);
+
+		bool bLBVHParametersChanged = false;
+		bLBVHParametersChanged |= ImGui::Checkbox("Parallel Construction##LBVH", &m_bIsLBVHConstructedInParallel); ImGui::SameLine(); GUI::HelpMarker("Computes and sorts the Morton codes and emits independent subtrees on all cores. The resulting trees are identical to the ones built on a single thread.");
+		bLBVHParametersChanged |= ImGui::Checkbox("63 Bit Morton Codes##LBVH", &m_tLBVHParameters.m_bUse63BitMortonCodes); ImGui::SameLine(); GUI::HelpMarker("Quantizes the objects' centroids to 21 instead of 10 bits per axis. Large or densely packed scenes get fewer identical codes and thereby better splits, at the cost of twice as many sorting passes.");
+
+		if (bLBVHParametersChanged && !m_tScene.m_vecObjects.empty())
+		{
+			ReconstructAllTrees();
+			ResetSimulation();
+		}
+	}
+
+	// PLOC OPTIONS
+	if (iCurrentConstructionStrategyItemIndex == 4)
+	{
+		ImGui::Text("PLOC OPTIONS AND PARAMETERS");
+		ImGui::ColorEdit3("Node Color##PLOC", (float*)&m_vec4PLOCNodeRenderColor, iColorPickerFlags); ImGui::SameLine();
+		ImGui::Checkbox("Gradient##PLOC", &m_bNodeDepthColorGrading); ImGui::SameLine(); GUI::HelpMarker("When active, the BVH's Bounding Volumes will be colou graded depending on their depth in the hierarchy");
+		if (m_bNodeDepthColorGrading)
+			ImGui::ColorEdit3("Node Gradient Color##PLOC", (float*)&m_vec4PLOCNodeRenderColor_Gradient, iColorPickerFlags);
+
+		bool bPLOCParametersChanged = false;
+		bPLOCParametersChanged |= ImGui::Checkbox("Parallel Construction##PLOC", &m_bIsPLOCConstructedInParallel); ImGui::SameLine(); GUI::HelpMarker("Searches nearest neighbors and merges clusters on all cores. The resulting trees are identical to the ones built on a single thread.");
+		int iSearchRadius = static_cast<int>(m_tPLOCParameters.m_uiSearchRadius);
+		ImGui::SliderInt("Search Radius##PLOC", &iSearchRadius, 1, 64); ImGui::SameLine(); GUI::HelpMarker("How many clusters before and after a cluster, in Morton order, are candidates for its nearest neighbor. Larger radii find better merges, approaching the BOTTOM UP trees, but search longer.");
+		m_tPLOCParameters.m_uiSearchRadius = static_cast<size_t>(iSearchRadius);
+		bPLOCParametersChanged |= ImGui::IsItemDeactivatedAfterEdit();
+
+		if (bPLOCParametersChanged && !m_tScene.m_vecObjects.empty())
+		{
+			ReconstructAllTrees();
+			ResetSimulation();
+		}
+	}
+
 
 
 	//if (ImGui::Button("Rebuild BVHs"))
@@ -2344,6 +3149,15 @@ void BVHVisualization::RenderSimOptions()
 
 	ImGui::Separator();
 
+	ImGui::Checkbox("Frustum Culling", &m_bFrustumCulling); ImGui::SameLine(); GUI::HelpMarker("Only draws the objects within the camera's frustum, found by the flattened copy of the active hierarchy. Nodes that lie completely inside of some of the frustum's planes are not tested against them again, neither are their subtrees.");
+	if (m_bFrustumCulling)
+	{
+		ImGui::Text("Visible / culled objects: %zu / %zu", m_uiNumVisibleObjects, m_tScene.m_vecObjects.size() - std::min(m_uiNumVisibleObjects, m_tScene.m_vecObjects.size()));
+		ImGui::Text("Frustum query: %.1f us", m_fFrustumCullingMicroseconds);
+	}
+
+	ImGui::Separator();
+
 	// X axis grid
 	ImGui::Text("X Axis Grid"); ImGui::SameLine(); GUI::HelpMarker("A rasterized grid facing the X axis, spanning the YZ plane. Grid size = 100cm");
 	ImGui::ColorEdit3("Color##X", (float*)&m_vec4GridColorX, iColorPickerFlags); ImGui::SameLine();
@@ -2459,7 +3273,7 @@ void BVHVisualization::RenderObjectPropertiesWindow()
 
 
 	if (m_bObjectPropertiesPendingChanges)
-		ImGui::TextWrapped("Applying changes to object properties [OK] will invalidate the BVH. It will automatically be reconstructed and the visualization reset. Clicking [CANCEL] will discard all changes.");
+		ImGui::TextWrapped("Applying changes to object properties [OK] will invalidate the BVH. It will automatically be refitted, or reconstructed if refitting degraded it too much, and the visualization reset. Clicking [CANCEL] will discard all changes.");
 
 	if (ImGui::Button("OK"))
 	{
@@ -2653,8 +3467,7 @@ void BVHVisualization::CrosshairClick()
 	CollisionDetection::Ray tRay(m_tCamera.GetCurrentPosition(), vec3RayDirection);
 
 	// check for intersections with ray
-	//CollisionDetection::RayCastIntersectionResult tResult = CollisionDetection::CastRayIntoBVH(pEngine->m_pVisualization->m_tTopDownBVH_AABB, tRay);
-	CollisionDetection::RayCastIntersectionResult tResult = CollisionDetection::BruteForceRayIntoObjects(m_tScene.m_vecObjects, tRay);
+	CollisionDetection::RayCastIntersectionResult tResult = CastRayIntoActiveBVH(tRay);
 
 	SceneObject* pPreviouslyFocusedObject = m_pCurrentlyFocusedObject;
 	if (pPreviouslyFocusedObject)	// if there was an object in focus before this click, cancel any pending changes made to it
@@ -2681,8 +3494,7 @@ void BVHVisualization::CursorClick()
 	CollisionDetection::Ray tRay(m_tCamera.GetCurrentPosition(), vec3RayDirection);
 
 	// check for intersections with ray
-	//CollisionDetection::RayCastIntersectionResult tResult = CollisionDetection::CastRayIntoBVH(pEngine->m_pVisualization->m_tTopDownBVH_AABB, tRay);
-	CollisionDetection::RayCastIntersectionResult tResult = CollisionDetection::BruteForceRayIntoObjects(m_tScene.m_vecObjects, tRay);
+	CollisionDetection::RayCastIntersectionResult tResult = CastRayIntoActiveBVH(tRay);
 
 	SceneObject* pPreviouslyFocusedObject = m_pCurrentlyFocusedObject;
 	if (pPreviouslyFocusedObject)	// if there was an object in focus before this click, cancel any pending changes made to it
@@ -2,6 +2,7 @@
 
 #include "Visualization.h"
 #include "Scene.h"
+#include "TaskPool.h"
 
 #include <vector>
 
@@ -28,10 +29,14 @@ private:
 
 	struct BVHRenderingDataTuple {
 		CollisionDetection::BoundingVolumeHierarchy m_tBVH;
+		CollisionDetection::LinearBVH m_tLinearBVH;		// flattened copy of m_tBVH, used for ray casts
 		std::vector<TreeNodeForRendering> m_vecTreeNodeDataForRendering;
 		std::vector<TreeNodeForRendering> m_vecTreeLeafDataForRendering; // currently only used for rendering in the graph window
+		float m_fConstructionTimeInMilliseconds = 0.0f;	// only the construction of the hierarchy itself, without any rendering data
 		void DeleteAllData() {
 			m_tBVH.DeleteTree();
+			m_tLinearBVH.m_vecNodes.clear();
+			m_tLinearBVH.m_vecObjectPermutation.clear();
 			m_vecTreeNodeDataForRendering.clear();
 			m_vecTreeLeafDataForRendering.clear();
 		}
@@ -52,6 +57,9 @@ private:
 	enum eBVHConstructionStrategy {
 		TOPDOWN = 0,
 		BOTTOMUP,
+		TOPDOWN_SAH,
+		LBVH,
+		PLOC,
 		NUM_BVHCONSTRUCTIONSTRATEGIES
 	};
 
@@ -71,7 +79,36 @@ private:
 	BVHRenderingDataTuple m_tBottomUpAABBs;
 	BVHRenderingDataTuple m_tTopDownBoundingSpheres;
 	BVHRenderingDataTuple m_tBottomUpBoundingSpheres;
+	BVHRenderingDataTuple m_tTopDownSAHAABBs;
+	BVHRenderingDataTuple m_tTopDownSAHBoundingSpheres;
+	BVHRenderingDataTuple m_tLBVHAABBs;
+	BVHRenderingDataTuple m_tLBVHBoundingSpheres;
+	BVHRenderingDataTuple m_tPLOCAABBs;
+	BVHRenderingDataTuple m_tPLOCBoundingSpheres;
 	BVHRenderingDataTuple* m_pCurrentlyActiveConstructionStrategy;	// todo: update the GUI to refer to this, also use it for all rendering purposes
+	CollisionDetection::SAHParameters m_tSAHParameters;
+	CollisionDetection::ObjectMeanLeafParameters m_tObjectMeanLeafParameters;
+	TaskPool m_tTaskPool;
+	bool m_bIsTopDownConstructedInParallel;
+	CollisionDetection::LBVHParameters m_tLBVHParameters;
+	bool m_bIsLBVHConstructedInParallel;
+	CollisionDetection::PLOCParameters m_tPLOCParameters;
+	bool m_bIsPLOCConstructedInParallel;
+	float m_fRefitRebuildThreshold;	// a refitted tree is constructed anew once its nodes' surface area grew by this factor
+	CollisionDetection::DynamicAABBTree m_tDynamicAABBTree;	// never constructed anew, every scene edit updates it incrementally
+	float m_fDynamicAABBTreeUpdateTimeInMicroseconds;		// time the last scene edit took to update the dynamic tree
+	float m_fSingleRayBenchmarkRaysPerSecond;				// result of the last ray cast benchmark, 0 until it was run
+	float m_pRayPacketBenchmarkRaysPerSecond[3];			// same for packets of 4, 8 and 16 rays
+	float m_pHierarchyBenchmarkRaysPerSecond[NUM_BVHBOUNDINGVOLUMES];	// same for the AABB and the Bounding Sphere hierarchy of the current strategy, traversed without flattening
+	float m_fKDTreeBenchmarkRaysPerSecond;					// same for a k-d tree constructed over the scene for the benchmark
+	float m_fKDTreeConstructionTimeInMilliseconds;
+	size_t m_uiKDTreeNumObjectReferences;					// objects straddling splitting planes are referenced more than once
+	std::vector<CollisionDetection::ObjectPair> m_vecOverlappingObjectPairs;	// kept between overlap queries, only grown when a query finds more pairs than fit
+	size_t m_uiNumOverlappingObjectPairs;
+	float m_pOverlappingPairsBenchmarkMilliseconds[3];		// brute force, hierarchy, hierarchy in parallel. 0 until the benchmark was run
+	std::vector<SceneObject*> m_vecVisibleObjects;			// result of the last frustum query, only grown when the results do not fit anymore
+	size_t m_uiNumVisibleObjects;
+	float m_fFrustumCullingMicroseconds;					// time the last frustum query took
 
 	/*
 		Members related to the 3D Window
@@ -106,6 +143,12 @@ private:
 	glm::vec4 m_vec4TopDownNodeRenderColor_Gradient;
 	glm::vec4 m_vec4BottomUpNodeRenderColor;
 	glm::vec4 m_vec4BottomUpNodeRenderColor_Gradient;
+	glm::vec4 m_vec4TopDownSAHNodeRenderColor;
+	glm::vec4 m_vec4TopDownSAHNodeRenderColor_Gradient;
+	glm::vec4 m_vec4LBVHNodeRenderColor;
+	glm::vec4 m_vec4LBVHNodeRenderColor_Gradient;
+	glm::vec4 m_vec4PLOCNodeRenderColor;
+	glm::vec4 m_vec4PLOCNodeRenderColor_Gradient;
 	glm::vec4 m_vec4CrossHairColor;
 	// other options
 	glm::vec3 m_vec3GridPositionsOnAxes;
@@ -116,6 +159,7 @@ private:
 	bool m_bRenderGridYPlane;
 	bool m_bRenderGridZPlane;
 	bool m_bNodeDepthColorGrading;
+	bool m_bFrustumCulling;		// only draw the objects the active hierarchy finds within the camera's frustum
 
 	/*
 		Members related to the 2D graph window
@@ -174,7 +218,18 @@ public:
 private:
 	void LoadDefaultScene(Scene& rSceneToLoadInto);	// makeshift implementation of loading a scene
 	void ReconstructAllTrees();
+	void RebuildDynamicAABBTree();	// only for loading a whole scene, edits update the dynamic tree incrementally
 	void UpdateAfterObjectPropertiesChange();
+	// refits the tree after the given object moved, or constructs it anew if refitting degraded it too much
+	void RefitOrReconstructTree(BVHRenderingDataTuple& rBVHRenderDataTuple, size_t uiMovedObjectIndex,
+		void(*pRefitBVHForObject)(CollisionDetection::BoundingVolumeHierarchy&, const SceneObject*, size_t),
+		void(BVHVisualization::*pConstructBVHandRenderData)(Scene&, BVHRenderingDataTuple&));
+	// casts a grid of rays from the camera into the hierarchies of the current strategy, ray by ray and in packets, and into a k-d tree, and measures the rays per second
+	void RunRayCastBenchmark();
+	// picks by the bounding volume the active hierarchy is built with: Bounding Sphere trees have no AABBs to test
+	CollisionDetection::RayCastIntersectionResult CastRayIntoActiveBVH(const CollisionDetection::Ray& rCastedRay) const;
+	// finds all objects with overlapping AABBs by brute force and through the AABB hierarchy of the current strategy, and measures how long each took
+	void RunOverlappingPairsBenchmark();
 
 	// simulation controls
 	void ResetSimulation();
@@ -193,6 +248,8 @@ private:
 	void SetNewBVHConstructionStrategy(eBVHConstructionStrategy eNewStrategy);
 	eBVHBoundingVolume GetCurrentBVHBoundingVolume() const;
 	void SetNewBVHBoundingVolume(eBVHBoundingVolume eNewBoundingVolume);
+	void UpdateCurrentlyActiveBVH();	// points m_pCurrentlyActiveConstructionStrategy to the tuple matching the current strategy and bounding volume
+	BVHRenderingDataTuple& GetBVHRenderingDataTuple(eBVHBoundingVolume eBoundingVolume);	// the tuple of the current strategy built with the given bounding volume
 
 	// scene manipulation
 	void DeleteGivenObject(SceneObject* pToBeDeletedObject);
@@ -214,7 +271,9 @@ private:
 	void UpdateProjectionMatrices();
 	void Render3DVisualization();
 	void RenderVisualizationGUI();
+	void CullObjectsOutsideOfFrustum();	// queries the active hierarchy for the objects RenderRealObjects draws, after the camera matrices were updated
 	void RenderRealObjects() const;
+	void RenderRealObject(const SceneObject& rSceneObject) const;
 	void RenderHUDComponents() const;
 	void RenderDataStructureObjects() const;
 	void Render3DSceneConstants() const;
@@ -244,35 +303,56 @@ private:
 	void CrosshairClick();
 	void CursorClick();
 
-	// BVHs
-	BVHRenderingDataTuple ConstructTopDownAABBBVHandRenderDataForScene(Scene& rScene);
-	BVHRenderingDataTuple ConstructBottomUpAABBBVHandRenderDataForScene(Scene& rScene);
-	BVHRenderingDataTuple ConstructTopDownBoundingSphereBVHandRenderDataForScene(Scene& rScene);
-	BVHRenderingDataTuple ConstructBottomUpBoundingSphereBVHandRenderDataForScene(Scene& rScene);
+	// BVHs. Every construction fills the given tuple in place, reusing its memory from previous constructions
+	void ConstructTopDownAABBBVHandRenderDataForScene(Scene& rScene, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	void ConstructBottomUpAABBBVHandRenderDataForScene(Scene& rScene, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	void ConstructTopDownBoundingSphereBVHandRenderDataForScene(Scene& rScene, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	void ConstructBottomUpBoundingSphereBVHandRenderDataForScene(Scene& rScene, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	void ConstructTopDownSAHAABBBVHandRenderDataForScene(Scene& rScene, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	void ConstructTopDownSAHBoundingSphereBVHandRenderDataForScene(Scene& rScene, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	void ConstructLBVHAABBBVHandRenderDataForScene(Scene& rScene, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	void ConstructLBVHBoundingSphereBVHandRenderDataForScene(Scene& rScene, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	void ConstructPLOCAABBBVHandRenderDataForScene(Scene& rScene, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	void ConstructPLOCBoundingSphereBVHandRenderDataForScene(Scene& rScene, BVHRenderingDataTuple& rBVHRenderDataTuple);
 
 	// 2D graph
 	void ConstructBVHTreeGraphRenderData(BVHRenderingDataTuple& rBVHRenderDataTuple);
 	void RecursiveConstructTreeGraphRenderData(const CollisionDetection::BVHTreeNode* pCurrentNode, BVHRenderingDataTuple& rBVHRenderDataTuple, ScreenSpaceForGraphRendering tScreenSpaceForThisNode, glm::vec2 vec2PreviousDrawPosition);
 	void DrawNodeAtPosition(glm::vec2 vec2ScreenSpacePosition, const glm::vec4& rvec4DrawColor) const;
-	void Draw2DObjectAtPosition(glm::vec2 vec2ScreenSpacePosition, const glm::vec4& rvec4DrawColor) const;
+	void Draw2DObjectAtPosition(glm::vec2 vec2ScreenSpacePosition, const glm::vec4& rvec4DrawColor, float fDrawSize) const;
+	void Draw2DLeafAtPosition(glm::vec2 vec2ScreenSpacePosition, const glm::vec4& rvec4DrawColor, uint32_t uiNumObjects) const;
 	void DrawLineFromTo(glm::vec2 vec2From, glm::vec2 vec2To) const;
 
 	/*
-		recursive function that constructs a top down AABB tree
+		recursive function that constructs a top down AABB tree.
+		Works on the object references from uiFirstObjectReference on, partitioning them in place. The scene objects are left untouched.
+		pNewNode is the first of the 2 * uiNumObjectReferences - 1 nodes reserved for this subtree, the most it can possibly need.
+		With a task pool, independent subtrees and large partitioning steps are processed in parallel. The resulting tree is the same.
 	*/
-	void RecursiveTopDownTree_AABB(CollisionDetection::BVHTreeNode** pNode, SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+	void RecursiveTopDownTree_AABB(CollisionDetection::BVHTreeNode* pNewNode, const SceneObject* pSceneObjects, CollisionDetection::ObjectReference* pObjectReferences, size_t uiFirstObjectReference, size_t uiNumObjectReferences, TaskPool* pTaskPool);
 	/*
-		TODO: DOC
+		constructs a bottom up AABB tree by executing the given merge order, as determined by CalcBottomUpMergeOrder_AABB or CalcPLOCMergeOrder_AABB.
+		Returns the root node.
 	*/
-	CollisionDetection::BVHTreeNode* BottomUpTree_AABB(SceneObject* pSceneObjects, size_t uiNumSceneObjects, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	CollisionDetection::BVHTreeNode* BottomUpTree_AABB(SceneObject* pSceneObjects, size_t uiNumSceneObjects, const std::vector<CollisionDetection::BottomUpMerge>& rvecMerges, BVHRenderingDataTuple& rBVHRenderDataTuple);
 	/*
-		recursive function that constructs a top down Bounding Sphere tree
+		recursive function that constructs a top down Bounding Sphere tree. Works on object references, like RecursiveTopDownTree_AABB
 	*/
-	void RecursiveTopDownTree_BoundingSphere(CollisionDetection::BVHTreeNode** pNode, SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+	void RecursiveTopDownTree_BoundingSphere(CollisionDetection::BVHTreeNode* pNewNode, const SceneObject* pSceneObjects, CollisionDetection::ObjectReference* pObjectReferences, size_t uiFirstObjectReference, size_t uiNumObjectReferences, TaskPool* pTaskPool);
 	/*
-		TODO: DOC
+		constructs a bottom up Bounding Sphere tree by executing the given merge order, like BottomUpTree_AABB
+	*/
+	CollisionDetection::BVHTreeNode* BottomUpTree_BoundingSphere(SceneObject* pSceneObjects, size_t uiNumSceneObjects, const std::vector<CollisionDetection::BottomUpMerge>& rvecMerges, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	/*
+		recursive function that constructs a top down AABB tree, partitioning by the binned Surface Area Heuristic.
+		Leaves may hold more than one object, if the SAH considers that cheaper than splitting any further.
+	*/
+	void RecursiveTopDownTree_SAH_AABB(CollisionDetection::BoundingVolumeHierarchy& rBVH, CollisionDetection::BVHTreeNode** pNode, const SceneObject* pSceneObjects, CollisionDetection::ObjectReference* pObjectReferences, size_t uiFirstObjectReference, size_t uiNumObjectReferences);
+	/*
+		recursive function that constructs a top down Bounding Sphere tree, partitioning by the binned Surface Area Heuristic.
+		The heuristic itself always works on the objects' AABBs, only the nodes' bounding volumes are spheres.
 	*/
-	CollisionDetection::BVHTreeNode* BottomUpTree_BoundingSphere(SceneObject* pSceneObjects, size_t uiNumSceneObjects, BVHRenderingDataTuple& rBVHRenderDataTuple);
+	void RecursiveTopDownTree_SAH_BoundingSphere(CollisionDetection::BoundingVolumeHierarchy& rBVH, CollisionDetection::BVHTreeNode** pNode, const SceneObject* pSceneObjects, CollisionDetection::ObjectReference* pObjectReferences, size_t uiFirstObjectReference, size_t uiNumObjectReferences);
 	/*
 		TODO: DOC
 	*/
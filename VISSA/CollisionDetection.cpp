@@ -2,15 +2,22 @@
 
 #include <limits>
 #include <algorithm>
+#include <cmath>
+#include <queue>
+#include <functional>
+#include <atomic>
 
 //#include "Visualization.h"
 #include "Scene.h"
 #include "SceneObject.h"
 #include "GeometricPrimitiveData.h"
+#include "TaskPool.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <immintrin.h>	// SSE for all targets, AVX only where the build enables it
+
 using namespace CollisionDetection;	// ok here since we are in a translation unit devoted to the CollisionDetection namespace
 
 /*
@@ -26,10 +33,110 @@ namespace CollisionDetection {
 			size_t m_uiMaxVertexIndex;
 		};
 
+		struct SAHBin {
+			glm::vec3 m_vec3Min = glm::vec3(std::numeric_limits<float>::max());
+			glm::vec3 m_vec3Max = glm::vec3(std::numeric_limits<float>::lowest());
+			size_t m_uiNumObjects = 0u;
+		};
+
+		/*
+			The rays of a packet prepared for testing them against a box all at once, stored as one array per slab
+		*/
+		template <size_t uiPacketSize>
+		struct RayPacketSlabData {
+			alignas(32) float m_pOrigins[3][uiPacketSize];
+			alignas(32) float m_pInverseDirections[3][uiPacketSize];
+			alignas(32) uint32_t m_pIsDirectionNegative[3][uiPacketSize];	// all bits set where the ray's direction is negative
+			alignas(32) float m_pMaxEntryDistances[uiPacketSize];			// the closest hit of every ray so far, boxes entered beyond it are misses
+		};
+
+		struct MortonCodedObject {
+			uint64_t m_uiMortonCode;
+			uint32_t m_uiObjectIndex;
+		};
+
+		/*
+			Where an object's AABB begins or ends on one axis, swept by the k-d tree construction
+		*/
+		struct KDTreeEdge {
+			float m_fPosition;
+			uint32_t m_uiObjectIndex;
+			bool m_bIsStart;
+		};
+
+		/*
+			State shared by all nodes of one k-d tree construction. The edges are scratch memory, reused by every node.
+		*/
+		struct KDTreeConstruction {
+			KDTree* m_pKDTree;
+			SceneObject* m_pSceneObjects;
+			const KDTreeParameters* m_pParameters;
+			std::vector<KDTreeEdge> m_pEdges[3];
+		};
+
+		/*
+			A cell of a k-d tree put aside by the ray traversal, with the interval of the ray's line inside of it
+		*/
+		struct KDTreeCellToVisit {
+			uint32_t m_uiNodeIndex;
+			float m_fIntervalMin;
+			float m_fIntervalMax;
+		};
+
+		/*
+			The box of a region query, in the same form as the nodes of a LinearBVH, so both are compared without any rounding
+		*/
+		struct MinMaxBox {
+			glm::vec3 m_vec3Min;
+			glm::vec3 m_vec3Max;
+		};
+
+		/*
+			The caller's buffer for the objects of a region query
+		*/
+		struct ObjectQueryOutput {
+			SceneObject** m_ppObjects;
+			size_t m_uiMaxNumObjects;
+			size_t m_uiNumObjects;	// all objects found so far, including those that did not fit into m_ppObjects
+		};
+
+		/*
+			The caller's buffer for the pairs of an overlap query. Shared by all tasks of the query.
+		*/
+		struct ObjectPairOutput {
+			ObjectPair* m_pPairs;
+			size_t m_uiMaxNumPairs;
+			std::atomic<size_t> m_uiNumPairs;	// all pairs found so far, including those that did not fit into m_pPairs
+		};
+
+		/*
+			Pairs found by a single task, handed over to the ObjectPairOutput in batches so tasks rarely contend for it
+		*/
+		struct ObjectPairBatch {
+			static const size_t s_uiMaxNumPairs = 64u;
+
+			ObjectPair m_pPairs[s_uiMaxNumPairs];
+			size_t m_uiNumPairs = 0u;
+		};
+
+		template <typename BoundingVolume>
+		struct OverlappingPairsQuery {
+			const BoundingVolumeHierarchy* m_pBVH;
+			const BoundingVolumeHierarchy* m_pOtherBVH;		// the same as m_pBVH when a hierarchy is tested against itself
+			BoundingVolume BVHTreeNode::* m_pNodeBoundingVolume;
+			BoundingVolume SceneObject::* m_pObjectBoundingVolume;
+			int(*m_pTestBoundingVolumes)(const BoundingVolume&, const BoundingVolume&);
+			TaskPool* m_pTaskPool;						// null for serial queries
+			ObjectPairOutput* m_pOutput;
+		};
+
 		//////////////////////////////////////////
 		// BOUNDING VOLUMES
 		//////////////////////////////////////////
 
+		// one bit per plane of a Frustum
+		const uint32_t s_uiAllFrustumPlanesMask = (1u << 6) - 1u;
+
 		/*
 			pVertices = original vertex data as it was sent to the GPU, including position, normals and UVs (= stride of 8 floats per vertex)
 
@@ -80,30 +187,445 @@ namespace CollisionDetection {
 			cheating shortcut function that creates a Bounding Sphere for an object by exploiting intrisic knowledge that the object is a sphere.
 		*/
 		BoundingSphere ConstructLocalSpaceBoundingSphereForSphere(const SceneObject& rCurrentSphere);
+		/*
+			Whether the inner AABB lies completely within the outer one
+		*/
+		bool DoesAABBContainAABB(const AABB& rOuterAABB, const AABB& rInnerAABB);
+		/*
+			StaticTestAABBagainstFrustum for a box given by its minimum and maximum corner, against the planes whose bits are set in ruiPlaneMask.
+			The bits of the planes the box lies completely inside of are cleared, nothing within the box needs to be tested against them anymore.
+			Boxes within others never pass a plane their enclosing box failed, not even by rounding.
+		*/
+		int TestMinMaxBoxagainstFrustumPlanes(const glm::vec3& rvec3Min, const glm::vec3& rvec3Max, const Frustum& rFrustum, uint32_t& ruiPlaneMask);
 
 		//////////////////////////////////////////
 		// BOUNDING VOLUME HIERARCHY
 		//////////////////////////////////////////
 
+		/*
+			Object references are measured and partitioned in chunks of this size once there are more of them than that.
+			The chunking never depends on whether a task pool is used, otherwise parallel and serial construction would build different trees.
+		*/
+		const size_t s_uiObjectReferenceChunkSize = 4096u;
+		/*
+			Below this number of object references, distributing the chunks onto a task pool is not worth it
+		*/
+		const size_t s_uiMinNumObjectReferencesForParallelPartitioning = 32768u;
+
+		/*
+			Calls fnProcessChunk(uiChunkIndex, uiFirstObjectReference, uiNumObjectReferencesInChunk) for every chunk of s_uiObjectReferenceChunkSize references.
+			Without a task pool, the chunks are processed in order on the calling thread.
+		*/
+		template <typename ChunkFunction>
+		void ForEachObjectReferenceChunk(size_t uiNumObjectReferences, TaskPool* pTaskPool, const ChunkFunction& fnProcessChunk);
+		/*
+			The object mean partitioning behind PartitionObjectReferencesInPlace_AABB and PartitionObjectReferencesInPlace_BoundingSphere.
+			pBoundingVolume selects which bounding volume of the objects decides the splitting axis. Runs serially if pTaskPool is null.
+		*/
+		template <typename BoundingVolume>
+		size_t PartitionObjectReferencesAtObjectMean(const SceneObject* pSceneObjects, ObjectReference* pObjectReferences, size_t uiNumObjectReferences, BoundingVolume SceneObject::* pBoundingVolume, TaskPool* pTaskPool);
+		/*
+			Stable partitioning of the given references: those with a centroid coordinate below fSplittingPlane on the given axis come first.
+			Goes through a scratch buffer chunk by chunk, so that the chunks can be processed in parallel. Returns the number of references on the "left" side.
+		*/
+		size_t StablePartitionObjectReferencesInChunks(ObjectReference* pObjectReferences, size_t uiNumObjectReferences, int iSplittingAxis, float fSplittingPlane, TaskPool* pTaskPool);
+		/*
+			Surface area of the box spanned by the given minimum and maximum corner points.
+			Returns 0 for boxes that have never been grown (min > max).
+		*/
+		float CalcSurfaceAreaOfExtents(const glm::vec3& rvec3Min, const glm::vec3& rvec3Max);
+		/*
+			Surface area of the AABB enclosing all referenced objects. A single object is measured by its own AABB.
+		*/
+		float CalcSurfaceAreaOfObjects_AABB(const SceneObject* pSceneObjects, const ObjectReference* pObjectReferences, size_t uiNumObjectReferences);
+		/*
+			Surface area of the Bounding Sphere enclosing all referenced objects. A single object is measured by its own Bounding Sphere.
+		*/
+		float CalcSurfaceAreaOfObjects_BoundingSphere(const SceneObject* pSceneObjects, const ObjectReference* pObjectReferences, size_t uiNumObjectReferences);
+		/*
+			Maps a centroid coordinate onto one of the uiNumBins bins of the binned SAH.
+			Both counting and partitioning have to use this very function, otherwise objects might end up on the wrong side.
+		*/
+		size_t CalcSAHBinIndex(float fCentroidCoordinate, float fCentroidMinimum, float fBinsPerUnit, size_t uiNumBins);
+		/*
+			Grows the given SAH bin, so it encloses the given AABB
+		*/
+		void GrowSAHBinByAABB(SAHBin& rBin, const AABB& rAABB);
+		/*
+			The volume of the AABB that would result from merging the two given AABBs. Used to pick bottom up merge partners.
+		*/
+		float CalcBottomUpMergeCost_AABB(const AABB& rAABB1, const AABB& rAABB2);
+		/*
+			The diameter of the Bounding Sphere that would result from merging the two given Bounding Spheres. Used to pick bottom up merge partners.
+		*/
+		float CalcBottomUpMergeCost_BoundingSphere(const BoundingSphere& rBoundingSphere1, const BoundingSphere& rBoundingSphere2);
+		/*
+			The greedy agglomerative clustering behind CalcBottomUpMergeOrder_AABB and CalcBottomUpMergeOrder_BoundingSphere.
+			rvecBoundingVolumes holds the leaves' bounding volumes and receives the bounding volume of every merged node.
+		*/
+		template <typename BoundingVolume>
+		std::vector<BottomUpMerge> CalcBottomUpMergeOrder(std::vector<BoundingVolume>& rvecBoundingVolumes,
+			float(*pMergeCostFunction)(const BoundingVolume&, const BoundingVolume&),
+			BoundingVolume(*pMergeFunction)(const BoundingVolume&, const BoundingVolume&));
+		/*
+			Appends the given node and its whole subtree to rvecLinearNodes in depth first order. Returns the index of the appended node.
+		*/
+		uint32_t RecursiveFlattenBVHTree(const BVHTreeNode* pNode, const std::vector<SceneObject*>& rvecObjectPermutation, std::vector<LinearBVHNode>& rvecLinearNodes);
+		/*
+			Appends the wide node for the given node of a LinearBVH, and the whole subtree below it, to rvecWideNodes. Returns the index of the appended node.
+		*/
+		template <size_t uiWidth>
+		uint32_t RecursiveCollapseIntoWideBVH(const std::vector<LinearBVHNode>& rvecLinearNodes, uint32_t uiLinearNodeIndex, std::vector<WideBVHNode<uiWidth>>& rvecWideNodes);
+		/*
+			The collapse behind CreateBVH4 and CreateBVH8
+		*/
+		template <size_t uiWidth>
+		WideBVH<uiWidth> CreateWideBVH(const BoundingVolumeHierarchy& rBVH);
+		/*
+			Appends the k-d tree node for the given objects and cell, and the whole subtree below it, to the tree under construction.
+			iRemainingDepth counts down to 0, iNumBadRefines counts the splits above that cost more than a leaf would have.
+		*/
+		void RecursiveConstructKDTreeNode(KDTreeConstruction& rConstruction, const std::vector<uint32_t>& rvecObjectIndices, const glm::vec3& rvec3CellMin, const glm::vec3& rvec3CellMax,
+			int iRemainingDepth, int iNumBadRefines);
+		/*
+			Surface area of the node's AABB, used to measure how much a refitted tree degraded
+		*/
+		float CalcNodeSurfaceArea_AABB(const BVHTreeNode& rNode);
+		/*
+			Surface area of the node's Bounding Sphere, used to measure how much a refitted tree degraded
+		*/
+		float CalcNodeSurfaceArea_BoundingSphere(const BVHTreeNode& rNode);
+		/*
+			Links the given node and its whole subtree to their parents and registers every leaf with its objects in rBVH.m_vecLeafOfObject.
+			Returns the summed surface area of all nodes in the subtree, leaves excluded.
+		*/
+		float RecursiveLinkBVHTreeForRefitting(BoundingVolumeHierarchy& rBVH, BVHTreeNode* pNode, BVHTreeNode* pParent, const SceneObject* pSceneObjects, float(*pCalcNodeSurfaceArea)(const BVHTreeNode&));
+		/*
+			Recomputes the node's AABB from its children, or for leaves from its objects. Returns whether the AABB changed.
+		*/
+		bool RefitNode_AABB(BVHTreeNode& rNode, const std::vector<SceneObject*>& rvecObjectPermutation);
+		/*
+			Recomputes the node's Bounding Sphere from its children, or for leaves from its objects. Returns whether the Bounding Sphere changed.
+		*/
+		bool RefitNode_BoundingSphere(BVHTreeNode& rNode, const std::vector<SceneObject*>& rvecObjectPermutation);
+		/*
+			Refits the given leaf and then its ancestors one after another, until a node's bounding volume stays the same.
+			Keeps rBVH.m_fNodeSurfaceArea up to date.
+		*/
+		void RefitBVHTreeFromLeaf(BoundingVolumeHierarchy& rBVH, BVHTreeNode* pLeaf,
+			bool(*pRefitNode)(BVHTreeNode&, const std::vector<SceneObject*>&),
+			float(*pCalcNodeSurfaceArea)(const BVHTreeNode&));
+		/*
+			Below this number of objects, emitting an LBVH subtree as a task of its own is not worth it
+		*/
+		const size_t s_uiMinNumObjectsForLBVHSubtreeTask = 1024u;
+		/*
+			Spreads the lowest 10 bits of the given value so that two zero bits follow every one of them
+		*/
+		uint64_t ExpandBitsForMortonCode30(uint64_t uiValue);
+		/*
+			Spreads the lowest 21 bits of the given value so that two zero bits follow every one of them
+		*/
+		uint64_t ExpandBitsForMortonCode63(uint64_t uiValue);
+		/*
+			Computes the Morton codes of all objects' AABB centroids, quantized within the extent of all centroids, and returns them sorted
+		*/
+		std::vector<MortonCodedObject> CreateSortedMortonCodes(const SceneObject* pSceneObjects, size_t uiNumSceneObjects, const LBVHParameters& rParameters, TaskPool* pTaskPool);
+		/*
+			Stable least significant digit radix sort on the lowest uiNumKeyBits bits of the Morton codes, 11 bits per pass.
+			Every pass counts and scatters chunk by chunk, so the chunks can be processed in parallel. Passes in which all codes share their digit are skipped.
+		*/
+		void RadixSortMortonCodedObjects(std::vector<MortonCodedObject>& rvecMortonCodedObjects, size_t uiNumKeyBits, TaskPool* pTaskPool);
+		/*
+			Returns the number of the given sorted codes in the "left" half: those with the highest bit in which the first and last code differ cleared.
+			Ranges of identical codes are split in the middle.
+		*/
+		size_t FindMortonCodeSplit(const MortonCodedObject* pSortedMortonCodedObjects, size_t uiNumMortonCodedObjects);
+		/*
+			Emits the subtree for the given range of sorted codes into pNode and the 2 * uiNumMortonCodedObjects - 2 nodes following it:
+			the left child directly follows its parent, the right child follows the whole left subtree.
+			pLeafBoundingVolumes holds the bounding volumes of the objects in sorted order. Node volumes are merged from the children after they have been emitted.
+		*/
+		template <typename BoundingVolume>
+		void RecursiveEmitLBVHNode(BVHTreeNode* pNode, const MortonCodedObject* pSortedMortonCodedObjects, size_t uiFirstMortonCodedObject, size_t uiNumMortonCodedObjects,
+			const BoundingVolume* pLeafBoundingVolumes, BoundingVolume BVHTreeNode::* pNodeBoundingVolume,
+			BoundingVolume(*pMergeFunction)(const BoundingVolume&, const BoundingVolume&), TaskPool* pTaskPool);
+		/*
+			The construction behind ConstructLBVH_AABB and ConstructLBVH_BoundingSphere
+		*/
+		template <typename BoundingVolume>
+		void ConstructLBVH(BoundingVolumeHierarchy& rBVH, SceneObject* pSceneObjects, size_t uiNumSceneObjects, const LBVHParameters& rParameters,
+			BoundingVolume SceneObject::* pObjectBoundingVolume, BoundingVolume BVHTreeNode::* pNodeBoundingVolume,
+			BoundingVolume(*pMergeFunction)(const BoundingVolume&, const BoundingVolume&), TaskPool* pTaskPool);
+		/*
+			The clustering behind CalcPLOCMergeOrder_AABB and CalcPLOCMergeOrder_BoundingSphere.
+			pObjectBoundingVolume selects the bounding volume of the objects that is merged and measured.
+		*/
+		template <typename BoundingVolume>
+		std::vector<BottomUpMerge> CalcPLOCMergeOrder(const SceneObject* pSceneObjects, size_t uiNumSceneObjects, const PLOCParameters& rParameters,
+			BoundingVolume SceneObject::* pObjectBoundingVolume,
+			float(*pMergeCostFunction)(const BoundingVolume&, const BoundingVolume&),
+			BoundingVolume(*pMergeFunction)(const BoundingVolume&, const BoundingVolume&), TaskPool* pTaskPool);
+
+
+		//////////////////////////////////////////
+		// RAY CASTING
+		//////////////////////////////////////////
+
+		// nodes put aside by a ray traversal. Deep enough for any reasonably balanced hierarchy, deeper ones continue by recursion
+		const size_t s_uiRayTraversalStackSize = 64u;
+		// nodes put aside by SHORT_STACK_TRAVERSAL. When it overflows, the oldest entry is dropped and later found again along the parent links
+		const size_t s_uiRayTraversalShortStackSize = 4u;
+
+		/*
+			Casts the ray into the subtree of the given node, always visiting the left child before the right one.
+			pStatistics may be null.
+		*/
+		RayCastIntersectionResult RecursiveRayCastIntoBVHTree(const BoundingVolumeHierarchy& rBVH, const BVHTreeNode* pNode, const Ray& rCastedRay, RayTraversalStatistics* pStatistics);
+		/*
+			Tests the ray against the given bounding volume of every object of the given leaf, updating rResult if one of them is hit closer than rResult's current hit
+		*/
+		template <typename BoundingVolume>
+		void CastRayIntoBVHLeaf(const BoundingVolumeHierarchy& rBVH, const BVHTreeNode* pLeaf, const Ray& rCastedRay, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			int(*pIntersectRayBoundingVolume)(const Ray&, const BoundingVolume&, float&), RayCastIntersectionResult& rResult, RayTraversalStatistics& rStatistics);
+		/*
+			Whether the ray hits the given bounding volume of the node no further away than fMaxEntryDistance. Writes the distance at which the ray enters it.
+		*/
+		template <typename BoundingVolume>
+		bool IntersectRayBVHNode(const Ray& rCastedRay, const BVHTreeNode* pNode, BoundingVolume BVHTreeNode::* pNodeBoundingVolume,
+			int(*pIntersectRayBoundingVolume)(const Ray&, const BoundingVolume&, float&), float fMaxEntryDistance, float& rfEntryDistance, RayTraversalStatistics& rStatistics);
+		/*
+			The child of the given node whose center comes first along the ray's direction
+		*/
+		const BVHTreeNode* GetNearChildAlongRay(const BVHTreeNode* pNode, const Ray& rCastedRay);
+		/*
+			The traversal behind STACK_TRAVERSAL and CastRayIntoBVH_BoundingSphere. pNodeBoundingVolume and pObjectBoundingVolume select what the ray is tested against
+		*/
+		template <typename BoundingVolume>
+		RayCastIntersectionResult StackRayCastIntoBVHTree(const BoundingVolumeHierarchy& rBVH, const Ray& rCastedRay,
+			BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			int(*pIntersectRayBoundingVolume)(const Ray&, const BoundingVolume&, float&), RayTraversalStatistics& rStatistics);
+		/*
+			Visits the subtree of the given node, which the ray enters at fEntryDistance, and updates rResult with every closer hit.
+			When the stack runs full, the near child's subtree is traversed by recursion, so the order of the nodes stays the same.
+		*/
+		template <typename BoundingVolume>
+		void StackRayCastIntoBVHSubtree(const BoundingVolumeHierarchy& rBVH, const BVHTreeNode* pSubtreeRootNode, float fEntryDistance, const Ray& rCastedRay,
+			BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			int(*pIntersectRayBoundingVolume)(const Ray&, const BoundingVolume&, float&), RayCastIntersectionResult& rResult, RayTraversalStatistics& rStatistics);
+		RayCastIntersectionResult StacklessRayCastIntoBVHTree(const BoundingVolumeHierarchy& rBVH, const Ray& rCastedRay, RayTraversalStatistics& rStatistics);
+		RayCastIntersectionResult ShortStackRayCastIntoBVHTree(const BoundingVolumeHierarchy& rBVH, const Ray& rCastedRay, RayTraversalStatistics& rStatistics);
+		/*
+			TODO: DOC
+		*/
+		int IntersectRayAABB(const Ray& rIntersectingRay, const AABB& rAABB, float& rfIntersectionDistance, glm::vec3& rvec3IntersectionPoint);
+		/*
+			Slab test for boxes given by their minimum and maximum corner, without any branches or divisions. Does not compute the intersection point.
+			Boxes are hit as soon as the ray's line passes through them, rfIntersectionDistanceMin is negative for boxes behind the origin.
+		*/
+		int IntersectRayMinMaxBox(const Ray& rIntersectingRay, const glm::vec3& rvec3Min, const glm::vec3& rvec3Max, float& rfIntersectionDistanceMin);
+		/*
+			Same as IntersectRayMinMaxBox, also returning the distance at which the ray's line leaves the box
+		*/
+		int IntersectRayMinMaxBoxEntryExit(const Ray& rIntersectingRay, const glm::vec3& rvec3Min, const glm::vec3& rvec3Max, float& rfIntersectionDistanceMin, float& rfIntersectionDistanceMax);
+		/*
+			Same as IntersectRayAABB, without computing the intersection point
+		*/
+		int IntersectRayAABBDistanceOnly(const Ray& rIntersectingRay, const AABB& rAABB, float& rfIntersectionDistanceMin);
+		/*
+			Whether the ray's line passes through the Bounding Sphere, and at which distance it enters it. Just like the slab tests,
+			spheres behind the origin are hit at negative distances. The ray's direction has to be normalized.
+		*/
+		int IntersectRayBoundingSphere(const Ray& rIntersectingRay, const BoundingSphere& rBoundingSphere, float& rfIntersectionDistanceMin);
+		/*
+			Slab test of four boxes given as structure of arrays, with the very same results as four calls of IntersectRayMinMaxBox.
+			Returns a bit mask of the boxes that are hit and entered no further away than fMaxEntryDistance, and writes all four entry distances.
+		*/
+		uint32_t IntersectRayFourMinMaxBoxes(const Ray& rRay, const float* pMinX, const float* pMinY, const float* pMinZ,
+			const float* pMaxX, const float* pMaxY, const float* pMaxZ, float fMaxEntryDistance, float* pEntryDistances);
+#if defined(__AVX__)
+		/*
+			Same as IntersectRayFourMinMaxBoxes, for eight boxes
+		*/
+		uint32_t IntersectRayEightMinMaxBoxes(const Ray& rRay, const float* pMinX, const float* pMinY, const float* pMinZ,
+			const float* pMaxX, const float* pMaxY, const float* pMaxZ, float fMaxEntryDistance, float* pEntryDistances);
+#endif
+		/*
+			Tests the ray against all children of the given node. Returns a bit mask of the children that are hit no further away than fMaxEntryDistance
+		*/
+		uint32_t IntersectRayWideBVHChildren(const Ray& rRay, const WideBVHNode<4>& rNode, float fMaxEntryDistance, float* pEntryDistances);
+		uint32_t IntersectRayWideBVHChildren(const Ray& rRay, const WideBVHNode<8>& rNode, float fMaxEntryDistance, float* pEntryDistances);
+		/*
+			The traversal behind both CastRayIntoBVH overloads for wide hierarchies
+		*/
+		template <size_t uiWidth>
+		RayCastIntersectionResult CastRayIntoWideBVH(const WideBVH<uiWidth>& rBVH, const Ray& rCastedRay);
+		/*
+			Visits the subtree of the given wide node, which the ray enters at fEntryDistance, and updates rResult with every closer hit.
+			When the stack runs full, the nearest children's subtrees are traversed by recursion, so the order of the nodes stays the same.
+		*/
+		template <size_t uiWidth>
+		void CastRayIntoWideBVHSubtree(const WideBVH<uiWidth>& rBVH, uint32_t uiSubtreeRootIndex, float fEntryDistance, const Ray& rCastedRay, RayCastIntersectionResult& rResult);
+		/*
+			Continues a single ray's cast into the subtree of the given LinearBVH node, updating rResult wherever something closer is hit
+		*/
+		void CastRayIntoLinearBVHSubtree(const LinearBVH& rBVH, uint32_t uiSubtreeRootIndex, const Ray& rCastedRay, RayCastIntersectionResult& rResult);
+		/*
+			Same as CastRayIntoLinearBVHSubtree, for a subtree of a dynamic tree
+		*/
+		void CastRayIntoDynamicAABBTreeSubtree(const DynamicAABBTree& rTree, int32_t iSubtreeRootNode, SceneObject* pSceneObjects, const Ray& rCastedRay, RayCastIntersectionResult& rResult);
+		template <size_t uiPacketSize>
+		RayPacketSlabData<uiPacketSize> CreateRayPacketSlabData(const Ray* pRays, size_t uiNumRays);
+		/*
+			Slab test of four rays of a packet, starting at uiFirstRay, against one box. Every ray gets the very same result as IntersectRayMinMaxBox,
+			except that boxes entered beyond the ray's closest hit so far count as misses. Returns a bit mask of the rays that hit the box.
+		*/
+		template <size_t uiPacketSize>
+		uint32_t IntersectFourRaysMinMaxBox(const RayPacketSlabData<uiPacketSize>& rPacket, size_t uiFirstRay, const glm::vec3& rvec3Min, const glm::vec3& rvec3Max);
+#if defined(__AVX__)
+		/*
+			Same as IntersectFourRaysMinMaxBox, for eight rays
+		*/
+		template <size_t uiPacketSize>
+		uint32_t IntersectEightRaysMinMaxBox(const RayPacketSlabData<uiPacketSize>& rPacket, size_t uiFirstRay, const glm::vec3& rvec3Min, const glm::vec3& rvec3Max);
+#endif
+		/*
+			Slab test of all rays of a packet against one box. Returns a bit mask of the rays that hit it
+		*/
+		template <size_t uiPacketSize>
+		uint32_t IntersectRayPacketMinMaxBox(const RayPacketSlabData<uiPacketSize>& rPacket, const glm::vec3& rvec3Min, const glm::vec3& rvec3Max);
+		/*
+			Casts up to uiPacketSize rays as one packet, see CastRayPacketsIntoBVH
+		*/
+		template <size_t uiPacketSize>
+		void CastRayPacketIntoLinearBVH(const LinearBVH& rBVH, const Ray* pRays, size_t uiNumRays, RayCastIntersectionResult* pResults);
+		/*
+			Continues the packet's cast into the subtree of the given LinearBVH node for the rays in uiSubtreeActiveRays.
+			When the stack runs full, the subtree that would be visited next is traversed by recursion, so the order of the nodes stays the same.
+		*/
+		template <size_t uiPacketSize>
+		void CastRayPacketIntoLinearBVHSubtree(const LinearBVH& rBVH, uint32_t uiSubtreeRootIndex, uint32_t uiSubtreeActiveRays, RayPacketSlabData<uiPacketSize>& rPacket,
+			const Ray* pRays, size_t uiNumRays, RayCastIntersectionResult* pResults);
+
+		//////////////////////////////////////////
+		// OVERLAPPING PAIRS
+		//////////////////////////////////////////
 
+		/*
+			The query behind all FindOverlappingObjectPairs functions. pOtherBVH is null to test rBVH against itself.
+		*/
+		template <typename BoundingVolume>
+		size_t FindOverlappingObjectPairs(const BoundingVolumeHierarchy& rBVH, const BoundingVolumeHierarchy* pOtherBVH,
+			BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			int(*pTestBoundingVolumes)(const BoundingVolume&, const BoundingVolume&), ObjectPair* pPairs, size_t uiMaxNumPairs, TaskPool* pTaskPool);
+		/*
+			All overlapping pairs of objects within the subtree of the given node: those within either child's subtree, and those between the two subtrees
+		*/
+		template <typename BoundingVolume>
+		void FindOverlappingObjectPairsInSubtree(const OverlappingPairsQuery<BoundingVolume>& rQuery, const BVHTreeNode* pNode, int iDepth, ObjectPairBatch& rBatch);
+		/*
+			All overlapping pairs of one object from the subtree of pNode, a node of the query's first hierarchy, and one from the subtree of pOtherNode.
+			Descends into the node with the larger bounding volume first, so both subtrees shrink at a similar rate and disjoint ones are pruned early.
+		*/
+		template <typename BoundingVolume>
+		void FindOverlappingObjectPairsBetweenSubtrees(const OverlappingPairsQuery<BoundingVolume>& rQuery, const BVHTreeNode* pNode, const BVHTreeNode* pOtherNode, int iDepth, ObjectPairBatch& rBatch);
+		void AddObjectPair(ObjectPairOutput& rOutput, ObjectPairBatch& rBatch, SceneObject* pObject, SceneObject* pOtherObject);
+		void FlushObjectPairBatch(ObjectPairOutput& rOutput, ObjectPairBatch& rBatch);
 
+		//////////////////////////////////////////
+		// REGION QUERIES
+		//////////////////////////////////////////
 
+		/*
+			The frustum culling of a LinearBVH subtree, only testing the planes in uiPlaneMask. Adds the objects it finds to those the caller found before,
+			counting the ones that do not fit into ppObjects anymore. Subtrees that do not fit onto the fixed stack anymore are culled by recursion.
+		*/
+		void FindLinearBVHSubtreeObjectsInFrustum(const LinearBVH& rBVH, uint32_t uiSubtreeRootIndex, uint32_t uiPlaneMask, const Frustum& rFrustum,
+			SceneObject** ppObjects, size_t uiMaxNumObjects, size_t& ruiNumObjects);
+		/*
+			The region query of a LinearBVH subtree. pTestMinMaxBox decides for nodes and objects alike whether their box lies within the queried region.
+			Subtrees that do not fit onto the fixed stack anymore are queried by recursion. Returns false once the visitor ended the query.
+		*/
+		template <typename QueryVolume>
+		bool QueryLinearBVHSubtree(const LinearBVH& rBVH, uint32_t uiSubtreeRootIndex, const QueryVolume& rQueryVolume,
+			int(*pTestMinMaxBox)(const glm::vec3&, const glm::vec3&, const QueryVolume&), ObjectQueryVisitor pVisitor, void* pUserData);
+		/*
+			Same as QueryLinearBVHSubtree, for a subtree of a dynamic tree
+		*/
+		template <typename QueryVolume>
+		bool QueryDynamicAABBTreeSubtree(const DynamicAABBTree& rTree, int32_t iSubtreeRootNode, SceneObject* pSceneObjects, const QueryVolume& rQueryVolume,
+			int(*pTestMinMaxBox)(const glm::vec3&, const glm::vec3&, const QueryVolume&), ObjectQueryVisitor pVisitor, void* pUserData);
+		int TestMinMaxBoxagainstMinMaxBox(const glm::vec3& rvec3Min, const glm::vec3& rvec3Max, const MinMaxBox& rQueryBox);
+		int TestMinMaxBoxagainstBoundingSphere(const glm::vec3& rvec3Min, const glm::vec3& rvec3Max, const BoundingSphere& rQuerySphere);
+		int TestMinMaxBoxagainstPoint(const glm::vec3& rvec3Min, const glm::vec3& rvec3Max, const glm::vec3& rvec3QueryPoint);
+		/*
+			The visitor behind the region queries that write into the caller's buffer. pUserData is the ObjectQueryOutput, the query is never ended early.
+		*/
+		bool AddObjectToQueryOutput(SceneObject* pObject, void* pUserData);
+		MinMaxBox CreateMinMaxBox(const AABB& rAABB);
 
+		//////////////////////////////////////////
+		// NEAREST OBJECTS
+		//////////////////////////////////////////
 
+		// nodes put aside by a nearest object query. Once the heap is full, further nodes are searched right away instead
+		const size_t s_uiNearestObjectsHeapSize = 64u;
 
+		/*
+			The best first search behind all FindNearestObjects functions. pCalcDistance measures the distance of the query point to nodes and objects alike.
+		*/
+		template <typename BoundingVolume>
+		size_t FindNearestObjectsInBVH(const BoundingVolumeHierarchy& rBVH, const glm::vec3& rvec3Point, size_t uiMaxNumObjects, float fMaxDistance,
+			BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			float(*pCalcDistance)(const glm::vec3&, const BoundingVolume&), NearestObject* pNearestObjects);
+		/*
+			Continues the search in the subtree of the given node, which is fSubtreeRootDistance away from the query point.
+			The found objects and the search distance are shared with the caller, so the search can descend into a subtree whenever its heap of nodes is full.
+		*/
+		template <typename BoundingVolume>
+		void FindNearestObjectsInBVHSubtree(const BoundingVolumeHierarchy& rBVH, const BVHTreeNode* pSubtreeRootNode, float fSubtreeRootDistance, const glm::vec3& rvec3Point, size_t uiMaxNumObjects,
+			BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			float(*pCalcDistance)(const glm::vec3&, const BoundingVolume&), NearestObject* pNearestObjects, size_t& ruiNumNearestObjects, float& rfSearchDistance);
+		/*
+			Distance of the point to the closest point of the AABB, 0 for points inside of it
+		*/
+		float CalcDistancePointAABB(const glm::vec3& rvec3Point, const AABB& rAABB);
+		/*
+			Distance of the point to the surface of the Bounding Sphere, 0 for points inside of it
+		*/
+		float CalcDistancePointBoundingSphere(const glm::vec3& rvec3Point, const BoundingSphere& rBoundingSphere);
 
 		//////////////////////////////////////////
-		// RAY CASTING
+		// SWEPT VOLUMES
 		//////////////////////////////////////////
 
+		// nodes put aside by a swept volume cast. Once the heap is full, further nodes are searched right away instead
+		const size_t s_uiSweptVolumeHeapSize = 64u;
+
 		/*
-			TODO: DOC
+			The cast behind CastAABBIntoBVH and CastBoundingSphereIntoBVH. pCalcTimeOfImpact tests the moving volume against nodes and objects alike.
 		*/
-		RayCastIntersectionResult RecursiveRayCastIntoBVHTree(const BVHTreeNode* pNode, const Ray& rCastedRay);
+		template <typename BoundingVolume>
+		TimeOfImpactResult CastSweptVolumeIntoBVH(const BoundingVolumeHierarchy& rBVH, const BoundingVolume& rMovingBoundingVolume, const glm::vec3& rvec3Displacement,
+			const SceneObject* pIgnoredObject, BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			bool(*pCalcTimeOfImpact)(const BoundingVolume&, const glm::vec3&, const BoundingVolume&, float&));
 		/*
-			TODO: DOC
+			Continues the cast in the subtree of the given node, which the moving volume hits at fSubtreeRootTimeOfImpact, updating rResult with every earlier hit.
+			The cast descends into a subtree right away whenever its heap of nodes is full.
 		*/
-		int IntersectRayAABB(const Ray& rIntersectingRay, const AABB& rAABB, float& rfIntersectionDistance, glm::vec3& rvec3IntersectionPoint);
+		template <typename BoundingVolume>
+		void CastSweptVolumeIntoBVHSubtree(const BoundingVolumeHierarchy& rBVH, const BVHTreeNode* pSubtreeRootNode, float fSubtreeRootTimeOfImpact, const BoundingVolume& rMovingBoundingVolume,
+			const glm::vec3& rvec3Displacement, const SceneObject* pIgnoredObject, BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			bool(*pCalcTimeOfImpact)(const BoundingVolume&, const glm::vec3&, const BoundingVolume&, float&), TimeOfImpactResult& rResult);
+		/*
+			The moving AABB hits the resting one where its center enters their Minkowski sum, a box with the summed radii: a slab test along
+			the displacement, clipped to [0, 1]. Writes the time of impact and returns true if they touch within the displacement.
+		*/
+		bool CalcTimeOfImpactAABBagainstAABB(const AABB& rMovingAABB, const glm::vec3& rvec3Displacement, const AABB& rAABB, float& rfTimeOfImpact);
+		/*
+			Same for two Bounding Spheres: the moving center has to enter the sphere of the summed radii around the resting center
+		*/
+		bool CalcTimeOfImpactBoundingSphereagainstBoundingSphere(const BoundingSphere& rMovingBoundingSphere, const glm::vec3& rvec3Displacement, const BoundingSphere& rBoundingSphere, float& rfTimeOfImpact);
 	}
 	
 };
@@ -112,6 +634,23 @@ namespace CollisionDetection {
 	implementation of "public" functions (external linkage)
 */
 
+CollisionDetection::Ray::Ray(const glm::vec3 & vec3Origin, const glm::vec3 & vec3Direction) :
+	m_vec3Origin(vec3Origin),
+	m_vec3Direction(vec3Direction)
+{
+	for (int iCurrentAxis = 0; iCurrentAxis < 3; iCurrentAxis++)
+	{
+		m_pIsDirectionNegative[iCurrentAxis] = std::signbit(vec3Direction[iCurrentAxis]);
+
+		// a ray this close to parallel to an axis' slab only checks whether its origin lies within the slab: an infinite reciprocal
+		// turns the distances to the slab's planes into -infinity and +infinity for origins inside of it and into a missed slab for all others
+		if (std::abs(vec3Direction[iCurrentAxis]) < std::numeric_limits<float>::epsilon())
+			m_vec3InverseDirection[iCurrentAxis] = m_pIsDirectionNegative[iCurrentAxis] ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+		else
+			m_vec3InverseDirection[iCurrentAxis] = 1.0f / vec3Direction[iCurrentAxis];
+	}
+}
+
 float CollisionDetection::AABB::CalcMinimumX() const
 {
 	assert(glm::length(m_vec3Radius) > 0.0f);
@@ -176,6 +715,14 @@ float CollisionDetection::AABB::CalcMaximumForAxis(size_t uiAxisIndex) const
 	return m_vec3Center[uiNonWarningProducingAxisIndex] + m_vec3Radius[uiNonWarningProducingAxisIndex];
 }
 
+float CollisionDetection::AABB::CalcSurfaceArea() const
+{
+	// the radius stores half-widths, the full extents are twice as long
+	const glm::vec3 vec3Extents = m_vec3Radius * 2.0f;
+
+	return 2.0f * (vec3Extents.x * vec3Extents.y + vec3Extents.x * vec3Extents.z + vec3Extents.y * vec3Extents.z);
+}
+
 float CollisionDetection::BoundingSphere::CalcMinimumX() const
 {
 	return m_vec3Center.x - m_fRadius;
@@ -206,56 +753,79 @@ float CollisionDetection::BoundingSphere::CalcMaximumZ() const
 	return m_vec3Center.z + m_fRadius;
 }
 
+float CollisionDetection::BoundingSphere::CalcSurfaceArea() const
+{
+	return 4.0f * glm::pi<float>() * m_fRadius * m_fRadius;
+}
+
 void CollisionDetection::ConstructBoundingVolumesForScene(Scene& rScene)
 {
 	for (SceneObject& rCurrentSceneObject : rScene.m_vecObjects)
 	{
-		if (rCurrentSceneObject.m_eType == SceneObject::eType::CUBE)
-		{
-			rCurrentSceneObject.m_tLocalSpaceAABB = ConstructAABBFromVertexData(Primitives::Cube::VertexData, sizeof(Primitives::Cube::VertexData) / (sizeof(GLfloat) *  8u)); // 8 floats per vertex
-			//rCurrentSceneObject.m_tLocalSpaceBoundingSphere = ConstructBoundingSphereFromVertexData(Primitives::Cube::VertexData, sizeof(Primitives::Cube::IndexData) / sizeof(GLfloat));
-			rCurrentSceneObject.m_tLocalSpaceBoundingSphere = ConstructLocalSpaceBoundingSphereForCube(rCurrentSceneObject);
+		ConstructBoundingVolumesForObject(rCurrentSceneObject);
+		rCurrentSceneObject.m_tSweptWorldSpaceAABB = rCurrentSceneObject.m_tWorldSpaceAABB;
+	}
+}
 
-		}
-		else if(rCurrentSceneObject.m_eType == SceneObject::eType::SPHERE)
-		{
-			rCurrentSceneObject.m_tLocalSpaceAABB = ConstructAABBFromVertexData(Primitives::Sphere::VertexData, Primitives::Sphere::NumberOfTrianglesInSphere * 3);
-			rCurrentSceneObject.m_tLocalSpaceBoundingSphere = ConstructBoundingSphereFromVertexData(Primitives::Sphere::VertexData, Primitives::Sphere::NumberOfTrianglesInSphere * 3);
-			//rCurrentSceneObject.m_tLocalSpaceBoundingSphere = ConstructLocalSpaceBoundingSphereForSphere(rCurrentSceneObject);
-		}
-		else
-		{
-			assert(!"nothing here!");
-		}
+void CollisionDetection::ConstructBoundingVolumesForObject(SceneObject & rSceneObject)
+{
+	if (rSceneObject.m_eType == SceneObject::eType::CUBE)
+	{
+		rSceneObject.m_tLocalSpaceAABB = ConstructAABBFromVertexData(Primitives::Cube::VertexData, sizeof(Primitives::Cube::VertexData) / (sizeof(GLfloat) *  8u)); // 8 floats per vertex
+		//rSceneObject.m_tLocalSpaceBoundingSphere = ConstructBoundingSphereFromVertexData(Primitives::Cube::VertexData, sizeof(Primitives::Cube::IndexData) / sizeof(GLfloat));
+		rSceneObject.m_tLocalSpaceBoundingSphere = ConstructLocalSpaceBoundingSphereForCube(rSceneObject);
+
+	}
+	else if(rSceneObject.m_eType == SceneObject::eType::SPHERE)
+	{
+		rSceneObject.m_tLocalSpaceAABB = ConstructAABBFromVertexData(Primitives::Sphere::VertexData, Primitives::Sphere::NumberOfTrianglesInSphere * 3);
+		rSceneObject.m_tLocalSpaceBoundingSphere = ConstructBoundingSphereFromVertexData(Primitives::Sphere::VertexData, Primitives::Sphere::NumberOfTrianglesInSphere * 3);
+		//rSceneObject.m_tLocalSpaceBoundingSphere = ConstructLocalSpaceBoundingSphereForSphere(rSceneObject);
+	}
+	else
+	{
+		assert(!"nothing here!");
 	}
 }
 
 void CollisionDetection::UpdateBoundingVolumesForScene(Scene& rScene)
 {
 	for (SceneObject& rCurrentSceneObject : rScene.m_vecObjects)
-	{
-		const SceneObject::Transform& rCurrentObjectTransform = rCurrentSceneObject.m_tTransform;
+		UpdateBoundingVolumesForObject(rCurrentSceneObject);
+}
 
-		if (rCurrentObjectTransform.HasUniformScaling())
-		{
-			glm::mat4 mat4Transform = glm::mat4(1.0f); // identity
-			mat4Transform = glm::rotate(mat4Transform, glm::radians(rCurrentObjectTransform.m_tRotation.m_fAngle), rCurrentObjectTransform.m_tRotation.m_vec3Axis);
+void CollisionDetection::UpdateBoundingVolumesForObject(SceneObject & rSceneObject)
+{
+	const SceneObject::Transform& rObjectTransform = rSceneObject.m_tTransform;
 
-			rCurrentSceneObject.m_tWorldSpaceAABB = UpdateAABBFromAABB_UniformScaling(rCurrentSceneObject.m_tLocalSpaceAABB, mat4Transform, rCurrentObjectTransform.m_vec3Position, rCurrentObjectTransform.m_vec3Scale);
-		}
-		else
-		{
-			glm::mat4 mat4Transform = glm::mat4(1.0f); // identity
-			mat4Transform = glm::translate(mat4Transform, rCurrentObjectTransform.m_vec3Position);
-			mat4Transform = glm::rotate(mat4Transform, glm::radians(rCurrentObjectTransform.m_tRotation.m_fAngle), rCurrentObjectTransform.m_tRotation.m_vec3Axis);
-			mat4Transform = glm::scale(mat4Transform, rCurrentObjectTransform.m_vec3Scale);
+	if (rObjectTransform.HasUniformScaling())
+	{
+		glm::mat4 mat4Transform = glm::mat4(1.0f); // identity
+		mat4Transform = glm::rotate(mat4Transform, glm::radians(rObjectTransform.m_tRotation.m_fAngle), rObjectTransform.m_tRotation.m_vec3Axis);
 
-			rCurrentSceneObject.m_tWorldSpaceAABB = UpdateAABBFromAABB_NonUniformScaling(rCurrentSceneObject.m_tLocalSpaceAABB, mat4Transform);
-		}
-		
-		// updated Bounding Sphere
-		rCurrentSceneObject.m_tWorldSpaceBoundingSphere = UpdateBoundingSphere(rCurrentSceneObject.m_tLocalSpaceBoundingSphere, rCurrentObjectTransform.m_vec3Position, rCurrentObjectTransform.m_vec3Scale);
+		rSceneObject.m_tWorldSpaceAABB = UpdateAABBFromAABB_UniformScaling(rSceneObject.m_tLocalSpaceAABB, mat4Transform, rObjectTransform.m_vec3Position, rObjectTransform.m_vec3Scale);
+	}
+	else
+	{
+		glm::mat4 mat4Transform = glm::mat4(1.0f); // identity
+		mat4Transform = glm::translate(mat4Transform, rObjectTransform.m_vec3Position);
+		mat4Transform = glm::rotate(mat4Transform, glm::radians(rObjectTransform.m_tRotation.m_fAngle), rObjectTransform.m_tRotation.m_vec3Axis);
+		mat4Transform = glm::scale(mat4Transform, rObjectTransform.m_vec3Scale);
+
+		rSceneObject.m_tWorldSpaceAABB = UpdateAABBFromAABB_NonUniformScaling(rSceneObject.m_tLocalSpaceAABB, mat4Transform);
 	}
+	
+	// updated Bounding Sphere
+	rSceneObject.m_tWorldSpaceBoundingSphere = UpdateBoundingSphere(rSceneObject.m_tLocalSpaceBoundingSphere, rObjectTransform.m_vec3Position, rObjectTransform.m_vec3Scale);
+
+	// not moved through UpdateSweptBoundingVolumesForObject: no motion to enclose
+	rSceneObject.m_tSweptWorldSpaceAABB = rSceneObject.m_tWorldSpaceAABB;
+}
+
+void CollisionDetection::UpdateSweptBoundingVolumesForObject(SceneObject & rSceneObject, const AABB & rPreviousWorldSpaceAABB)
+{
+	UpdateBoundingVolumesForObject(rSceneObject);
+	rSceneObject.m_tSweptWorldSpaceAABB = MergeTwoAABBs(rPreviousWorldSpaceAABB, rSceneObject.m_tWorldSpaceAABB);
 }
 
 int CollisionDetection::StaticTestAABBagainstAABB(const AABB & rAABB, const AABB & rOtherAABB)
@@ -269,21 +839,55 @@ int CollisionDetection::StaticTestAABBagainstAABB(const AABB & rAABB, const AABB
 	return 1;
 }
 
-AABB CollisionDetection::CreateAABBForMultipleObjects(const SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+int CollisionDetection::StaticTestBoundingSphereagainstBoundingSphere(const BoundingSphere & rBoundingSphere, const BoundingSphere & rOtherBoundingSphere)
 {
-	AABB tResult;
+	const glm::vec3 vec3CenterToCenter = rOtherBoundingSphere.m_vec3Center - rBoundingSphere.m_vec3Center;
+	const float fRadiusSum = rBoundingSphere.m_fRadius + rOtherBoundingSphere.m_fRadius;
+	return (glm::dot(vec3CenterToCenter, vec3CenterToCenter) <= fRadiusSum * fRadiusSum) ? 1 : 0;
+}
 
-	// initializing min values to max and vice versa for definitive overwriting for the first vertex
-	float fXMin = std::numeric_limits<float>::max();
-	float fXMax = std::numeric_limits<float>::lowest();
-	float fYMin = std::numeric_limits<float>::max();
+Frustum CollisionDetection::CreateFrustum(const glm::mat4 & rProjectionCamera)
+{
+	// each plane is the sum or difference of the matrix' last row and one of the others (Gribb and Hartmann). glm stores columns, so the rows are gathered first
+	glm::vec4 pRows[4];
+	for (glm::mat4::length_type iCurrentRow = 0; iCurrentRow < 4; iCurrentRow++)
+		pRows[iCurrentRow] = glm::vec4(rProjectionCamera[0][iCurrentRow], rProjectionCamera[1][iCurrentRow], rProjectionCamera[2][iCurrentRow], rProjectionCamera[3][iCurrentRow]);
+
+	Frustum tResult;
+	for (int iCurrentAxis = 0; iCurrentAxis < 3; iCurrentAxis++)
+	{
+		tResult.m_pPlanes[2 * iCurrentAxis] = pRows[3] + pRows[iCurrentAxis];
+		tResult.m_pPlanes[2 * iCurrentAxis + 1] = pRows[3] - pRows[iCurrentAxis];
+	}
+
+	// normalized, so the planes yield actual distances
+	for (glm::vec4& rCurrentPlane : tResult.m_pPlanes)
+		rCurrentPlane /= glm::length(glm::vec3(rCurrentPlane));
+
+	return tResult;
+}
+
+int CollisionDetection::StaticTestAABBagainstFrustum(const AABB & rAABB, const Frustum & rFrustum)
+{
+	uint32_t uiPlaneMask = s_uiAllFrustumPlanesMask;
+	return TestMinMaxBoxagainstFrustumPlanes(rAABB.m_vec3Center - rAABB.m_vec3Radius, rAABB.m_vec3Center + rAABB.m_vec3Radius, rFrustum, uiPlaneMask);
+}
+
+AABB CollisionDetection::CreateAABBForMultipleObjects(const SceneObject * pSceneObjects, const ObjectReference * pObjectReferences, size_t uiNumObjectReferences)
+{
+	AABB tResult;
+
+	// initializing min values to max and vice versa for definitive overwriting for the first vertex
+	float fXMin = std::numeric_limits<float>::max();
+	float fXMax = std::numeric_limits<float>::lowest();
+	float fYMin = std::numeric_limits<float>::max();
 	float fYMax = std::numeric_limits<float>::lowest();
 	float fZMin = std::numeric_limits<float>::max();
 	float fZMax = std::numeric_limits<float>::lowest();
 
-	for (size_t uiCurrentSceneObjectIndex = 0u; uiCurrentSceneObjectIndex < uiNumSceneObjects; uiCurrentSceneObjectIndex++)
+	for (size_t uiCurrentObjectReference = 0u; uiCurrentObjectReference < uiNumObjectReferences; uiCurrentObjectReference++)
 	{
-		const SceneObject& rCurrentObject = pSceneObjects[uiCurrentSceneObjectIndex];
+		const SceneObject& rCurrentObject = pSceneObjects[pObjectReferences[uiCurrentObjectReference].m_uiObjectIndex];
 		assert(glm::length(rCurrentObject.m_tWorldSpaceAABB.m_vec3Radius) > 0.0f);	// make sure AABB of current object has already been constructed
 
 		// get extent of current AABB
@@ -354,18 +958,18 @@ AABB CollisionDetection::MergeTwoAABBs(const AABB & rAABB1, const AABB & rAABB2)
 	return tResult;
 }
 
-BoundingSphere CollisionDetection::CreateBoundingSphereForMultipleObjects(const SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+BoundingSphere CollisionDetection::CreateBoundingSphereForMultipleObjects(const SceneObject * pSceneObjects, const ObjectReference * pObjectReferences, size_t uiNumObjectReferences)
 {
-	assert(uiNumSceneObjects >= 2u); // if 1 or less, some error occurred
-	assert(pSceneObjects[0].m_tWorldSpaceBoundingSphere.m_fRadius > 0.0f);
+	assert(uiNumObjectReferences >= 2u); // if 1 or less, some error occurred
+	assert(pSceneObjects[pObjectReferences[0].m_uiObjectIndex].m_tWorldSpaceBoundingSphere.m_fRadius > 0.0f);
 
 	// initiliazing result with first object
-	BoundingSphere tResult = pSceneObjects[0].m_tWorldSpaceBoundingSphere;
+	BoundingSphere tResult = pSceneObjects[pObjectReferences[0].m_uiObjectIndex].m_tWorldSpaceBoundingSphere;
 
 	// for every FOLLOWING object (its bounding sphere specifically) ...
-	for (size_t uiCurrentObjectToBeEncompassed = 1u; uiCurrentObjectToBeEncompassed < uiNumSceneObjects; uiCurrentObjectToBeEncompassed++)
+	for (size_t uiCurrentObjectToBeEncompassed = 1u; uiCurrentObjectToBeEncompassed < uiNumObjectReferences; uiCurrentObjectToBeEncompassed++)
 	{
-		const BoundingSphere& rCurrentOtherBoundingSphere = pSceneObjects[uiCurrentObjectToBeEncompassed].m_tWorldSpaceBoundingSphere;
+		const BoundingSphere& rCurrentOtherBoundingSphere = pSceneObjects[pObjectReferences[uiCurrentObjectToBeEncompassed].m_uiObjectIndex].m_tWorldSpaceBoundingSphere;
 		assert(rCurrentOtherBoundingSphere.m_fRadius > 0.0f);
 
 		// we determine the distance vector to encompassed sphere from result sphere
@@ -396,6 +1000,12 @@ BoundingSphere CollisionDetection::MergeTwoBoundingSpheres(const BoundingSphere
 
 	// we determine the distance vector to encompassed sphere from result sphere
 	const glm::vec3 vec3CenterPointsDistance = rBoundingSphere2.m_vec3Center - tResult.m_vec3Center;
+	// growing towards the most distant point only works if neither sphere encloses the other already. This includes concentric spheres
+	const float fCenterPointsDistance = glm::length(vec3CenterPointsDistance);
+	if (fCenterPointsDistance + rBoundingSphere2.m_fRadius <= rBoundingSphere1.m_fRadius)
+		return rBoundingSphere1;
+	if (fCenterPointsDistance + rBoundingSphere1.m_fRadius <= rBoundingSphere2.m_fRadius)
+		return rBoundingSphere2;
 	// we construct the normalized direction of the distance ...
 	const glm::vec3 vec3NormalizedCenterPointsDirection = glm::normalize(vec3CenterPointsDistance);
 	// ...  to then scale it by the encompassed sphere's radius, resulting in a "directed" radius
@@ -412,318 +1022,391 @@ BoundingSphere CollisionDetection::MergeTwoBoundingSpheres(const BoundingSphere
 	//////////////////////////BVH/////////////////////////////////
 	//////////////////////////////////////////////////////////////
 
-void CollisionDetection::BoundingVolumeHierarchy::DeleteTree()
+constexpr size_t CollisionDetection::BVHTreeNodeArena::s_uiMinNumNodesPerBlock;
+
+BVHTreeNode * CollisionDetection::BVHTreeNodeArena::AllocateNode()
 {
-	RecursiveDeleteTree(m_pRootNode);
-	delete m_pRootNode;
-	m_pRootNode = nullptr;
+	return AllocateNodes(1u);
 }
 
-void CollisionDetection::BoundingVolumeHierarchy::RecursiveDeleteTree(BVHTreeNode * pNode)
+BVHTreeNode * CollisionDetection::BVHTreeNodeArena::AllocateNodes(size_t uiNumNodes)
 {
-	if (pNode == nullptr)
-		return;
+	assert(uiNumNodes > 0u);
 
-	if (pNode->m_pLeft)
+	// skipping blocks from previous constructions that are too small for the requested nodes
+	while (m_uiCurrentBlock < m_vecBlocks.size() && m_uiNumUsedNodesInCurrentBlock + uiNumNodes > m_vecBlocks[m_uiCurrentBlock].m_uiNumNodes)
 	{
-		RecursiveDeleteTree(pNode->m_pLeft);
+		m_uiCurrentBlock++;
+		m_uiNumUsedNodesInCurrentBlock = 0u;
 	}
 
-	if (pNode->m_pRight)
+	// only allocate new memory if every block from previous constructions is used up. Fresh nodes are constructed already
+	const bool bIsNewBlock = (m_uiCurrentBlock == m_vecBlocks.size());
+	if (bIsNewBlock)
 	{
-		RecursiveDeleteTree(pNode->m_pRight);
+		Block tNewBlock;
+		tNewBlock.m_uiNumNodes = std::max(s_uiMinNumNodesPerBlock, uiNumNodes);
+		tNewBlock.m_pNodes.reset(new BVHTreeNode[tNewBlock.m_uiNumNodes]);
+		m_vecBlocks.push_back(std::move(tNewBlock));
 	}
 
-	delete pNode->m_pLeft;
-	pNode->m_pLeft = nullptr;
-	delete pNode->m_pRight;
-	pNode->m_pRight = nullptr;
+	BVHTreeNode* pNewNodes = m_vecBlocks[m_uiCurrentBlock].m_pNodes.get() + m_uiNumUsedNodesInCurrentBlock;
+	if (!bIsNewBlock)
+		std::fill(pNewNodes, pNewNodes + uiNumNodes, BVHTreeNode());	// the nodes are left over from a previous construction
+	m_uiNumUsedNodesInCurrentBlock += uiNumNodes;
+
+	m_uiNumAllocatedNodes += uiNumNodes;
+	m_uiPeakNumAllocatedNodes = std::max(m_uiPeakNumAllocatedNodes, m_uiNumAllocatedNodes);
+
+	return pNewNodes;
 }
 
-//////////////////////////////////////////
-// RAY CASTING
-//////////////////////////////////////////
+void CollisionDetection::BVHTreeNodeArena::Reset()
+{
+	m_uiCurrentBlock = 0u;
+	m_uiNumUsedNodesInCurrentBlock = 0u;
+	m_uiNumAllocatedNodes = 0u;
+}
 
-size_t CollisionDetection::PartitionSceneObjectsInPlace_AABB(SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+size_t CollisionDetection::BVHTreeNodeArena::GetNumReservedBytes() const
 {
-	assert(pSceneObjects);
-	assert(uiNumSceneObjects > 0u);
-	/*
-		an explanation:
-		This function:
-		1. decides the splitting axis
-		2. then the splitting point
-		3. then partitions the given scene objects
-	*/
+	size_t uiNumReservedNodes = 0u;
+	for (const Block& rCurrentBlock : m_vecBlocks)
+		uiNumReservedNodes += rCurrentBlock.m_uiNumNodes;
 
-	// 1. Finding the splitting axis
-	// 1.1. Finding the axis with the longest extent
+	return uiNumReservedNodes * sizeof(BVHTreeNode);
+}
 
-	// initializing with values that will definitely be overwritten
-	float fXMaxExtent = std::numeric_limits<float>::lowest();
-	float fXMinExtent = std::numeric_limits<float>::max();
-	float fYMaxExtent = std::numeric_limits<float>::lowest();
-	float fYMinExtent = std::numeric_limits<float>::max();
-	float fZMaxExtent = std::numeric_limits<float>::lowest();
-	float fZMinExtent = std::numeric_limits<float>::max();
+BVHTreeNode * CollisionDetection::BoundingVolumeHierarchy::AllocateNode()
+{
+	return m_tNodeArena.AllocateNode();
+}
 
-	// finding min and max extents for every axis
-	for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
-	{
-		const SceneObject& rCurrentSceneObject = pSceneObjects[uiCurrentSceneObject];
+BVHTreeNode * CollisionDetection::BoundingVolumeHierarchy::AllocateNodes(size_t uiNumNodes)
+{
+	return m_tNodeArena.AllocateNodes(uiNumNodes);
+}
 
-		fXMaxExtent = std::max(fXMaxExtent, rCurrentSceneObject.m_tWorldSpaceAABB.CalcMaximumX());
-		fYMaxExtent = std::max(fYMaxExtent, rCurrentSceneObject.m_tWorldSpaceAABB.CalcMaximumY());
-		fZMaxExtent = std::max(fZMaxExtent, rCurrentSceneObject.m_tWorldSpaceAABB.CalcMaximumZ());
+void CollisionDetection::BoundingVolumeHierarchy::DeleteTree()
+{
+	m_tNodeArena.Reset();
+	m_pRootNode = nullptr;
+	m_vecObjectPermutation.clear();
+	m_iTDeepestDepthOfNodes = 0;
+	m_vecLeafOfObject.clear();
+	m_fNodeSurfaceAreaAfterConstruction = 0.0f;
+	m_fNodeSurfaceArea = 0.0f;
+}
 
-		fXMinExtent = std::min(fXMinExtent, rCurrentSceneObject.m_tWorldSpaceAABB.CalcMinimumX());
-		fYMinExtent = std::min(fYMinExtent, rCurrentSceneObject.m_tWorldSpaceAABB.CalcMinimumY());
-		fZMinExtent = std::min(fZMinExtent, rCurrentSceneObject.m_tWorldSpaceAABB.CalcMinimumZ());
-	}
+float CollisionDetection::BoundingVolumeHierarchy::CalcRefitDegradation() const
+{
+	// a tree consisting of a single leaf cannot degrade
+	if (m_fNodeSurfaceAreaAfterConstruction <= 0.0f)
+		return 1.0f;
 
-	// Getting the longest extent of the 3 axes
-	const float fXTotalExtent = fXMaxExtent - fXMinExtent;
-	const float fYTotalExtent = fYMaxExtent - fYMinExtent;
-	const float fZTotalExtent = fZMaxExtent - fZMinExtent;
+	return m_fNodeSurfaceArea / m_fNodeSurfaceAreaAfterConstruction;
+}
 
-	// """sorting""" the axes by their extents
-	const int iNumSplittingAxes = 3;
-	const int x = 0, y = 1, z = 2;
-	int iSplittingAxes[iNumSplittingAxes];
-	iSplittingAxes[0] = x;
+LinearBVH CollisionDetection::CreateLinearBVH(const BoundingVolumeHierarchy & rBVH)
+{
+	LinearBVH tResult;
 
-	if (fYTotalExtent > fXTotalExtent && fYTotalExtent > fZTotalExtent)
-		iSplittingAxes[0] = y;
+	if (rBVH.m_pRootNode == nullptr)
+		return tResult;
 
-	if (fZTotalExtent > fXTotalExtent && fZTotalExtent > fYTotalExtent)
-		iSplittingAxes[0] = z;
+	// a binary tree with n leaves has 2n - 1 nodes, and there are at most as many leaves as objects
+	tResult.m_vecNodes.reserve(2u * rBVH.m_vecObjectPermutation.size());
+	RecursiveFlattenBVHTree(rBVH.m_pRootNode, rBVH.m_vecObjectPermutation, tResult.m_vecNodes);
 
-	// first axis now stores the index of the longest axis in the 3 dimensional coordinate vector
-	// now for the other two
-	iSplittingAxes[1] = y;
-	iSplittingAxes[2] = z;
-	if (fZTotalExtent > fYTotalExtent)
-		std::swap(iSplittingAxes[1], iSplittingAxes[2]);
+	// leaves keep their object ranges, so the permutation can be taken as it is
+	tResult.m_vecObjectPermutation = rBVH.m_vecObjectPermutation;
 
-	// Next step: try to partition objects along the longest axis, if that doesn't work (all objects in one child), try next best
+	return tResult;
+}
 
-	size_t uiNumLeftChildren = uiNumSceneObjects; // intentionally initiliazed to an invalid index for when every axis fails
-	SceneObject* pCopiedArray = new SceneObject[uiNumSceneObjects];
-	for (int iCurrentSplittingAxisIndex = 0; iCurrentSplittingAxisIndex < iNumSplittingAxes; iCurrentSplittingAxisIndex++)
-	{
-		// 2. Finding the splitting point on the current axis
-		// done by using the object mean (mean of the object centroids)
+BVH4 CollisionDetection::CreateBVH4(const BoundingVolumeHierarchy & rBVH)
+{
+	return CreateWideBVH<4>(rBVH);
+}
 
-		float fObjectCentroidsMean = 0.0f;
-		const float fPreDivisionFactor = 1.0f / static_cast<float>(uiNumSceneObjects);
-		const int iCurrentSplittingAxis = iSplittingAxes[iCurrentSplittingAxisIndex];
+BVH8 CollisionDetection::CreateBVH8(const BoundingVolumeHierarchy & rBVH)
+{
+	return CreateWideBVH<8>(rBVH);
+}
 
-		// iterate over all scene objects and determine the mean by accumulating equally weighted coordinates of the splitting axis
-		for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
-		{
-			const glm::vec3& rCurrentSceneObjectCenter = pSceneObjects[uiCurrentSceneObject].m_tWorldSpaceAABB.m_vec3Center;
-			fObjectCentroidsMean += rCurrentSceneObjectCenter[iCurrentSplittingAxis] * fPreDivisionFactor;
-		}
+constexpr int CollisionDetection::KDTree::s_iMaxDepthLimit;
 
-		// 3. partitioning the scene objects:				
+KDTree CollisionDetection::ConstructKDTree(SceneObject * pSceneObjects, size_t uiNumSceneObjects, const KDTreeParameters & rParameters)
+{
+	assert(pSceneObjects || uiNumSceneObjects == 0u);
+	assert(uiNumSceneObjects <= std::numeric_limits<uint32_t>::max());
+	assert(rParameters.m_fEmptyBonus >= 0.0f && rParameters.m_fEmptyBonus <= 1.0f);
 
-		// two passes: one for determination of bucket sizes, the second for sorting into buckets
-		// first pass
-		const size_t uiNumBuckets = 2u;
-		size_t uiNumElementsPerBucket[uiNumBuckets] = { 0u };
-		for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
-		{
-			// will be true == 1 for right bucket and false == 0 for left bucket throught implicit type conversion
-			const size_t uiBucketIndex = (pSceneObjects[uiCurrentSceneObject].m_tWorldSpaceAABB.m_vec3Center[iCurrentSplittingAxis] >= fObjectCentroidsMean);
-			uiNumElementsPerBucket[uiBucketIndex]++;
-		}
+	KDTree tResult;
+	tResult.m_vec3Min = glm::vec3(0.0f);
+	tResult.m_vec3Max = glm::vec3(0.0f);
+
+	if (uiNumSceneObjects == 0u)
+		return tResult;
 
-		assert((uiNumElementsPerBucket[0] + uiNumElementsPerBucket[1]) == uiNumSceneObjects);
+	// the root's cell encloses all objects
+	tResult.m_vec3Min = glm::vec3(std::numeric_limits<float>::max());
+	tResult.m_vec3Max = glm::vec3(std::numeric_limits<float>::lowest());
+	std::vector<uint32_t> vecObjectIndices(uiNumSceneObjects);
+	for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
+	{
+		const AABB& rCurrentAABB = pSceneObjects[uiCurrentSceneObject].m_tWorldSpaceAABB;
+		tResult.m_vec3Min = glm::min(tResult.m_vec3Min, rCurrentAABB.m_vec3Center - rCurrentAABB.m_vec3Radius);
+		tResult.m_vec3Max = glm::max(tResult.m_vec3Max, rCurrentAABB.m_vec3Center + rCurrentAABB.m_vec3Radius);
+		vecObjectIndices[uiCurrentSceneObject] = static_cast<uint32_t>(uiCurrentSceneObject);
+	}
 
-		// second pass
-		size_t uiBucketInsertionIndices[uiNumBuckets];
-		uiBucketInsertionIndices[0u] = 0u;
-		uiBucketInsertionIndices[1u] = uiNumElementsPerBucket[0u];
+	int iMaxDepth = rParameters.m_iMaxDepth;
+	if (iMaxDepth <= 0)
+		iMaxDepth = static_cast<int>(std::round(8.0f + 1.3f * std::log2(static_cast<float>(uiNumSceneObjects))));
+	iMaxDepth = std::min(iMaxDepth, KDTree::s_iMaxDepthLimit);
 
-		for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
-		{
-			// will be true == 1 for right bucket and false == 0 for left bucket throught implicit type conversion
-			const size_t uiBucketIndex = (pSceneObjects[uiCurrentSceneObject].m_tWorldSpaceAABB.m_vec3Center[iCurrentSplittingAxis] >= fObjectCentroidsMean);
-			const size_t uiInsertionIndex = uiBucketInsertionIndices[uiBucketIndex]++;
-			pCopiedArray[uiInsertionIndex] = pSceneObjects[uiCurrentSceneObject];
-		}
+	KDTreeConstruction tConstruction;
+	tConstruction.m_pKDTree = &tResult;
+	tConstruction.m_pSceneObjects = pSceneObjects;
+	tConstruction.m_pParameters = &rParameters;
+	for (int iCurrentAxis = 0; iCurrentAxis < 3; iCurrentAxis++)
+		tConstruction.m_pEdges[iCurrentAxis].reserve(2u * uiNumSceneObjects);
 
-		memcpy(pSceneObjects, pCopiedArray, uiNumSceneObjects * sizeof(SceneObject));
+	RecursiveConstructKDTreeNode(tConstruction, vecObjectIndices, tResult.m_vec3Min, tResult.m_vec3Max, iMaxDepth, 0);
 
+	return tResult;
+}
 
-		if (uiNumElementsPerBucket[0] > 0 && uiNumElementsPerBucket[1] > 0) // if the objects were actually partitioned
-		{
-			uiNumLeftChildren = uiNumElementsPerBucket[0]; // number of left children = partitioning index
-			break;	// no need to consider the other axes
-		}
+//////////////////////////////////////////
+// RAY CASTING
+//////////////////////////////////////////
+
+std::vector<ObjectReference> CollisionDetection::CreateObjectReferences(const SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+{
+	assert(pSceneObjects);
+	assert(uiNumSceneObjects <= std::numeric_limits<uint32_t>::max());
+
+	std::vector<ObjectReference> vecResult;
+	vecResult.reserve(uiNumSceneObjects);
+
+	for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
+	{
+		ObjectReference tNewObjectReference;
+		tNewObjectReference.m_vec3Centroid = pSceneObjects[uiCurrentSceneObject].m_tWorldSpaceAABB.m_vec3Center;
+		tNewObjectReference.m_uiObjectIndex = static_cast<uint32_t>(uiCurrentSceneObject);
+		vecResult.push_back(tNewObjectReference);
 	}
 
-	delete[] pCopiedArray;
+	return vecResult;
+}
 
-	/*
-		Now, there is still one edge case left: what if one were to add two identical objects to the tree?
-		identical = their two bounding volumes are identical.
-		There is no proper way to partition these objects, but they have to be partitioned. Otherwise,
-		tree construction would endlessly try to partition them in the "next" child.
-		Solution: just partition them "randomly" -> equal number of both objects on both sides
-	*/
+std::vector<SceneObject*> CollisionDetection::CreateObjectPermutation(SceneObject * pSceneObjects, const std::vector<ObjectReference>& rvecObjectReferences)
+{
+	assert(pSceneObjects);
 
-	if (uiNumLeftChildren == uiNumSceneObjects) // the invalid index from before partitioning was attempted
-		uiNumLeftChildren = uiNumSceneObjects / 2u;	// partition all identical objects evenly
+	std::vector<SceneObject*> vecResult;
+	vecResult.reserve(rvecObjectReferences.size());
 
-	/*
-		another note: since the objects were "fake" sorted already anyway, no need to sort them again.
-		It doesn't matter if they would have been all left or all right, they are still identical and sorted.
-	*/
+	for (const ObjectReference& rCurrentObjectReference : rvecObjectReferences)
+		vecResult.push_back(pSceneObjects + rCurrentObjectReference.m_uiObjectIndex);
 
-	return uiNumLeftChildren;
+	return vecResult;
+}
+
+size_t CollisionDetection::PartitionObjectReferencesInPlace_AABB(const SceneObject * pSceneObjects, ObjectReference * pObjectReferences, size_t uiNumObjectReferences)
+{
+	return PartitionObjectReferencesAtObjectMean(pSceneObjects, pObjectReferences, uiNumObjectReferences, &SceneObject::m_tWorldSpaceAABB, nullptr);
+}
+
+size_t CollisionDetection::PartitionObjectReferencesInPlace_BoundingSphere(const SceneObject * pSceneObjects, ObjectReference * pObjectReferences, size_t uiNumObjectReferences)
+{
+	return PartitionObjectReferencesAtObjectMean(pSceneObjects, pObjectReferences, uiNumObjectReferences, &SceneObject::m_tWorldSpaceBoundingSphere, nullptr);
+}
+
+size_t CollisionDetection::PartitionObjectReferencesInPlace_AABB(const SceneObject * pSceneObjects, ObjectReference * pObjectReferences, size_t uiNumObjectReferences, TaskPool & rTaskPool)
+{
+	return PartitionObjectReferencesAtObjectMean(pSceneObjects, pObjectReferences, uiNumObjectReferences, &SceneObject::m_tWorldSpaceAABB, &rTaskPool);
 }
 
-size_t CollisionDetection::PartitionSceneObjectsInPlace_BoundingSphere(SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+size_t CollisionDetection::PartitionObjectReferencesInPlace_BoundingSphere(const SceneObject * pSceneObjects, ObjectReference * pObjectReferences, size_t uiNumObjectReferences, TaskPool & rTaskPool)
+{
+	return PartitionObjectReferencesAtObjectMean(pSceneObjects, pObjectReferences, uiNumObjectReferences, &SceneObject::m_tWorldSpaceBoundingSphere, &rTaskPool);
+}
+
+size_t CollisionDetection::PartitionObjectReferencesInPlace_SAH(const SceneObject * pSceneObjects, ObjectReference * pObjectReferences, size_t uiNumObjectReferences, const SAHParameters & rParameters)
 {
 	assert(pSceneObjects);
-	assert(uiNumSceneObjects > 0u);
+	assert(pObjectReferences);
+	assert(uiNumObjectReferences > 0u);
+	assert(rParameters.m_uiNumBins >= 2u);
 	/*
 		an explanation:
 		This function:
-		1. decides the splitting axis
-		2. then the splitting point
-		3. then partitions the given scene objects
+		1. determines the extent of the object centroids, which is the space that is divided into bins
+		2. sorts the objects into bins, for every axis
+		3. evaluates the SAH cost of splitting at every boundary between two neighbouring bins
+		4. compares the cheapest split against the cost of not splitting at all, i.e. creating a leaf
+		5. partitions the given object references according to the cheapest split
 	*/
 
-	// 1. Finding the splitting axis
-	// 1.1. Finding the axis with the longest extent
-
-	// initializing with values that will definitely be overwritten
-	float fXMaxExtent = std::numeric_limits<float>::lowest();
-	float fXMinExtent = std::numeric_limits<float>::max();
-	float fYMaxExtent = std::numeric_limits<float>::lowest();
-	float fYMinExtent = std::numeric_limits<float>::max();
-	float fZMaxExtent = std::numeric_limits<float>::lowest();
-	float fZMinExtent = std::numeric_limits<float>::max();
-
-	// finding min and max extents for every axis
-	for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
+	// 1. extents of the object centroids and bounds of all objects
+	glm::vec3 vec3CentroidMin(std::numeric_limits<float>::max());
+	glm::vec3 vec3CentroidMax(std::numeric_limits<float>::lowest());
+	SAHBin tParentBounds;
+	for (size_t uiCurrentObjectReference = 0u; uiCurrentObjectReference < uiNumObjectReferences; uiCurrentObjectReference++)
 	{
-		const SceneObject& rCurrentSceneObject = pSceneObjects[uiCurrentSceneObject];
-
-		fXMaxExtent = std::max(fXMaxExtent, rCurrentSceneObject.m_tWorldSpaceBoundingSphere.CalcMaximumX());
-		fYMaxExtent = std::max(fYMaxExtent, rCurrentSceneObject.m_tWorldSpaceBoundingSphere.CalcMaximumY());
-		fZMaxExtent = std::max(fZMaxExtent, rCurrentSceneObject.m_tWorldSpaceBoundingSphere.CalcMaximumZ());
+		const AABB& rCurrentAABB = pSceneObjects[pObjectReferences[uiCurrentObjectReference].m_uiObjectIndex].m_tWorldSpaceAABB;
 
-		fXMinExtent = std::min(fXMinExtent, rCurrentSceneObject.m_tWorldSpaceBoundingSphere.CalcMinimumX());
-		fYMinExtent = std::min(fYMinExtent, rCurrentSceneObject.m_tWorldSpaceBoundingSphere.CalcMinimumY());
-		fZMinExtent = std::min(fZMinExtent, rCurrentSceneObject.m_tWorldSpaceBoundingSphere.CalcMinimumZ());
+		vec3CentroidMin = glm::min(vec3CentroidMin, rCurrentAABB.m_vec3Center);
+		vec3CentroidMax = glm::max(vec3CentroidMax, rCurrentAABB.m_vec3Center);
+		GrowSAHBinByAABB(tParentBounds, rCurrentAABB);
 	}
 
-	// Getting the longest extent of the 3 axes
-	const float fXTotalExtent = fXMaxExtent - fXMinExtent;
-	const float fYTotalExtent = fYMaxExtent - fYMinExtent;
-	const float fZTotalExtent = fZMaxExtent - fZMinExtent;
+	const float fParentSurfaceArea = CalcSurfaceAreaOfExtents(tParentBounds.m_vec3Min, tParentBounds.m_vec3Max);
+	const float fInverseParentSurfaceArea = (fParentSurfaceArea > 0.0f) ? (1.0f / fParentSurfaceArea) : 1.0f;
+	const float fLeafCost = static_cast<float>(uiNumObjectReferences) * rParameters.m_fObjectIntersectionCost;
 
-	// """sorting""" the axes by their extents
-	const int iNumSplittingAxes = 3;
-	const int x = 0, y = 1, z = 2;
-	int iSplittingAxes[iNumSplittingAxes];
-	iSplittingAxes[0] = x;
+	// 2. & 3. binning and evaluating all bin boundaries on all three axes
+	const size_t uiNumBins = rParameters.m_uiNumBins;
+	std::vector<SAHBin> vecBins(uiNumBins);
+	std::vector<float> vecRightSideWeightedAreas(uiNumBins);	// surface area * number of objects of everything right of a bin boundary
+	std::vector<size_t> vecRightSideNumObjects(uiNumBins);
 
-	if (fYTotalExtent > fXTotalExtent && fYTotalExtent > fZTotalExtent)
-		iSplittingAxes[0] = y;
+	float fBestSplitCost = std::numeric_limits<float>::max();
+	int iBestSplitAxis = -1;		// intentionally initialized to an invalid axis for when no axis can be split
+	size_t uiBestSplitBin = 0u;		// objects in bins with a lower index than this go "left"
 
-	if (fZTotalExtent > fXTotalExtent && fZTotalExtent > fYTotalExtent)
-		iSplittingAxes[0] = z;
-
-	// first axis now stores the index of the longest axis in the 3 dimensional coordinate vector
-	// now for the other two
-	iSplittingAxes[1] = y;
-	iSplittingAxes[2] = z;
-	if (fZTotalExtent > fYTotalExtent)
-		std::swap(iSplittingAxes[1], iSplittingAxes[2]);
-
-	// Next step: try to partition objects along the longest axis, if that doesn't work (all objects in one child), try next best
-
-	size_t uiNumLeftChildren = uiNumSceneObjects; // intentionally initiliazed to an invalid index for when every partitioning axis fails
-	SceneObject* pCopiedArray = new SceneObject[uiNumSceneObjects];
-	for (int iCurrentSplittingAxisIndex = 0; iCurrentSplittingAxisIndex < iNumSplittingAxes; iCurrentSplittingAxisIndex++)
+	for (int iCurrentAxis = 0; iCurrentAxis < 3; iCurrentAxis++)
 	{
-		// 2. Finding the splitting point on the current axis
-		// done by using the object mean (mean of the object centroids)
+		const float fCentroidExtent = vec3CentroidMax[iCurrentAxis] - vec3CentroidMin[iCurrentAxis];
+		if (fCentroidExtent <= 0.0f)
+			continue;	// all centroids lie on the same plane orthogonal to this axis, there is nothing to split
 
-		float fObjectCentroidsMean = 0.0f;
-		const float fPreDivisionFactor = 1.0f / static_cast<float>(uiNumSceneObjects);
-		const int iCurrentSplittingAxis = iSplittingAxes[iCurrentSplittingAxisIndex];
+		const float fBinsPerUnit = static_cast<float>(uiNumBins) / fCentroidExtent;
 
-		// iterate over all scene objects and determine the mean by accumulating equally weighted coordinates of the splitting axis
-		for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
+		// sort every object into its bin
+		std::fill(vecBins.begin(), vecBins.end(), SAHBin());
+		for (size_t uiCurrentObjectReference = 0u; uiCurrentObjectReference < uiNumObjectReferences; uiCurrentObjectReference++)
 		{
-			const glm::vec3& rCurrentSceneObjectCenter = pSceneObjects[uiCurrentSceneObject].m_tWorldSpaceAABB.m_vec3Center;
-			fObjectCentroidsMean += rCurrentSceneObjectCenter[iCurrentSplittingAxis] * fPreDivisionFactor;
+			const ObjectReference& rCurrentObjectReference = pObjectReferences[uiCurrentObjectReference];
+			const AABB& rCurrentAABB = pSceneObjects[rCurrentObjectReference.m_uiObjectIndex].m_tWorldSpaceAABB;
+			const size_t uiBinIndex = CalcSAHBinIndex(rCurrentObjectReference.m_vec3Centroid[iCurrentAxis], vec3CentroidMin[iCurrentAxis], fBinsPerUnit, uiNumBins);
+			GrowSAHBinByAABB(vecBins[uiBinIndex], rCurrentAABB);
 		}
 
-		// 3. partitioning the scene objects:				
-
-		// two passes: one for determination of bucket sizes, the second for sorting into buckets
-		// first pass
-		const size_t uiNumBuckets = 2u;
-		size_t uiNumElementsPerBucket[uiNumBuckets] = { 0u };
-		for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
+		// sweeping from the right: accumulating everything right of every bin boundary
+		SAHBin tAccumulatedRightSide;
+		for (size_t uiCurrentBin = uiNumBins - 1u; uiCurrentBin > 0u; uiCurrentBin--)
 		{
-			// will be true == 1 for right bucket and false == 0 for left bucket throught implicit type conversion
-			const size_t uiBucketIndex = (pSceneObjects[uiCurrentSceneObject].m_tWorldSpaceAABB.m_vec3Center[iCurrentSplittingAxis] >= fObjectCentroidsMean);
-			uiNumElementsPerBucket[uiBucketIndex]++;
-		}
-
-		assert((uiNumElementsPerBucket[0] + uiNumElementsPerBucket[1]) == uiNumSceneObjects);
+			const SAHBin& rCurrentBin = vecBins[uiCurrentBin];
+			if (rCurrentBin.m_uiNumObjects > 0u)
+			{
+				tAccumulatedRightSide.m_vec3Min = glm::min(tAccumulatedRightSide.m_vec3Min, rCurrentBin.m_vec3Min);
+				tAccumulatedRightSide.m_vec3Max = glm::max(tAccumulatedRightSide.m_vec3Max, rCurrentBin.m_vec3Max);
+				tAccumulatedRightSide.m_uiNumObjects += rCurrentBin.m_uiNumObjects;
+			}
 
-		// second pass
-		size_t uiBucketInsertionIndices[uiNumBuckets];
-		uiBucketInsertionIndices[0u] = 0u;
-		uiBucketInsertionIndices[1u] = uiNumElementsPerBucket[0u];
+			vecRightSideNumObjects[uiCurrentBin] = tAccumulatedRightSide.m_uiNumObjects;
+			vecRightSideWeightedAreas[uiCurrentBin] = CalcSurfaceAreaOfExtents(tAccumulatedRightSide.m_vec3Min, tAccumulatedRightSide.m_vec3Max) * static_cast<float>(tAccumulatedRightSide.m_uiNumObjects);
+		}
 
-		for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
+		// sweeping from the left: now both sides of every bin boundary are known and the split can be evaluated
+		SAHBin tAccumulatedLeftSide;
+		for (size_t uiCurrentBoundary = 1u; uiCurrentBoundary < uiNumBins; uiCurrentBoundary++)
 		{
-			// will be true == 1 for right bucket and false == 0 for left bucket throught implicit type conversion
-			const size_t uiBucketIndex = (pSceneObjects[uiCurrentSceneObject].m_tWorldSpaceAABB.m_vec3Center[iCurrentSplittingAxis] >= fObjectCentroidsMean);
-			const size_t uiInsertionIndex = uiBucketInsertionIndices[uiBucketIndex]++;
-			pCopiedArray[uiInsertionIndex] = pSceneObjects[uiCurrentSceneObject];
-		}
+			const SAHBin& rBinLeftOfBoundary = vecBins[uiCurrentBoundary - 1u];
+			if (rBinLeftOfBoundary.m_uiNumObjects > 0u)
+			{
+				tAccumulatedLeftSide.m_vec3Min = glm::min(tAccumulatedLeftSide.m_vec3Min, rBinLeftOfBoundary.m_vec3Min);
+				tAccumulatedLeftSide.m_vec3Max = glm::max(tAccumulatedLeftSide.m_vec3Max, rBinLeftOfBoundary.m_vec3Max);
+				tAccumulatedLeftSide.m_uiNumObjects += rBinLeftOfBoundary.m_uiNumObjects;
+			}
 
-		memcpy(pSceneObjects, pCopiedArray, uiNumSceneObjects * sizeof(SceneObject));
+			// a split that leaves one side empty is no split at all
+			if (tAccumulatedLeftSide.m_uiNumObjects == 0u || vecRightSideNumObjects[uiCurrentBoundary] == 0u)
+				continue;
 
+			const float fLeftSideWeightedArea = CalcSurfaceAreaOfExtents(tAccumulatedLeftSide.m_vec3Min, tAccumulatedLeftSide.m_vec3Max) * static_cast<float>(tAccumulatedLeftSide.m_uiNumObjects);
+			const float fSplitCost = rParameters.m_fNodeTraversalCost + (fLeftSideWeightedArea + vecRightSideWeightedAreas[uiCurrentBoundary]) * fInverseParentSurfaceArea * rParameters.m_fObjectIntersectionCost;
 
-		if (uiNumElementsPerBucket[0] > 0 && uiNumElementsPerBucket[1] > 0) // if the objects were actually partitioned
-		{
-			uiNumLeftChildren = uiNumElementsPerBucket[0]; // number of left children = partitioning index
-			break;	// no need to consider the other axes
+			if (fSplitCost < fBestSplitCost)
+			{
+				fBestSplitCost = fSplitCost;
+				iBestSplitAxis = iCurrentAxis;
+				uiBestSplitBin = uiCurrentBoundary;
+			}
 		}
 	}
 
-	delete[] pCopiedArray;
+	// 4. would a leaf be cheaper?
+	const bool bIsLeafAllowed = (uiNumObjectReferences <= rParameters.m_uiMaxObjectsPerLeaf);
+	if (bIsLeafAllowed && (iBestSplitAxis == -1 || fLeafCost <= fBestSplitCost))
+		return 0u;
 
 	/*
-		Now, there is still one edge case left: what if one were to add two identical objects to the tree?
-		identical = their two bounding volumes are identical.
-		There is no proper way to partition these objects, but they have to be partitioned. Otherwise,
-		tree construction would endlessly try to partition them in the "next" child.
-		Solution: just partition them "randomly" -> equal number of both objects on both sides
+		Same edge case as for the object mean partitioning: every centroid is identical, so no bin boundary separates anything.
+		These objects still have to be partitioned, so they are split evenly.
 	*/
+	if (iBestSplitAxis == -1)
+		return uiNumObjectReferences / 2u;
 
-	if (uiNumLeftChildren == uiNumSceneObjects) // the invalid index from before partitioning was attempted
-		uiNumLeftChildren = uiNumSceneObjects / 2u;	// partition all identical objects evenly
+	// 5. partitioning the object references according to the best split
+	const float fBestAxisBinsPerUnit = static_cast<float>(uiNumBins) / (vec3CentroidMax[iBestSplitAxis] - vec3CentroidMin[iBestSplitAxis]);
+	const ObjectReference* pFirstRightSideObjectReference = std::partition(pObjectReferences, pObjectReferences + uiNumObjectReferences, [&](const ObjectReference& rObjectReference) {
+		return CalcSAHBinIndex(rObjectReference.m_vec3Centroid[iBestSplitAxis], vec3CentroidMin[iBestSplitAxis], fBestAxisBinsPerUnit, uiNumBins) < uiBestSplitBin;
+	});
 
-	/*
-		another note: since the objects were "fake" sorted already anyway, no need to sort them again.
-		It doesn't matter if they would have been all left or all right, they are still identical and sorted.
-	*/
+	const size_t uiNumLeftChildren = static_cast<size_t>(pFirstRightSideObjectReference - pObjectReferences);
+	assert(uiNumLeftChildren > 0u && uiNumLeftChildren < uiNumObjectReferences);
 
 	return uiNumLeftChildren;
 }
 
+bool CollisionDetection::IsLeafCheaperThanSplit_AABB(const SceneObject * pSceneObjects, const ObjectReference * pObjectReferences, size_t uiNumObjectReferences, size_t uiNumLeftObjectReferences, const ObjectMeanLeafParameters & rParameters)
+{
+	assert(pSceneObjects);
+	assert(pObjectReferences);
+	assert(uiNumLeftObjectReferences > 0u && uiNumLeftObjectReferences < uiNumObjectReferences);
+
+	const size_t uiNumRightObjectReferences = uiNumObjectReferences - uiNumLeftObjectReferences;
+
+	const float fParentSurfaceArea = CalcSurfaceAreaOfObjects_AABB(pSceneObjects, pObjectReferences, uiNumObjectReferences);
+	if (fParentSurfaceArea <= 0.0f) // degenerated set, nothing to gain from splitting it
+		return true;
+
+	const float fLeftSurfaceArea = CalcSurfaceAreaOfObjects_AABB(pSceneObjects, pObjectReferences, uiNumLeftObjectReferences);
+	const float fRightSurfaceArea = CalcSurfaceAreaOfObjects_AABB(pSceneObjects, pObjectReferences + uiNumLeftObjectReferences, uiNumRightObjectReferences);
+
+	const float fLeafCost = rParameters.m_fObjectIntersectionCost * static_cast<float>(uiNumObjectReferences);
+	const float fSplitCost = rParameters.m_fNodeTraversalCost + rParameters.m_fObjectIntersectionCost *
+		(fLeftSurfaceArea * static_cast<float>(uiNumLeftObjectReferences) + fRightSurfaceArea * static_cast<float>(uiNumRightObjectReferences)) / fParentSurfaceArea;
+
+	return fLeafCost <= fSplitCost;
+}
+
+bool CollisionDetection::IsLeafCheaperThanSplit_BoundingSphere(const SceneObject * pSceneObjects, const ObjectReference * pObjectReferences, size_t uiNumObjectReferences, size_t uiNumLeftObjectReferences, const ObjectMeanLeafParameters & rParameters)
+{
+	assert(pSceneObjects);
+	assert(pObjectReferences);
+	assert(uiNumLeftObjectReferences > 0u && uiNumLeftObjectReferences < uiNumObjectReferences);
+
+	const size_t uiNumRightObjectReferences = uiNumObjectReferences - uiNumLeftObjectReferences;
+
+	const float fParentSurfaceArea = CalcSurfaceAreaOfObjects_BoundingSphere(pSceneObjects, pObjectReferences, uiNumObjectReferences);
+	if (fParentSurfaceArea <= 0.0f) // degenerated set, nothing to gain from splitting it
+		return true;
+
+	const float fLeftSurfaceArea = CalcSurfaceAreaOfObjects_BoundingSphere(pSceneObjects, pObjectReferences, uiNumLeftObjectReferences);
+	const float fRightSurfaceArea = CalcSurfaceAreaOfObjects_BoundingSphere(pSceneObjects, pObjectReferences + uiNumLeftObjectReferences, uiNumRightObjectReferences);
+
+	const float fLeafCost = rParameters.m_fObjectIntersectionCost * static_cast<float>(uiNumObjectReferences);
+	const float fSplitCost = rParameters.m_fNodeTraversalCost + rParameters.m_fObjectIntersectionCost *
+		(fLeftSurfaceArea * static_cast<float>(uiNumLeftObjectReferences) + fRightSurfaceArea * static_cast<float>(uiNumRightObjectReferences)) / fParentSurfaceArea;
+
+	return fLeafCost <= fSplitCost;
+}
+
 void CollisionDetection::FindBottomUpNodesToMerge_AABB(BVHTreeNode ** pNode, size_t uiNumNodes, size_t & rNodeIndex1, size_t & rNodeIndex2)
 {
 	float fCurrentlySmallestAABBVolume = std::numeric_limits<float>::max();
@@ -735,14 +1418,7 @@ void CollisionDetection::FindBottomUpNodesToMerge_AABB(BVHTreeNode ** pNode, siz
 		for (size_t uiCurrentMergePartnerIndex2 = uiCurrentMergePartnerIndex1 + 1; uiCurrentMergePartnerIndex2 < uiNumNodes; uiCurrentMergePartnerIndex2++)
 		{
 			//  determine the size of the bounding volume that would result from the two current 
-			const AABB& rAABB1 = pNode[uiCurrentMergePartnerIndex1]->m_tAABBForNode;
-			const AABB& rAABB2 = pNode[uiCurrentMergePartnerIndex2]->m_tAABBForNode;
-
-			const float fMergedAABBExtentX = std::abs(rAABB1.m_vec3Center.x - rAABB2.m_vec3Center.x) + rAABB1.m_vec3Radius.x + rAABB2.m_vec3Radius.x;
-			const float fMergedAABBExtentY = std::abs(rAABB1.m_vec3Center.y - rAABB2.m_vec3Center.y) + rAABB1.m_vec3Radius.y + rAABB2.m_vec3Radius.y;
-			const float fMergedAABBExtentZ = std::abs(rAABB1.m_vec3Center.z - rAABB2.m_vec3Center.z) + rAABB1.m_vec3Radius.z + rAABB2.m_vec3Radius.z;
-
-			const float fMergedAABBVolume = fMergedAABBExtentX * fMergedAABBExtentY * fMergedAABBExtentZ;
+			const float fMergedAABBVolume = CalcBottomUpMergeCost_AABB(pNode[uiCurrentMergePartnerIndex1]->m_tAABBForNode, pNode[uiCurrentMergePartnerIndex2]->m_tAABBForNode);
 
 			// update results conditionally
 			if (fMergedAABBVolume < fCurrentlySmallestAABBVolume)
@@ -766,27 +1442,7 @@ void CollisionDetection::FindBottomUpNodesToMerge_BoundingSphere(BVHTreeNode **
 		for (size_t uiCurrentMergePartnerIndex2 = uiCurrentMergePartnerIndex1 + 1; uiCurrentMergePartnerIndex2 < uiNumNodes; uiCurrentMergePartnerIndex2++)
 		{
 			//  determine the size of the bounding volume that would result from the two current 
-			const BoundingSphere& rBoundingSphere1 = pNode[uiCurrentMergePartnerIndex1]->m_tBoundingSphereForNode;
-			const BoundingSphere& rBoundingSphere2 = pNode[uiCurrentMergePartnerIndex2]->m_tBoundingSphereForNode;
-
-			// we determine the distance vector to sphere2 from sphere1
-			const glm::vec3 vec3CenterPointsDistance = rBoundingSphere2.m_vec3Center - rBoundingSphere1.m_vec3Center;
-			// we construct the normalized direction of the distance ...
-			const glm::vec3 vec3NormalizedCenterPointsDirection = glm::normalize(vec3CenterPointsDistance);
-			// ... to then scale it by the second sphere's radius, resulting in a "directed radius"
-			const glm::vec3 vec3DirectedSecondSphereRadius = vec3NormalizedCenterPointsDirection * rBoundingSphere2.m_fRadius;
-			// ... we also scale its inverse with the first sphere's radius, resulting in a "radius" directed in the opposite direction
-			const glm::vec3 vec3DirectedFirstSphereRadius = -vec3NormalizedCenterPointsDirection * rBoundingSphere1.m_fRadius;
-
-			// we construct the point on the second sphere that is the most distant to the first sphere's center
-			const glm::vec3 vec3SecondSphereMostDistantPoint = rBoundingSphere2.m_vec3Center + vec3DirectedSecondSphereRadius;
-			// we construct the point on the first sphere that is the most distant to the second sphere's center
-			const glm::vec3 vec3FirstSphereMostDistantPoint = rBoundingSphere1.m_vec3Center + vec3DirectedFirstSphereRadius;
-
-			// having constructed the two most distant points, we can now simply determine their distance
-			const glm::vec3 vec3DistanceBetweenMostDistantPoints = vec3SecondSphereMostDistantPoint - vec3FirstSphereMostDistantPoint;
-			// which effectively is the diameter of the bounding sphere that would encompass both spheres.
-			const float fMergedBoundingSphereDiameter = glm::length(vec3DistanceBetweenMostDistantPoints);
+			const float fMergedBoundingSphereDiameter = CalcBottomUpMergeCost_BoundingSphere(pNode[uiCurrentMergePartnerIndex1]->m_tBoundingSphereForNode, pNode[uiCurrentMergePartnerIndex2]->m_tBoundingSphereForNode);
 
 			// update results conditionally
 			if (fMergedBoundingSphereDiameter < fCurrentlySmallestBoundingSphereDiameter)
@@ -799,433 +1455,5141 @@ void CollisionDetection::FindBottomUpNodesToMerge_BoundingSphere(BVHTreeNode **
 	}
 }
 
-RayCastIntersectionResult CollisionDetection::CastRayIntoBVH(const BoundingVolumeHierarchy & rBVH, const Ray & rCastedRay)
+std::vector<BottomUpMerge> CollisionDetection::CalcBottomUpMergeOrder_AABB(const SceneObject * pSceneObjects, size_t uiNumSceneObjects)
 {
-	RayCastIntersectionResult tResult;
+	assert(pSceneObjects);
+	assert(uiNumSceneObjects > 0u);
 
-	if (rBVH.m_pRootNode) // only actually cast a ray if there are objects in the scene
-	{
-		tResult = RecursiveRayCastIntoBVHTree(rBVH.m_pRootNode, rCastedRay);
-	}
+	// room for all leaves and all nodes that are going to be merged from them
+	std::vector<AABB> vecAABBs;
+	vecAABBs.reserve(2u * uiNumSceneObjects - 1u);
+	for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
+		vecAABBs.push_back(pSceneObjects[uiCurrentSceneObject].m_tWorldSpaceAABB);
 
-	return tResult;
+	return CalcBottomUpMergeOrder<AABB>(vecAABBs, &CalcBottomUpMergeCost_AABB, &MergeTwoAABBs);
 }
 
-RayCastIntersectionResult CollisionDetection::BruteForceRayIntoObjects(std::vector<SceneObject>& rvecObjects, const Ray & rCastedRay)
+std::vector<BottomUpMerge> CollisionDetection::CalcBottomUpMergeOrder_BoundingSphere(const SceneObject * pSceneObjects, size_t uiNumSceneObjects)
 {
-	RayCastIntersectionResult tResult;
+	assert(pSceneObjects);
+	assert(uiNumSceneObjects > 0u);
 
-	for (SceneObject& rCurrentSceneObject : rvecObjects)
-	{
-		glm::vec3 vec3CurrentPointOfIntersection;
-		float fCurrentIntersectionDistance = 0.0f;
-		if (IntersectRayAABB(rCastedRay, rCurrentSceneObject.m_tWorldSpaceAABB, fCurrentIntersectionDistance, vec3CurrentPointOfIntersection))
-		{
-			if (fCurrentIntersectionDistance < tResult.m_fIntersectionDistance)
-			{
-				tResult.m_fIntersectionDistance = fCurrentIntersectionDistance;
-				tResult.m_vec3PointOfIntersection = vec3CurrentPointOfIntersection;
-				tResult.m_pFirstIntersectedSceneObject = &rCurrentSceneObject;
-			}
-		}
-	}
+	// room for all leaves and all nodes that are going to be merged from them
+	std::vector<BoundingSphere> vecBoundingSpheres;
+	vecBoundingSpheres.reserve(2u * uiNumSceneObjects - 1u);
+	for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumSceneObjects; uiCurrentSceneObject++)
+		vecBoundingSpheres.push_back(pSceneObjects[uiCurrentSceneObject].m_tWorldSpaceBoundingSphere);
 
-	return tResult;
+	return CalcBottomUpMergeOrder<BoundingSphere>(vecBoundingSpheres, &CalcBottomUpMergeCost_BoundingSphere, &MergeTwoBoundingSpheres);
 }
 
-/*
-	Implementation of "private" functions (internal linkage)
-*/
-namespace CollisionDetection {
-	namespace {
+std::vector<BottomUpMerge> CollisionDetection::CalcPLOCMergeOrder_AABB(const SceneObject * pSceneObjects, size_t uiNumSceneObjects, const PLOCParameters & rParameters, TaskPool * pTaskPool)
+{
+	return CalcPLOCMergeOrder<AABB>(pSceneObjects, uiNumSceneObjects, rParameters, &SceneObject::m_tWorldSpaceAABB, &CalcBottomUpMergeCost_AABB, &MergeTwoAABBs, pTaskPool);
+}
 
-		//////////////////////////////////////////
-		// BOUNDING VOLUMES
-		//////////////////////////////////////////
+std::vector<BottomUpMerge> CollisionDetection::CalcPLOCMergeOrder_BoundingSphere(const SceneObject * pSceneObjects, size_t uiNumSceneObjects, const PLOCParameters & rParameters, TaskPool * pTaskPool)
+{
+	return CalcPLOCMergeOrder<BoundingSphere>(pSceneObjects, uiNumSceneObjects, rParameters, &SceneObject::m_tWorldSpaceBoundingSphere, &CalcBottomUpMergeCost_BoundingSphere, &MergeTwoBoundingSpheres, pTaskPool);
+}
 
-		MostSeperatedPointsIndices MostSeperatedPointsOnAABB(float * pVertices, size_t uiNumberOfVertices)
-		{
-			MostSeperatedPointsIndices tResult;
+void CollisionDetection::ConstructLBVH_AABB(BoundingVolumeHierarchy & rBVH, SceneObject * pSceneObjects, size_t uiNumSceneObjects, const LBVHParameters & rParameters, TaskPool * pTaskPool)
+{
+	ConstructLBVH(rBVH, pSceneObjects, uiNumSceneObjects, rParameters, &SceneObject::m_tWorldSpaceAABB, &BVHTreeNode::m_tAABBForNode, &MergeTwoAABBs, pTaskPool);
+}
 
-			size_t uiMinXIndex = 0u, uiMaxXIndex = 0u, uiMinYIndex = 0u, uiMaxYIndex = 0u, uiMinZIndex = 0u, uiMaxZIndex = 0u;
-			for (size_t uiCurrentVertexIndex = 1; uiCurrentVertexIndex < uiNumberOfVertices; uiCurrentVertexIndex++)
-			{
-				//min and max for X: *8 accounts for stride, +0 accounts for x coordinate
-				if (pVertices[uiCurrentVertexIndex * 8 + 0] < pVertices[uiMinXIndex * 8 + 0]) uiMinXIndex = uiCurrentVertexIndex;
-				if (pVertices[uiCurrentVertexIndex * 8 + 0] > pVertices[uiMaxXIndex * 8 + 0]) uiMaxXIndex = uiCurrentVertexIndex;
-				//min and max for Y: *8 accounts for stride, +1 accounts for y coordinate
-				if (pVertices[uiCurrentVertexIndex * 8 + 1] < pVertices[uiMinYIndex * 8 + 1]) uiMinYIndex = uiCurrentVertexIndex;
-				if (pVertices[uiCurrentVertexIndex * 8 + 1] > pVertices[uiMaxYIndex * 8 + 1]) uiMaxYIndex = uiCurrentVertexIndex;
-				//min and max for Y: *8 accounts for stride, +2 accounts for z coordinate
-				if (pVertices[uiCurrentVertexIndex * 8 + 2] < pVertices[uiMinZIndex * 8 + 2]) uiMinZIndex = uiCurrentVertexIndex;
-				if (pVertices[uiCurrentVertexIndex * 8 + 2] > pVertices[uiMaxZIndex * 8 + 2]) uiMaxZIndex = uiCurrentVertexIndex;
-			}
+void CollisionDetection::ConstructLBVH_BoundingSphere(BoundingVolumeHierarchy & rBVH, SceneObject * pSceneObjects, size_t uiNumSceneObjects, const LBVHParameters & rParameters, TaskPool * pTaskPool)
+{
+	ConstructLBVH(rBVH, pSceneObjects, uiNumSceneObjects, rParameters, &SceneObject::m_tWorldSpaceBoundingSphere, &BVHTreeNode::m_tBoundingSphereForNode, &MergeTwoBoundingSpheres, pTaskPool);
+}
 
-			//creating points for distance calculation
-			const glm::vec3 vec3MinXPoint(pVertices[uiMinXIndex * 8 + 0], pVertices[uiMinXIndex * 8 + 1], pVertices[uiMinXIndex * 8 + 2]);
-			const glm::vec3 vec3MaxXPoint(pVertices[uiMaxXIndex * 8 + 0], pVertices[uiMaxXIndex * 8 + 1], pVertices[uiMaxXIndex * 8 + 2]);
-			const glm::vec3 vec3MinYPoint(pVertices[uiMinYIndex * 8 + 0], pVertices[uiMinYIndex * 8 + 1], pVertices[uiMinYIndex * 8 + 2]);
-			const glm::vec3 vec3MaxYPoint(pVertices[uiMaxYIndex * 8 + 0], pVertices[uiMaxYIndex * 8 + 1], pVertices[uiMaxYIndex * 8 + 2]);
-			const glm::vec3 vec3MinZPoint(pVertices[uiMinZIndex * 8 + 0], pVertices[uiMinZIndex * 8 + 1], pVertices[uiMinZIndex * 8 + 2]);
-			const glm::vec3 vec3MaxZPoint(pVertices[uiMaxZIndex * 8 + 0], pVertices[uiMaxZIndex * 8 + 1], pVertices[uiMaxZIndex * 8 + 2]);
+void CollisionDetection::ConstructLBVH_SweptAABB(BoundingVolumeHierarchy & rBVH, SceneObject * pSceneObjects, size_t uiNumSceneObjects, const LBVHParameters & rParameters, TaskPool * pTaskPool)
+{
+	ConstructLBVH(rBVH, pSceneObjects, uiNumSceneObjects, rParameters, &SceneObject::m_tSweptWorldSpaceAABB, &BVHTreeNode::m_tAABBForNode, &MergeTwoAABBs, pTaskPool);
+}
 
-			//calculating the distace
-			const glm::vec3 vec3DistanceXPoints = vec3MaxXPoint - vec3MinXPoint;
-			const glm::vec3 vec3DistanceYPoints = vec3MaxYPoint - vec3MinYPoint;
-			const glm::vec3 vec3DistanceZPoints = vec3MaxZPoint - vec3MinZPoint;
+void CollisionDetection::PrepareBVHForRefitting_AABB(BoundingVolumeHierarchy & rBVH, const SceneObject * pSceneObjects)
+{
+	assert(rBVH.m_pRootNode);
+	assert(pSceneObjects);
 
-			//computing the squared distance for all pairs
-			const float fSquaredDistanceXPoints = glm::dot(vec3DistanceXPoints, vec3DistanceXPoints);
-			const float fSquaredDistanceYPoints = glm::dot(vec3DistanceYPoints, vec3DistanceYPoints);
-			const float fSquaredDistanceZPoints = glm::dot(vec3DistanceZPoints, vec3DistanceZPoints);
+	rBVH.m_vecLeafOfObject.assign(rBVH.m_vecObjectPermutation.size(), nullptr);
+	rBVH.m_fNodeSurfaceAreaAfterConstruction = RecursiveLinkBVHTreeForRefitting(rBVH, rBVH.m_pRootNode, nullptr, pSceneObjects, CalcNodeSurfaceArea_AABB);
+	rBVH.m_fNodeSurfaceArea = rBVH.m_fNodeSurfaceAreaAfterConstruction;
+}
 
-			//references only for readability
-			size_t& ruiMinVertexIndex = tResult.m_uiMinVertexIndex;
-			size_t& ruiMaxVertexIndex = tResult.m_uiMaxVertexIndex;
+void CollisionDetection::PrepareBVHForRefitting_BoundingSphere(BoundingVolumeHierarchy & rBVH, const SceneObject * pSceneObjects)
+{
+	assert(rBVH.m_pRootNode);
+	assert(pSceneObjects);
 
-			//base assumption : arbitrary axis, here X, is the longest
-			ruiMinVertexIndex = uiMinXIndex;
-			ruiMaxVertexIndex = uiMaxXIndex;
+	rBVH.m_vecLeafOfObject.assign(rBVH.m_vecObjectPermutation.size(), nullptr);
+	rBVH.m_fNodeSurfaceAreaAfterConstruction = RecursiveLinkBVHTreeForRefitting(rBVH, rBVH.m_pRootNode, nullptr, pSceneObjects, CalcNodeSurfaceArea_BoundingSphere);
+	rBVH.m_fNodeSurfaceArea = rBVH.m_fNodeSurfaceAreaAfterConstruction;
+}
 
-			//correction into Y axis if those points are farther apart
-			if (fSquaredDistanceYPoints > fSquaredDistanceXPoints && fSquaredDistanceYPoints > fSquaredDistanceZPoints)
-			{
-				ruiMinVertexIndex = uiMinYIndex;
-				ruiMaxVertexIndex = uiMaxYIndex;
-			}
+void CollisionDetection::RefitBVHForObject_AABB(BoundingVolumeHierarchy & rBVH, const SceneObject * pSceneObjects, size_t uiObjectIndex)
+{
+	assert(pSceneObjects);
+	assert(uiObjectIndex < rBVH.m_vecLeafOfObject.size());	// the hierarchy has to be prepared for refitting
 
-			//correction into Z axis if those points are farther apart
-			if (fSquaredDistanceZPoints > fSquaredDistanceXPoints && fSquaredDistanceZPoints > fSquaredDistanceYPoints)
-			{
-				ruiMinVertexIndex = uiMinZIndex;
-				ruiMaxVertexIndex = uiMaxZIndex;
-			}
+	RefitBVHTreeFromLeaf(rBVH, rBVH.m_vecLeafOfObject[uiObjectIndex], RefitNode_AABB, CalcNodeSurfaceArea_AABB);
+}
 
-			return tResult;
-		}
+void CollisionDetection::RefitBVHForObject_BoundingSphere(BoundingVolumeHierarchy & rBVH, const SceneObject * pSceneObjects, size_t uiObjectIndex)
+{
+	assert(pSceneObjects);
+	assert(uiObjectIndex < rBVH.m_vecLeafOfObject.size());	// the hierarchy has to be prepared for refitting
+
+	RefitBVHTreeFromLeaf(rBVH, rBVH.m_vecLeafOfObject[uiObjectIndex], RefitNode_BoundingSphere, CalcNodeSurfaceArea_BoundingSphere);
+}
+
+void CollisionDetection::RefitLinearBVHForObject(LinearBVH & rLinearBVH, const BoundingVolumeHierarchy & rBVH, size_t uiObjectIndex)
+{
+	assert(uiObjectIndex < rBVH.m_vecLeafOfObject.size());	// the hierarchy has to be prepared for refitting
+	assert(!rLinearBVH.m_vecNodes.empty());
+
+	const BVHTreeNode* pLeaf = rBVH.m_vecLeafOfObject[uiObjectIndex];
+	assert(pLeaf);
+
+	// first, for every level of the path, whether it continues to the right child. Then the same path is taken down the flattened copy, turning those into node indices
+	size_t uiLeafDepth = 0u;
+	for (const BVHTreeNode* pCurrentNode = pLeaf; pCurrentNode->m_pParent; pCurrentNode = pCurrentNode->m_pParent)
+		uiLeafDepth++;
+
+	std::vector<uint32_t> vecPathNodeIndices(uiLeafDepth + 1u);
+	size_t uiCurrentDepth = uiLeafDepth;
+	for (const BVHTreeNode* pCurrentNode = pLeaf; pCurrentNode->m_pParent; pCurrentNode = pCurrentNode->m_pParent)
+		vecPathNodeIndices[uiCurrentDepth--] = (pCurrentNode == pCurrentNode->m_pParent->m_pRight) ? 1u : 0u;
+
+	vecPathNodeIndices[0] = 0u;
+	for (uiCurrentDepth = 1u; uiCurrentDepth <= uiLeafDepth; uiCurrentDepth++)
+	{
+		const uint32_t uiParentIndex = vecPathNodeIndices[uiCurrentDepth - 1u];
+		assert(rLinearBVH.m_vecNodes[uiParentIndex].IsANode());
+		// the left child directly follows its parent
+		vecPathNodeIndices[uiCurrentDepth] = (vecPathNodeIndices[uiCurrentDepth] == 1u) ? rLinearBVH.m_vecNodes[uiParentIndex].m_uiRightChildOrFirstObject : uiParentIndex + 1u;
+	}
+
+	// the leaf encloses its objects, every node above it its two children, just like when flattening
+	LinearBVHNode& rLinearLeaf = rLinearBVH.m_vecNodes[vecPathNodeIndices[uiLeafDepth]];
+	assert(!rLinearLeaf.IsANode() && rLinearLeaf.m_uiRightChildOrFirstObject == pLeaf->m_uiFirstObject);
+
+	rLinearLeaf.m_vec3Min = glm::vec3(std::numeric_limits<float>::max());
+	rLinearLeaf.m_vec3Max = glm::vec3(std::numeric_limits<float>::lowest());
+	for (uint32_t uiCurrentObject = rLinearLeaf.m_uiRightChildOrFirstObject; uiCurrentObject < rLinearLeaf.m_uiRightChildOrFirstObject + rLinearLeaf.m_uiNumObjects; uiCurrentObject++)
+	{
+		const AABB& rCurrentAABB = rLinearBVH.m_vecObjectPermutation[uiCurrentObject]->m_tWorldSpaceAABB;
+		rLinearLeaf.m_vec3Min = glm::min(rLinearLeaf.m_vec3Min, rCurrentAABB.m_vec3Center - rCurrentAABB.m_vec3Radius);
+		rLinearLeaf.m_vec3Max = glm::max(rLinearLeaf.m_vec3Max, rCurrentAABB.m_vec3Center + rCurrentAABB.m_vec3Radius);
+	}
+
+	for (uiCurrentDepth = uiLeafDepth; uiCurrentDepth-- > 0u; )
+	{
+		const uint32_t uiCurrentNodeIndex = vecPathNodeIndices[uiCurrentDepth];
+		LinearBVHNode& rCurrentNode = rLinearBVH.m_vecNodes[uiCurrentNodeIndex];
+		const LinearBVHNode& rLeftChild = rLinearBVH.m_vecNodes[uiCurrentNodeIndex + 1u];
+		const LinearBVHNode& rRightChild = rLinearBVH.m_vecNodes[rCurrentNode.m_uiRightChildOrFirstObject];
+		rCurrentNode.m_vec3Min = glm::min(rLeftChild.m_vec3Min, rRightChild.m_vec3Min);
+		rCurrentNode.m_vec3Max = glm::max(rLeftChild.m_vec3Max, rRightChild.m_vec3Max);
+	}
+}
+
+constexpr int32_t CollisionDetection::DynamicAABBTree::s_iNullNode;
+
+CollisionDetection::DynamicAABBTree::DynamicAABBTree(float fFatAABBMargin) :
+	m_vecNodes(),
+	m_vecLeafOfObject(),
+	m_iRootNode(s_iNullNode),
+	m_iFreeList(s_iNullNode),
+	m_uiNumObjects(0u),
+	m_fFatAABBMargin(fFatAABBMargin)
+{
+	assert(fFatAABBMargin >= 0.0f);
+}
+
+void CollisionDetection::DynamicAABBTree::InsertObject(const SceneObject * pSceneObjects, uint32_t uiObjectIndex)
+{
+	assert(pSceneObjects);
+
+	if (uiObjectIndex >= m_vecLeafOfObject.size())
+		m_vecLeafOfObject.resize(uiObjectIndex + 1u, s_iNullNode);
+	assert(m_vecLeafOfObject[uiObjectIndex] == s_iNullNode);	// every object can only be inserted once
+
+	const int32_t iNewLeaf = AllocateNode();
+	Node& rNewLeaf = m_vecNodes[iNewLeaf];
+	rNewLeaf.m_tAABB = CreateFatAABB(pSceneObjects[uiObjectIndex].m_tWorldSpaceAABB);
+	rNewLeaf.m_uiObjectIndex = uiObjectIndex;
+
+	m_vecLeafOfObject[uiObjectIndex] = iNewLeaf;
+	m_uiNumObjects++;
+
+	InsertLeaf(iNewLeaf);
+}
+
+void CollisionDetection::DynamicAABBTree::RemoveObject(uint32_t uiObjectIndex)
+{
+	assert(uiObjectIndex < m_vecLeafOfObject.size());
+	const int32_t iLeaf = m_vecLeafOfObject[uiObjectIndex];
+	assert(iLeaf != s_iNullNode);	// the object has to be in the tree
+
+	RemoveLeaf(iLeaf);
+	FreeNode(iLeaf);
+
+	m_vecLeafOfObject[uiObjectIndex] = s_iNullNode;
+	m_uiNumObjects--;
+}
+
+bool CollisionDetection::DynamicAABBTree::UpdateObject(const SceneObject * pSceneObjects, uint32_t uiObjectIndex)
+{
+	assert(pSceneObjects);
+	assert(uiObjectIndex < m_vecLeafOfObject.size());
+	const int32_t iLeaf = m_vecLeafOfObject[uiObjectIndex];
+	assert(iLeaf != s_iNullNode);	// the object has to be in the tree
+
+	// a fat AABB more than four times as large as a fresh one would only make the tree worse
+	const float fMaxFatAABBSurfaceAreaGrowth = 4.0f;
+	const AABB tNewFatAABB = CreateFatAABB(pSceneObjects[uiObjectIndex].m_tWorldSpaceAABB);
+	const AABB& rCurrentFatAABB = m_vecNodes[iLeaf].m_tAABB;
+	if (DoesAABBContainAABB(rCurrentFatAABB, pSceneObjects[uiObjectIndex].m_tWorldSpaceAABB) && rCurrentFatAABB.CalcSurfaceArea() <= fMaxFatAABBSurfaceAreaGrowth * tNewFatAABB.CalcSurfaceArea())
+		return false;
+
+	RemoveLeaf(iLeaf);
+	m_vecNodes[iLeaf].m_tAABB = tNewFatAABB;
+	InsertLeaf(iLeaf);
+
+	return true;
+}
+
+void CollisionDetection::DynamicAABBTree::ChangeObjectIndex(uint32_t uiOldObjectIndex, uint32_t uiNewObjectIndex)
+{
+	assert(uiOldObjectIndex < m_vecLeafOfObject.size());
+	const int32_t iLeaf = m_vecLeafOfObject[uiOldObjectIndex];
+	assert(iLeaf != s_iNullNode);	// the object has to be in the tree
+
+	if (uiNewObjectIndex >= m_vecLeafOfObject.size())
+		m_vecLeafOfObject.resize(uiNewObjectIndex + 1u, s_iNullNode);
+	assert(m_vecLeafOfObject[uiNewObjectIndex] == s_iNullNode);	// the new index must not be taken by another object
+
+	m_vecLeafOfObject[uiOldObjectIndex] = s_iNullNode;
+	m_vecLeafOfObject[uiNewObjectIndex] = iLeaf;
+	m_vecNodes[iLeaf].m_uiObjectIndex = uiNewObjectIndex;
+}
+
+void CollisionDetection::DynamicAABBTree::Clear()
+{
+	m_vecNodes.clear();
+	m_vecLeafOfObject.clear();
+	m_iRootNode = s_iNullNode;
+	m_iFreeList = s_iNullNode;
+	m_uiNumObjects = 0u;
+}
+
+int32_t CollisionDetection::DynamicAABBTree::GetHeight() const
+{
+	return (m_iRootNode != s_iNullNode) ? m_vecNodes[m_iRootNode].m_iHeight : 0;
+}
+
+float CollisionDetection::DynamicAABBTree::CalcNodeSurfaceArea() const
+{
+	float fResult = 0.0f;
+	for (const Node& rCurrentNode : m_vecNodes)
+	{
+		// skipping leaves and free nodes
+		if (rCurrentNode.m_iHeight > 0)
+			fResult += rCurrentNode.m_tAABB.CalcSurfaceArea();
+	}
+
+	return fResult;
+}
+
+int32_t CollisionDetection::DynamicAABBTree::AllocateNode()
+{
+	if (m_iFreeList == s_iNullNode)
+	{
+		assert(m_vecNodes.size() < static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+		m_vecNodes.emplace_back();
+		return static_cast<int32_t>(m_vecNodes.size() - 1u);
+	}
+
+	const int32_t iNewNode = m_iFreeList;
+	m_iFreeList = m_vecNodes[iNewNode].m_iParentOrNextFreeNode;
+	m_vecNodes[iNewNode] = Node();
+
+	return iNewNode;
+}
+
+void CollisionDetection::DynamicAABBTree::FreeNode(int32_t iNode)
+{
+	Node& rFreedNode = m_vecNodes[iNode];
+	rFreedNode = Node();
+	rFreedNode.m_iHeight = -1;
+	rFreedNode.m_iParentOrNextFreeNode = m_iFreeList;
+	m_iFreeList = iNode;
+}
+
+AABB CollisionDetection::DynamicAABBTree::CreateFatAABB(const AABB & rObjectAABB) const
+{
+	AABB tResult = rObjectAABB;
+	tResult.m_vec3Radius *= 1.0f + m_fFatAABBMargin;
+
+	return tResult;
+}
+
+void CollisionDetection::DynamicAABBTree::InsertLeaf(int32_t iLeaf)
+{
+	if (m_iRootNode == s_iNullNode)
+	{
+		m_iRootNode = iLeaf;
+		m_vecNodes[iLeaf].m_iParentOrNextFreeNode = s_iNullNode;
+		return;
+	}
+
+	const AABB tLeafAABB = m_vecNodes[iLeaf].m_tAABB;
+	const int32_t iSibling = FindBestSibling(tLeafAABB);
+	const int32_t iOldParent = m_vecNodes[iSibling].m_iParentOrNextFreeNode;
+
+	// the new parent takes the place of the sibling, with the sibling and the new leaf as its children
+	const int32_t iNewParent = AllocateNode();	// might move all nodes, no references to them are held here
+	Node& rNewParent = m_vecNodes[iNewParent];
+	rNewParent.m_iParentOrNextFreeNode = iOldParent;
+	rNewParent.m_iLeft = iSibling;
+	rNewParent.m_iRight = iLeaf;
+	m_vecNodes[iSibling].m_iParentOrNextFreeNode = iNewParent;
+	m_vecNodes[iLeaf].m_iParentOrNextFreeNode = iNewParent;
+
+	if (iOldParent == s_iNullNode)
+	{
+		m_iRootNode = iNewParent;
+	}
+	else
+	{
+		Node& rOldParent = m_vecNodes[iOldParent];
+		if (rOldParent.m_iLeft == iSibling)
+			rOldParent.m_iLeft = iNewParent;
+		else
+			rOldParent.m_iRight = iNewParent;
+	}
+
+	RefitAndRotateAncestors(iNewParent);
+}
+
+void CollisionDetection::DynamicAABBTree::RemoveLeaf(int32_t iLeaf)
+{
+	if (iLeaf == m_iRootNode)
+	{
+		m_iRootNode = s_iNullNode;
+		return;
+	}
+
+	// the leaf's sibling takes the place of their parent
+	const int32_t iParent = m_vecNodes[iLeaf].m_iParentOrNextFreeNode;
+	const Node& rParent = m_vecNodes[iParent];
+	const int32_t iGrandparent = rParent.m_iParentOrNextFreeNode;
+	const int32_t iSibling = (rParent.m_iLeft == iLeaf) ? rParent.m_iRight : rParent.m_iLeft;
+
+	m_vecNodes[iSibling].m_iParentOrNextFreeNode = iGrandparent;
+	m_vecNodes[iLeaf].m_iParentOrNextFreeNode = s_iNullNode;
+	FreeNode(iParent);
+
+	if (iGrandparent == s_iNullNode)
+	{
+		m_iRootNode = iSibling;
+	}
+	else
+	{
+		Node& rGrandparent = m_vecNodes[iGrandparent];
+		if (rGrandparent.m_iLeft == iParent)
+			rGrandparent.m_iLeft = iSibling;
+		else
+			rGrandparent.m_iRight = iSibling;
+
+		RefitAndRotateAncestors(iGrandparent);
+	}
+}
+
+int32_t CollisionDetection::DynamicAABBTree::FindBestSibling(const AABB & rLeafAABB) const
+{
+	assert(m_iRootNode != s_iNullNode);
+
+	// Branch and bound: the cost of a sibling is the surface area of the new parent plus the growth of all of the sibling's ancestors ("inherited" cost).
+	// Every node of a subtree costs at least the leaf's own surface area plus the inherited cost of the subtree, so subtrees that cannot beat the best sibling found so far are skipped
+	struct SiblingCandidate {
+		int32_t m_iNode;
+		float m_fInheritedCost;
+	};
+
+	const float fLeafSurfaceArea = rLeafAABB.CalcSurfaceArea();
+	int32_t iBestSibling = m_iRootNode;
+	float fBestCost = std::numeric_limits<float>::max();
+
+	std::vector<SiblingCandidate> vecCandidates;
+	vecCandidates.reserve(64u);
+	vecCandidates.push_back({ m_iRootNode, 0.0f });
+
+	while (!vecCandidates.empty())
+	{
+		const SiblingCandidate tCurrentCandidate = vecCandidates.back();
+		vecCandidates.pop_back();
+		const Node& rCurrentNode = m_vecNodes[tCurrentCandidate.m_iNode];
+
+		const float fMergedSurfaceArea = MergeTwoAABBs(rLeafAABB, rCurrentNode.m_tAABB).CalcSurfaceArea();
+		const float fCost = fMergedSurfaceArea + tCurrentCandidate.m_fInheritedCost;
+		if (fCost < fBestCost)
+		{
+			fBestCost = fCost;
+			iBestSibling = tCurrentCandidate.m_iNode;
+		}
+
+		if (rCurrentNode.IsALeaf())
+			continue;
+
+		const float fInheritedCostOfChildren = tCurrentCandidate.m_fInheritedCost + fMergedSurfaceArea - rCurrentNode.m_tAABB.CalcSurfaceArea();
+		if (fLeafSurfaceArea + fInheritedCostOfChildren < fBestCost)
+		{
+			vecCandidates.push_back({ rCurrentNode.m_iLeft, fInheritedCostOfChildren });
+			vecCandidates.push_back({ rCurrentNode.m_iRight, fInheritedCostOfChildren });
+		}
+	}
+
+	return iBestSibling;
+}
+
+void CollisionDetection::DynamicAABBTree::RefitAndRotateAncestors(int32_t iNode)
+{
+	while (iNode != s_iNullNode)
+	{
+		// rotating only exchanges nodes below this one, so its own AABB can be refitted afterwards
+		RotateNode(iNode);
+
+		Node& rCurrentNode = m_vecNodes[iNode];
+		const Node& rLeftChild = m_vecNodes[rCurrentNode.m_iLeft];
+		const Node& rRightChild = m_vecNodes[rCurrentNode.m_iRight];
+		rCurrentNode.m_tAABB = MergeTwoAABBs(rLeftChild.m_tAABB, rRightChild.m_tAABB);
+		rCurrentNode.m_iHeight = 1 + std::max(rLeftChild.m_iHeight, rRightChild.m_iHeight);
+
+		iNode = rCurrentNode.m_iParentOrNextFreeNode;
+	}
+}
+
+void CollisionDetection::DynamicAABBTree::RotateNode(int32_t iNode)
+{
+	const Node& rNode = m_vecNodes[iNode];
+	assert(!rNode.IsALeaf());
+
+	// every child can be swapped with either child of its sibling. The rotation that shrinks the sibling's AABB the most is performed, if any
+	const int32_t aiChildren[2] = { rNode.m_iLeft, rNode.m_iRight };
+	float fBestSurfaceAreaReduction = 0.0f;
+	int32_t iBestChild = s_iNullNode;
+	int32_t iBestGrandchild = s_iNullNode;
+
+	for (size_t uiCurrentChild = 0u; uiCurrentChild < 2u; uiCurrentChild++)
+	{
+		const Node& rChild = m_vecNodes[aiChildren[uiCurrentChild]];
+		const Node& rSibling = m_vecNodes[aiChildren[1u - uiCurrentChild]];
+		if (rSibling.IsALeaf())
+			continue;
+
+		// swapping the child with one grandchild leaves the sibling with the child and the other grandchild
+		const float fSiblingSurfaceArea = rSibling.m_tAABB.CalcSurfaceArea();
+		const float fReductionSwappingLeft = fSiblingSurfaceArea - MergeTwoAABBs(rChild.m_tAABB, m_vecNodes[rSibling.m_iRight].m_tAABB).CalcSurfaceArea();
+		const float fReductionSwappingRight = fSiblingSurfaceArea - MergeTwoAABBs(rChild.m_tAABB, m_vecNodes[rSibling.m_iLeft].m_tAABB).CalcSurfaceArea();
+
+		if (fReductionSwappingLeft > fBestSurfaceAreaReduction)
+		{
+			fBestSurfaceAreaReduction = fReductionSwappingLeft;
+			iBestChild = aiChildren[uiCurrentChild];
+			iBestGrandchild = rSibling.m_iLeft;
+		}
+		if (fReductionSwappingRight > fBestSurfaceAreaReduction)
+		{
+			fBestSurfaceAreaReduction = fReductionSwappingRight;
+			iBestChild = aiChildren[uiCurrentChild];
+			iBestGrandchild = rSibling.m_iRight;
+		}
+	}
+
+	if (iBestChild != s_iNullNode)
+		SwapChildWithGrandchild(iNode, iBestChild, iBestGrandchild);
+}
+
+void CollisionDetection::DynamicAABBTree::SwapChildWithGrandchild(int32_t iNode, int32_t iChild, int32_t iGrandchild)
+{
+	Node& rNode = m_vecNodes[iNode];
+	const int32_t iSibling = m_vecNodes[iGrandchild].m_iParentOrNextFreeNode;
+	Node& rSibling = m_vecNodes[iSibling];
+	assert(rSibling.m_iParentOrNextFreeNode == iNode);
+	assert(iSibling != iChild);
+
+	// the grandchild moves up into the child's place, the child moves down into the grandchild's place
+	if (rNode.m_iLeft == iChild)
+		rNode.m_iLeft = iGrandchild;
+	else
+		rNode.m_iRight = iGrandchild;
+
+	if (rSibling.m_iLeft == iGrandchild)
+		rSibling.m_iLeft = iChild;
+	else
+		rSibling.m_iRight = iChild;
+
+	m_vecNodes[iGrandchild].m_iParentOrNextFreeNode = iNode;
+	m_vecNodes[iChild].m_iParentOrNextFreeNode = iSibling;
+
+	// only the sibling's subtree changed below the node
+	const Node& rSiblingLeftChild = m_vecNodes[rSibling.m_iLeft];
+	const Node& rSiblingRightChild = m_vecNodes[rSibling.m_iRight];
+	rSibling.m_tAABB = MergeTwoAABBs(rSiblingLeftChild.m_tAABB, rSiblingRightChild.m_tAABB);
+	rSibling.m_iHeight = 1 + std::max(rSiblingLeftChild.m_iHeight, rSiblingRightChild.m_iHeight);
+}
+
+RayCastIntersectionResult CollisionDetection::CastRayIntoBVH(const BoundingVolumeHierarchy & rBVH, const Ray & rCastedRay)
+{
+	RayCastIntersectionResult tResult;
+
+	if (rBVH.m_pRootNode) // only actually cast a ray if there are objects in the scene
+	{
+		tResult = RecursiveRayCastIntoBVHTree(rBVH, rBVH.m_pRootNode, rCastedRay, nullptr);
+	}
+
+	return tResult;
+}
+
+RayCastIntersectionResult CollisionDetection::CastRayIntoBVH(const BoundingVolumeHierarchy & rBVH, const Ray & rCastedRay, eRayTraversal eTraversal, RayTraversalStatistics * pStatistics)
+{
+	RayCastIntersectionResult tResult;
+
+	if (rBVH.m_pRootNode == nullptr) // only actually cast a ray if there are objects in the scene
+		return tResult;
+
+	// the statistics are always gathered, it is cheaper than checking whether they are wanted at every node
+	RayTraversalStatistics tStatistics;
+
+	switch (eTraversal)
+	{
+	case eRayTraversal::RECURSIVE_TRAVERSAL:
+		tResult = RecursiveRayCastIntoBVHTree(rBVH, rBVH.m_pRootNode, rCastedRay, &tStatistics);
+		break;
+	case eRayTraversal::STACK_TRAVERSAL:
+		tResult = StackRayCastIntoBVHTree(rBVH, rCastedRay, &BVHTreeNode::m_tAABBForNode, &SceneObject::m_tWorldSpaceAABB, IntersectRayAABBDistanceOnly, tStatistics);
+		break;
+	case eRayTraversal::STACKLESS_TRAVERSAL:
+		tResult = StacklessRayCastIntoBVHTree(rBVH, rCastedRay, tStatistics);
+		break;
+	case eRayTraversal::SHORT_STACK_TRAVERSAL:
+		tResult = ShortStackRayCastIntoBVHTree(rBVH, rCastedRay, tStatistics);
+		break;
+	default:
+		assert(!"disaster");
+		break;
+	}
+
+	if (pStatistics)
+	{
+		pStatistics->m_uiNumVisitedNodes += tStatistics.m_uiNumVisitedNodes;
+		pStatistics->m_uiNumBoundingVolumeTests += tStatistics.m_uiNumBoundingVolumeTests;
+		pStatistics->m_uiNumObjectTests += tStatistics.m_uiNumObjectTests;
+	}
+
+	return tResult;
+}
+
+RayCastIntersectionResult CollisionDetection::CastRayIntoBVH_BoundingSphere(const BoundingVolumeHierarchy & rBVH, const Ray & rCastedRay, RayTraversalStatistics * pStatistics)
+{
+	RayCastIntersectionResult tResult;
+
+	if (rBVH.m_pRootNode == nullptr) // only actually cast a ray if there are objects in the scene
+		return tResult;
+
+	RayTraversalStatistics tStatistics;
+	tResult = StackRayCastIntoBVHTree(rBVH, rCastedRay, &BVHTreeNode::m_tBoundingSphereForNode, &SceneObject::m_tWorldSpaceBoundingSphere, IntersectRayBoundingSphere, tStatistics);
+
+	if (pStatistics)
+	{
+		pStatistics->m_uiNumVisitedNodes += tStatistics.m_uiNumVisitedNodes;
+		pStatistics->m_uiNumBoundingVolumeTests += tStatistics.m_uiNumBoundingVolumeTests;
+		pStatistics->m_uiNumObjectTests += tStatistics.m_uiNumObjectTests;
+	}
+
+	return tResult;
+}
+
+RayCastIntersectionResult CollisionDetection::CastRayIntoBVH(const LinearBVH & rBVH, const Ray & rCastedRay)
+{
+	RayCastIntersectionResult tResult;
+
+	if (rBVH.m_vecNodes.empty()) // only actually cast a ray if there are objects in the scene
+		return tResult;
+
+	CastRayIntoLinearBVHSubtree(rBVH, 0u, rCastedRay, tResult);
+
+	return tResult;
+}
+
+RayCastIntersectionResult CollisionDetection::CastRayIntoBVH(const BVH4 & rBVH, const Ray & rCastedRay)
+{
+	return CastRayIntoWideBVH(rBVH, rCastedRay);
+}
+
+RayCastIntersectionResult CollisionDetection::CastRayIntoBVH(const BVH8 & rBVH, const Ray & rCastedRay)
+{
+	return CastRayIntoWideBVH(rBVH, rCastedRay);
+}
+
+void CollisionDetection::CastRayPacketsIntoBVH(const LinearBVH & rBVH, const Ray * pRays, size_t uiNumRays, size_t uiPacketSize, RayCastIntersectionResult * pResults)
+{
+	assert(uiNumRays == 0u || (pRays && pResults));
+
+	for (size_t uiCurrentRay = 0u; uiCurrentRay < uiNumRays; uiCurrentRay++)
+		pResults[uiCurrentRay] = RayCastIntersectionResult();
+
+	if (rBVH.m_vecNodes.empty()) // only actually cast rays if there are objects in the scene
+		return;
+
+	for (size_t uiFirstRayOfPacket = 0u; uiFirstRayOfPacket < uiNumRays; uiFirstRayOfPacket += uiPacketSize)
+	{
+		const size_t uiNumRaysInPacket = std::min(uiPacketSize, uiNumRays - uiFirstRayOfPacket);
+
+		switch (uiPacketSize)
+		{
+		case 4u:
+			CastRayPacketIntoLinearBVH<4u>(rBVH, pRays + uiFirstRayOfPacket, uiNumRaysInPacket, pResults + uiFirstRayOfPacket);
+			break;
+		case 8u:
+			CastRayPacketIntoLinearBVH<8u>(rBVH, pRays + uiFirstRayOfPacket, uiNumRaysInPacket, pResults + uiFirstRayOfPacket);
+			break;
+		case 16u:
+			CastRayPacketIntoLinearBVH<16u>(rBVH, pRays + uiFirstRayOfPacket, uiNumRaysInPacket, pResults + uiFirstRayOfPacket);
+			break;
+		default:
+			assert(!"packets hold 4, 8 or 16 rays");
+			return;
+		}
+	}
+}
+
+RayCastIntersectionResult CollisionDetection::CastRayIntoBVH(const DynamicAABBTree & rTree, SceneObject * pSceneObjects, const Ray & rCastedRay)
+{
+	RayCastIntersectionResult tResult;
+
+	if (rTree.GetRootNode() == DynamicAABBTree::s_iNullNode) // only actually cast a ray if there are objects in the tree
+		return tResult;
+
+	assert(pSceneObjects);
+	CastRayIntoDynamicAABBTreeSubtree(rTree, rTree.GetRootNode(), pSceneObjects, rCastedRay, tResult);
+
+	return tResult;
+}
+
+RayCastIntersectionResult CollisionDetection::CastRayIntoBVH(const KDTree & rKDTree, const Ray & rCastedRay)
+{
+	RayCastIntersectionResult tResult;
+
+	if (rKDTree.m_vecNodes.empty()) // only actually cast a ray if there are objects in the tree
+		return tResult;
+
+	// the part of the ray's line within the root's cell, split further at every plane it crosses on the way down
+	float fIntervalMin, fIntervalMax;
+	if (!IntersectRayMinMaxBoxEntryExit(rCastedRay, rKDTree.m_vec3Min, rKDTree.m_vec3Max, fIntervalMin, fIntervalMax))
+		return tResult;
+
+	// the farther sides of the crossed planes, put aside for later. Every level of the tree puts aside at most one of them
+	KDTreeCellToVisit pCellsToVisit[KDTree::s_iMaxDepthLimit];
+	size_t uiNumCellsToVisit = 0u;
+	uint32_t uiCurrentNodeIndex = 0u;
+
+	while (true)
+	{
+		const KDTreeNode& rCurrentNode = rKDTree.m_vecNodes[uiCurrentNodeIndex];
+
+		if (!rCurrentNode.IsALeaf())
+		{
+			const uint32_t uiSplitAxis = rCurrentNode.m_uiSplitAxis;
+			// the line passes through the side its direction comes from first
+			const bool bIsAboveFirst = rCastedRay.m_pIsDirectionNegative[uiSplitAxis];
+			const uint32_t uiFirstChild = bIsAboveFirst ? rCurrentNode.m_uiAboveChildOrFirstObject : uiCurrentNodeIndex + 1u;
+			const uint32_t uiSecondChild = bIsAboveFirst ? uiCurrentNodeIndex + 1u : rCurrentNode.m_uiAboveChildOrFirstObject;
+			// infinite for lines parallel to the plane, which stay on the side of their origin. NaN if the origin lies right on the plane
+			const float fPlaneDistance = (rCurrentNode.m_fSplitPosition - rCastedRay.m_vec3Origin[uiSplitAxis]) * rCastedRay.m_vec3InverseDirection[uiSplitAxis];
+
+			if (fPlaneDistance > fIntervalMax)		// the line leaves the cell before it reaches the plane
+				uiCurrentNodeIndex = uiFirstChild;
+			else if (fPlaneDistance < fIntervalMin)	// the line reaches the plane before it enters the cell
+				uiCurrentNodeIndex = uiSecondChild;
+			else
+			{
+				assert(uiNumCellsToVisit < static_cast<size_t>(KDTree::s_iMaxDepthLimit));
+				KDTreeCellToVisit& rSecondCell = pCellsToVisit[uiNumCellsToVisit++];
+				rSecondCell.m_uiNodeIndex = uiSecondChild;
+				rSecondCell.m_fIntervalMax = fIntervalMax;
+				if (std::isnan(fPlaneDistance))
+				{
+					// a line lying in the plane touches both sides all along
+					rSecondCell.m_fIntervalMin = fIntervalMin;
+				}
+				else
+				{
+					rSecondCell.m_fIntervalMin = fPlaneDistance;
+					fIntervalMax = fPlaneDistance;
+				}
+				uiCurrentNodeIndex = uiFirstChild;
+			}
+			continue;
+		}
+
+		// is a leaf
+		assert(rCurrentNode.m_uiAboveChildOrFirstObject + rCurrentNode.m_uiNumObjects <= rKDTree.m_vecObjectReferences.size());
+		SceneObject* const* ppLeafObjects = rKDTree.m_vecObjectReferences.data() + rCurrentNode.m_uiAboveChildOrFirstObject;
+		for (uint32_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < rCurrentNode.m_uiNumObjects; uiCurrentSceneObject++)
+		{
+			float fIntersectionDistanceForCurrentAABB;
+			glm::vec3 vec3CurrentIntersectionPoint;
+			if (IntersectRayAABB(rCastedRay, ppLeafObjects[uiCurrentSceneObject]->m_tWorldSpaceAABB, fIntersectionDistanceForCurrentAABB, vec3CurrentIntersectionPoint))
+			{
+				if (fIntersectionDistanceForCurrentAABB < tResult.m_fIntersectionDistance)
+				{
+					tResult.m_fIntersectionDistance = fIntersectionDistanceForCurrentAABB;
+					tResult.m_vec3PointOfIntersection = vec3CurrentIntersectionPoint;
+					tResult.m_pFirstIntersectedSceneObject = ppLeafObjects[uiCurrentSceneObject];
+				}
+			}
+		}
+
+		// cells the line enters beyond the closest hit so far cannot hold anything closer. Every hit lies within the cell the line
+		// passes through at that distance, as each cell references all objects overlapping it, so those cells are skipped
+		do
+		{
+			if (uiNumCellsToVisit == 0u)
+				return tResult;
+
+			const KDTreeCellToVisit& rNextCell = pCellsToVisit[--uiNumCellsToVisit];
+			uiCurrentNodeIndex = rNextCell.m_uiNodeIndex;
+			fIntervalMin = rNextCell.m_fIntervalMin;
+			fIntervalMax = rNextCell.m_fIntervalMax;
+		} while (fIntervalMin > tResult.m_fIntersectionDistance);
+	}
+}
+
+RayCastIntersectionResult CollisionDetection::CastRayIntoSpatialHashGrid(const SpatialHashGrid & rGrid, SceneObject * pSceneObjects, const Ray & rCastedRay, RayTraversalStatistics * pStatistics)
+{
+	RayCastIntersectionResult tResult;
+
+	if (rGrid.GetNumObjects() == 0u) // only actually cast a ray if there are objects in the grid
+		return tResult;
+
+	assert(pSceneObjects);
+	RayTraversalStatistics tStatistics;
+
+	// the line only has to be followed through the box around all occupied cells
+	const SpatialHashGrid::CellRange& rOccupiedCells = rGrid.GetOccupiedCells();
+	const float fCellSize = rGrid.GetCellSize();
+	glm::vec3 vec3GridMinimum, vec3GridMaximum;
+	for (int iCurrentAxis = 0; iCurrentAxis < 3; iCurrentAxis++)
+	{
+		vec3GridMinimum[iCurrentAxis] = static_cast<float>(rOccupiedCells.m_pMinimumCell[iCurrentAxis]) * fCellSize;
+		vec3GridMaximum[iCurrentAxis] = static_cast<float>(rOccupiedCells.m_pMaximumCell[iCurrentAxis] + 1) * fCellSize;
+	}
+
+	float fGridEntryDistance;
+	if (!IntersectRayMinMaxBox(rCastedRay, vec3GridMinimum, vec3GridMaximum, fGridEntryDistance))
+		return tResult;
+
+	// per axis: the current cell, the direction to step in, the distance at which the line crosses into the next cell, and the distance between two crossings.
+	// Axes the ray is practically parallel to are never stepped along, just like the slab tests treat them
+	int32_t pCell[3];
+	int32_t pStep[3];
+	float pNextCrossingDistance[3];
+	float pCrossingDistanceDelta[3];
+	for (int iCurrentAxis = 0; iCurrentAxis < 3; iCurrentAxis++)
+	{
+		const float fInverseDirection = rCastedRay.m_vec3InverseDirection[iCurrentAxis];
+		const bool bIsParallel = std::isinf(fInverseDirection);
+		const float fEntryCoordinate = bIsParallel ? rCastedRay.m_vec3Origin[iCurrentAxis] : rCastedRay.m_vec3Origin[iCurrentAxis] + rCastedRay.m_vec3Direction[iCurrentAxis] * fGridEntryDistance;
+
+		// rounding may put the entry point just outside of the occupied cells
+		pCell[iCurrentAxis] = static_cast<int32_t>(std::floor(fEntryCoordinate / fCellSize));
+		pCell[iCurrentAxis] = std::max(rOccupiedCells.m_pMinimumCell[iCurrentAxis], std::min(pCell[iCurrentAxis], rOccupiedCells.m_pMaximumCell[iCurrentAxis]));
+
+		if (bIsParallel)
+		{
+			pStep[iCurrentAxis] = 0;
+			pNextCrossingDistance[iCurrentAxis] = std::numeric_limits<float>::infinity();
+			pCrossingDistanceDelta[iCurrentAxis] = std::numeric_limits<float>::infinity();
+		}
+		else
+		{
+			pStep[iCurrentAxis] = rCastedRay.m_pIsDirectionNegative[iCurrentAxis] ? -1 : 1;
+			const int32_t iNextCellBoundary = rCastedRay.m_pIsDirectionNegative[iCurrentAxis] ? pCell[iCurrentAxis] : pCell[iCurrentAxis] + 1;
+			pNextCrossingDistance[iCurrentAxis] = (static_cast<float>(iNextCellBoundary) * fCellSize - rCastedRay.m_vec3Origin[iCurrentAxis]) * fInverseDirection;
+			pCrossingDistanceDelta[iCurrentAxis] = fCellSize * std::abs(fInverseDirection);
+		}
+	}
+
+	for (;;)
+	{
+		tStatistics.m_uiNumVisitedNodes++;
+
+		const std::vector<uint32_t>* pCellObjects = rGrid.GetObjectsInCell(pCell);
+		if (pCellObjects)
+		{
+			for (uint32_t uiCurrentObject : *pCellObjects)
+			{
+				tStatistics.m_uiNumObjectTests++;
+
+				// objects touching several cells are tested again in each of them, that is cheaper than remembering which were tested already
+				float fIntersectionDistanceForCurrentAABB;
+				glm::vec3 vec3CurrentIntersectionPoint;
+				if (IntersectRayAABB(rCastedRay, pSceneObjects[uiCurrentObject].m_tWorldSpaceAABB, fIntersectionDistanceForCurrentAABB, vec3CurrentIntersectionPoint))
+				{
+					if (fIntersectionDistanceForCurrentAABB < tResult.m_fIntersectionDistance)
+					{
+						tResult.m_fIntersectionDistance = fIntersectionDistanceForCurrentAABB;
+						tResult.m_vec3PointOfIntersection = vec3CurrentIntersectionPoint;
+						tResult.m_pFirstIntersectedSceneObject = pSceneObjects + uiCurrentObject;
+					}
+				}
+			}
+		}
+
+		// on to the cell whose boundary the line crosses first
+		int iCrossedAxis = 0;
+		if (pNextCrossingDistance[1] < pNextCrossingDistance[iCrossedAxis])
+			iCrossedAxis = 1;
+		if (pNextCrossingDistance[2] < pNextCrossingDistance[iCrossedAxis])
+			iCrossedAxis = 2;
+
+		// every object that was not tested yet is entered beyond that boundary
+		if (tResult.m_fIntersectionDistance <= pNextCrossingDistance[iCrossedAxis] || pStep[iCrossedAxis] == 0)
+			break;
+
+		pCell[iCrossedAxis] += pStep[iCrossedAxis];
+		if (pCell[iCrossedAxis] < rOccupiedCells.m_pMinimumCell[iCrossedAxis] || pCell[iCrossedAxis] > rOccupiedCells.m_pMaximumCell[iCrossedAxis])
+			break;
+		pNextCrossingDistance[iCrossedAxis] += pCrossingDistanceDelta[iCrossedAxis];
+	}
+
+	if (pStatistics)
+	{
+		pStatistics->m_uiNumVisitedNodes += tStatistics.m_uiNumVisitedNodes;
+		pStatistics->m_uiNumObjectTests += tStatistics.m_uiNumObjectTests;
+	}
+
+	return tResult;
+}
+
+RayCastIntersectionResult CollisionDetection::CastRayIntoLooseOctree(const LooseOctree & rOctree, SceneObject * pSceneObjects, const Ray & rCastedRay, RayTraversalStatistics * pStatistics)
+{
+	RayCastIntersectionResult tResult;
+
+	if (rOctree.GetRootNode() == LooseOctree::s_iNullNode) // only actually cast a ray if there are objects in the octree
+		return tResult;
+
+	assert(pSceneObjects);
+	const std::vector<LooseOctree::Node>& rvecNodes = rOctree.GetNodes();
+	RayTraversalStatistics tStatistics;
+
+	// nodes along with the distance at which the ray enters their loose bounds. The root also holds objects outside of its loose bounds, so it is entered right away.
+	// a node's children are pushed at once, so the stack never holds more than seven nodes per level besides the current one's children
+	std::pair<int32_t, float> pNodesToVisit[7 * LooseOctree::s_iMaxDepthLimit + 8];
+	size_t uiNumNodesToVisit = 0u;
+	pNodesToVisit[uiNumNodesToVisit++] = std::make_pair(rOctree.GetRootNode(), std::numeric_limits<float>::lowest());
+
+	while (uiNumNodesToVisit > 0u)
+	{
+		const std::pair<int32_t, float> tCurrentNode = pNodesToVisit[--uiNumNodesToVisit];
+
+		// nothing in this subtree can be closer than the closest hit found so far
+		if (tCurrentNode.second > tResult.m_fIntersectionDistance)
+			continue;
+
+		const LooseOctree::Node& rCurrentNode = rvecNodes[tCurrentNode.first];
+		tStatistics.m_uiNumVisitedNodes++;
+
+		for (uint32_t uiCurrentObject : rCurrentNode.m_vecObjects)
+		{
+			tStatistics.m_uiNumObjectTests++;
+
+			float fIntersectionDistanceForCurrentAABB;
+			glm::vec3 vec3CurrentIntersectionPoint;
+			if (IntersectRayAABB(rCastedRay, pSceneObjects[uiCurrentObject].m_tWorldSpaceAABB, fIntersectionDistanceForCurrentAABB, vec3CurrentIntersectionPoint))
+			{
+				if (fIntersectionDistanceForCurrentAABB < tResult.m_fIntersectionDistance)
+				{
+					tResult.m_fIntersectionDistance = fIntersectionDistanceForCurrentAABB;
+					tResult.m_vec3PointOfIntersection = vec3CurrentIntersectionPoint;
+					tResult.m_pFirstIntersectedSceneObject = pSceneObjects + uiCurrentObject;
+				}
+			}
+		}
+
+		// the children that are hit are pushed farthest first, so the nearest one is visited next
+		const size_t uiFirstChild = uiNumNodesToVisit;
+		for (int32_t iChild : rCurrentNode.m_pChildren)
+		{
+			if (iChild == LooseOctree::s_iNullNode)
+				continue;
+
+			float fChildEntryDistance;
+			if (IntersectRayAABBDistanceOnly(rCastedRay, rvecNodes[iChild].m_tLooseAABB, fChildEntryDistance) && fChildEntryDistance <= tResult.m_fIntersectionDistance)
+				pNodesToVisit[uiNumNodesToVisit++] = std::make_pair(iChild, fChildEntryDistance);
+		}
+		std::sort(pNodesToVisit + uiFirstChild, pNodesToVisit + uiNumNodesToVisit, [](const std::pair<int32_t, float>& rA, const std::pair<int32_t, float>& rB) { return rA.second > rB.second; });
+	}
+
+	if (pStatistics)
+	{
+		pStatistics->m_uiNumVisitedNodes += tStatistics.m_uiNumVisitedNodes;
+		pStatistics->m_uiNumObjectTests += tStatistics.m_uiNumObjectTests;
+	}
+
+	return tResult;
+}
+
+RayCastIntersectionResult CollisionDetection::BruteForceRayIntoObjects(std::vector<SceneObject>& rvecObjects, const Ray & rCastedRay)
+{
+	RayCastIntersectionResult tResult;
+
+	// four objects at a time with the SIMD slab test, their boxes are gathered as structure of arrays first
+	const size_t uiNumObjects = rvecObjects.size();
+	size_t uiCurrentSceneObject = 0u;
+	for (; uiCurrentSceneObject + 4u <= uiNumObjects; uiCurrentSceneObject += 4u)
+	{
+		float pMins[3][4], pMaxs[3][4];
+		for (size_t uiCurrentBox = 0u; uiCurrentBox < 4u; uiCurrentBox++)
+		{
+			const AABB& rCurrentAABB = rvecObjects[uiCurrentSceneObject + uiCurrentBox].m_tWorldSpaceAABB;
+			for (int iCurrentSlab = 0; iCurrentSlab < 3; iCurrentSlab++)
+			{
+				pMins[iCurrentSlab][uiCurrentBox] = rCurrentAABB.m_vec3Center[iCurrentSlab] - rCurrentAABB.m_vec3Radius[iCurrentSlab];
+				pMaxs[iCurrentSlab][uiCurrentBox] = rCurrentAABB.m_vec3Center[iCurrentSlab] + rCurrentAABB.m_vec3Radius[iCurrentSlab];
+			}
+		}
+
+		float pIntersectionDistances[4];
+		const uint32_t uiHitBoxes = IntersectRayFourMinMaxBoxes(rCastedRay, pMins[0], pMins[1], pMins[2], pMaxs[0], pMaxs[1], pMaxs[2], tResult.m_fIntersectionDistance, pIntersectionDistances);
+		if (uiHitBoxes == 0u)
+			continue;
+
+		// in order, so the first of several equally distant objects is kept, just like testing them one by one
+		for (size_t uiCurrentBox = 0u; uiCurrentBox < 4u; uiCurrentBox++)
+		{
+			if ((uiHitBoxes & (1u << uiCurrentBox)) && pIntersectionDistances[uiCurrentBox] < tResult.m_fIntersectionDistance)
+			{
+				tResult.m_fIntersectionDistance = pIntersectionDistances[uiCurrentBox];
+				tResult.m_vec3PointOfIntersection = rCastedRay.m_vec3Origin + rCastedRay.m_vec3Direction * pIntersectionDistances[uiCurrentBox];
+				tResult.m_pFirstIntersectedSceneObject = &rvecObjects[uiCurrentSceneObject + uiCurrentBox];
+			}
+		}
+	}
+
+	// the remaining objects one by one
+	for (; uiCurrentSceneObject < uiNumObjects; uiCurrentSceneObject++)
+	{
+		SceneObject& rCurrentSceneObject = rvecObjects[uiCurrentSceneObject];
+		glm::vec3 vec3CurrentPointOfIntersection;
+		float fCurrentIntersectionDistance = 0.0f;
+		if (IntersectRayAABB(rCastedRay, rCurrentSceneObject.m_tWorldSpaceAABB, fCurrentIntersectionDistance, vec3CurrentPointOfIntersection))
+		{
+			if (fCurrentIntersectionDistance < tResult.m_fIntersectionDistance)
+			{
+				tResult.m_fIntersectionDistance = fCurrentIntersectionDistance;
+				tResult.m_vec3PointOfIntersection = vec3CurrentPointOfIntersection;
+				tResult.m_pFirstIntersectedSceneObject = &rCurrentSceneObject;
+			}
+		}
+	}
+
+	return tResult;
+}
+
+size_t CollisionDetection::FindObjectsInFrustum(const LinearBVH & rBVH, const Frustum & rFrustum, SceneObject ** ppObjects, size_t uiMaxNumObjects)
+{
+	assert(ppObjects || uiMaxNumObjects == 0u);
+
+	size_t uiNumObjects = 0u;
+
+	if (rBVH.m_vecNodes.empty())
+		return uiNumObjects;
+
+	FindLinearBVHSubtreeObjectsInFrustum(rBVH, 0u, s_uiAllFrustumPlanesMask, rFrustum, ppObjects, uiMaxNumObjects, uiNumObjects);
+	return uiNumObjects;
+}
+
+bool CollisionDetection::QueryAABB(const LinearBVH & rBVH, const AABB & rAABB, ObjectQueryVisitor pVisitor, void * pUserData)
+{
+	assert(pVisitor);
+
+	if (rBVH.m_vecNodes.empty())
+		return true;
+
+	return QueryLinearBVHSubtree(rBVH, 0u, CreateMinMaxBox(rAABB), TestMinMaxBoxagainstMinMaxBox, pVisitor, pUserData);
+}
+
+bool CollisionDetection::QuerySphere(const LinearBVH & rBVH, const BoundingSphere & rSphere, ObjectQueryVisitor pVisitor, void * pUserData)
+{
+	assert(pVisitor);
+
+	if (rBVH.m_vecNodes.empty())
+		return true;
+
+	return QueryLinearBVHSubtree(rBVH, 0u, rSphere, TestMinMaxBoxagainstBoundingSphere, pVisitor, pUserData);
+}
+
+bool CollisionDetection::QueryPoint(const LinearBVH & rBVH, const glm::vec3 & rvec3Point, ObjectQueryVisitor pVisitor, void * pUserData)
+{
+	assert(pVisitor);
+
+	if (rBVH.m_vecNodes.empty())
+		return true;
+
+	return QueryLinearBVHSubtree(rBVH, 0u, rvec3Point, TestMinMaxBoxagainstPoint, pVisitor, pUserData);
+}
+
+bool CollisionDetection::QueryAABB(const DynamicAABBTree & rTree, SceneObject * pSceneObjects, const AABB & rAABB, ObjectQueryVisitor pVisitor, void * pUserData)
+{
+	assert(pVisitor);
+
+	if (rTree.GetRootNode() == DynamicAABBTree::s_iNullNode)
+		return true;
+
+	assert(pSceneObjects);
+	return QueryDynamicAABBTreeSubtree(rTree, rTree.GetRootNode(), pSceneObjects, CreateMinMaxBox(rAABB), TestMinMaxBoxagainstMinMaxBox, pVisitor, pUserData);
+}
+
+bool CollisionDetection::QuerySphere(const DynamicAABBTree & rTree, SceneObject * pSceneObjects, const BoundingSphere & rSphere, ObjectQueryVisitor pVisitor, void * pUserData)
+{
+	assert(pVisitor);
+
+	if (rTree.GetRootNode() == DynamicAABBTree::s_iNullNode)
+		return true;
+
+	assert(pSceneObjects);
+	return QueryDynamicAABBTreeSubtree(rTree, rTree.GetRootNode(), pSceneObjects, rSphere, TestMinMaxBoxagainstBoundingSphere, pVisitor, pUserData);
+}
+
+bool CollisionDetection::QueryPoint(const DynamicAABBTree & rTree, SceneObject * pSceneObjects, const glm::vec3 & rvec3Point, ObjectQueryVisitor pVisitor, void * pUserData)
+{
+	assert(pVisitor);
+
+	if (rTree.GetRootNode() == DynamicAABBTree::s_iNullNode)
+		return true;
+
+	assert(pSceneObjects);
+	return QueryDynamicAABBTreeSubtree(rTree, rTree.GetRootNode(), pSceneObjects, rvec3Point, TestMinMaxBoxagainstPoint, pVisitor, pUserData);
+}
+
+size_t CollisionDetection::QueryAABB(const LinearBVH & rBVH, const AABB & rAABB, SceneObject ** ppObjects, size_t uiMaxNumObjects)
+{
+	assert(ppObjects || uiMaxNumObjects == 0u);
+
+	ObjectQueryOutput tOutput = { ppObjects, uiMaxNumObjects, 0u };
+	QueryAABB(rBVH, rAABB, AddObjectToQueryOutput, &tOutput);
+	return tOutput.m_uiNumObjects;
+}
+
+size_t CollisionDetection::QuerySphere(const LinearBVH & rBVH, const BoundingSphere & rSphere, SceneObject ** ppObjects, size_t uiMaxNumObjects)
+{
+	assert(ppObjects || uiMaxNumObjects == 0u);
+
+	ObjectQueryOutput tOutput = { ppObjects, uiMaxNumObjects, 0u };
+	QuerySphere(rBVH, rSphere, AddObjectToQueryOutput, &tOutput);
+	return tOutput.m_uiNumObjects;
+}
+
+size_t CollisionDetection::QueryPoint(const LinearBVH & rBVH, const glm::vec3 & rvec3Point, SceneObject ** ppObjects, size_t uiMaxNumObjects)
+{
+	assert(ppObjects || uiMaxNumObjects == 0u);
+
+	ObjectQueryOutput tOutput = { ppObjects, uiMaxNumObjects, 0u };
+	QueryPoint(rBVH, rvec3Point, AddObjectToQueryOutput, &tOutput);
+	return tOutput.m_uiNumObjects;
+}
+
+size_t CollisionDetection::QueryAABB(const DynamicAABBTree & rTree, SceneObject * pSceneObjects, const AABB & rAABB, SceneObject ** ppObjects, size_t uiMaxNumObjects)
+{
+	assert(ppObjects || uiMaxNumObjects == 0u);
+
+	ObjectQueryOutput tOutput = { ppObjects, uiMaxNumObjects, 0u };
+	QueryAABB(rTree, pSceneObjects, rAABB, AddObjectToQueryOutput, &tOutput);
+	return tOutput.m_uiNumObjects;
+}
+
+size_t CollisionDetection::QuerySphere(const DynamicAABBTree & rTree, SceneObject * pSceneObjects, const BoundingSphere & rSphere, SceneObject ** ppObjects, size_t uiMaxNumObjects)
+{
+	assert(ppObjects || uiMaxNumObjects == 0u);
+
+	ObjectQueryOutput tOutput = { ppObjects, uiMaxNumObjects, 0u };
+	QuerySphere(rTree, pSceneObjects, rSphere, AddObjectToQueryOutput, &tOutput);
+	return tOutput.m_uiNumObjects;
+}
+
+size_t CollisionDetection::QueryPoint(const DynamicAABBTree & rTree, SceneObject * pSceneObjects, const glm::vec3 & rvec3Point, SceneObject ** ppObjects, size_t uiMaxNumObjects)
+{
+	assert(ppObjects || uiMaxNumObjects == 0u);
+
+	ObjectQueryOutput tOutput = { ppObjects, uiMaxNumObjects, 0u };
+	QueryPoint(rTree, pSceneObjects, rvec3Point, AddObjectToQueryOutput, &tOutput);
+	return tOutput.m_uiNumObjects;
+}
+
+size_t CollisionDetection::FindNearestObjects_AABB(const BoundingVolumeHierarchy & rBVH, const glm::vec3 & rvec3Point, size_t uiMaxNumObjects, float fMaxDistance, NearestObject * pNearestObjects)
+{
+	return FindNearestObjectsInBVH(rBVH, rvec3Point, uiMaxNumObjects, fMaxDistance, &BVHTreeNode::m_tAABBForNode, &SceneObject::m_tWorldSpaceAABB, CalcDistancePointAABB, pNearestObjects);
+}
+
+size_t CollisionDetection::FindNearestObjects_BoundingSphere(const BoundingVolumeHierarchy & rBVH, const glm::vec3 & rvec3Point, size_t uiMaxNumObjects, float fMaxDistance, NearestObject * pNearestObjects)
+{
+	return FindNearestObjectsInBVH(rBVH, rvec3Point, uiMaxNumObjects, fMaxDistance, &BVHTreeNode::m_tBoundingSphereForNode, &SceneObject::m_tWorldSpaceBoundingSphere, CalcDistancePointBoundingSphere, pNearestObjects);
+}
+
+NearestObject CollisionDetection::FindClosestObject_AABB(const BoundingVolumeHierarchy & rBVH, const glm::vec3 & rvec3Point, float fMaxDistance)
+{
+	NearestObject tResult;
+	FindNearestObjects_AABB(rBVH, rvec3Point, 1u, fMaxDistance, &tResult);
+	return tResult;
+}
+
+NearestObject CollisionDetection::FindClosestObject_BoundingSphere(const BoundingVolumeHierarchy & rBVH, const glm::vec3 & rvec3Point, float fMaxDistance)
+{
+	NearestObject tResult;
+	FindNearestObjects_BoundingSphere(rBVH, rvec3Point, 1u, fMaxDistance, &tResult);
+	return tResult;
+}
+
+TimeOfImpactResult CollisionDetection::CastAABBIntoBVH(const BoundingVolumeHierarchy & rBVH, const AABB & rMovingAABB, const glm::vec3 & rvec3Displacement, const SceneObject * pIgnoredObject)
+{
+	return CastSweptVolumeIntoBVH(rBVH, rMovingAABB, rvec3Displacement, pIgnoredObject, &BVHTreeNode::m_tAABBForNode, &SceneObject::m_tWorldSpaceAABB, CalcTimeOfImpactAABBagainstAABB);
+}
+
+TimeOfImpactResult CollisionDetection::CastBoundingSphereIntoBVH(const BoundingVolumeHierarchy & rBVH, const BoundingSphere & rMovingBoundingSphere, const glm::vec3 & rvec3Displacement, const SceneObject * pIgnoredObject)
+{
+	return CastSweptVolumeIntoBVH(rBVH, rMovingBoundingSphere, rvec3Displacement, pIgnoredObject, &BVHTreeNode::m_tBoundingSphereForNode, &SceneObject::m_tWorldSpaceBoundingSphere, CalcTimeOfImpactBoundingSphereagainstBoundingSphere);
+}
+
+size_t CollisionDetection::FindOverlappingObjectPairs_AABB(const BoundingVolumeHierarchy & rBVH, ObjectPair * pPairs, size_t uiMaxNumPairs, TaskPool * pTaskPool)
+{
+	return FindOverlappingObjectPairs(rBVH, nullptr, &BVHTreeNode::m_tAABBForNode, &SceneObject::m_tWorldSpaceAABB, &StaticTestAABBagainstAABB, pPairs, uiMaxNumPairs, pTaskPool);
+}
+
+size_t CollisionDetection::FindOverlappingObjectPairs_BoundingSphere(const BoundingVolumeHierarchy & rBVH, ObjectPair * pPairs, size_t uiMaxNumPairs, TaskPool * pTaskPool)
+{
+	return FindOverlappingObjectPairs(rBVH, nullptr, &BVHTreeNode::m_tBoundingSphereForNode, &SceneObject::m_tWorldSpaceBoundingSphere, &StaticTestBoundingSphereagainstBoundingSphere, pPairs, uiMaxNumPairs, pTaskPool);
+}
+
+size_t CollisionDetection::FindOverlappingObjectPairs_SweptAABB(const BoundingVolumeHierarchy & rBVH, ObjectPair * pPairs, size_t uiMaxNumPairs, TaskPool * pTaskPool)
+{
+	return FindOverlappingObjectPairs(rBVH, nullptr, &BVHTreeNode::m_tAABBForNode, &SceneObject::m_tSweptWorldSpaceAABB, &StaticTestAABBagainstAABB, pPairs, uiMaxNumPairs, pTaskPool);
+}
+
+size_t CollisionDetection::FindOverlappingObjectPairs_AABB(const BoundingVolumeHierarchy & rBVH, const BoundingVolumeHierarchy & rOtherBVH, ObjectPair * pPairs, size_t uiMaxNumPairs, TaskPool * pTaskPool)
+{
+	return FindOverlappingObjectPairs(rBVH, &rOtherBVH, &BVHTreeNode::m_tAABBForNode, &SceneObject::m_tWorldSpaceAABB, &StaticTestAABBagainstAABB, pPairs, uiMaxNumPairs, pTaskPool);
+}
+
+size_t CollisionDetection::FindOverlappingObjectPairs_BoundingSphere(const BoundingVolumeHierarchy & rBVH, const BoundingVolumeHierarchy & rOtherBVH, ObjectPair * pPairs, size_t uiMaxNumPairs, TaskPool * pTaskPool)
+{
+	return FindOverlappingObjectPairs(rBVH, &rOtherBVH, &BVHTreeNode::m_tBoundingSphereForNode, &SceneObject::m_tWorldSpaceBoundingSphere, &StaticTestBoundingSphereagainstBoundingSphere, pPairs, uiMaxNumPairs, pTaskPool);
+}
+
+size_t CollisionDetection::BruteForceOverlappingObjectPairs(std::vector<SceneObject>& rvecObjects, ObjectPair * pPairs, size_t uiMaxNumPairs)
+{
+	assert(pPairs || uiMaxNumPairs == 0u);
+
+	size_t uiNumPairs = 0u;
+	for (size_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < rvecObjects.size(); uiCurrentSceneObject++)
+	{
+		for (size_t uiOtherSceneObject = uiCurrentSceneObject + 1u; uiOtherSceneObject < rvecObjects.size(); uiOtherSceneObject++)
+		{
+			if (!StaticTestAABBagainstAABB(rvecObjects[uiCurrentSceneObject].m_tWorldSpaceAABB, rvecObjects[uiOtherSceneObject].m_tWorldSpaceAABB))
+				continue;
+
+			if (uiNumPairs < uiMaxNumPairs)
+			{
+				pPairs[uiNumPairs].m_pObject = &rvecObjects[uiCurrentSceneObject];
+				pPairs[uiNumPairs].m_pOtherObject = &rvecObjects[uiOtherSceneObject];
+			}
+			uiNumPairs++;
+		}
+	}
+
+	return uiNumPairs;
+}
+
+constexpr uint32_t CollisionDetection::SweepAndPrune::s_uiNotInserted;
+
+CollisionDetection::SweepAndPrune::SweepAndPrune() :
+	m_pvecEndpoints(),
+	m_vecEndpointsOfObject(),
+	m_setOverlappingPairs(),
+	m_uiNumObjects(0u)
+{
+}
+
+void CollisionDetection::SweepAndPrune::Build(const SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+{
+	assert(pSceneObjects || uiNumSceneObjects == 0u);
+
+	Clear();
+	m_vecEndpointsOfObject.resize(uiNumSceneObjects);
+	m_uiNumObjects = uiNumSceneObjects;
+
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		std::vector<Endpoint>& rvecEndpoints = m_pvecEndpoints[uiCurrentAxis];
+		rvecEndpoints.resize(2u * uiNumSceneObjects);
+
+		for (uint32_t uiCurrentObject = 0u; uiCurrentObject < uiNumSceneObjects; uiCurrentObject++)
+		{
+			const AABB& rAABB = pSceneObjects[uiCurrentObject].m_tWorldSpaceAABB;
+
+			rvecEndpoints[2u * uiCurrentObject].m_fValue = rAABB.CalcMinimumForAxis(uiCurrentAxis);
+			rvecEndpoints[2u * uiCurrentObject].m_uiObjectIndex = uiCurrentObject;
+			rvecEndpoints[2u * uiCurrentObject].m_bIsMinimum = true;
+			rvecEndpoints[2u * uiCurrentObject + 1u].m_fValue = rAABB.CalcMaximumForAxis(uiCurrentAxis);
+			rvecEndpoints[2u * uiCurrentObject + 1u].m_uiObjectIndex = uiCurrentObject;
+			rvecEndpoints[2u * uiCurrentObject + 1u].m_bIsMinimum = false;
+		}
+
+		std::sort(rvecEndpoints.begin(), rvecEndpoints.end(), IsEndpointLess);
+
+		for (uint32_t uiCurrentEndpoint = 0u; uiCurrentEndpoint < rvecEndpoints.size(); uiCurrentEndpoint++)
+			GetEndpointPosition(rvecEndpoints[uiCurrentEndpoint], uiCurrentAxis) = uiCurrentEndpoint;
+	}
+
+	// sweep along x: every object whose interval was opened but not closed yet overlaps the next opened one on this axis
+	std::vector<uint32_t> vecOpenObjects;
+	std::vector<uint32_t> vecPositionInOpenObjects(uiNumSceneObjects);
+	for (const Endpoint& rCurrentEndpoint : m_pvecEndpoints[0])
+	{
+		if (rCurrentEndpoint.m_bIsMinimum)
+		{
+			for (uint32_t uiOpenObject : vecOpenObjects)
+			{
+				if (AreOverlapping(uiOpenObject, rCurrentEndpoint.m_uiObjectIndex))
+					m_setOverlappingPairs.insert(CreatePairKey(uiOpenObject, rCurrentEndpoint.m_uiObjectIndex));
+			}
+
+			vecPositionInOpenObjects[rCurrentEndpoint.m_uiObjectIndex] = static_cast<uint32_t>(vecOpenObjects.size());
+			vecOpenObjects.push_back(rCurrentEndpoint.m_uiObjectIndex);
+		}
+		else
+		{
+			const uint32_t uiPosition = vecPositionInOpenObjects[rCurrentEndpoint.m_uiObjectIndex];
+			vecOpenObjects[uiPosition] = vecOpenObjects.back();
+			vecPositionInOpenObjects[vecOpenObjects[uiPosition]] = uiPosition;
+			vecOpenObjects.pop_back();
+		}
+	}
+}
+
+void CollisionDetection::SweepAndPrune::InsertObject(const SceneObject * pSceneObjects, uint32_t uiObjectIndex)
+{
+	assert(pSceneObjects);
+
+	if (uiObjectIndex >= m_vecEndpointsOfObject.size())
+		m_vecEndpointsOfObject.resize(uiObjectIndex + 1u);
+	assert(m_vecEndpointsOfObject[uiObjectIndex].m_pMinimumEndpoint[0] == s_uiNotInserted);	// every object can only be inserted once
+
+	// all endpoints have to be in place before the first swap tests the object for overlaps on every axis
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		std::vector<Endpoint>& rvecEndpoints = m_pvecEndpoints[uiCurrentAxis];
+
+		Endpoint tNewEndpoint;
+		tNewEndpoint.m_uiObjectIndex = uiObjectIndex;
+
+		tNewEndpoint.m_bIsMinimum = true;
+		m_vecEndpointsOfObject[uiObjectIndex].m_pMinimumEndpoint[uiCurrentAxis] = static_cast<uint32_t>(rvecEndpoints.size());
+		rvecEndpoints.push_back(tNewEndpoint);
+
+		tNewEndpoint.m_bIsMinimum = false;
+		m_vecEndpointsOfObject[uiObjectIndex].m_pMaximumEndpoint[uiCurrentAxis] = static_cast<uint32_t>(rvecEndpoints.size());
+		rvecEndpoints.push_back(tNewEndpoint);
+	}
+	SetEndpointValues(pSceneObjects, uiObjectIndex);
+	m_uiNumObjects++;
+
+	// the minimum passes the maxima of all objects to its right, starting an overlap with each. The maximum ends those that lie beyond it again
+	const ObjectEndpoints& rObjectEndpoints = m_vecEndpointsOfObject[uiObjectIndex];
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		SortEndpointDown(uiCurrentAxis, rObjectEndpoints.m_pMinimumEndpoint[uiCurrentAxis]);
+		SortEndpointDown(uiCurrentAxis, rObjectEndpoints.m_pMaximumEndpoint[uiCurrentAxis]);
+	}
+}
+
+void CollisionDetection::SweepAndPrune::RemoveObject(uint32_t uiObjectIndex)
+{
+	assert(uiObjectIndex < m_vecEndpointsOfObject.size());
+	const ObjectEndpoints& rObjectEndpoints = m_vecEndpointsOfObject[uiObjectIndex];
+	assert(rObjectEndpoints.m_pMinimumEndpoint[0] != s_uiNotInserted);	// the object has to be in the lists
+
+	// moving the endpoints to the very end ends every overlap of the object on the way
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		m_pvecEndpoints[uiCurrentAxis][rObjectEndpoints.m_pMinimumEndpoint[uiCurrentAxis]].m_fValue = std::numeric_limits<float>::infinity();
+		m_pvecEndpoints[uiCurrentAxis][rObjectEndpoints.m_pMaximumEndpoint[uiCurrentAxis]].m_fValue = std::numeric_limits<float>::infinity();
+	}
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		SortEndpointUp(uiCurrentAxis, rObjectEndpoints.m_pMaximumEndpoint[uiCurrentAxis]);
+		SortEndpointUp(uiCurrentAxis, rObjectEndpoints.m_pMinimumEndpoint[uiCurrentAxis]);
+
+		assert(rObjectEndpoints.m_pMaximumEndpoint[uiCurrentAxis] + 1u == m_pvecEndpoints[uiCurrentAxis].size());
+		m_pvecEndpoints[uiCurrentAxis].pop_back();
+		m_pvecEndpoints[uiCurrentAxis].pop_back();
+	}
+
+	m_vecEndpointsOfObject[uiObjectIndex] = ObjectEndpoints();
+	m_uiNumObjects--;
+}
+
+size_t CollisionDetection::SweepAndPrune::UpdateObject(const SceneObject * pSceneObjects, uint32_t uiObjectIndex)
+{
+	assert(pSceneObjects);
+	assert(uiObjectIndex < m_vecEndpointsOfObject.size());
+	const ObjectEndpoints& rObjectEndpoints = m_vecEndpointsOfObject[uiObjectIndex];
+	assert(rObjectEndpoints.m_pMinimumEndpoint[0] != s_uiNotInserted);	// the object has to be in the lists
+
+	SetEndpointValues(pSceneObjects, uiObjectIndex);
+
+	// an endpoint only ever moves in one direction, the other sort does not swap anything
+	size_t uiNumSwaps = 0u;
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		uiNumSwaps += SortEndpointDown(uiCurrentAxis, rObjectEndpoints.m_pMinimumEndpoint[uiCurrentAxis]);
+		uiNumSwaps += SortEndpointDown(uiCurrentAxis, rObjectEndpoints.m_pMaximumEndpoint[uiCurrentAxis]);
+		uiNumSwaps += SortEndpointUp(uiCurrentAxis, rObjectEndpoints.m_pMaximumEndpoint[uiCurrentAxis]);
+		uiNumSwaps += SortEndpointUp(uiCurrentAxis, rObjectEndpoints.m_pMinimumEndpoint[uiCurrentAxis]);
+	}
+
+	return uiNumSwaps;
+}
+
+void CollisionDetection::SweepAndPrune::ChangeObjectIndex(uint32_t uiOldObjectIndex, uint32_t uiNewObjectIndex)
+{
+	assert(uiOldObjectIndex < m_vecEndpointsOfObject.size());
+	assert(m_vecEndpointsOfObject[uiOldObjectIndex].m_pMinimumEndpoint[0] != s_uiNotInserted);
+
+	if (uiNewObjectIndex >= m_vecEndpointsOfObject.size())
+		m_vecEndpointsOfObject.resize(uiNewObjectIndex + 1u);
+	assert(m_vecEndpointsOfObject[uiNewObjectIndex].m_pMinimumEndpoint[0] == s_uiNotInserted);	// the new index must not be taken by another object
+
+	m_vecEndpointsOfObject[uiNewObjectIndex] = m_vecEndpointsOfObject[uiOldObjectIndex];
+	m_vecEndpointsOfObject[uiOldObjectIndex] = ObjectEndpoints();
+
+	const ObjectEndpoints& rObjectEndpoints = m_vecEndpointsOfObject[uiNewObjectIndex];
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		m_pvecEndpoints[uiCurrentAxis][rObjectEndpoints.m_pMinimumEndpoint[uiCurrentAxis]].m_uiObjectIndex = uiNewObjectIndex;
+		m_pvecEndpoints[uiCurrentAxis][rObjectEndpoints.m_pMaximumEndpoint[uiCurrentAxis]].m_uiObjectIndex = uiNewObjectIndex;
+	}
+
+	// the index is part of the pairs' keys
+	std::vector<uint32_t> vecPairedObjects;
+	for (auto tIterator = m_setOverlappingPairs.begin(); tIterator != m_setOverlappingPairs.end();)
+	{
+		const uint32_t uiObjectIndex = static_cast<uint32_t>(*tIterator >> 32u);
+		const uint32_t uiOtherObjectIndex = static_cast<uint32_t>(*tIterator);
+
+		if (uiObjectIndex == uiOldObjectIndex || uiOtherObjectIndex == uiOldObjectIndex)
+		{
+			vecPairedObjects.push_back(uiObjectIndex == uiOldObjectIndex ? uiOtherObjectIndex : uiObjectIndex);
+			tIterator = m_setOverlappingPairs.erase(tIterator);
+		}
+		else
+			++tIterator;
+	}
+	for (uint32_t uiPairedObject : vecPairedObjects)
+		m_setOverlappingPairs.insert(CreatePairKey(uiNewObjectIndex, uiPairedObject));
+}
+
+void CollisionDetection::SweepAndPrune::Clear()
+{
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+		m_pvecEndpoints[uiCurrentAxis].clear();
+	m_vecEndpointsOfObject.clear();
+	m_setOverlappingPairs.clear();
+	m_uiNumObjects = 0u;
+}
+
+size_t CollisionDetection::SweepAndPrune::GetOverlappingObjectPairs(SceneObject * pSceneObjects, ObjectPair * pPairs, size_t uiMaxNumPairs) const
+{
+	assert(pSceneObjects || m_setOverlappingPairs.empty());
+	assert(pPairs || uiMaxNumPairs == 0u);
+
+	size_t uiNumPairs = 0u;
+	for (uint64_t uiCurrentPair : m_setOverlappingPairs)
+	{
+		if (uiNumPairs == uiMaxNumPairs)
+			break;
+
+		pPairs[uiNumPairs].m_pObject = &pSceneObjects[uiCurrentPair >> 32u];
+		pPairs[uiNumPairs].m_pOtherObject = &pSceneObjects[uiCurrentPair & 0xFFFFFFFFu];
+		uiNumPairs++;
+	}
+
+	return m_setOverlappingPairs.size();
+}
+
+const std::vector<CollisionDetection::SweepAndPrune::Endpoint>& CollisionDetection::SweepAndPrune::GetEndpoints(size_t uiAxisIndex) const
+{
+	assert(uiAxisIndex < 3u);
+	return m_pvecEndpoints[uiAxisIndex];
+}
+
+uint64_t CollisionDetection::SweepAndPrune::CreatePairKey(uint32_t uiObjectIndex, uint32_t uiOtherObjectIndex)
+{
+	assert(uiObjectIndex != uiOtherObjectIndex);
+
+	if (uiObjectIndex > uiOtherObjectIndex)
+		std::swap(uiObjectIndex, uiOtherObjectIndex);
+	return (static_cast<uint64_t>(uiObjectIndex) << 32u) | uiOtherObjectIndex;
+}
+
+bool CollisionDetection::SweepAndPrune::IsEndpointLess(const Endpoint & rEndpoint, const Endpoint & rOtherEndpoint)
+{
+	if (rEndpoint.m_fValue != rOtherEndpoint.m_fValue)
+		return rEndpoint.m_fValue < rOtherEndpoint.m_fValue;
+	return rEndpoint.m_bIsMinimum && !rOtherEndpoint.m_bIsMinimum;
+}
+
+bool CollisionDetection::SweepAndPrune::AreOverlapping(uint32_t uiObjectIndex, uint32_t uiOtherObjectIndex) const
+{
+	const ObjectEndpoints& rObjectEndpoints = m_vecEndpointsOfObject[uiObjectIndex];
+	const ObjectEndpoints& rOtherObjectEndpoints = m_vecEndpointsOfObject[uiOtherObjectIndex];
+
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		const std::vector<Endpoint>& rvecEndpoints = m_pvecEndpoints[uiCurrentAxis];
+
+		if (rvecEndpoints[rObjectEndpoints.m_pMinimumEndpoint[uiCurrentAxis]].m_fValue > rvecEndpoints[rOtherObjectEndpoints.m_pMaximumEndpoint[uiCurrentAxis]].m_fValue)
+			return false;
+		if (rvecEndpoints[rOtherObjectEndpoints.m_pMinimumEndpoint[uiCurrentAxis]].m_fValue > rvecEndpoints[rObjectEndpoints.m_pMaximumEndpoint[uiCurrentAxis]].m_fValue)
+			return false;
+	}
+
+	return true;
+}
+
+void CollisionDetection::SweepAndPrune::SetEndpointValues(const SceneObject * pSceneObjects, uint32_t uiObjectIndex)
+{
+	const AABB& rAABB = pSceneObjects[uiObjectIndex].m_tWorldSpaceAABB;
+	const ObjectEndpoints& rObjectEndpoints = m_vecEndpointsOfObject[uiObjectIndex];
+
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		m_pvecEndpoints[uiCurrentAxis][rObjectEndpoints.m_pMinimumEndpoint[uiCurrentAxis]].m_fValue = rAABB.CalcMinimumForAxis(uiCurrentAxis);
+		m_pvecEndpoints[uiCurrentAxis][rObjectEndpoints.m_pMaximumEndpoint[uiCurrentAxis]].m_fValue = rAABB.CalcMaximumForAxis(uiCurrentAxis);
+	}
+}
+
+void CollisionDetection::SweepAndPrune::SwapEndpointWithNext(size_t uiAxisIndex, uint32_t uiEndpoint)
+{
+	std::vector<Endpoint>& rvecEndpoints = m_pvecEndpoints[uiAxisIndex];
+	assert(uiEndpoint + 1u < rvecEndpoints.size());
+
+	std::swap(rvecEndpoints[uiEndpoint], rvecEndpoints[uiEndpoint + 1u]);
+	GetEndpointPosition(rvecEndpoints[uiEndpoint], uiAxisIndex) = uiEndpoint;
+	GetEndpointPosition(rvecEndpoints[uiEndpoint + 1u], uiAxisIndex) = uiEndpoint + 1u;
+
+	const Endpoint& rLeftEndpoint = rvecEndpoints[uiEndpoint];
+	const Endpoint& rRightEndpoint = rvecEndpoints[uiEndpoint + 1u];
+	if (rLeftEndpoint.m_bIsMinimum == rRightEndpoint.m_bIsMinimum || rLeftEndpoint.m_uiObjectIndex == rRightEndpoint.m_uiObjectIndex)
+		return;
+
+	// a minimum moved in front of a maximum: the two intervals overlap now, but the objects might still be apart on the other axes
+	if (rLeftEndpoint.m_bIsMinimum)
+	{
+		if (AreOverlapping(rLeftEndpoint.m_uiObjectIndex, rRightEndpoint.m_uiObjectIndex))
+			m_setOverlappingPairs.insert(CreatePairKey(rLeftEndpoint.m_uiObjectIndex, rRightEndpoint.m_uiObjectIndex));
+	}
+	// a maximum moved in front of a minimum: the intervals are apart
+	else
+		m_setOverlappingPairs.erase(CreatePairKey(rLeftEndpoint.m_uiObjectIndex, rRightEndpoint.m_uiObjectIndex));
+}
+
+size_t CollisionDetection::SweepAndPrune::SortEndpointDown(size_t uiAxisIndex, uint32_t uiEndpoint)
+{
+	const std::vector<Endpoint>& rvecEndpoints = m_pvecEndpoints[uiAxisIndex];
+
+	size_t uiNumSwaps = 0u;
+	while (uiEndpoint > 0u && IsEndpointLess(rvecEndpoints[uiEndpoint], rvecEndpoints[uiEndpoint - 1u]))
+	{
+		SwapEndpointWithNext(uiAxisIndex, uiEndpoint - 1u);
+		uiEndpoint--;
+		uiNumSwaps++;
+	}
+
+	return uiNumSwaps;
+}
+
+size_t CollisionDetection::SweepAndPrune::SortEndpointUp(size_t uiAxisIndex, uint32_t uiEndpoint)
+{
+	const std::vector<Endpoint>& rvecEndpoints = m_pvecEndpoints[uiAxisIndex];
+
+	size_t uiNumSwaps = 0u;
+	while (uiEndpoint + 1u < rvecEndpoints.size() && IsEndpointLess(rvecEndpoints[uiEndpoint + 1u], rvecEndpoints[uiEndpoint]))
+	{
+		SwapEndpointWithNext(uiAxisIndex, uiEndpoint);
+		uiEndpoint++;
+		uiNumSwaps++;
+	}
+
+	return uiNumSwaps;
+}
+
+uint32_t & CollisionDetection::SweepAndPrune::GetEndpointPosition(const Endpoint & rEndpoint, size_t uiAxisIndex)
+{
+	ObjectEndpoints& rObjectEndpoints = m_vecEndpointsOfObject[rEndpoint.m_uiObjectIndex];
+	return rEndpoint.m_bIsMinimum ? rObjectEndpoints.m_pMinimumEndpoint[uiAxisIndex] : rObjectEndpoints.m_pMaximumEndpoint[uiAxisIndex];
+}
+
+CollisionDetection::SpatialHashGrid::SpatialHashGrid() :
+	m_mapCells(),
+	m_vecCellsOfObject(),
+	m_tOccupiedCells(),
+	m_fCellSize(1.0f),
+	m_fInverseCellSize(1.0f),
+	m_uiNumObjects(0u)
+{
+}
+
+void CollisionDetection::SpatialHashGrid::Build(const SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+{
+	assert(pSceneObjects || uiNumSceneObjects == 0u);
+	assert(uiNumSceneObjects <= std::numeric_limits<uint32_t>::max());
+
+	Clear();
+	if (uiNumSceneObjects == 0u)
+		return;
+
+	SetCellSize(CalcCellSizeForObjects(pSceneObjects, uiNumSceneObjects));
+	m_mapCells.reserve(uiNumSceneObjects * 2u);
+	m_vecCellsOfObject.resize(uiNumSceneObjects);
+
+	for (uint32_t uiCurrentObject = 0u; uiCurrentObject < uiNumSceneObjects; uiCurrentObject++)
+		InsertObject(pSceneObjects, uiCurrentObject);
+}
+
+void CollisionDetection::SpatialHashGrid::InsertObject(const SceneObject * pSceneObjects, uint32_t uiObjectIndex)
+{
+	assert(pSceneObjects);
+
+	if (uiObjectIndex >= m_vecCellsOfObject.size())
+		m_vecCellsOfObject.resize(uiObjectIndex + 1u);
+	ObjectCells& rObjectCells = m_vecCellsOfObject[uiObjectIndex];
+	assert(!rObjectCells.m_bIsInserted);	// every object can only be inserted once
+
+	rObjectCells.m_tCellRange = CalcCellRange(pSceneObjects[uiObjectIndex].m_tWorldSpaceAABB);
+	rObjectCells.m_bIsInserted = true;
+	AddObjectToCells(uiObjectIndex, rObjectCells.m_tCellRange);
+	m_uiNumObjects++;
+}
+
+void CollisionDetection::SpatialHashGrid::RemoveObject(uint32_t uiObjectIndex)
+{
+	assert(uiObjectIndex < m_vecCellsOfObject.size());
+	ObjectCells& rObjectCells = m_vecCellsOfObject[uiObjectIndex];
+	assert(rObjectCells.m_bIsInserted);	// the object has to be in the grid
+
+	RemoveObjectFromCells(uiObjectIndex, rObjectCells.m_tCellRange);
+	rObjectCells = ObjectCells();
+	m_uiNumObjects--;
+}
+
+bool CollisionDetection::SpatialHashGrid::UpdateObject(const SceneObject * pSceneObjects, uint32_t uiObjectIndex)
+{
+	assert(pSceneObjects);
+	assert(uiObjectIndex < m_vecCellsOfObject.size());
+	ObjectCells& rObjectCells = m_vecCellsOfObject[uiObjectIndex];
+	assert(rObjectCells.m_bIsInserted);	// the object has to be in the grid
+
+	// most of the time, an object that moved a little still touches the very same cells
+	const CellRange tNewCellRange = CalcCellRange(pSceneObjects[uiObjectIndex].m_tWorldSpaceAABB);
+	if (std::equal(tNewCellRange.m_pMinimumCell, tNewCellRange.m_pMinimumCell + 3, rObjectCells.m_tCellRange.m_pMinimumCell) &&
+		std::equal(tNewCellRange.m_pMaximumCell, tNewCellRange.m_pMaximumCell + 3, rObjectCells.m_tCellRange.m_pMaximumCell))
+		return false;
+
+	RemoveObjectFromCells(uiObjectIndex, rObjectCells.m_tCellRange);
+	rObjectCells.m_tCellRange = tNewCellRange;
+	AddObjectToCells(uiObjectIndex, rObjectCells.m_tCellRange);
+
+	return true;
+}
+
+void CollisionDetection::SpatialHashGrid::ChangeObjectIndex(uint32_t uiOldObjectIndex, uint32_t uiNewObjectIndex)
+{
+	assert(uiOldObjectIndex < m_vecCellsOfObject.size());
+	assert(m_vecCellsOfObject[uiOldObjectIndex].m_bIsInserted);
+
+	if (uiNewObjectIndex >= m_vecCellsOfObject.size())
+		m_vecCellsOfObject.resize(uiNewObjectIndex + 1u);
+	assert(!m_vecCellsOfObject[uiNewObjectIndex].m_bIsInserted);	// the new index must not be taken by another object
+
+	m_vecCellsOfObject[uiNewObjectIndex] = m_vecCellsOfObject[uiOldObjectIndex];
+	m_vecCellsOfObject[uiOldObjectIndex] = ObjectCells();
+
+	const CellRange& rCellRange = m_vecCellsOfObject[uiNewObjectIndex].m_tCellRange;
+	for (int32_t iCellZ = rCellRange.m_pMinimumCell[2]; iCellZ <= rCellRange.m_pMaximumCell[2]; iCellZ++)
+	{
+		for (int32_t iCellY = rCellRange.m_pMinimumCell[1]; iCellY <= rCellRange.m_pMaximumCell[1]; iCellY++)
+		{
+			for (int32_t iCellX = rCellRange.m_pMinimumCell[0]; iCellX <= rCellRange.m_pMaximumCell[0]; iCellX++)
+			{
+				std::vector<uint32_t>& rvecCellObjects = m_mapCells[CreateCellKey(iCellX, iCellY, iCellZ)];
+				std::replace(rvecCellObjects.begin(), rvecCellObjects.end(), uiOldObjectIndex, uiNewObjectIndex);
+			}
+		}
+	}
+}
+
+void CollisionDetection::SpatialHashGrid::Clear()
+{
+	m_mapCells.clear();
+	m_vecCellsOfObject.clear();
+	m_tOccupiedCells = CellRange();
+	m_uiNumObjects = 0u;
+}
+
+void CollisionDetection::SpatialHashGrid::SetCellSize(float fCellSize)
+{
+	assert(fCellSize > 0.0f);
+	assert(m_uiNumObjects == 0u);	// the cells of the objects would not fit anymore
+
+	m_fCellSize = fCellSize;
+	m_fInverseCellSize = 1.0f / fCellSize;
+}
+
+size_t CollisionDetection::SpatialHashGrid::FindOverlappingObjectPairs(SceneObject * pSceneObjects, ObjectPair * pPairs, size_t uiMaxNumPairs) const
+{
+	assert(pSceneObjects || m_uiNumObjects == 0u);
+	assert(pPairs || uiMaxNumPairs == 0u);
+
+	size_t uiNumPairs = 0u;
+	for (const std::pair<const uint64_t, std::vector<uint32_t>>& rCurrentCell : m_mapCells)
+	{
+		const std::vector<uint32_t>& rvecCellObjects = rCurrentCell.second;
+		for (size_t uiCurrentObject = 0u; uiCurrentObject < rvecCellObjects.size(); uiCurrentObject++)
+		{
+			const uint32_t uiObjectIndex = rvecCellObjects[uiCurrentObject];
+			const CellRange& rCellRange = m_vecCellsOfObject[uiObjectIndex].m_tCellRange;
+
+			for (size_t uiOtherObject = uiCurrentObject + 1u; uiOtherObject < rvecCellObjects.size(); uiOtherObject++)
+			{
+				const uint32_t uiOtherObjectIndex = rvecCellObjects[uiOtherObject];
+				const CellRange& rOtherCellRange = m_vecCellsOfObject[uiOtherObjectIndex].m_tCellRange;
+
+				// the first cell both objects touch is where their pair is reported
+				const uint64_t uiFirstSharedCell = CreateCellKey(std::max(rCellRange.m_pMinimumCell[0], rOtherCellRange.m_pMinimumCell[0]),
+					std::max(rCellRange.m_pMinimumCell[1], rOtherCellRange.m_pMinimumCell[1]), std::max(rCellRange.m_pMinimumCell[2], rOtherCellRange.m_pMinimumCell[2]));
+				if (uiFirstSharedCell != rCurrentCell.first)
+					continue;
+
+				if (!StaticTestAABBagainstAABB(pSceneObjects[uiObjectIndex].m_tWorldSpaceAABB, pSceneObjects[uiOtherObjectIndex].m_tWorldSpaceAABB))
+					continue;
+
+				if (uiNumPairs < uiMaxNumPairs)
+				{
+					pPairs[uiNumPairs].m_pObject = &pSceneObjects[uiObjectIndex];
+					pPairs[uiNumPairs].m_pOtherObject = &pSceneObjects[uiOtherObjectIndex];
+				}
+				uiNumPairs++;
+			}
+		}
+	}
+
+	return uiNumPairs;
+}
+
+const std::vector<uint32_t>* CollisionDetection::SpatialHashGrid::GetObjectsInCell(const int32_t * pCell) const
+{
+	const std::unordered_map<uint64_t, std::vector<uint32_t>>::const_iterator tCell = m_mapCells.find(CreateCellKey(pCell[0], pCell[1], pCell[2]));
+	return (tCell != m_mapCells.end()) ? &tCell->second : nullptr;
+}
+
+const CollisionDetection::SpatialHashGrid::CellRange & CollisionDetection::SpatialHashGrid::GetCellRangeOfObject(uint32_t uiObjectIndex) const
+{
+	assert(uiObjectIndex < m_vecCellsOfObject.size() && m_vecCellsOfObject[uiObjectIndex].m_bIsInserted);
+	return m_vecCellsOfObject[uiObjectIndex].m_tCellRange;
+}
+
+float CollisionDetection::SpatialHashGrid::CalcCellSizeForObjects(const SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+{
+	assert(pSceneObjects && uiNumSceneObjects > 0u);
+
+	std::vector<float> vecLargestExtents(uiNumSceneObjects);
+	for (size_t uiCurrentObject = 0u; uiCurrentObject < uiNumSceneObjects; uiCurrentObject++)
+	{
+		const glm::vec3& rRadius = pSceneObjects[uiCurrentObject].m_tWorldSpaceAABB.m_vec3Radius;
+		vecLargestExtents[uiCurrentObject] = 2.0f * std::max(rRadius.x, std::max(rRadius.y, rRadius.z));
+	}
+
+	std::vector<float>::iterator tMedian = vecLargestExtents.begin() + uiNumSceneObjects / 2u;
+	std::nth_element(vecLargestExtents.begin(), tMedian, vecLargestExtents.end());
+
+	return *tMedian;
+}
+
+uint64_t CollisionDetection::SpatialHashGrid::CreateCellKey(int32_t iCellX, int32_t iCellY, int32_t iCellZ)
+{
+	const uint64_t uiMask = (1u << 21u) - 1u;
+	return (static_cast<uint64_t>(static_cast<uint32_t>(iCellX)) & uiMask) | ((static_cast<uint64_t>(static_cast<uint32_t>(iCellY)) & uiMask) << 21u) | ((static_cast<uint64_t>(static_cast<uint32_t>(iCellZ)) & uiMask) << 42u);
+}
+
+CollisionDetection::SpatialHashGrid::CellRange CollisionDetection::SpatialHashGrid::CalcCellRange(const AABB & rAABB) const
+{
+	CellRange tCellRange;
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		tCellRange.m_pMinimumCell[uiCurrentAxis] = static_cast<int32_t>(std::floor(rAABB.CalcMinimumForAxis(uiCurrentAxis) * m_fInverseCellSize));
+		tCellRange.m_pMaximumCell[uiCurrentAxis] = static_cast<int32_t>(std::floor(rAABB.CalcMaximumForAxis(uiCurrentAxis) * m_fInverseCellSize));
+
+		// larger objects would share keys with their own cells
+		assert(tCellRange.m_pMaximumCell[uiCurrentAxis] - tCellRange.m_pMinimumCell[uiCurrentAxis] < (1 << 21));
+	}
+
+	return tCellRange;
+}
+
+void CollisionDetection::SpatialHashGrid::AddObjectToCells(uint32_t uiObjectIndex, const CellRange & rCellRange)
+{
+	for (int32_t iCellZ = rCellRange.m_pMinimumCell[2]; iCellZ <= rCellRange.m_pMaximumCell[2]; iCellZ++)
+	{
+		for (int32_t iCellY = rCellRange.m_pMinimumCell[1]; iCellY <= rCellRange.m_pMaximumCell[1]; iCellY++)
+		{
+			for (int32_t iCellX = rCellRange.m_pMinimumCell[0]; iCellX <= rCellRange.m_pMaximumCell[0]; iCellX++)
+				m_mapCells[CreateCellKey(iCellX, iCellY, iCellZ)].push_back(uiObjectIndex);
+		}
+	}
+
+	const bool bIsFirstOccupiedCell = m_tOccupiedCells.m_pMaximumCell[0] < m_tOccupiedCells.m_pMinimumCell[0];
+	for (size_t uiCurrentAxis = 0u; uiCurrentAxis < 3u; uiCurrentAxis++)
+	{
+		m_tOccupiedCells.m_pMinimumCell[uiCurrentAxis] = bIsFirstOccupiedCell ? rCellRange.m_pMinimumCell[uiCurrentAxis] : std::min(m_tOccupiedCells.m_pMinimumCell[uiCurrentAxis], rCellRange.m_pMinimumCell[uiCurrentAxis]);
+		m_tOccupiedCells.m_pMaximumCell[uiCurrentAxis] = bIsFirstOccupiedCell ? rCellRange.m_pMaximumCell[uiCurrentAxis] : std::max(m_tOccupiedCells.m_pMaximumCell[uiCurrentAxis], rCellRange.m_pMaximumCell[uiCurrentAxis]);
+	}
+}
+
+void CollisionDetection::SpatialHashGrid::RemoveObjectFromCells(uint32_t uiObjectIndex, const CellRange & rCellRange)
+{
+	for (int32_t iCellZ = rCellRange.m_pMinimumCell[2]; iCellZ <= rCellRange.m_pMaximumCell[2]; iCellZ++)
+	{
+		for (int32_t iCellY = rCellRange.m_pMinimumCell[1]; iCellY <= rCellRange.m_pMaximumCell[1]; iCellY++)
+		{
+			for (int32_t iCellX = rCellRange.m_pMinimumCell[0]; iCellX <= rCellRange.m_pMaximumCell[0]; iCellX++)
+			{
+				const std::unordered_map<uint64_t, std::vector<uint32_t>>::iterator tCell = m_mapCells.find(CreateCellKey(iCellX, iCellY, iCellZ));
+				assert(tCell != m_mapCells.end());
+
+				// the order within a cell does not matter
+				std::vector<uint32_t>& rvecCellObjects = tCell->second;
+				const std::vector<uint32_t>::iterator tObject = std::find(rvecCellObjects.begin(), rvecCellObjects.end(), uiObjectIndex);
+				assert(tObject != rvecCellObjects.end());
+				*tObject = rvecCellObjects.back();
+				rvecCellObjects.pop_back();
+
+				if (rvecCellObjects.empty())
+					m_mapCells.erase(tCell);
+			}
+		}
+	}
+}
+
+constexpr int32_t CollisionDetection::LooseOctree::s_iNullNode;
+constexpr int32_t CollisionDetection::LooseOctree::s_iMaxDepthLimit;
+
+CollisionDetection::LooseOctree::LooseOctree(const glm::vec3 & rvec3Center, float fHalfWidth, int32_t iMaxDepth) :
+	m_vecNodes(),
+	m_vecNodeOfObject(),
+	m_iRootNode(s_iNullNode),
+	m_iFreeList(s_iNullNode),
+	m_uiNumObjects(0u),
+	m_uiNumNodes(0u),
+	m_vec3Center(rvec3Center),
+	m_fHalfWidth(fHalfWidth),
+	m_iMaxDepth(iMaxDepth)
+{
+	assert(fHalfWidth > 0.0f);
+	assert(iMaxDepth >= 0 && iMaxDepth <= s_iMaxDepthLimit);
+}
+
+void CollisionDetection::LooseOctree::Build(const SceneObject * pSceneObjects, size_t uiNumSceneObjects)
+{
+	assert(pSceneObjects || uiNumSceneObjects == 0u);
+	assert(uiNumSceneObjects <= std::numeric_limits<uint32_t>::max());
+
+	Clear();
+	if (uiNumSceneObjects == 0u)
+		return;
+
+	// the root's cube only has to hold the objects' centers, their loose bounds take care of the rest
+	glm::vec3 vec3MinimumCenter = pSceneObjects[0].m_tWorldSpaceAABB.m_vec3Center;
+	glm::vec3 vec3MaximumCenter = vec3MinimumCenter;
+	for (size_t uiCurrentObject = 1u; uiCurrentObject < uiNumSceneObjects; uiCurrentObject++)
+	{
+		vec3MinimumCenter = glm::min(vec3MinimumCenter, pSceneObjects[uiCurrentObject].m_tWorldSpaceAABB.m_vec3Center);
+		vec3MaximumCenter = glm::max(vec3MaximumCenter, pSceneObjects[uiCurrentObject].m_tWorldSpaceAABB.m_vec3Center);
+	}
+	const glm::vec3 vec3HalfExtents = 0.5f * (vec3MaximumCenter - vec3MinimumCenter);
+	const float fHalfWidth = std::max(std::max(vec3HalfExtents.x, vec3HalfExtents.y), vec3HalfExtents.z);
+	SetBounds(0.5f * (vec3MinimumCenter + vec3MaximumCenter), std::max(fHalfWidth, std::numeric_limits<float>::epsilon()));
+
+	m_vecNodeOfObject.resize(uiNumSceneObjects, s_iNullNode);
+	for (uint32_t uiCurrentObject = 0u; uiCurrentObject < uiNumSceneObjects; uiCurrentObject++)
+		InsertObject(pSceneObjects, uiCurrentObject);
+}
+
+void CollisionDetection::LooseOctree::InsertObject(const SceneObject * pSceneObjects, uint32_t uiObjectIndex)
+{
+	assert(pSceneObjects);
+
+	if (uiObjectIndex >= m_vecNodeOfObject.size())
+		m_vecNodeOfObject.resize(uiObjectIndex + 1u, s_iNullNode);
+	assert(m_vecNodeOfObject[uiObjectIndex] == s_iNullNode);	// every object can only be inserted once
+
+	const int32_t iNode = FindOrCreateNodeForAABB(pSceneObjects[uiObjectIndex].m_tWorldSpaceAABB);
+	m_vecNodes[iNode].m_vecObjects.push_back(uiObjectIndex);
+	m_vecNodeOfObject[uiObjectIndex] = iNode;
+	m_uiNumObjects++;
+}
+
+void CollisionDetection::LooseOctree::RemoveObject(uint32_t uiObjectIndex)
+{
+	assert(uiObjectIndex < m_vecNodeOfObject.size());
+	const int32_t iNode = m_vecNodeOfObject[uiObjectIndex];
+	assert(iNode != s_iNullNode);	// the object has to be in the octree
+
+	// the order within a node does not matter
+	std::vector<uint32_t>& rvecNodeObjects = m_vecNodes[iNode].m_vecObjects;
+	const std::vector<uint32_t>::iterator tObject = std::find(rvecNodeObjects.begin(), rvecNodeObjects.end(), uiObjectIndex);
+	assert(tObject != rvecNodeObjects.end());
+	*tObject = rvecNodeObjects.back();
+	rvecNodeObjects.pop_back();
+
+	m_vecNodeOfObject[uiObjectIndex] = s_iNullNode;
+	m_uiNumObjects--;
+
+	FreeEmptyNodes(iNode);
+}
+
+bool CollisionDetection::LooseOctree::UpdateObject(const SceneObject * pSceneObjects, uint32_t uiObjectIndex)
+{
+	assert(pSceneObjects);
+	assert(uiObjectIndex < m_vecNodeOfObject.size());
+	const int32_t iNode = m_vecNodeOfObject[uiObjectIndex];
+	assert(iNode != s_iNullNode);	// the object has to be in the octree
+
+	// the loose bounds let objects wander up to half a cube beyond their node's cube before they have to move
+	const AABB& rObjectAABB = pSceneObjects[uiObjectIndex].m_tWorldSpaceAABB;
+	const Node& rNode = m_vecNodes[iNode];
+	const int32_t iDepth = CalcDepthForAABB(rObjectAABB);
+	if (iDepth == rNode.m_iDepth && (iNode == m_iRootNode || glm::all(glm::lessThanEqual(glm::abs(rObjectAABB.m_vec3Center - rNode.m_tLooseAABB.m_vec3Center) + rObjectAABB.m_vec3Radius, rNode.m_tLooseAABB.m_vec3Radius))))
+		return false;
+
+	RemoveObject(uiObjectIndex);
+	InsertObject(pSceneObjects, uiObjectIndex);
+
+	return true;
+}
+
+void CollisionDetection::LooseOctree::ChangeObjectIndex(uint32_t uiOldObjectIndex, uint32_t uiNewObjectIndex)
+{
+	assert(uiOldObjectIndex < m_vecNodeOfObject.size());
+	const int32_t iNode = m_vecNodeOfObject[uiOldObjectIndex];
+	assert(iNode != s_iNullNode);
+
+	if (uiNewObjectIndex >= m_vecNodeOfObject.size())
+		m_vecNodeOfObject.resize(uiNewObjectIndex + 1u, s_iNullNode);
+	assert(m_vecNodeOfObject[uiNewObjectIndex] == s_iNullNode);	// the new index must not be taken by another object
+
+	std::vector<uint32_t>& rvecNodeObjects = m_vecNodes[iNode].m_vecObjects;
+	std::replace(rvecNodeObjects.begin(), rvecNodeObjects.end(), uiOldObjectIndex, uiNewObjectIndex);
+	m_vecNodeOfObject[uiNewObjectIndex] = iNode;
+	m_vecNodeOfObject[uiOldObjectIndex] = s_iNullNode;
+}
+
+void CollisionDetection::LooseOctree::Clear()
+{
+	m_vecNodes.clear();
+	m_vecNodeOfObject.clear();
+	m_iRootNode = s_iNullNode;
+	m_iFreeList = s_iNullNode;
+	m_uiNumObjects = 0u;
+	m_uiNumNodes = 0u;
+}
+
+void CollisionDetection::LooseOctree::SetBounds(const glm::vec3 & rvec3Center, float fHalfWidth)
+{
+	assert(fHalfWidth > 0.0f);
+	assert(m_uiNumObjects == 0u);	// the nodes of the objects would not fit anymore
+
+	m_vec3Center = rvec3Center;
+	m_fHalfWidth = fHalfWidth;
+}
+
+size_t CollisionDetection::LooseOctree::FindObjectsOverlappingAABB(const SceneObject * pSceneObjects, const AABB & rAABB, uint32_t * pObjectIndices, size_t uiMaxNumObjects) const
+{
+	return FindObjects(pSceneObjects, rAABB, StaticTestAABBagainstAABB, pObjectIndices, uiMaxNumObjects);
+}
+
+size_t CollisionDetection::LooseOctree::FindObjectsInFrustum(const SceneObject * pSceneObjects, const Frustum & rFrustum, uint32_t * pObjectIndices, size_t uiMaxNumObjects) const
+{
+	return FindObjects(pSceneObjects, rFrustum, StaticTestAABBagainstFrustum, pObjectIndices, uiMaxNumObjects);
+}
+
+int32_t CollisionDetection::LooseOctree::GetNodeOfObject(uint32_t uiObjectIndex) const
+{
+	return (uiObjectIndex < m_vecNodeOfObject.size()) ? m_vecNodeOfObject[uiObjectIndex] : s_iNullNode;
+}
+
+int32_t CollisionDetection::LooseOctree::AllocateNode(int32_t iParent, int32_t iDepth, const glm::vec3 & rvec3CubeCenter, float fCubeHalfWidth)
+{
+	int32_t iNewNode = m_iFreeList;
+	if (iNewNode == s_iNullNode)
+	{
+		assert(m_vecNodes.size() < static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+		m_vecNodes.emplace_back();
+		iNewNode = static_cast<int32_t>(m_vecNodes.size() - 1u);
+	}
+	else
+	{
+		m_iFreeList = m_vecNodes[iNewNode].m_iParentOrNextFreeNode;
+		m_vecNodes[iNewNode] = Node();
+	}
+
+	Node& rNewNode = m_vecNodes[iNewNode];
+	rNewNode.m_tLooseAABB.m_vec3Center = rvec3CubeCenter;
+	rNewNode.m_tLooseAABB.m_vec3Radius = glm::vec3(2.0f * fCubeHalfWidth);
+	rNewNode.m_iParentOrNextFreeNode = iParent;
+	rNewNode.m_iDepth = iDepth;
+	m_uiNumNodes++;
+
+	return iNewNode;
+}
+
+void CollisionDetection::LooseOctree::FreeNode(int32_t iNode)
+{
+	Node& rFreedNode = m_vecNodes[iNode];
+	rFreedNode = Node();
+	rFreedNode.m_iDepth = -1;
+	rFreedNode.m_iParentOrNextFreeNode = m_iFreeList;
+	m_iFreeList = iNode;
+	m_uiNumNodes--;
+}
+
+int32_t CollisionDetection::LooseOctree::CalcDepthForAABB(const AABB & rAABB) const
+{
+	// objects centered outside of the root's cube would not fit into the loose bounds of any node
+	if (glm::any(glm::greaterThan(glm::abs(rAABB.m_vec3Center - m_vec3Center), glm::vec3(m_fHalfWidth))))
+		return 0;
+
+	// a node holds objects reaching up to its cube's half width beyond its cube
+	const float fLargestRadius = std::max(std::max(rAABB.m_vec3Radius.x, rAABB.m_vec3Radius.y), rAABB.m_vec3Radius.z);
+	int32_t iDepth = 0;
+	float fCubeHalfWidth = m_fHalfWidth;
+	while (iDepth < m_iMaxDepth && fLargestRadius <= 0.5f * fCubeHalfWidth)
+	{
+		fCubeHalfWidth *= 0.5f;
+		iDepth++;
+	}
+
+	return iDepth;
+}
+
+int32_t CollisionDetection::LooseOctree::FindOrCreateNodeForAABB(const AABB & rAABB)
+{
+	if (m_iRootNode == s_iNullNode)
+		m_iRootNode = AllocateNode(s_iNullNode, 0, m_vec3Center, m_fHalfWidth);
+
+	const int32_t iDepth = CalcDepthForAABB(rAABB);
+	int32_t iNode = m_iRootNode;
+	glm::vec3 vec3CubeCenter = m_vec3Center;
+	float fCubeHalfWidth = m_fHalfWidth;
+	for (int32_t iCurrentDepth = 1; iCurrentDepth <= iDepth; iCurrentDepth++)
+	{
+		// the child cube holding the AABB's center
+		fCubeHalfWidth *= 0.5f;
+		int iOctant = 0;
+		for (glm::vec3::length_type iCurrentAxis = 0; iCurrentAxis < 3; iCurrentAxis++)
+		{
+			const bool bIsUpperHalf = rAABB.m_vec3Center[iCurrentAxis] >= vec3CubeCenter[iCurrentAxis];
+			iOctant |= bIsUpperHalf ? (1 << iCurrentAxis) : 0;
+			vec3CubeCenter[iCurrentAxis] += bIsUpperHalf ? fCubeHalfWidth : -fCubeHalfWidth;
+		}
+
+		int32_t iChild = m_vecNodes[iNode].m_pChildren[iOctant];
+		if (iChild == s_iNullNode)
+		{
+			iChild = AllocateNode(iNode, iCurrentDepth, vec3CubeCenter, fCubeHalfWidth);	// may move the nodes, no references are held across this
+			m_vecNodes[iNode].m_pChildren[iOctant] = iChild;
+		}
+		iNode = iChild;
+	}
+
+	return iNode;
+}
+
+void CollisionDetection::LooseOctree::FreeEmptyNodes(int32_t iNode)
+{
+	while (iNode != s_iNullNode)
+	{
+		const Node& rNode = m_vecNodes[iNode];
+		if (!rNode.m_vecObjects.empty() || std::any_of(std::begin(rNode.m_pChildren), std::end(rNode.m_pChildren), [](int32_t iChild) { return iChild != s_iNullNode; }))
+			return;
+
+		const int32_t iParent = rNode.m_iParentOrNextFreeNode;
+		if (iParent == s_iNullNode)
+		{
+			m_iRootNode = s_iNullNode;
+		}
+		else
+		{
+			int32_t* pChildren = m_vecNodes[iParent].m_pChildren;
+			*std::find(pChildren, pChildren + 8, iNode) = s_iNullNode;
+		}
+
+		FreeNode(iNode);
+		iNode = iParent;
+	}
+}
+
+template <typename QueryVolume>
+size_t CollisionDetection::LooseOctree::FindObjects(const SceneObject * pSceneObjects, const QueryVolume & rQueryVolume, int(*pTestAABB)(const AABB&, const QueryVolume&), uint32_t * pObjectIndices, size_t uiMaxNumObjects) const
+{
+	assert(pSceneObjects || m_uiNumObjects == 0u);
+	assert(pObjectIndices || uiMaxNumObjects == 0u);
+
+	if (m_iRootNode == s_iNullNode)
+		return 0u;
+
+	// a node's children are pushed at once, so the stack never holds more than seven nodes per level besides the current one's children
+	int32_t pNodesToVisit[7 * s_iMaxDepthLimit + 8];
+	size_t uiNumNodesToVisit = 0u;
+	pNodesToVisit[uiNumNodesToVisit++] = m_iRootNode;
+
+	size_t uiNumObjects = 0u;
+	while (uiNumNodesToVisit > 0u)
+	{
+		const int32_t iCurrentNode = pNodesToVisit[--uiNumNodesToVisit];
+		const Node& rCurrentNode = m_vecNodes[iCurrentNode];
+
+		// the root also holds the objects that do not fit into its loose bounds, so it is always visited
+		if (iCurrentNode != m_iRootNode && !pTestAABB(rCurrentNode.m_tLooseAABB, rQueryVolume))
+			continue;
+
+		for (uint32_t uiCurrentObject : rCurrentNode.m_vecObjects)
+		{
+			if (!pTestAABB(pSceneObjects[uiCurrentObject].m_tWorldSpaceAABB, rQueryVolume))
+				continue;
+
+			if (uiNumObjects < uiMaxNumObjects)
+				pObjectIndices[uiNumObjects] = uiCurrentObject;
+			uiNumObjects++;
+		}
+
+		for (int32_t iChild : rCurrentNode.m_pChildren)
+		{
+			if (iChild != s_iNullNode)
+				pNodesToVisit[uiNumNodesToVisit++] = iChild;
+		}
+	}
+
+	return uiNumObjects;
+}
+
+/*
+	Implementation of "private" functions (internal linkage)
+*/
+namespace CollisionDetection {
+	namespace {
+
+		//////////////////////////////////////////
+		// BOUNDING VOLUMES
+		//////////////////////////////////////////
+
+		MostSeperatedPointsIndices MostSeperatedPointsOnAABB(float * pVertices, size_t uiNumberOfVertices)
+		{
+			MostSeperatedPointsIndices tResult;
+
+			size_t uiMinXIndex = 0u, uiMaxXIndex = 0u, uiMinYIndex = 0u, uiMaxYIndex = 0u, uiMinZIndex = 0u, uiMaxZIndex = 0u;
+			for (size_t uiCurrentVertexIndex = 1; uiCurrentVertexIndex < uiNumberOfVertices; uiCurrentVertexIndex++)
+			{
+				//min and max for X: *8 accounts for stride, +0 accounts for x coordinate
+				if (pVertices[uiCurrentVertexIndex * 8 + 0] < pVertices[uiMinXIndex * 8 + 0]) uiMinXIndex = uiCurrentVertexIndex;
+				if (pVertices[uiCurrentVertexIndex * 8 + 0] > pVertices[uiMaxXIndex * 8 + 0]) uiMaxXIndex = uiCurrentVertexIndex;
+				//min and max for Y: *8 accounts for stride, +1 accounts for y coordinate
+				if (pVertices[uiCurrentVertexIndex * 8 + 1] < pVertices[uiMinYIndex * 8 + 1]) uiMinYIndex = uiCurrentVertexIndex;
+				if (pVertices[uiCurrentVertexIndex * 8 + 1] > pVertices[uiMaxYIndex * 8 + 1]) uiMaxYIndex = uiCurrentVertexIndex;
+				//min and max for Y: *8 accounts for stride, +2 accounts for z coordinate
+				if (pVertices[uiCurrentVertexIndex * 8 + 2] < pVertices[uiMinZIndex * 8 + 2]) uiMinZIndex = uiCurrentVertexIndex;
+				if (pVertices[uiCurrentVertexIndex * 8 + 2] > pVertices[uiMaxZIndex * 8 + 2]) uiMaxZIndex = uiCurrentVertexIndex;
+			}
+
+			//creating points for distance calculation
+			const glm::vec3 vec3MinXPoint(pVertices[uiMinXIndex * 8 + 0], pVertices[uiMinXIndex * 8 + 1], pVertices[uiMinXIndex * 8 + 2]);
+			const glm::vec3 vec3MaxXPoint(pVertices[uiMaxXIndex * 8 + 0], pVertices[uiMaxXIndex * 8 + 1], pVertices[uiMaxXIndex * 8 + 2]);
+			const glm::vec3 vec3MinYPoint(pVertices[uiMinYIndex * 8 + 0], pVertices[uiMinYIndex * 8 + 1], pVertices[uiMinYIndex * 8 + 2]);
+			const glm::vec3 vec3MaxYPoint(pVertices[uiMaxYIndex * 8 + 0], pVertices[uiMaxYIndex * 8 + 1], pVertices[uiMaxYIndex * 8 + 2]);
+			const glm::vec3 vec3MinZPoint(pVertices[uiMinZIndex * 8 + 0], pVertices[uiMinZIndex * 8 + 1], pVertices[uiMinZIndex * 8 + 2]);
+			const glm::vec3 vec3MaxZPoint(pVertices[uiMaxZIndex * 8 + 0], pVertices[uiMaxZIndex * 8 + 1], pVertices[uiMaxZIndex * 8 + 2]);
+
+			//calculating the distace
+			const glm::vec3 vec3DistanceXPoints = vec3MaxXPoint - vec3MinXPoint;
+			const glm::vec3 vec3DistanceYPoints = vec3MaxYPoint - vec3MinYPoint;
+			const glm::vec3 vec3DistanceZPoints = vec3MaxZPoint - vec3MinZPoint;
+
+			//computing the squared distance for all pairs
+			const float fSquaredDistanceXPoints = glm::dot(vec3DistanceXPoints, vec3DistanceXPoints);
+			const float fSquaredDistanceYPoints = glm::dot(vec3DistanceYPoints, vec3DistanceYPoints);
+			const float fSquaredDistanceZPoints = glm::dot(vec3DistanceZPoints, vec3DistanceZPoints);
+
+			//references only for readability
+			size_t& ruiMinVertexIndex = tResult.m_uiMinVertexIndex;
+			size_t& ruiMaxVertexIndex = tResult.m_uiMaxVertexIndex;
+
+			//base assumption : arbitrary axis, here X, is the longest
+			ruiMinVertexIndex = uiMinXIndex;
+			ruiMaxVertexIndex = uiMaxXIndex;
+
+			//correction into Y axis if those points are farther apart
+			if (fSquaredDistanceYPoints > fSquaredDistanceXPoints && fSquaredDistanceYPoints > fSquaredDistanceZPoints)
+			{
+				ruiMinVertexIndex = uiMinYIndex;
+				ruiMaxVertexIndex = uiMaxYIndex;
+			}
+
+			//correction into Z axis if those points are farther apart
+			if (fSquaredDistanceZPoints > fSquaredDistanceXPoints && fSquaredDistanceZPoints > fSquaredDistanceYPoints)
+			{
+				ruiMinVertexIndex = uiMinZIndex;
+				ruiMaxVertexIndex = uiMaxZIndex;
+			}
+
+			return tResult;
+		}
 
 		AABB ConstructAABBFromVertexData(float * pVertices, size_t uiNumberOfVertices)
 		{
-			AABB tResult;
+			AABB tResult;
+
+			// initializing min values to max and vice versa for definitive overwriting for the first vertex
+			float fXMin = std::numeric_limits<float>::max();
+			float fXMax = std::numeric_limits<float>::lowest();
+			float fYMin = std::numeric_limits<float>::max();
+			float fYMax = std::numeric_limits<float>::lowest();
+			float fZMin = std::numeric_limits<float>::max();
+			float fZMax = std::numeric_limits<float>::lowest();
+
+			for (size_t uiCurrentVertex = 0u; uiCurrentVertex < uiNumberOfVertices; uiCurrentVertex++)
+			{
+				const size_t uiCurrentDataIndex = uiCurrentVertex * 8; // 8 is the assumed stride;
+
+				const float fVertexPositionX = pVertices[uiCurrentDataIndex + 0];
+				const float fVertexPositionY = pVertices[uiCurrentDataIndex + 1];
+				const float fVertexPositionZ = pVertices[uiCurrentDataIndex + 2];
+
+				fXMin = std::min<float>(fXMin, fVertexPositionX);
+				fYMin = std::min<float>(fYMin, fVertexPositionY);
+				fZMin = std::min<float>(fZMin, fVertexPositionZ);
+				fXMax = std::max<float>(fXMax, fVertexPositionX);
+				fYMax = std::max<float>(fYMax, fVertexPositionY);
+				fZMax = std::max<float>(fZMax, fVertexPositionZ);
+			}
+
+			/*
+				maximum and minimum extents along current axis are now stored
+				now to determine the radius of the AABB.
+				to tightly fit the AABB for the given vertices, the absolute distance to the centre, which is assumed to be 0,0,0
+				are compared. The longer distance is the half-width for that axis.
+			*/
+
+			const float fHalfWidthX = std::max(std::abs(fXMin), std::abs(fXMax));
+			const float fHalfWidthY = std::max(std::abs(fYMin), std::abs(fYMax));
+			const float fHalfWidthZ = std::max(std::abs(fZMin), std::abs(fZMax));
+
+			tResult.m_vec3Center = glm::vec3(0.0f, 0.0f, 0.0f);		// local space center / pivot point. assumed to be 0,0,0. This is true for all of VISSAs objects
+			tResult.m_vec3Radius = glm::vec3(fHalfWidthX, fHalfWidthY, fHalfWidthZ);
+
+			return tResult;
+		}
+
+		AABB UpdateAABBFromAABB_UniformScaling(const AABB& rLocalSpaceAABB, const glm::mat4& mat4Rotation, const glm::vec3& rTranslation, const glm::vec3& rScale)
+		{
+			assert(glm::length(rLocalSpaceAABB.m_vec3Radius) > 0.0f);	// make sure old AABB has already been constructed
+
+			AABB tResult;
+
+			for (int i = 0; i < 3; i++) // for every axis of the new AABB
+			{
+				tResult.m_vec3Center[i] = rTranslation[i];	// we assume the translation
+				tResult.m_vec3Radius[i] = 0.0f;				// and start with a radius of 0
+				for (int j = 0; j < 3; j++)		// for every axis of the old AABB
+				{
+					tResult.m_vec3Center[i] += mat4Rotation[i][j] * rLocalSpaceAABB.m_vec3Center[j];				// we adjust the center. This only has an effect, when the old AABBs center was not {0,0,0}, like somewhere in world-space.	When the old AABBs centre point was in 0,0,0 local space, this will do nothing.
+					tResult.m_vec3Radius[i] += std::abs(mat4Rotation[i][j]) * rLocalSpaceAABB.m_vec3Radius[j];		// we continuosly increase the radius, starting at 0. For every axis of the old, rotated old AABB (j), we add its impact to the radius of the axis of the new AABB (i)
+				}
+				tResult.m_vec3Radius[i] *= rScale[i]; // we scale the current axis of the new AABB
+			}
+
+			return tResult;
+		}
+
+		AABB UpdateAABBFromAABB_NonUniformScaling(const AABB & rLocalSpaceAABB, const glm::mat4 & mat4Transform)
+		{
+			assert(glm::length(rLocalSpaceAABB.m_vec3Radius) > 0.0f);	// make sure old AABB has already been constructed
+
+			AABB tResult;
+
+			// world space AABB center by extracting the 4th colum of the transform matrix
+			const glm::vec3 vec3NewAABBCenter = mat4Transform[3];
+			tResult.m_vec3Center = vec3NewAABBCenter;
+
+			// constructing all corner points of the old AABB
+			std::vector<glm::vec4> vecOldAABBCornerPoints{
+				glm::vec4(rLocalSpaceAABB.CalcMaximumX(), rLocalSpaceAABB.CalcMaximumY(), rLocalSpaceAABB.CalcMaximumZ(), 1.0f),
+				glm::vec4(rLocalSpaceAABB.CalcMinimumX(), rLocalSpaceAABB.CalcMaximumY(), rLocalSpaceAABB.CalcMaximumZ(), 1.0f),
+				glm::vec4(rLocalSpaceAABB.CalcMaximumX(), rLocalSpaceAABB.CalcMinimumY(), rLocalSpaceAABB.CalcMaximumZ(), 1.0f),
+				glm::vec4(rLocalSpaceAABB.CalcMaximumX(), rLocalSpaceAABB.CalcMaximumY(), rLocalSpaceAABB.CalcMinimumZ(), 1.0f),
+				glm::vec4(rLocalSpaceAABB.CalcMinimumX(), rLocalSpaceAABB.CalcMinimumY(), rLocalSpaceAABB.CalcMaximumZ(), 1.0f),
+				glm::vec4(rLocalSpaceAABB.CalcMaximumX(), rLocalSpaceAABB.CalcMinimumY(), rLocalSpaceAABB.CalcMinimumZ(), 1.0f),
+				glm::vec4(rLocalSpaceAABB.CalcMinimumX(), rLocalSpaceAABB.CalcMaximumY(), rLocalSpaceAABB.CalcMinimumZ(), 1.0f),
+				glm::vec4(rLocalSpaceAABB.CalcMinimumX(), rLocalSpaceAABB.CalcMinimumY(), rLocalSpaceAABB.CalcMinimumZ(), 1.0f),
+			};
+
+			for (const glm::vec4& rCurrentCornerPoint : vecOldAABBCornerPoints) // for every corner point
+			{
+				// transform it into world space
+				const glm::vec4 vec4WorldSpaceCornerPoint = mat4Transform * rCurrentCornerPoint;
+
+				// world space AABB half-widths
+				const float fHalfWidthXForCurrentCornerPoint = std::abs(vec4WorldSpaceCornerPoint.x - tResult.m_vec3Center.x);
+				const float fHalfWidthYForCurrentCornerPoint = std::abs(vec4WorldSpaceCornerPoint.y - tResult.m_vec3Center.y);
+				const float fHalfWidthZForCurrentCornerPoint = std::abs(vec4WorldSpaceCornerPoint.z - tResult.m_vec3Center.z);
+
+				tResult.m_vec3Radius.x = std::max(tResult.m_vec3Radius.x, fHalfWidthXForCurrentCornerPoint);
+				tResult.m_vec3Radius.y = std::max(tResult.m_vec3Radius.y, fHalfWidthYForCurrentCornerPoint);
+				tResult.m_vec3Radius.z = std::max(tResult.m_vec3Radius.z, fHalfWidthZForCurrentCornerPoint);
+			}
+
+			return tResult;
+		}
+
+		BoundingSphere ConstructBoundingSphereFromVertexData_Iterative(float * pVertices, size_t uiNumberOfVertices)
+		{
+			assert(!"not yet implemented");
+			const size_t uiNumberOfIterations = 8u;
+
+			BoundingSphere tResult;
+
+			return tResult;
+		}
+
+		BoundingSphere ConstructBoundingSphereFromVertexData(float * pVertices, size_t uiNumberOfVertices)
+		{
+			BoundingSphere tRitterSphere = BoundingSphereFromDistantPoints(pVertices, uiNumberOfVertices);
+
+
+			for (size_t uiCurrentVertex = 0; uiCurrentVertex < uiNumberOfVertices; uiCurrentVertex++)
+			{
+				glm::vec3 vec3PointToBeEncompassed(pVertices[uiCurrentVertex * 8 + 0], pVertices[uiCurrentVertex * 8 + 1], pVertices[uiCurrentVertex * 8 + 2]);
+				ConditionallyUpdateSphereToEncompassPoint(tRitterSphere, vec3PointToBeEncompassed);
+			}
+
+
+
+			return tRitterSphere;
+		}
+
+		BoundingSphere BoundingSphereFromDistantPoints(float * pVertices, size_t uiNumberOfVertices)
+		{
+			BoundingSphere tResult;
+
+			MostSeperatedPointsIndices tMostSeperatedPoints = MostSeperatedPointsOnAABB(pVertices, uiNumberOfVertices);
+
+			const glm::vec3 vec3MinPoint(pVertices[tMostSeperatedPoints.m_uiMinVertexIndex * 8 + 0], pVertices[tMostSeperatedPoints.m_uiMinVertexIndex * 8 + 1], pVertices[tMostSeperatedPoints.m_uiMinVertexIndex * 8 + 2]);
+			const glm::vec3 vec3MaxPoint(pVertices[tMostSeperatedPoints.m_uiMaxVertexIndex * 8 + 0], pVertices[tMostSeperatedPoints.m_uiMaxVertexIndex * 8 + 1], pVertices[tMostSeperatedPoints.m_uiMaxVertexIndex * 8 + 2]);
+
+			tResult.m_vec3Center = vec3MinPoint * 0.5f + vec3MaxPoint * 0.5f;
+			tResult.m_fRadius = std::sqrtf(glm::dot(vec3MaxPoint - tResult.m_vec3Center, vec3MaxPoint - tResult.m_vec3Center));
+
+			return tResult;
+		}
+
+		void ConditionallyUpdateSphereToEncompassPoint(BoundingSphere & rSphereToBeUpdated, const glm::vec3 & rvec3PointToBeEncompassed)
+		{
+			const glm::vec3 vec3DistanceBetweenSphereCenterAndPoint = rvec3PointToBeEncompassed - rSphereToBeUpdated.m_vec3Center;
+			const float fSquaredDistance = glm::dot(vec3DistanceBetweenSphereCenterAndPoint, vec3DistanceBetweenSphereCenterAndPoint);
+
+			// conditional update
+			if (fSquaredDistance > rSphereToBeUpdated.m_fRadius * rSphereToBeUpdated.m_fRadius)		// comparing squared distances because square roots are expensive
+			{
+				const float fActualDistance = std::sqrtf(fSquaredDistance);
+				const float fNewRadius = rSphereToBeUpdated.m_fRadius * 0.5f + fActualDistance * 0.5f;
+				const float fSphereCenterAdjustment = (fNewRadius - rSphereToBeUpdated.m_fRadius) / fActualDistance;
+				rSphereToBeUpdated.m_fRadius = fNewRadius;
+				rSphereToBeUpdated.m_vec3Center += vec3DistanceBetweenSphereCenterAndPoint * fSphereCenterAdjustment;
+			}
+		}
+
+		BoundingSphere UpdateBoundingSphere(const BoundingSphere & rLocalSpaceBoundingSphere, const glm::vec3 & rTranslation, const glm::vec3 & rScale)
+		{
+			BoundingSphere tResult;
+			tResult.m_vec3Center = rLocalSpaceBoundingSphere.m_vec3Center + rTranslation;
+
+			float fHighestScalingInAxis = rScale.x;
+			if (rScale.y > fHighestScalingInAxis)
+				fHighestScalingInAxis = rScale.y;
+			if (rScale.z > fHighestScalingInAxis)
+				fHighestScalingInAxis = rScale.z;
+
+			tResult.m_fRadius = rLocalSpaceBoundingSphere.m_fRadius * fHighestScalingInAxis;
+
+			//const float fSquaredScalingDistance = glm::dot(rScale, rScale); // equivalent to: (x + y + z)
+			//const float fSquaredUnitScaling = 3.0f;							// equivalent to: (1 + 1 + 1)
+
+			//const float fSquaredRadiusScalingFactor = fSquaredScalingDistance / fSquaredUnitScaling;
+			//const float fActualRadiusScalingFactor = std::sqrtf(fSquaredRadiusScalingFactor);
+
+			//tResult.m_fRadius = rLocalSpaceBoundingSphere.m_fRadius * fActualRadiusScalingFactor;
+
+			return tResult;
+		}
+
+		BoundingSphere ConstructLocalSpaceBoundingSphereForCube(const SceneObject & rCurrentCube)
+		{
+			assert(rCurrentCube.m_eType == SceneObject::eType::CUBE);
+
+			BoundingSphere tResult;
+
+			tResult.m_vec3Center = glm::vec3(0.0f, 0.0f, 0.0f);
+			assert(std::abs(Primitives::Cube::VertexData[0]) == 50.0f); // your cheat is out of date
+			const float fSquaredDistanceToFurthestPoint = glm::dot(glm::vec3(50.0f, 50.0f, 50.0f), glm::vec3(50.0f, 50.0f, 50.0f));
+			tResult.m_fRadius = std::sqrtf(fSquaredDistanceToFurthestPoint);
+
+			return tResult;
+		}
+
+		BoundingSphere ConstructLocalSpaceBoundingSphereForSphere(const SceneObject & rCurrentSphere)
+		{
+			assert(rCurrentSphere.m_eType == SceneObject::eType::SPHERE);
+			BoundingSphere tResult;
+
+			tResult.m_vec3Center = glm::vec3(0.0f, 0.0f, 0.0f);
+			tResult.m_fRadius = Primitives::Sphere::SphereDefaultRadius;
+
+			return tResult;
+		}
+
+		bool DoesAABBContainAABB(const AABB & rOuterAABB, const AABB & rInnerAABB)
+		{
+			const glm::vec3 vec3CenterDistance = glm::abs(rInnerAABB.m_vec3Center - rOuterAABB.m_vec3Center);
+			return glm::all(glm::lessThanEqual(vec3CenterDistance + rInnerAABB.m_vec3Radius, rOuterAABB.m_vec3Radius));
+		}
+
+		int TestMinMaxBoxagainstFrustumPlanes(const glm::vec3 & rvec3Min, const glm::vec3 & rvec3Max, const Frustum & rFrustum, uint32_t & ruiPlaneMask)
+		{
+			for (int iCurrentPlane = 0; iCurrentPlane < 6; iCurrentPlane++)
+			{
+				const uint32_t uiPlaneBit = 1u << iCurrentPlane;
+				if (!(ruiPlaneMask & uiPlaneBit))
+					continue;
+
+				// the box' corner furthest along the plane's normal is the last to leave its inner side, the opposite corner the first
+				const glm::vec4& rCurrentPlane = rFrustum.m_pPlanes[iCurrentPlane];
+				const glm::vec3 vec3Normal(rCurrentPlane);
+				const glm::bvec3 bvec3IsNormalPositive = glm::greaterThanEqual(vec3Normal, glm::vec3(0.0f));
+				const glm::vec3 vec3FurthestCorner = glm::mix(rvec3Min, rvec3Max, bvec3IsNormalPositive);
+				const glm::vec3 vec3NearestCorner = glm::mix(rvec3Max, rvec3Min, bvec3IsNormalPositive);
+				if (glm::dot(vec3Normal, vec3FurthestCorner) + rCurrentPlane.w < 0.0f)
+					return 0;
+				if (glm::dot(vec3Normal, vec3NearestCorner) + rCurrentPlane.w >= 0.0f)
+					ruiPlaneMask &= ~uiPlaneBit;
+			}
+			return 1;
+		}
+
+		//////////////////////////////////////////
+		// BOUNDING VOLUME HIERARCHY
+		//////////////////////////////////////////
+
+		float CalcSurfaceAreaOfExtents(const glm::vec3 & rvec3Min, const glm::vec3 & rvec3Max)
+		{
+			const glm::vec3 vec3Extents = rvec3Max - rvec3Min;
+			if (vec3Extents.x < 0.0f || vec3Extents.y < 0.0f || vec3Extents.z < 0.0f)
+				return 0.0f;
+
+			return 2.0f * (vec3Extents.x * vec3Extents.y + vec3Extents.x * vec3Extents.z + vec3Extents.y * vec3Extents.z);
+		}
+
+		float CalcSurfaceAreaOfObjects_AABB(const SceneObject * pSceneObjects, const ObjectReference * pObjectReferences, size_t uiNumObjectReferences)
+		{
+			assert(uiNumObjectReferences > 0u);
+
+			if (uiNumObjectReferences == 1u)
+				return pSceneObjects[pObjectReferences->m_uiObjectIndex].m_tWorldSpaceAABB.CalcSurfaceArea();
+
+			return CreateAABBForMultipleObjects(pSceneObjects, pObjectReferences, uiNumObjectReferences).CalcSurfaceArea();
+		}
+
+		float CalcSurfaceAreaOfObjects_BoundingSphere(const SceneObject * pSceneObjects, const ObjectReference * pObjectReferences, size_t uiNumObjectReferences)
+		{
+			assert(uiNumObjectReferences > 0u);
+
+			if (uiNumObjectReferences == 1u)
+				return pSceneObjects[pObjectReferences->m_uiObjectIndex].m_tWorldSpaceBoundingSphere.CalcSurfaceArea();
+
+			return CreateBoundingSphereForMultipleObjects(pSceneObjects, pObjectReferences, uiNumObjectReferences).CalcSurfaceArea();
+		}
+
+		template <typename ChunkFunction>
+		void ForEachObjectReferenceChunk(size_t uiNumObjectReferences, TaskPool* pTaskPool, const ChunkFunction& fnProcessChunk)
+		{
+			const size_t uiNumChunks = (uiNumObjectReferences + s_uiObjectReferenceChunkSize - 1u) / s_uiObjectReferenceChunkSize;
+
+			if (pTaskPool == nullptr || uiNumChunks == 1u)
+			{
+				for (size_t uiCurrentChunk = 0u; uiCurrentChunk < uiNumChunks; uiCurrentChunk++)
+				{
+					const size_t uiFirstObjectReference = uiCurrentChunk * s_uiObjectReferenceChunkSize;
+					fnProcessChunk(uiCurrentChunk, uiFirstObjectReference, std::min(s_uiObjectReferenceChunkSize, uiNumObjectReferences - uiFirstObjectReference));
+				}
+				return;
+			}
+
+			TaskPool::TaskGroup tChunkTasks;
+			for (size_t uiCurrentChunk = 0u; uiCurrentChunk < uiNumChunks; uiCurrentChunk++)
+			{
+				const size_t uiFirstObjectReference = uiCurrentChunk * s_uiObjectReferenceChunkSize;
+				const size_t uiNumObjectReferencesInChunk = std::min(s_uiObjectReferenceChunkSize, uiNumObjectReferences - uiFirstObjectReference);
+				pTaskPool->Submit(tChunkTasks, [&fnProcessChunk, uiCurrentChunk, uiFirstObjectReference, uiNumObjectReferencesInChunk]() {
+					fnProcessChunk(uiCurrentChunk, uiFirstObjectReference, uiNumObjectReferencesInChunk);
+				});
+			}
+			pTaskPool->Wait(tChunkTasks);
+		}
+
+		template <typename BoundingVolume>
+		size_t PartitionObjectReferencesAtObjectMean(const SceneObject * pSceneObjects, ObjectReference * pObjectReferences, size_t uiNumObjectReferences, BoundingVolume SceneObject::* pBoundingVolume, TaskPool * pTaskPool)
+		{
+			assert(pSceneObjects);
+			assert(pObjectReferences);
+			assert(uiNumObjectReferences > 0u);
+			/*
+				an explanation:
+				This function:
+				1. decides the splitting axis
+				2. then the splitting point
+				3. then partitions the given object references
+
+				Large sets are processed in chunks. The results of the chunks are always combined in the same order,
+				so the resulting partitioning does not depend on whether the chunks ran in parallel or not.
+			*/
+
+			const size_t uiNumChunks = (uiNumObjectReferences + s_uiObjectReferenceChunkSize - 1u) / s_uiObjectReferenceChunkSize;
+			TaskPool* pChunkTaskPool = (uiNumObjectReferences >= s_uiMinNumObjectReferencesForParallelPartitioning) ? pTaskPool : nullptr;
+
+			// 1. Finding the splitting axis
+			// 1.1. Finding the axis with the longest extent
+
+			const auto fnGrowExtentsByObjects = [&](size_t uiFirstObjectReference, size_t uiNumObjectReferencesToGrowBy, glm::vec3& rvec3MinExtents, glm::vec3& rvec3MaxExtents) {
+				for (size_t uiCurrentObjectReference = uiFirstObjectReference; uiCurrentObjectReference < uiFirstObjectReference + uiNumObjectReferencesToGrowBy; uiCurrentObjectReference++)
+				{
+					const BoundingVolume& rCurrentBoundingVolume = pSceneObjects[pObjectReferences[uiCurrentObjectReference].m_uiObjectIndex].*pBoundingVolume;
+
+					rvec3MaxExtents.x = std::max(rvec3MaxExtents.x, rCurrentBoundingVolume.CalcMaximumX());
+					rvec3MaxExtents.y = std::max(rvec3MaxExtents.y, rCurrentBoundingVolume.CalcMaximumY());
+					rvec3MaxExtents.z = std::max(rvec3MaxExtents.z, rCurrentBoundingVolume.CalcMaximumZ());
+
+					rvec3MinExtents.x = std::min(rvec3MinExtents.x, rCurrentBoundingVolume.CalcMinimumX());
+					rvec3MinExtents.y = std::min(rvec3MinExtents.y, rCurrentBoundingVolume.CalcMinimumY());
+					rvec3MinExtents.z = std::min(rvec3MinExtents.z, rCurrentBoundingVolume.CalcMinimumZ());
+				}
+			};
+
+			// initializing with values that will definitely be overwritten
+			glm::vec3 vec3MinExtents(std::numeric_limits<float>::max());
+			glm::vec3 vec3MaxExtents(std::numeric_limits<float>::lowest());
+
+			// finding min and max extents for every axis. Minima and maxima are exact, no matter in which order they are combined
+			if (uiNumChunks == 1u)
+			{
+				fnGrowExtentsByObjects(0u, uiNumObjectReferences, vec3MinExtents, vec3MaxExtents);
+			}
+			else
+			{
+				std::vector<glm::vec3> vecChunkMinExtents(uiNumChunks, vec3MinExtents);
+				std::vector<glm::vec3> vecChunkMaxExtents(uiNumChunks, vec3MaxExtents);
+				ForEachObjectReferenceChunk(uiNumObjectReferences, pChunkTaskPool, [&](size_t uiChunk, size_t uiFirstObjectReference, size_t uiNumObjectReferencesInChunk) {
+					fnGrowExtentsByObjects(uiFirstObjectReference, uiNumObjectReferencesInChunk, vecChunkMinExtents[uiChunk], vecChunkMaxExtents[uiChunk]);
+				});
+
+				for (size_t uiCurrentChunk = 0u; uiCurrentChunk < uiNumChunks; uiCurrentChunk++)
+				{
+					vec3MinExtents = glm::min(vec3MinExtents, vecChunkMinExtents[uiCurrentChunk]);
+					vec3MaxExtents = glm::max(vec3MaxExtents, vecChunkMaxExtents[uiCurrentChunk]);
+				}
+			}
+
+			// Getting the longest extent of the 3 axes
+			const float fXTotalExtent = vec3MaxExtents.x - vec3MinExtents.x;
+			const float fYTotalExtent = vec3MaxExtents.y - vec3MinExtents.y;
+			const float fZTotalExtent = vec3MaxExtents.z - vec3MinExtents.z;
+
+			// """sorting""" the axes by their extents
+			const int iNumSplittingAxes = 3;
+			const int x = 0, y = 1, z = 2;
+			int iSplittingAxes[iNumSplittingAxes];
+			iSplittingAxes[0] = x;
+
+			if (fYTotalExtent > fXTotalExtent && fYTotalExtent > fZTotalExtent)
+				iSplittingAxes[0] = y;
+
+			if (fZTotalExtent > fXTotalExtent && fZTotalExtent > fYTotalExtent)
+				iSplittingAxes[0] = z;
+
+			// first axis now stores the index of the longest axis in the 3 dimensional coordinate vector
+			// now for the other two
+			iSplittingAxes[1] = y;
+			iSplittingAxes[2] = z;
+			if (fZTotalExtent > fYTotalExtent)
+				std::swap(iSplittingAxes[1], iSplittingAxes[2]);
+
+			// Next step: try to partition objects along the longest axis, if that doesn't work (all objects in one child), try next best
+
+			size_t uiNumLeftChildren = uiNumObjectReferences; // intentionally initiliazed to an invalid index for when every axis fails
+			for (int iCurrentSplittingAxisIndex = 0; iCurrentSplittingAxisIndex < iNumSplittingAxes; iCurrentSplittingAxisIndex++)
+			{
+				// 2. Finding the splitting point on the current axis
+				// done by using the object mean (mean of the object centroids)
+
+				const float fPreDivisionFactor = 1.0f / static_cast<float>(uiNumObjectReferences);
+				const int iCurrentSplittingAxis = iSplittingAxes[iCurrentSplittingAxisIndex];
+
+				// accumulating equally weighted coordinates of the splitting axis
+				const auto fnSumWeightedCentroidCoordinates = [&](size_t uiFirstObjectReference, size_t uiNumObjectReferencesToSum) {
+					float fSum = 0.0f;
+					for (size_t uiCurrentObjectReference = uiFirstObjectReference; uiCurrentObjectReference < uiFirstObjectReference + uiNumObjectReferencesToSum; uiCurrentObjectReference++)
+						fSum += pObjectReferences[uiCurrentObjectReference].m_vec3Centroid[iCurrentSplittingAxis] * fPreDivisionFactor;
+					return fSum;
+				};
+
+				float fObjectCentroidsMean = 0.0f;
+				if (uiNumChunks == 1u)
+				{
+					fObjectCentroidsMean = fnSumWeightedCentroidCoordinates(0u, uiNumObjectReferences);
+				}
+				else
+				{
+					// floating point addition is not associative: the sums of the chunks are added up in a fixed order
+					std::vector<float> vecChunkSums(uiNumChunks, 0.0f);
+					ForEachObjectReferenceChunk(uiNumObjectReferences, pChunkTaskPool, [&](size_t uiChunk, size_t uiFirstObjectReference, size_t uiNumObjectReferencesInChunk) {
+						vecChunkSums[uiChunk] = fnSumWeightedCentroidCoordinates(uiFirstObjectReference, uiNumObjectReferencesInChunk);
+					});
+
+					for (float fCurrentChunkSum : vecChunkSums)
+						fObjectCentroidsMean += fCurrentChunkSum;
+				}
+
+				// 3. partitioning the object references:
+				// swapping the compact references in place, the scene objects themselves are never touched
+				size_t uiNumElementsLeft = 0u;
+				if (uiNumChunks == 1u)
+				{
+					const ObjectReference* pFirstRightObjectReference = std::partition(pObjectReferences, pObjectReferences + uiNumObjectReferences, [&](const ObjectReference& rObjectReference) {
+						return rObjectReference.m_vec3Centroid[iCurrentSplittingAxis] < fObjectCentroidsMean;
+					});
+					uiNumElementsLeft = static_cast<size_t>(pFirstRightObjectReference - pObjectReferences);
+				}
+				else
+				{
+					// std::partition leaves an order behind that chunks cannot reproduce, large sets are partitioned stably instead
+					uiNumElementsLeft = StablePartitionObjectReferencesInChunks(pObjectReferences, uiNumObjectReferences, iCurrentSplittingAxis, fObjectCentroidsMean, pChunkTaskPool);
+				}
+
+				if (uiNumElementsLeft > 0 && uiNumElementsLeft < uiNumObjectReferences) // if the objects were actually partitioned
+				{
+					uiNumLeftChildren = uiNumElementsLeft; // number of left children = partitioning index
+					break;	// no need to consider the other axes
+				}
+			}
+
+			/*
+				Now, there is still one edge case left: what if one were to add two identical objects to the tree?
+				identical = their two bounding volumes are identical.
+				There is no proper way to partition these objects, but they have to be partitioned. Otherwise,
+				tree construction would endlessly try to partition them in the "next" child.
+				Solution: just partition them "randomly" -> equal number of both objects on both sides
+			*/
+
+			if (uiNumLeftChildren == uiNumObjectReferences) // the invalid index from before partitioning was attempted
+				uiNumLeftChildren = uiNumObjectReferences / 2u;	// partition all identical objects evenly
+
+			/*
+				another note: since the objects were "fake" sorted already anyway, no need to sort them again.
+				It doesn't matter if they would have been all left or all right, they are still identical and sorted.
+			*/
+
+			return uiNumLeftChildren;
+		}
+
+		size_t StablePartitionObjectReferencesInChunks(ObjectReference * pObjectReferences, size_t uiNumObjectReferences, int iSplittingAxis, float fSplittingPlane, TaskPool * pTaskPool)
+		{
+			assert(pObjectReferences);
+
+			const size_t uiNumChunks = (uiNumObjectReferences + s_uiObjectReferenceChunkSize - 1u) / s_uiObjectReferenceChunkSize;
+			const auto fnIsLeft = [iSplittingAxis, fSplittingPlane](const ObjectReference& rObjectReference) {
+				return rObjectReference.m_vec3Centroid[iSplittingAxis] < fSplittingPlane;
+			};
+
+			// 1. counting, per chunk, how many references go left
+			std::vector<size_t> vecNumLeftPerChunk(uiNumChunks, 0u);
+			ForEachObjectReferenceChunk(uiNumObjectReferences, pTaskPool, [&](size_t uiChunk, size_t uiFirstObjectReference, size_t uiNumObjectReferencesInChunk) {
+				vecNumLeftPerChunk[uiChunk] = static_cast<size_t>(std::count_if(pObjectReferences + uiFirstObjectReference, pObjectReferences + uiFirstObjectReference + uiNumObjectReferencesInChunk, fnIsLeft));
+			});
+
+			// 2. where every chunk writes its left and right references to
+			std::vector<size_t> vecLeftOffsetPerChunk(uiNumChunks);
+			std::vector<size_t> vecRightOffsetPerChunk(uiNumChunks);
+			size_t uiNumLeft = 0u;
+			for (size_t uiCurrentChunk = 0u; uiCurrentChunk < uiNumChunks; uiCurrentChunk++)
+			{
+				vecLeftOffsetPerChunk[uiCurrentChunk] = uiNumLeft;
+				uiNumLeft += vecNumLeftPerChunk[uiCurrentChunk];
+			}
+
+			// nothing to move if everything ends up on one side
+			if (uiNumLeft == 0u || uiNumLeft == uiNumObjectReferences)
+				return uiNumLeft;
+
+			size_t uiNextRightOffset = uiNumLeft;
+			for (size_t uiCurrentChunk = 0u; uiCurrentChunk < uiNumChunks; uiCurrentChunk++)
+			{
+				vecRightOffsetPerChunk[uiCurrentChunk] = uiNextRightOffset;
+				const size_t uiNumObjectReferencesInChunk = std::min(s_uiObjectReferenceChunkSize, uiNumObjectReferences - uiCurrentChunk * s_uiObjectReferenceChunkSize);
+				uiNextRightOffset += uiNumObjectReferencesInChunk - vecNumLeftPerChunk[uiCurrentChunk];
+			}
+			assert(uiNextRightOffset == uiNumObjectReferences);
+
+			// 3. scattering into the scratch buffer, preserving the order within both sides ...
+			std::vector<ObjectReference> vecPartitionedObjectReferences(uiNumObjectReferences);
+			ForEachObjectReferenceChunk(uiNumObjectReferences, pTaskPool, [&](size_t uiChunk, size_t uiFirstObjectReference, size_t uiNumObjectReferencesInChunk) {
+				size_t uiNextLeft = vecLeftOffsetPerChunk[uiChunk];
+				size_t uiNextRight = vecRightOffsetPerChunk[uiChunk];
+				for (size_t uiCurrentObjectReference = uiFirstObjectReference; uiCurrentObjectReference < uiFirstObjectReference + uiNumObjectReferencesInChunk; uiCurrentObjectReference++)
+				{
+					const ObjectReference& rCurrentObjectReference = pObjectReferences[uiCurrentObjectReference];
+					if (fnIsLeft(rCurrentObjectReference))
+						vecPartitionedObjectReferences[uiNextLeft++] = rCurrentObjectReference;
+					else
+						vecPartitionedObjectReferences[uiNextRight++] = rCurrentObjectReference;
+				}
+			});
+
+			// ... and copying them back
+			ForEachObjectReferenceChunk(uiNumObjectReferences, pTaskPool, [&](size_t, size_t uiFirstObjectReference, size_t uiNumObjectReferencesInChunk) {
+				std::copy(vecPartitionedObjectReferences.begin() + uiFirstObjectReference, vecPartitionedObjectReferences.begin() + uiFirstObjectReference + uiNumObjectReferencesInChunk, pObjectReferences + uiFirstObjectReference);
+			});
+
+			return uiNumLeft;
+		}
+
+		size_t CalcSAHBinIndex(float fCentroidCoordinate, float fCentroidMinimum, float fBinsPerUnit, size_t uiNumBins)
+		{
+			const size_t uiBinIndex = static_cast<size_t>((fCentroidCoordinate - fCentroidMinimum) * fBinsPerUnit);
+
+			// the object(s) with the maximum centroid would land one past the last bin
+			return std::min(uiBinIndex, uiNumBins - 1u);
+		}
+
+		void GrowSAHBinByAABB(SAHBin & rBin, const AABB & rAABB)
+		{
+			rBin.m_vec3Min = glm::min(rBin.m_vec3Min, rAABB.m_vec3Center - rAABB.m_vec3Radius);
+			rBin.m_vec3Max = glm::max(rBin.m_vec3Max, rAABB.m_vec3Center + rAABB.m_vec3Radius);
+			rBin.m_uiNumObjects++;
+		}
+
+		float CalcBottomUpMergeCost_AABB(const AABB & rAABB1, const AABB & rAABB2)
+		{
+			const float fMergedAABBExtentX = std::abs(rAABB1.m_vec3Center.x - rAABB2.m_vec3Center.x) + rAABB1.m_vec3Radius.x + rAABB2.m_vec3Radius.x;
+			const float fMergedAABBExtentY = std::abs(rAABB1.m_vec3Center.y - rAABB2.m_vec3Center.y) + rAABB1.m_vec3Radius.y + rAABB2.m_vec3Radius.y;
+			const float fMergedAABBExtentZ = std::abs(rAABB1.m_vec3Center.z - rAABB2.m_vec3Center.z) + rAABB1.m_vec3Radius.z + rAABB2.m_vec3Radius.z;
+
+			return fMergedAABBExtentX * fMergedAABBExtentY * fMergedAABBExtentZ;
+		}
+
+		float CalcBottomUpMergeCost_BoundingSphere(const BoundingSphere & rBoundingSphere1, const BoundingSphere & rBoundingSphere2)
+		{
+			/*
+				The two most distant points of both spheres lie on the line through both centers:
+				one radius "behind" the first center and one radius "beyond" the second center.
+				Their distance, which effectively is the diameter of the bounding sphere that would encompass both spheres,
+				therefore is the distance of the centers plus both radii.
+				Unlike normalizing the center distance, this also works for concentric spheres.
+			*/
+			const float fCenterPointsDistance = glm::length(rBoundingSphere2.m_vec3Center - rBoundingSphere1.m_vec3Center);
+
+			return fCenterPointsDistance + rBoundingSphere1.m_fRadius + rBoundingSphere2.m_fRadius;
+		}
+
+		template <typename BoundingVolume>
+		std::vector<BottomUpMerge> CalcBottomUpMergeOrder(std::vector<BoundingVolume>& rvecBoundingVolumes,
+			float(*pMergeCostFunction)(const BoundingVolume&, const BoundingVolume&),
+			BoundingVolume(*pMergeFunction)(const BoundingVolume&, const BoundingVolume&))
+		{
+			/*
+				an explanation:
+				The naive approach searches all pairs of nodes for the cheapest merge, for every single merge.
+				Here, every node instead remembers its best merge partner and what merging with it would cost.
+				The cheapest of all those cached merges is the globally cheapest merge, so a priority queue hands it out.
+				After merging two nodes:
+				1. the new node searches for its best merge partner once
+				2. every other node only checks whether the new node is a better partner than the one it already knows
+				3. only nodes whose best partner just got merged away have to search again
+				Entries in the priority queue are never removed, they are invalidated by a node's version counter instead.
+				Merges of equal cost are ordered by the pair's smaller node index, then its larger one, so ties never depend on the
+				order of the active nodes or of the priority queue: every node keeps the partner with the smaller index among equally
+				good ones, which makes its cached merge the least pair it is part of.
+			*/
+			struct CachedMerge {
+				float m_fMergeCost;
+				size_t m_uiNodeIndex;
+				size_t m_uiPartnerIndex;
+				uint32_t m_uiNodeVersion;
+
+				bool operator> (const CachedMerge& rOther) const {
+					if (m_fMergeCost != rOther.m_fMergeCost)
+						return m_fMergeCost > rOther.m_fMergeCost;
+					const size_t uiSmallerIndex = std::min(m_uiNodeIndex, m_uiPartnerIndex);
+					const size_t uiOtherSmallerIndex = std::min(rOther.m_uiNodeIndex, rOther.m_uiPartnerIndex);
+					if (uiSmallerIndex != uiOtherSmallerIndex)
+						return uiSmallerIndex > uiOtherSmallerIndex;
+					return std::max(m_uiNodeIndex, m_uiPartnerIndex) > std::max(rOther.m_uiNodeIndex, rOther.m_uiPartnerIndex);
+				}
+			};
+
+			const size_t uiNumLeaves = rvecBoundingVolumes.size();
+			const size_t uiMaxNumNodes = 2u * uiNumLeaves - 1u;
+
+			std::vector<BottomUpMerge> vecResult;
+			vecResult.reserve(uiNumLeaves - 1u);
+
+			std::vector<size_t> vecBestMergePartner(uiMaxNumNodes, 0u);
+			std::vector<float> vecBestMergeCost(uiMaxNumNodes, std::numeric_limits<float>::max());
+			std::vector<uint32_t> vecNodeVersions(uiMaxNumNodes, 0u);
+			std::vector<size_t> vecActiveNodes;		// nodes that have not been merged yet. Unordered, removal swaps with the last one
+			std::vector<size_t> vecPositionInActiveNodes(uiMaxNumNodes, 0u);
+			std::priority_queue<CachedMerge, std::vector<CachedMerge>, std::greater<CachedMerge>> tCachedMerges;
+
+			auto SearchBestMergePartner = [&](size_t uiNodeIndex) {
+				vecBestMergeCost[uiNodeIndex] = std::numeric_limits<float>::max();
+				vecBestMergePartner[uiNodeIndex] = std::numeric_limits<size_t>::max();
+				for (size_t uiOtherNodeIndex : vecActiveNodes)
+				{
+					if (uiOtherNodeIndex == uiNodeIndex)
+						continue;
+
+					const float fMergeCost = pMergeCostFunction(rvecBoundingVolumes[uiNodeIndex], rvecBoundingVolumes[uiOtherNodeIndex]);
+					const bool bIsTieWithSmallerIndex = (fMergeCost == vecBestMergeCost[uiNodeIndex]) && (uiOtherNodeIndex < vecBestMergePartner[uiNodeIndex]);
+					if (fMergeCost < vecBestMergeCost[uiNodeIndex] || bIsTieWithSmallerIndex)
+					{
+						vecBestMergeCost[uiNodeIndex] = fMergeCost;
+						vecBestMergePartner[uiNodeIndex] = uiOtherNodeIndex;
+					}
+				}
+
+				vecNodeVersions[uiNodeIndex]++;
+				if (vecBestMergeCost[uiNodeIndex] < std::numeric_limits<float>::max())
+					tCachedMerges.push({ vecBestMergeCost[uiNodeIndex], uiNodeIndex, vecBestMergePartner[uiNodeIndex], vecNodeVersions[uiNodeIndex] });
+			};
+
+			auto RemoveFromActiveNodes = [&](size_t uiNodeIndex) {
+				const size_t uiPosition = vecPositionInActiveNodes[uiNodeIndex];
+				vecActiveNodes[uiPosition] = vecActiveNodes.back();
+				vecPositionInActiveNodes[vecActiveNodes[uiPosition]] = uiPosition;
+				vecActiveNodes.pop_back();
+				vecNodeVersions[uiNodeIndex]++;	// invalidates all of its cached merges
+			};
+
+			// initially, all leaves are active and search their best partner among each other
+			vecActiveNodes.reserve(uiNumLeaves);
+			for (size_t uiCurrentLeaf = 0u; uiCurrentLeaf < uiNumLeaves; uiCurrentLeaf++)
+			{
+				vecPositionInActiveNodes[uiCurrentLeaf] = vecActiveNodes.size();
+				vecActiveNodes.push_back(uiCurrentLeaf);
+			}
+			for (size_t uiCurrentLeaf = 0u; uiCurrentLeaf < uiNumLeaves; uiCurrentLeaf++)
+				SearchBestMergePartner(uiCurrentLeaf);
+
+			std::vector<size_t> vecNodesThatLostTheirPartner;
+			while (vecActiveNodes.size() > 1u)
+			{
+				// the cheapest cached merge that is still valid is the globally cheapest merge
+				assert(!tCachedMerges.empty());
+				const CachedMerge tCheapestMerge = tCachedMerges.top();
+				tCachedMerges.pop();
+				if (tCheapestMerge.m_uiNodeVersion != vecNodeVersions[tCheapestMerge.m_uiNodeIndex])
+					continue;	// outdated
+
+				const size_t uiMergePartnerIndex1 = tCheapestMerge.m_uiNodeIndex;
+				const size_t uiMergePartnerIndex2 = vecBestMergePartner[uiMergePartnerIndex1];
+
+				// merging
+				const size_t uiNewNodeIndex = rvecBoundingVolumes.size();
+				rvecBoundingVolumes.push_back(pMergeFunction(rvecBoundingVolumes[uiMergePartnerIndex1], rvecBoundingVolumes[uiMergePartnerIndex2]));
+				vecResult.push_back({ std::min(uiMergePartnerIndex1, uiMergePartnerIndex2), std::max(uiMergePartnerIndex1, uiMergePartnerIndex2) });
+
+				RemoveFromActiveNodes(uiMergePartnerIndex1);
+				RemoveFromActiveNodes(uiMergePartnerIndex2);
+
+				// 2. & 3.: updating every remaining node with the new node as a potential partner
+				vecNodesThatLostTheirPartner.clear();
+				for (size_t uiCurrentActiveNode : vecActiveNodes)
+				{
+					const size_t uiCurrentBestPartner = vecBestMergePartner[uiCurrentActiveNode];
+					if (uiCurrentBestPartner == uiMergePartnerIndex1 || uiCurrentBestPartner == uiMergePartnerIndex2)
+					{
+						vecNodesThatLostTheirPartner.push_back(uiCurrentActiveNode);
+						continue;
+					}
+
+					// on a tie, the current partner is kept: the new node has the largest index of all
+					const float fMergeCost = pMergeCostFunction(rvecBoundingVolumes[uiCurrentActiveNode], rvecBoundingVolumes[uiNewNodeIndex]);
+					if (fMergeCost < vecBestMergeCost[uiCurrentActiveNode])
+					{
+						vecBestMergeCost[uiCurrentActiveNode] = fMergeCost;
+						vecBestMergePartner[uiCurrentActiveNode] = uiNewNodeIndex;
+						vecNodeVersions[uiCurrentActiveNode]++;
+						tCachedMerges.push({ fMergeCost, uiCurrentActiveNode, uiNewNodeIndex, vecNodeVersions[uiCurrentActiveNode] });
+					}
+				}
+
+				vecPositionInActiveNodes[uiNewNodeIndex] = vecActiveNodes.size();
+				vecActiveNodes.push_back(uiNewNodeIndex);
+
+				for (size_t uiCurrentNodeThatLostItsPartner : vecNodesThatLostTheirPartner)
+					SearchBestMergePartner(uiCurrentNodeThatLostItsPartner);
+
+				// 1.
+				SearchBestMergePartner(uiNewNodeIndex);
+			}
+
+			assert(vecResult.size() == uiNumLeaves - 1u);
+
+			return vecResult;
+		}
+
+		uint32_t RecursiveFlattenBVHTree(const BVHTreeNode * pNode, const std::vector<SceneObject*>& rvecObjectPermutation, std::vector<LinearBVHNode>& rvecLinearNodes)
+		{
+			assert(pNode);
+			assert(rvecLinearNodes.size() < std::numeric_limits<uint32_t>::max());
+
+			const uint32_t uiNewNodeIndex = static_cast<uint32_t>(rvecLinearNodes.size());
+			rvecLinearNodes.push_back(LinearBVHNode());
+
+			glm::vec3 vec3Min(std::numeric_limits<float>::max());
+			glm::vec3 vec3Max(std::numeric_limits<float>::lowest());
+			uint32_t uiRightChildOrFirstObject = 0u;
+			uint32_t uiNumObjects = 0u;
+
+			if (pNode->IsANode())
+			{
+				// if it is a node, there was a partitioning step, which means there have to be two children
+				assert(pNode->m_pLeft);
+				assert(pNode->m_pRight);
+
+				// the left child is appended first and therefore lands directly behind this node
+				const uint32_t uiLeftChildIndex = RecursiveFlattenBVHTree(pNode->m_pLeft, rvecObjectPermutation, rvecLinearNodes);
+				const uint32_t uiRightChildIndex = RecursiveFlattenBVHTree(pNode->m_pRight, rvecObjectPermutation, rvecLinearNodes);
+				assert(uiLeftChildIndex == uiNewNodeIndex + 1u);
+
+				// careful: the vector might have grown, no references into it are held across the recursion
+				vec3Min = glm::min(rvecLinearNodes[uiLeftChildIndex].m_vec3Min, rvecLinearNodes[uiRightChildIndex].m_vec3Min);
+				vec3Max = glm::max(rvecLinearNodes[uiLeftChildIndex].m_vec3Max, rvecLinearNodes[uiRightChildIndex].m_vec3Max);
+				uiRightChildOrFirstObject = uiRightChildIndex;
+			}
+			else // is a leaf
+			{
+				assert(pNode->m_uiFirstObject + pNode->m_uiNumOjbects <= rvecObjectPermutation.size());
+
+				for (uint32_t uiCurrentObject = pNode->m_uiFirstObject; uiCurrentObject < pNode->m_uiFirstObject + pNode->m_uiNumOjbects; uiCurrentObject++)
+				{
+					const AABB& rCurrentAABB = rvecObjectPermutation[uiCurrentObject]->m_tWorldSpaceAABB;
+					vec3Min = glm::min(vec3Min, rCurrentAABB.m_vec3Center - rCurrentAABB.m_vec3Radius);
+					vec3Max = glm::max(vec3Max, rCurrentAABB.m_vec3Center + rCurrentAABB.m_vec3Radius);
+				}
+				uiRightChildOrFirstObject = pNode->m_uiFirstObject;
+				uiNumObjects = pNode->m_uiNumOjbects;
+			}
+
+			LinearBVHNode& rNewNode = rvecLinearNodes[uiNewNodeIndex];
+			rNewNode.m_vec3Min = vec3Min;
+			rNewNode.m_vec3Max = vec3Max;
+			rNewNode.m_uiRightChildOrFirstObject = uiRightChildOrFirstObject;
+			rNewNode.m_uiNumObjects = uiNumObjects;
+
+			return uiNewNodeIndex;
+		}
+
+		template <size_t uiWidth>
+		uint32_t RecursiveCollapseIntoWideBVH(const std::vector<LinearBVHNode>& rvecLinearNodes, uint32_t uiLinearNodeIndex, std::vector<WideBVHNode<uiWidth>>& rvecWideNodes)
+		{
+			static_assert(uiWidth >= 2u, "a wide node needs room for both children of a binary node");
+			assert(uiLinearNodeIndex < rvecLinearNodes.size());
+			assert(rvecWideNodes.size() < std::numeric_limits<uint32_t>::max());
+
+			const uint32_t uiNewNodeIndex = static_cast<uint32_t>(rvecWideNodes.size());
+			rvecWideNodes.push_back(WideBVHNode<uiWidth>());
+
+			// gathering the children. Only a hierarchy consisting of a single leaf ends up with a single child here
+			uint32_t pChildren[uiWidth];
+			size_t uiNumChildren = 0u;
+			const LinearBVHNode& rLinearNode = rvecLinearNodes[uiLinearNodeIndex];
+			if (rLinearNode.IsANode())
+			{
+				pChildren[uiNumChildren++] = uiLinearNodeIndex + 1u;
+				pChildren[uiNumChildren++] = rLinearNode.m_uiRightChildOrFirstObject;
+			}
+			else
+			{
+				pChildren[uiNumChildren++] = uiLinearNodeIndex;
+			}
+
+			// opening the largest child that is a node, until the wide node is full or only leaves are left
+			while (uiNumChildren < uiWidth)
+			{
+				size_t uiChildToOpen = uiWidth;
+				float fLargestSurfaceArea = -1.0f;
+				for (size_t uiCurrentChild = 0u; uiCurrentChild < uiNumChildren; uiCurrentChild++)
+				{
+					const LinearBVHNode& rCurrentChild = rvecLinearNodes[pChildren[uiCurrentChild]];
+					if (!rCurrentChild.IsANode())
+						continue;
+
+					const glm::vec3 vec3Extents = rCurrentChild.m_vec3Max - rCurrentChild.m_vec3Min;
+					const float fSurfaceArea = 2.0f * (vec3Extents.x * vec3Extents.y + vec3Extents.y * vec3Extents.z + vec3Extents.z * vec3Extents.x);
+					if (fSurfaceArea > fLargestSurfaceArea)
+					{
+						fLargestSurfaceArea = fSurfaceArea;
+						uiChildToOpen = uiCurrentChild;
+					}
+				}
+
+				if (uiChildToOpen == uiWidth)
+					break;
+
+				// the left grandchild takes the opened child's slot, so neighbouring slots stay neighbours in space
+				const uint32_t uiOpenedChild = pChildren[uiChildToOpen];
+				pChildren[uiChildToOpen] = uiOpenedChild + 1u;
+				pChildren[uiNumChildren++] = rvecLinearNodes[uiOpenedChild].m_uiRightChildOrFirstObject;
+			}
+
+			for (size_t uiCurrentChild = 0u; uiCurrentChild < uiNumChildren; uiCurrentChild++)
+			{
+				const LinearBVHNode& rCurrentChild = rvecLinearNodes[pChildren[uiCurrentChild]];
+				uint32_t uiChildNodeOrFirstObject = rCurrentChild.m_uiRightChildOrFirstObject;
+				if (rCurrentChild.IsANode())
+					uiChildNodeOrFirstObject = RecursiveCollapseIntoWideBVH(rvecLinearNodes, pChildren[uiCurrentChild], rvecWideNodes);
+
+				// careful: the vector might have grown during the recursion
+				WideBVHNode<uiWidth>& rNewNode = rvecWideNodes[uiNewNodeIndex];
+				rNewNode.m_pChildMinX[uiCurrentChild] = rCurrentChild.m_vec3Min.x;
+				rNewNode.m_pChildMinY[uiCurrentChild] = rCurrentChild.m_vec3Min.y;
+				rNewNode.m_pChildMinZ[uiCurrentChild] = rCurrentChild.m_vec3Min.z;
+				rNewNode.m_pChildMaxX[uiCurrentChild] = rCurrentChild.m_vec3Max.x;
+				rNewNode.m_pChildMaxY[uiCurrentChild] = rCurrentChild.m_vec3Max.y;
+				rNewNode.m_pChildMaxZ[uiCurrentChild] = rCurrentChild.m_vec3Max.z;
+				rNewNode.m_pChildNodeOrFirstObject[uiCurrentChild] = uiChildNodeOrFirstObject;
+				rNewNode.m_pChildNumObjects[uiCurrentChild] = rCurrentChild.m_uiNumObjects;
+			}
+			rvecWideNodes[uiNewNodeIndex].m_uiNumChildren = static_cast<uint32_t>(uiNumChildren);
+
+			return uiNewNodeIndex;
+		}
+
+		template <size_t uiWidth>
+		WideBVH<uiWidth> CreateWideBVH(const BoundingVolumeHierarchy & rBVH)
+		{
+			WideBVH<uiWidth> tResult;
+
+			// the flattened hierarchy already holds the AABBs of all nodes, whichever bounding volume the hierarchy was built with
+			LinearBVH tLinearBVH = CreateLinearBVH(rBVH);
+			if (tLinearBVH.m_vecNodes.empty())
+				return tResult;
+
+			// every wide node replaces at least one binary node
+			tResult.m_vecNodes.reserve(tLinearBVH.m_vecNodes.size() / 2u + 1u);
+			RecursiveCollapseIntoWideBVH(tLinearBVH.m_vecNodes, 0u, tResult.m_vecNodes);
+
+			// leaves keep their object ranges, so the permutation can be taken as it is
+			tResult.m_vecObjectPermutation = std::move(tLinearBVH.m_vecObjectPermutation);
+
+			return tResult;
+		}
+
+		void RecursiveConstructKDTreeNode(KDTreeConstruction & rConstruction, const std::vector<uint32_t>& rvecObjectIndices, const glm::vec3 & rvec3CellMin, const glm::vec3 & rvec3CellMax,
+			int iRemainingDepth, int iNumBadRefines)
+		{
+			KDTree& rKDTree = *rConstruction.m_pKDTree;
+			const KDTreeParameters& rParameters = *rConstruction.m_pParameters;
+			const size_t uiNumObjects = rvecObjectIndices.size();
+			const uint32_t uiNodeIndex = static_cast<uint32_t>(rKDTree.m_vecNodes.size());
+			rKDTree.m_vecNodes.emplace_back();
+
+			// find the cheapest splitting plane, unless the set is small enough for a leaf anyway
+			const glm::vec3 vec3CellExtent = rvec3CellMax - rvec3CellMin;
+			const float fCellSurfaceArea = 2.0f * (vec3CellExtent.x * vec3CellExtent.y + vec3CellExtent.x * vec3CellExtent.z + vec3CellExtent.y * vec3CellExtent.z);
+			const float fLeafCost = rParameters.m_fObjectIntersectionCost * static_cast<float>(uiNumObjects);
+			float fBestCost = std::numeric_limits<float>::max();
+			int iBestAxis = -1;
+			size_t uiBestEdge = 0u;
+
+			if (iRemainingDepth > 0 && uiNumObjects > rParameters.m_uiMaxObjectsPerLeaf && fCellSurfaceArea > 0.0f)
+			{
+				const float fInverseCellSurfaceArea = 1.0f / fCellSurfaceArea;
+
+				for (int iCurrentAxis = 0; iCurrentAxis < 3; iCurrentAxis++)
+				{
+					// every object begins and ends once on this axis. At equal positions beginnings come first,
+					// so an object touching the plane from above is still counted on both sides of it
+					std::vector<KDTreeEdge>& rvecEdges = rConstruction.m_pEdges[iCurrentAxis];
+					rvecEdges.clear();
+					for (uint32_t uiCurrentObjectIndex : rvecObjectIndices)
+					{
+						const AABB& rCurrentAABB = rConstruction.m_pSceneObjects[uiCurrentObjectIndex].m_tWorldSpaceAABB;
+						rvecEdges.push_back({ rCurrentAABB.m_vec3Center[iCurrentAxis] - rCurrentAABB.m_vec3Radius[iCurrentAxis], uiCurrentObjectIndex, true });
+						rvecEdges.push_back({ rCurrentAABB.m_vec3Center[iCurrentAxis] + rCurrentAABB.m_vec3Radius[iCurrentAxis], uiCurrentObjectIndex, false });
+					}
+					std::sort(rvecEdges.begin(), rvecEdges.end(), [](const KDTreeEdge& rFirst, const KDTreeEdge& rSecond) {
+						if (rFirst.m_fPosition != rSecond.m_fPosition)
+							return rFirst.m_fPosition < rSecond.m_fPosition;
+						return rFirst.m_bIsStart && !rSecond.m_bIsStart;
+					});
+
+					// sweep the planes through all edges, counting the objects on both sides. The surface areas of the two cells
+					// share the faces parallel to the plane, only the faces along the axis grow and shrink
+					const int iOtherAxis0 = (iCurrentAxis + 1) % 3;
+					const int iOtherAxis1 = (iCurrentAxis + 2) % 3;
+					const float fPlaneArea = vec3CellExtent[iOtherAxis0] * vec3CellExtent[iOtherAxis1];
+					const float fPlaneCircumference = vec3CellExtent[iOtherAxis0] + vec3CellExtent[iOtherAxis1];
+					size_t uiNumObjectsBelow = 0u;
+					size_t uiNumObjectsAbove = uiNumObjects;
+
+					for (size_t uiCurrentEdge = 0u; uiCurrentEdge < rvecEdges.size(); uiCurrentEdge++)
+					{
+						const KDTreeEdge& rCurrentEdge = rvecEdges[uiCurrentEdge];
+						if (!rCurrentEdge.m_bIsStart)
+							uiNumObjectsAbove--;
+
+						// planes on the cell's boundary would not split anything
+						const float fPosition = rCurrentEdge.m_fPosition;
+						if (fPosition > rvec3CellMin[iCurrentAxis] && fPosition < rvec3CellMax[iCurrentAxis])
+						{
+							const float fSurfaceAreaBelow = 2.0f * (fPlaneArea + (fPosition - rvec3CellMin[iCurrentAxis]) * fPlaneCircumference);
+							const float fSurfaceAreaAbove = 2.0f * (fPlaneArea + (rvec3CellMax[iCurrentAxis] - fPosition) * fPlaneCircumference);
+							const float fEmptyBonus = (uiNumObjectsBelow == 0u || uiNumObjectsAbove == 0u) ? rParameters.m_fEmptyBonus : 0.0f;
+							const float fCost = rParameters.m_fNodeTraversalCost + rParameters.m_fObjectIntersectionCost * (1.0f - fEmptyBonus) *
+								(fSurfaceAreaBelow * fInverseCellSurfaceArea * static_cast<float>(uiNumObjectsBelow) + fSurfaceAreaAbove * fInverseCellSurfaceArea * static_cast<float>(uiNumObjectsAbove));
+
+							if (fCost < fBestCost)
+							{
+								fBestCost = fCost;
+								iBestAxis = iCurrentAxis;
+								uiBestEdge = uiCurrentEdge;
+							}
+						}
+
+						if (rCurrentEdge.m_bIsStart)
+							uiNumObjectsBelow++;
+					}
+				}
+
+				// a split that costs more than a leaf may still pay off further down, but not for too long
+				if (fBestCost > fLeafCost)
+					iNumBadRefines++;
+			}
+
+			if (iBestAxis == -1 || iNumBadRefines == 3 || (fBestCost > 4.0f * fLeafCost && uiNumObjects < 16u))
+			{
+				KDTreeNode& rLeaf = rKDTree.m_vecNodes[uiNodeIndex];
+				rLeaf.m_fSplitPosition = 0.0f;
+				rLeaf.m_uiAboveChildOrFirstObject = static_cast<uint32_t>(rKDTree.m_vecObjectReferences.size());
+				rLeaf.m_uiNumObjects = static_cast<uint32_t>(uiNumObjects);
+				rLeaf.m_uiSplitAxis = 3u;
+				for (uint32_t uiCurrentObjectIndex : rvecObjectIndices)
+					rKDTree.m_vecObjectReferences.push_back(rConstruction.m_pSceneObjects + uiCurrentObjectIndex);
+				return;
+			}
+
+			// the edges of the best axis are still sorted: objects beginning before the plane lie below it, objects ending after it above.
+			// The edges of the other axes were only needed for their costs, so the scratch memory can be handed down to the children
+			const std::vector<KDTreeEdge>& rvecBestEdges = rConstruction.m_pEdges[iBestAxis];
+			const float fSplitPosition = rvecBestEdges[uiBestEdge].m_fPosition;
+			std::vector<uint32_t> vecObjectIndicesBelow, vecObjectIndicesAbove;
+			for (size_t uiCurrentEdge = 0u; uiCurrentEdge < uiBestEdge; uiCurrentEdge++)
+			{
+				if (rvecBestEdges[uiCurrentEdge].m_bIsStart)
+					vecObjectIndicesBelow.push_back(rvecBestEdges[uiCurrentEdge].m_uiObjectIndex);
+			}
+			for (size_t uiCurrentEdge = uiBestEdge + 1u; uiCurrentEdge < rvecBestEdges.size(); uiCurrentEdge++)
+			{
+				if (!rvecBestEdges[uiCurrentEdge].m_bIsStart)
+					vecObjectIndicesAbove.push_back(rvecBestEdges[uiCurrentEdge].m_uiObjectIndex);
+			}
+
+			KDTreeNode& rNode = rKDTree.m_vecNodes[uiNodeIndex];
+			rNode.m_fSplitPosition = fSplitPosition;
+			rNode.m_uiNumObjects = 0u;
+			rNode.m_uiSplitAxis = static_cast<uint32_t>(iBestAxis);
+
+			glm::vec3 vec3BelowCellMax = rvec3CellMax;
+			vec3BelowCellMax[iBestAxis] = fSplitPosition;
+			RecursiveConstructKDTreeNode(rConstruction, vecObjectIndicesBelow, rvec3CellMin, vec3BelowCellMax, iRemainingDepth - 1, iNumBadRefines);
+			std::vector<uint32_t>().swap(vecObjectIndicesBelow);
+
+			// the node array may have grown in the meantime
+			rKDTree.m_vecNodes[uiNodeIndex].m_uiAboveChildOrFirstObject = static_cast<uint32_t>(rKDTree.m_vecNodes.size());
+			glm::vec3 vec3AboveCellMin = rvec3CellMin;
+			vec3AboveCellMin[iBestAxis] = fSplitPosition;
+			RecursiveConstructKDTreeNode(rConstruction, vecObjectIndicesAbove, vec3AboveCellMin, rvec3CellMax, iRemainingDepth - 1, iNumBadRefines);
+		}
+
+		float CalcNodeSurfaceArea_AABB(const BVHTreeNode & rNode)
+		{
+			return rNode.m_tAABBForNode.CalcSurfaceArea();
+		}
+
+		float CalcNodeSurfaceArea_BoundingSphere(const BVHTreeNode & rNode)
+		{
+			return rNode.m_tBoundingSphereForNode.CalcSurfaceArea();
+		}
+
+		float RecursiveLinkBVHTreeForRefitting(BoundingVolumeHierarchy & rBVH, BVHTreeNode * pNode, BVHTreeNode * pParent, const SceneObject * pSceneObjects, float(*pCalcNodeSurfaceArea)(const BVHTreeNode&))
+		{
+			assert(pNode);
+
+			pNode->m_pParent = pParent;
+
+			if (pNode->IsANode())
+			{
+				// if it is a node, there was a partitioning step, which means there have to be two children
+				assert(pNode->m_pLeft);
+				assert(pNode->m_pRight);
+
+				return pCalcNodeSurfaceArea(*pNode)
+					+ RecursiveLinkBVHTreeForRefitting(rBVH, pNode->m_pLeft, pNode, pSceneObjects, pCalcNodeSurfaceArea)
+					+ RecursiveLinkBVHTreeForRefitting(rBVH, pNode->m_pRight, pNode, pSceneObjects, pCalcNodeSurfaceArea);
+			}
+			else // is a leaf
+			{
+				for (uint32_t uiCurrentObject = pNode->m_uiFirstObject; uiCurrentObject < pNode->m_uiFirstObject + pNode->m_uiNumOjbects; uiCurrentObject++)
+				{
+					const size_t uiObjectIndex = static_cast<size_t>(rBVH.m_vecObjectPermutation[uiCurrentObject] - pSceneObjects);
+					assert(uiObjectIndex < rBVH.m_vecLeafOfObject.size());
+					rBVH.m_vecLeafOfObject[uiObjectIndex] = pNode;
+				}
+
+				return 0.0f;
+			}
+		}
+
+		bool RefitNode_AABB(BVHTreeNode & rNode, const std::vector<SceneObject*>& rvecObjectPermutation)
+		{
+			AABB tRefittedAABB;
+			if (rNode.IsANode())
+			{
+				tRefittedAABB = MergeTwoAABBs(rNode.m_pLeft->m_tAABBForNode, rNode.m_pRight->m_tAABBForNode);
+			}
+			else // is a leaf
+			{
+				tRefittedAABB = rvecObjectPermutation[rNode.m_uiFirstObject]->m_tWorldSpaceAABB;
+				for (uint32_t uiCurrentObject = rNode.m_uiFirstObject + 1u; uiCurrentObject < rNode.m_uiFirstObject + rNode.m_uiNumOjbects; uiCurrentObject++)
+					tRefittedAABB = MergeTwoAABBs(tRefittedAABB, rvecObjectPermutation[uiCurrentObject]->m_tWorldSpaceAABB);
+			}
+
+			const bool bHasChanged = (tRefittedAABB.m_vec3Center != rNode.m_tAABBForNode.m_vec3Center) || (tRefittedAABB.m_vec3Radius != rNode.m_tAABBForNode.m_vec3Radius);
+			rNode.m_tAABBForNode = tRefittedAABB;
+
+			return bHasChanged;
+		}
+
+		bool RefitNode_BoundingSphere(BVHTreeNode & rNode, const std::vector<SceneObject*>& rvecObjectPermutation)
+		{
+			BoundingSphere tRefittedBoundingSphere;
+			if (rNode.IsANode())
+			{
+				tRefittedBoundingSphere = MergeTwoBoundingSpheres(rNode.m_pLeft->m_tBoundingSphereForNode, rNode.m_pRight->m_tBoundingSphereForNode);
+			}
+			else // is a leaf
+			{
+				tRefittedBoundingSphere = rvecObjectPermutation[rNode.m_uiFirstObject]->m_tWorldSpaceBoundingSphere;
+				for (uint32_t uiCurrentObject = rNode.m_uiFirstObject + 1u; uiCurrentObject < rNode.m_uiFirstObject + rNode.m_uiNumOjbects; uiCurrentObject++)
+					tRefittedBoundingSphere = MergeTwoBoundingSpheres(tRefittedBoundingSphere, rvecObjectPermutation[uiCurrentObject]->m_tWorldSpaceBoundingSphere);
+			}
+
+			const bool bHasChanged = (tRefittedBoundingSphere.m_vec3Center != rNode.m_tBoundingSphereForNode.m_vec3Center) || (tRefittedBoundingSphere.m_fRadius != rNode.m_tBoundingSphereForNode.m_fRadius);
+			rNode.m_tBoundingSphereForNode = tRefittedBoundingSphere;
+
+			return bHasChanged;
+		}
+
+		void RefitBVHTreeFromLeaf(BoundingVolumeHierarchy & rBVH, BVHTreeNode * pLeaf, bool(*pRefitNode)(BVHTreeNode&, const std::vector<SceneObject*>&), float(*pCalcNodeSurfaceArea)(const BVHTreeNode&))
+		{
+			assert(pLeaf);
+			assert(!pLeaf->IsANode());
+
+			for (BVHTreeNode* pCurrentNode = pLeaf; pCurrentNode != nullptr; pCurrentNode = pCurrentNode->m_pParent)
+			{
+				const float fSurfaceAreaBeforeRefit = pCalcNodeSurfaceArea(*pCurrentNode);
+
+				// a bounding volume that stays the same cannot change any ancestor's either
+				if (!pRefitNode(*pCurrentNode, rBVH.m_vecObjectPermutation))
+					break;
+
+				if (pCurrentNode->IsANode())
+					rBVH.m_fNodeSurfaceArea += pCalcNodeSurfaceArea(*pCurrentNode) - fSurfaceAreaBeforeRefit;
+			}
+		}
+
+		uint64_t ExpandBitsForMortonCode30(uint64_t uiValue)
+		{
+			uiValue &= 0x3ffu;
+			uiValue = (uiValue | (uiValue << 16)) & 0x30000ffu;
+			uiValue = (uiValue | (uiValue << 8)) & 0x300f00fu;
+			uiValue = (uiValue | (uiValue << 4)) & 0x30c30c3u;
+			uiValue = (uiValue | (uiValue << 2)) & 0x9249249u;
+
+			return uiValue;
+		}
+
+		uint64_t ExpandBitsForMortonCode63(uint64_t uiValue)
+		{
+			uiValue &= 0x1fffffu;
+			uiValue = (uiValue | (uiValue << 32)) & 0x1f00000000ffffu;
+			uiValue = (uiValue | (uiValue << 16)) & 0x1f0000ff0000ffu;
+			uiValue = (uiValue | (uiValue << 8)) & 0x100f00f00f00f00fu;
+			uiValue = (uiValue | (uiValue << 4)) & 0x10c30c30c30c30c3u;
+			uiValue = (uiValue | (uiValue << 2)) & 0x1249249249249249u;
+
+			return uiValue;
+		}
+
+		std::vector<MortonCodedObject> CreateSortedMortonCodes(const SceneObject * pSceneObjects, size_t uiNumSceneObjects, const LBVHParameters & rParameters, TaskPool * pTaskPool)
+		{
+			assert(pSceneObjects);
+			assert(uiNumSceneObjects <= std::numeric_limits<uint32_t>::max());
+
+			TaskPool* pChunkTaskPool = (uiNumSceneObjects >= s_uiMinNumObjectReferencesForParallelPartitioning) ? pTaskPool : nullptr;
+			const size_t uiNumChunks = (uiNumSceneObjects + s_uiObjectReferenceChunkSize - 1u) / s_uiObjectReferenceChunkSize;
+
+			// 1. extent of all centroids, reduced chunk by chunk
+			std::vector<glm::vec3> vecChunkCentroidMin(uiNumChunks, glm::vec3(std::numeric_limits<float>::max()));
+			std::vector<glm::vec3> vecChunkCentroidMax(uiNumChunks, glm::vec3(std::numeric_limits<float>::lowest()));
+			ForEachObjectReferenceChunk(uiNumSceneObjects, pChunkTaskPool, [&](size_t uiChunk, size_t uiFirstObject, size_t uiNumObjectsInChunk) {
+				for (size_t uiCurrentObject = uiFirstObject; uiCurrentObject < uiFirstObject + uiNumObjectsInChunk; uiCurrentObject++)
+				{
+					vecChunkCentroidMin[uiChunk] = glm::min(vecChunkCentroidMin[uiChunk], pSceneObjects[uiCurrentObject].m_tWorldSpaceAABB.m_vec3Center);
+					vecChunkCentroidMax[uiChunk] = glm::max(vecChunkCentroidMax[uiChunk], pSceneObjects[uiCurrentObject].m_tWorldSpaceAABB.m_vec3Center);
+				}
+			});
+
+			glm::vec3 vec3CentroidMin = vecChunkCentroidMin[0];
+			glm::vec3 vec3CentroidMax = vecChunkCentroidMax[0];
+			for (size_t uiCurrentChunk = 1u; uiCurrentChunk < uiNumChunks; uiCurrentChunk++)
+			{
+				vec3CentroidMin = glm::min(vec3CentroidMin, vecChunkCentroidMin[uiCurrentChunk]);
+				vec3CentroidMax = glm::max(vec3CentroidMax, vecChunkCentroidMax[uiCurrentChunk]);
+			}
+
+			// 2. quantizing every centroid within that extent and interleaving the bits of its coordinates
+			const size_t uiNumBitsPerAxis = rParameters.m_bUse63BitMortonCodes ? 21u : 10u;
+			const float fNumCellsPerAxis = static_cast<float>(1u << uiNumBitsPerAxis);
+			const glm::vec3 vec3CentroidExtent = vec3CentroidMax - vec3CentroidMin;
+			// axes along which all centroids lie in the same plane always end up in the first cell
+			const glm::vec3 vec3CellsPerUnit = glm::vec3(
+				vec3CentroidExtent.x > 0.0f ? fNumCellsPerAxis / vec3CentroidExtent.x : 0.0f,
+				vec3CentroidExtent.y > 0.0f ? fNumCellsPerAxis / vec3CentroidExtent.y : 0.0f,
+				vec3CentroidExtent.z > 0.0f ? fNumCellsPerAxis / vec3CentroidExtent.z : 0.0f);
+			const float fMaxCell = fNumCellsPerAxis - 1.0f;
+
+			std::vector<MortonCodedObject> vecMortonCodedObjects(uiNumSceneObjects);
+			ForEachObjectReferenceChunk(uiNumSceneObjects, pChunkTaskPool, [&](size_t /*uiChunk*/, size_t uiFirstObject, size_t uiNumObjectsInChunk) {
+				for (size_t uiCurrentObject = uiFirstObject; uiCurrentObject < uiFirstObject + uiNumObjectsInChunk; uiCurrentObject++)
+				{
+					const glm::vec3 vec3Cell = glm::min((pSceneObjects[uiCurrentObject].m_tWorldSpaceAABB.m_vec3Center - vec3CentroidMin) * vec3CellsPerUnit, glm::vec3(fMaxCell));
+					const uint64_t uiCellX = static_cast<uint64_t>(vec3Cell.x);
+					const uint64_t uiCellY = static_cast<uint64_t>(vec3Cell.y);
+					const uint64_t uiCellZ = static_cast<uint64_t>(vec3Cell.z);
+
+					MortonCodedObject& rCurrentMortonCodedObject = vecMortonCodedObjects[uiCurrentObject];
+					rCurrentMortonCodedObject.m_uiObjectIndex = static_cast<uint32_t>(uiCurrentObject);
+					if (rParameters.m_bUse63BitMortonCodes)
+						rCurrentMortonCodedObject.m_uiMortonCode = (ExpandBitsForMortonCode63(uiCellX) << 2) | (ExpandBitsForMortonCode63(uiCellY) << 1) | ExpandBitsForMortonCode63(uiCellZ);
+					else
+						rCurrentMortonCodedObject.m_uiMortonCode = (ExpandBitsForMortonCode30(uiCellX) << 2) | (ExpandBitsForMortonCode30(uiCellY) << 1) | ExpandBitsForMortonCode30(uiCellZ);
+				}
+			});
+
+			// 3. sorting along the curve
+			RadixSortMortonCodedObjects(vecMortonCodedObjects, 3u * uiNumBitsPerAxis, pChunkTaskPool);
+
+			return vecMortonCodedObjects;
+		}
+
+		void RadixSortMortonCodedObjects(std::vector<MortonCodedObject>& rvecMortonCodedObjects, size_t uiNumKeyBits, TaskPool * pTaskPool)
+		{
+			// 11 bit digits sort 30 bit codes in 3 passes and 63 bit codes in 6
+			const size_t uiNumDigitBits = 11u;
+			const size_t uiNumDigitValues = 1u << uiNumDigitBits;
+			const size_t uiNumMortonCodedObjects = rvecMortonCodedObjects.size();
+			const size_t uiNumChunks = (uiNumMortonCodedObjects + s_uiObjectReferenceChunkSize - 1u) / s_uiObjectReferenceChunkSize;
+
+			std::vector<MortonCodedObject> vecScratchBuffer(uiNumMortonCodedObjects);
+			std::vector<size_t> vecChunkDigitOffsets(uiNumChunks * uiNumDigitValues);	// first per chunk counts of every digit, then where the chunk scatters every digit to
+
+			for (size_t uiCurrentShift = 0u; uiCurrentShift < uiNumKeyBits; uiCurrentShift += uiNumDigitBits)
+			{
+				// 1. counting the digits of every chunk
+				ForEachObjectReferenceChunk(uiNumMortonCodedObjects, pTaskPool, [&](size_t uiChunk, size_t uiFirstObject, size_t uiNumObjectsInChunk) {
+					size_t* pDigitCounts = vecChunkDigitOffsets.data() + uiChunk * uiNumDigitValues;
+					std::fill(pDigitCounts, pDigitCounts + uiNumDigitValues, 0u);
+					for (size_t uiCurrentObject = uiFirstObject; uiCurrentObject < uiFirstObject + uiNumObjectsInChunk; uiCurrentObject++)
+						pDigitCounts[(rvecMortonCodedObjects[uiCurrentObject].m_uiMortonCode >> uiCurrentShift) & (uiNumDigitValues - 1u)]++;
+				});
+
+				// 2. exclusive prefix sum, digit by digit and chunk by chunk within every digit, which keeps the sort stable
+				size_t uiNextOffset = 0u;
+				bool bAllCodesShareTheDigit = false;
+				for (size_t uiCurrentDigit = 0u; uiCurrentDigit < uiNumDigitValues; uiCurrentDigit++)
+				{
+					const size_t uiFirstOffsetOfDigit = uiNextOffset;
+					for (size_t uiCurrentChunk = 0u; uiCurrentChunk < uiNumChunks; uiCurrentChunk++)
+					{
+						size_t& rChunkDigitOffset = vecChunkDigitOffsets[uiCurrentChunk * uiNumDigitValues + uiCurrentDigit];
+						const size_t uiChunkDigitCount = rChunkDigitOffset;
+						rChunkDigitOffset = uiNextOffset;
+						uiNextOffset += uiChunkDigitCount;
+					}
+					bAllCodesShareTheDigit |= (uiNextOffset - uiFirstOffsetOfDigit == uiNumMortonCodedObjects);
+				}
+
+				// such a pass would not change the order at all
+				if (bAllCodesShareTheDigit)
+					continue;
+
+				// 3. scattering every chunk into its own slots
+				ForEachObjectReferenceChunk(uiNumMortonCodedObjects, pTaskPool, [&](size_t uiChunk, size_t uiFirstObject, size_t uiNumObjectsInChunk) {
+					size_t* pDigitOffsets = vecChunkDigitOffsets.data() + uiChunk * uiNumDigitValues;
+					for (size_t uiCurrentObject = uiFirstObject; uiCurrentObject < uiFirstObject + uiNumObjectsInChunk; uiCurrentObject++)
+					{
+						const MortonCodedObject& rCurrentMortonCodedObject = rvecMortonCodedObjects[uiCurrentObject];
+						vecScratchBuffer[pDigitOffsets[(rCurrentMortonCodedObject.m_uiMortonCode >> uiCurrentShift) & (uiNumDigitValues - 1u)]++] = rCurrentMortonCodedObject;
+					}
+				});
+
+				rvecMortonCodedObjects.swap(vecScratchBuffer);
+			}
+		}
+
+		size_t FindMortonCodeSplit(const MortonCodedObject * pSortedMortonCodedObjects, size_t uiNumMortonCodedObjects)
+		{
+			assert(uiNumMortonCodedObjects >= 2u);
+
+			const uint64_t uiDifferingBits = pSortedMortonCodedObjects[0].m_uiMortonCode ^ pSortedMortonCodedObjects[uiNumMortonCodedObjects - 1u].m_uiMortonCode;
+			if (uiDifferingBits == 0u)
+				return uiNumMortonCodedObjects / 2u;
+
+			// smearing the highest differing bit into all lower ones, then isolating it
+			uint64_t uiHighestDifferingBit = uiDifferingBits;
+			uiHighestDifferingBit |= uiHighestDifferingBit >> 1;
+			uiHighestDifferingBit |= uiHighestDifferingBit >> 2;
+			uiHighestDifferingBit |= uiHighestDifferingBit >> 4;
+			uiHighestDifferingBit |= uiHighestDifferingBit >> 8;
+			uiHighestDifferingBit |= uiHighestDifferingBit >> 16;
+			uiHighestDifferingBit |= uiHighestDifferingBit >> 32;
+			uiHighestDifferingBit ^= uiHighestDifferingBit >> 1;
+
+			// all codes of the range share the bits above it, so sorting put the ones with that bit cleared first
+			const MortonCodedObject* pFirstOfRightHalf = std::partition_point(pSortedMortonCodedObjects, pSortedMortonCodedObjects + uiNumMortonCodedObjects,
+				[uiHighestDifferingBit](const MortonCodedObject& rMortonCodedObject) {
+					return (rMortonCodedObject.m_uiMortonCode & uiHighestDifferingBit) == 0u;
+			});
+
+			return static_cast<size_t>(pFirstOfRightHalf - pSortedMortonCodedObjects);
+		}
+
+		template <typename BoundingVolume>
+		void RecursiveEmitLBVHNode(BVHTreeNode * pNode, const MortonCodedObject * pSortedMortonCodedObjects, size_t uiFirstMortonCodedObject, size_t uiNumMortonCodedObjects,
+			const BoundingVolume * pLeafBoundingVolumes, BoundingVolume BVHTreeNode::* pNodeBoundingVolume,
+			BoundingVolume(*pMergeFunction)(const BoundingVolume&, const BoundingVolume&), TaskPool * pTaskPool)
+		{
+			assert(pNode);
+			assert(uiNumMortonCodedObjects > 0u);
+
+			if (uiNumMortonCodedObjects == 1u)
+			{
+				pNode->m_uiFirstObject = static_cast<uint32_t>(uiFirstMortonCodedObject);
+				pNode->m_uiNumOjbects = 1u;
+				pNode->*pNodeBoundingVolume = pLeafBoundingVolumes[uiFirstMortonCodedObject];
+				return;
+			}
+
+			const size_t uiNumLeftMortonCodedObjects = FindMortonCodeSplit(pSortedMortonCodedObjects + uiFirstMortonCodedObject, uiNumMortonCodedObjects);
+			assert(uiNumLeftMortonCodedObjects > 0u && uiNumLeftMortonCodedObjects < uiNumMortonCodedObjects);
+
+			pNode->m_pLeft = pNode + 1;
+			pNode->m_pRight = pNode + 2u * uiNumLeftMortonCodedObjects;
+
+			// the left subtree is handed to the task pool while this thread goes on with the right one
+			if (pTaskPool && uiNumLeftMortonCodedObjects >= s_uiMinNumObjectsForLBVHSubtreeTask)
+			{
+				TaskPool::TaskGroup tLeftSubtree;
+				pTaskPool->Submit(tLeftSubtree, [=]() {
+					RecursiveEmitLBVHNode(pNode->m_pLeft, pSortedMortonCodedObjects, uiFirstMortonCodedObject, uiNumLeftMortonCodedObjects,
+						pLeafBoundingVolumes, pNodeBoundingVolume, pMergeFunction, pTaskPool);
+				});
+				RecursiveEmitLBVHNode(pNode->m_pRight, pSortedMortonCodedObjects, uiFirstMortonCodedObject + uiNumLeftMortonCodedObjects, uiNumMortonCodedObjects - uiNumLeftMortonCodedObjects,
+					pLeafBoundingVolumes, pNodeBoundingVolume, pMergeFunction, pTaskPool);
+				pTaskPool->Wait(tLeftSubtree);
+			}
+			else
+			{
+				RecursiveEmitLBVHNode(pNode->m_pLeft, pSortedMortonCodedObjects, uiFirstMortonCodedObject, uiNumLeftMortonCodedObjects,
+					pLeafBoundingVolumes, pNodeBoundingVolume, pMergeFunction, pTaskPool);
+				RecursiveEmitLBVHNode(pNode->m_pRight, pSortedMortonCodedObjects, uiFirstMortonCodedObject + uiNumLeftMortonCodedObjects, uiNumMortonCodedObjects - uiNumLeftMortonCodedObjects,
+					pLeafBoundingVolumes, pNodeBoundingVolume, pMergeFunction, pTaskPool);
+			}
+
+			pNode->*pNodeBoundingVolume = pMergeFunction(pNode->m_pLeft->*pNodeBoundingVolume, pNode->m_pRight->*pNodeBoundingVolume);
+		}
+
+		template <typename BoundingVolume>
+		void ConstructLBVH(BoundingVolumeHierarchy & rBVH, SceneObject * pSceneObjects, size_t uiNumSceneObjects, const LBVHParameters & rParameters,
+			BoundingVolume SceneObject::* pObjectBoundingVolume, BoundingVolume BVHTreeNode::* pNodeBoundingVolume,
+			BoundingVolume(*pMergeFunction)(const BoundingVolume&, const BoundingVolume&), TaskPool * pTaskPool)
+		{
+			assert(pSceneObjects);
+			assert(uiNumSceneObjects > 0u);
+			assert(rBVH.m_pRootNode == nullptr);	// delete the previous tree first
+
+			const std::vector<MortonCodedObject> vecSortedMortonCodedObjects = CreateSortedMortonCodes(pSceneObjects, uiNumSceneObjects, rParameters, pTaskPool);
+
+			// gathering the objects in sorted order up front, in one flat loop, keeps scattered reads out of the recursion
+			std::vector<BoundingVolume> vecLeafBoundingVolumes(uiNumSceneObjects);
+			rBVH.m_vecObjectPermutation.resize(uiNumSceneObjects);
+			TaskPool* pChunkTaskPool = (uiNumSceneObjects >= s_uiMinNumObjectReferencesForParallelPartitioning) ? pTaskPool : nullptr;
+			ForEachObjectReferenceChunk(uiNumSceneObjects, pChunkTaskPool, [&](size_t /*uiChunk*/, size_t uiFirstObject, size_t uiNumObjectsInChunk) {
+				for (size_t uiCurrentObject = uiFirstObject; uiCurrentObject < uiFirstObject + uiNumObjectsInChunk; uiCurrentObject++)
+				{
+					SceneObject* pCurrentSceneObject = pSceneObjects + vecSortedMortonCodedObjects[uiCurrentObject].m_uiObjectIndex;
+					vecLeafBoundingVolumes[uiCurrentObject] = pCurrentSceneObject->*pObjectBoundingVolume;
+					rBVH.m_vecObjectPermutation[uiCurrentObject] = pCurrentSceneObject;
+				}
+			});
+
+			// every leaf holds a single object, so the tree needs exactly 2n - 1 nodes
+			rBVH.m_pRootNode = rBVH.AllocateNodes(2u * uiNumSceneObjects - 1u);
+			RecursiveEmitLBVHNode(rBVH.m_pRootNode, vecSortedMortonCodedObjects.data(), 0u, uiNumSceneObjects, vecLeafBoundingVolumes.data(), pNodeBoundingVolume, pMergeFunction, pTaskPool);
+		}
+
+		template <typename BoundingVolume>
+		std::vector<BottomUpMerge> CalcPLOCMergeOrder(const SceneObject * pSceneObjects, size_t uiNumSceneObjects, const PLOCParameters & rParameters,
+			BoundingVolume SceneObject::* pObjectBoundingVolume,
+			float(*pMergeCostFunction)(const BoundingVolume&, const BoundingVolume&),
+			BoundingVolume(*pMergeFunction)(const BoundingVolume&, const BoundingVolume&), TaskPool * pTaskPool)
+		{
+			assert(pSceneObjects);
+			assert(uiNumSceneObjects > 0u);
+			assert(rParameters.m_uiSearchRadius > 0u);
+			/*
+				an explanation:
+				The clusters are kept in Morton order, so clusters close to each other in that order are close to each other in space.
+				Every round:
+				1. every cluster searches its nearest neighbor among the m_uiSearchRadius clusters before and after it
+				2. every pair of clusters that are each other's nearest neighbor is merged. The merged cluster takes the place of the first one,
+				   so the order is kept. Every chunk counts its merges and surviving clusters first, the prefix sums of those tell every chunk where to write
+				Ties are broken towards the pair of clusters that comes first, which makes the cheapest pair of a round always mutual: every round merges at least once.
+				Merge costs are always measured with the earlier cluster first, so both clusters of a pair see the very same cost.
+			*/
+			std::vector<BottomUpMerge> vecResult(uiNumSceneObjects - 1u);
+
+			// every cluster is identified by the index it has in the merge order, and carries its bounding volume along for cache friendly searching
+			std::vector<size_t> vecClusters(uiNumSceneObjects);
+			std::vector<BoundingVolume> vecClusterBoundingVolumes(uiNumSceneObjects);
+			{
+				const std::vector<MortonCodedObject> vecSortedMortonCodedObjects = CreateSortedMortonCodes(pSceneObjects, uiNumSceneObjects, LBVHParameters(), pTaskPool);
+				for (size_t uiCurrentCluster = 0u; uiCurrentCluster < uiNumSceneObjects; uiCurrentCluster++)
+				{
+					vecClusters[uiCurrentCluster] = vecSortedMortonCodedObjects[uiCurrentCluster].m_uiObjectIndex;
+					vecClusterBoundingVolumes[uiCurrentCluster] = pSceneObjects[vecClusters[uiCurrentCluster]].*pObjectBoundingVolume;
+				}
+			}
+
+			std::vector<size_t> vecNewClusters(uiNumSceneObjects);
+			std::vector<BoundingVolume> vecNewClusterBoundingVolumes(uiNumSceneObjects);
+			std::vector<size_t> vecNearestNeighbors(uiNumSceneObjects);
+			std::vector<size_t> vecChunkNumMerges;
+			std::vector<size_t> vecChunkNumSurvivingClusters;
+			size_t uiNumMerges = 0u;
+
+			while (vecClusters.size() > 1u)
+			{
+				const size_t uiNumClusters = vecClusters.size();
+				const size_t uiNumChunks = (uiNumClusters + s_uiObjectReferenceChunkSize - 1u) / s_uiObjectReferenceChunkSize;
+				TaskPool* pChunkTaskPool = (uiNumClusters >= s_uiMinNumObjectReferencesForParallelPartitioning) ? pTaskPool : nullptr;
+
+				// 1. nearest neighbors. Candidates are visited in order, so on equal costs the first one is kept
+				ForEachObjectReferenceChunk(uiNumClusters, pChunkTaskPool, [&](size_t, size_t uiFirstCluster, size_t uiNumClustersInChunk) {
+					for (size_t uiCurrentCluster = uiFirstCluster; uiCurrentCluster < uiFirstCluster + uiNumClustersInChunk; uiCurrentCluster++)
+					{
+						const size_t uiFirstCandidate = (uiCurrentCluster > rParameters.m_uiSearchRadius) ? uiCurrentCluster - rParameters.m_uiSearchRadius : 0u;
+						const size_t uiLastCandidate = std::min(uiCurrentCluster + rParameters.m_uiSearchRadius, uiNumClusters - 1u);
+
+						float fCheapestMergeCost = std::numeric_limits<float>::max();
+						size_t uiNearestNeighbor = uiCurrentCluster;
+						for (size_t uiCurrentCandidate = uiFirstCandidate; uiCurrentCandidate <= uiLastCandidate; uiCurrentCandidate++)
+						{
+							if (uiCurrentCandidate == uiCurrentCluster)
+								continue;
+
+							const float fMergeCost = (uiCurrentCandidate < uiCurrentCluster) ?
+								pMergeCostFunction(vecClusterBoundingVolumes[uiCurrentCandidate], vecClusterBoundingVolumes[uiCurrentCluster]) :
+								pMergeCostFunction(vecClusterBoundingVolumes[uiCurrentCluster], vecClusterBoundingVolumes[uiCurrentCandidate]);
+							if (fMergeCost < fCheapestMergeCost)
+							{
+								fCheapestMergeCost = fMergeCost;
+								uiNearestNeighbor = uiCurrentCandidate;
+							}
+						}
+
+						assert(uiNearestNeighbor != uiCurrentCluster);
+						vecNearestNeighbors[uiCurrentCluster] = uiNearestNeighbor;
+					}
+				});
+
+				// 2. counting merges and surviving clusters per chunk. A pair is merged by its first cluster, its second one does not survive
+				vecChunkNumMerges.assign(uiNumChunks, 0u);
+				vecChunkNumSurvivingClusters.assign(uiNumChunks, 0u);
+				ForEachObjectReferenceChunk(uiNumClusters, pChunkTaskPool, [&](size_t uiChunk, size_t uiFirstCluster, size_t uiNumClustersInChunk) {
+					for (size_t uiCurrentCluster = uiFirstCluster; uiCurrentCluster < uiFirstCluster + uiNumClustersInChunk; uiCurrentCluster++)
+					{
+						const size_t uiNearestNeighbor = vecNearestNeighbors[uiCurrentCluster];
+						const bool bIsMutual = (vecNearestNeighbors[uiNearestNeighbor] == uiCurrentCluster);
+						if (bIsMutual && uiCurrentCluster < uiNearestNeighbor)
+							vecChunkNumMerges[uiChunk]++;
+						if (!bIsMutual || uiCurrentCluster < uiNearestNeighbor)
+							vecChunkNumSurvivingClusters[uiChunk]++;
+					}
+				});
+
+				// exclusive prefix sums, turning the counts into every chunk's first merge and first surviving cluster
+				size_t uiNumMergesOfRound = 0u;
+				size_t uiNumSurvivingClusters = 0u;
+				for (size_t uiCurrentChunk = 0u; uiCurrentChunk < uiNumChunks; uiCurrentChunk++)
+				{
+					const size_t uiNumMergesInChunk = vecChunkNumMerges[uiCurrentChunk];
+					const size_t uiNumSurvivingClustersInChunk = vecChunkNumSurvivingClusters[uiCurrentChunk];
+					vecChunkNumMerges[uiCurrentChunk] = uiNumMerges + uiNumMergesOfRound;
+					vecChunkNumSurvivingClusters[uiCurrentChunk] = uiNumSurvivingClusters;
+					uiNumMergesOfRound += uiNumMergesInChunk;
+					uiNumSurvivingClusters += uiNumSurvivingClustersInChunk;
+				}
+				assert(uiNumMergesOfRound > 0u);
+
+				// merging and compacting. Clusters of one round never depend on each other's merges
+				vecNewClusters.resize(uiNumSurvivingClusters);
+				vecNewClusterBoundingVolumes.resize(uiNumSurvivingClusters);
+				ForEachObjectReferenceChunk(uiNumClusters, pChunkTaskPool, [&](size_t uiChunk, size_t uiFirstCluster, size_t uiNumClustersInChunk) {
+					size_t uiCurrentMerge = vecChunkNumMerges[uiChunk];
+					size_t uiCurrentNewCluster = vecChunkNumSurvivingClusters[uiChunk];
+					for (size_t uiCurrentCluster = uiFirstCluster; uiCurrentCluster < uiFirstCluster + uiNumClustersInChunk; uiCurrentCluster++)
+					{
+						const size_t uiNearestNeighbor = vecNearestNeighbors[uiCurrentCluster];
+						const bool bIsMutual = (vecNearestNeighbors[uiNearestNeighbor] == uiCurrentCluster);
+						if (!bIsMutual)
+						{
+							vecNewClusters[uiCurrentNewCluster] = vecClusters[uiCurrentCluster];
+							vecNewClusterBoundingVolumes[uiCurrentNewCluster] = vecClusterBoundingVolumes[uiCurrentCluster];
+							uiCurrentNewCluster++;
+						}
+						else if (uiCurrentCluster < uiNearestNeighbor)
+						{
+							vecResult[uiCurrentMerge] = { vecClusters[uiCurrentCluster], vecClusters[uiNearestNeighbor] };
+							vecNewClusters[uiCurrentNewCluster] = uiNumSceneObjects + uiCurrentMerge;
+							vecNewClusterBoundingVolumes[uiCurrentNewCluster] = pMergeFunction(vecClusterBoundingVolumes[uiCurrentCluster], vecClusterBoundingVolumes[uiNearestNeighbor]);
+							uiCurrentNewCluster++;
+							uiCurrentMerge++;
+						}
+					}
+				});
+
+				uiNumMerges += uiNumMergesOfRound;
+				vecClusters.swap(vecNewClusters);
+				vecClusterBoundingVolumes.swap(vecNewClusterBoundingVolumes);
+			}
+
+			assert(uiNumMerges == uiNumSceneObjects - 1u);
+			return vecResult;
+		}
+
+
+		//////////////////////////////////////////
+		// RAY CASTING
+		//////////////////////////////////////////
+
+		RayCastIntersectionResult RecursiveRayCastIntoBVHTree(const BoundingVolumeHierarchy & rBVH, const BVHTreeNode * pNode, const Ray & rCastedRay, RayTraversalStatistics * pStatistics)
+		{
+			assert(pNode);
+
+			RayCastIntersectionResult tResultForNodeAndAllItsChilren;
+
+			if (pStatistics)
+				pStatistics->m_uiNumVisitedNodes++;
+
+			if (pNode->IsANode())
+			{
+				float fIntersectionDistanceMin;
+				glm::vec3 vec3PointOfIntersection;
+				if (pStatistics)
+					pStatistics->m_uiNumBoundingVolumeTests++;
+				if (IntersectRayAABB(rCastedRay, pNode->m_tAABBForNode, fIntersectionDistanceMin, vec3PointOfIntersection))
+				{
+
+					if (pNode->m_pLeft)
+					{
+						RayCastIntersectionResult tResultLeftChild = RecursiveRayCastIntoBVHTree(rBVH, pNode->m_pLeft, rCastedRay, pStatistics);
+						//if (tResultLeftChild.m_fIntersectionDistance < tResultForNodeAndAllItsChilren.m_fIntersectionDistance) // this would always be true, because default intersection distance is FLT_MAX
+						tResultForNodeAndAllItsChilren = tResultLeftChild;
+					}
+
+					if (pNode->m_pRight)
+					{
+						RayCastIntersectionResult tResultRightchild = RecursiveRayCastIntoBVHTree(rBVH, pNode->m_pRight, rCastedRay, pStatistics);
+						if (tResultRightchild.m_fIntersectionDistance < tResultForNodeAndAllItsChilren.m_fIntersectionDistance)
+							tResultForNodeAndAllItsChilren = tResultRightchild;
+					}
+				}
+			}
+			else // is a leaf
+			{
+				assert(pNode->m_uiNumOjbects > 0u);
+				assert(pNode->m_uiFirstObject + pNode->m_uiNumOjbects <= rBVH.m_vecObjectPermutation.size());
+				SceneObject* const* ppLeafObjects = rBVH.m_vecObjectPermutation.data() + pNode->m_uiFirstObject;
+
+				/*
+					Checking every object in the current leaf.
+					This is needed because:
+					1: There could be more that one object in the leaf
+					2: The first object to be tested might not be the closest to the ray origin, i.e. the first object hit by the ray
+				*/
+				if (pStatistics)
+					pStatistics->m_uiNumObjectTests += pNode->m_uiNumOjbects;
+				for (uint32_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < pNode->m_uiNumOjbects; uiCurrentSceneObject++)
+				{
+					float fIntersectionDistanceForCurrentAABB;
+					glm::vec3 vec3CurrentIntersectionPoint;
+					if (IntersectRayAABB(rCastedRay, ppLeafObjects[uiCurrentSceneObject]->m_tWorldSpaceAABB, fIntersectionDistanceForCurrentAABB, vec3CurrentIntersectionPoint))
+					{
+						// if an intersection occured with the current object's AABB...
+						// ... and the distance to the intersection point is shorter than the previously shortest intersection distance
+						if (fIntersectionDistanceForCurrentAABB < tResultForNodeAndAllItsChilren.m_fIntersectionDistance)
+						{
+							// we update the current results
+							tResultForNodeAndAllItsChilren.m_fIntersectionDistance = fIntersectionDistanceForCurrentAABB;
+							tResultForNodeAndAllItsChilren.m_vec3PointOfIntersection = vec3CurrentIntersectionPoint;
+							tResultForNodeAndAllItsChilren.m_pFirstIntersectedSceneObject = ppLeafObjects[uiCurrentSceneObject];
+						}
+					}
+				}
+
+				// if, at the end of all intersection tests, no object AABB was hit, the result is still defaulted (which means its intersection distance = FLT_MAX)
+			}
+
+			return tResultForNodeAndAllItsChilren;
+		}
+
+		template <typename BoundingVolume>
+		void CastRayIntoBVHLeaf(const BoundingVolumeHierarchy & rBVH, const BVHTreeNode * pLeaf, const Ray & rCastedRay, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			int(*pIntersectRayBoundingVolume)(const Ray&, const BoundingVolume&, float&), RayCastIntersectionResult & rResult, RayTraversalStatistics & rStatistics)
+		{
+			assert(pLeaf);
+			assert(pLeaf->m_uiNumOjbects > 0u);
+			assert(pLeaf->m_uiFirstObject + pLeaf->m_uiNumOjbects <= rBVH.m_vecObjectPermutation.size());
+			SceneObject* const* ppLeafObjects = rBVH.m_vecObjectPermutation.data() + pLeaf->m_uiFirstObject;
+
+			rStatistics.m_uiNumObjectTests += pLeaf->m_uiNumOjbects;
+			for (uint32_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < pLeaf->m_uiNumOjbects; uiCurrentSceneObject++)
+			{
+				float fIntersectionDistanceForCurrentObject;
+				if (pIntersectRayBoundingVolume(rCastedRay, ppLeafObjects[uiCurrentSceneObject]->*pObjectBoundingVolume, fIntersectionDistanceForCurrentObject))
+				{
+					if (fIntersectionDistanceForCurrentObject < rResult.m_fIntersectionDistance)
+					{
+						rResult.m_fIntersectionDistance = fIntersectionDistanceForCurrentObject;
+						rResult.m_vec3PointOfIntersection = rCastedRay.m_vec3Origin + rCastedRay.m_vec3Direction * fIntersectionDistanceForCurrentObject;
+						rResult.m_pFirstIntersectedSceneObject = ppLeafObjects[uiCurrentSceneObject];
+					}
+				}
+			}
+		}
+
+		template <typename BoundingVolume>
+		bool IntersectRayBVHNode(const Ray & rCastedRay, const BVHTreeNode * pNode, BoundingVolume BVHTreeNode::* pNodeBoundingVolume,
+			int(*pIntersectRayBoundingVolume)(const Ray&, const BoundingVolume&, float&), float fMaxEntryDistance, float & rfEntryDistance, RayTraversalStatistics & rStatistics)
+		{
+			assert(pNode);
+
+			rStatistics.m_uiNumBoundingVolumeTests++;
+			if (!pIntersectRayBoundingVolume(rCastedRay, pNode->*pNodeBoundingVolume, rfEntryDistance))
+				return false;
+
+			return rfEntryDistance <= fMaxEntryDistance;
+		}
+
+		const BVHTreeNode* GetNearChildAlongRay(const BVHTreeNode * pNode, const Ray & rCastedRay)
+		{
+			assert(pNode && pNode->IsANode());
+
+			// only depends on the node and the ray, so backtracking always agrees with the way down on which child was the near one
+			const glm::vec3 vec3LeftToRight = pNode->m_pRight->m_tAABBForNode.m_vec3Center - pNode->m_pLeft->m_tAABBForNode.m_vec3Center;
+			return (glm::dot(vec3LeftToRight, rCastedRay.m_vec3Direction) >= 0.0f) ? pNode->m_pLeft : pNode->m_pRight;
+		}
+
+		template <typename BoundingVolume>
+		RayCastIntersectionResult StackRayCastIntoBVHTree(const BoundingVolumeHierarchy & rBVH, const Ray & rCastedRay,
+			BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			int(*pIntersectRayBoundingVolume)(const Ray&, const BoundingVolume&, float&), RayTraversalStatistics & rStatistics)
+		{
+			assert(rBVH.m_pRootNode);
+
+			RayCastIntersectionResult tResult;
+
+			// a root that is a leaf is tested object by object right away, just like the recursion does
+			float fRootEntryDistance = std::numeric_limits<float>::lowest();
+			if (rBVH.m_pRootNode->IsANode() && !IntersectRayBVHNode(rCastedRay, rBVH.m_pRootNode, pNodeBoundingVolume, pIntersectRayBoundingVolume, tResult.m_fIntersectionDistance, fRootEntryDistance, rStatistics))
+				return tResult;
+
+			StackRayCastIntoBVHSubtree(rBVH, rBVH.m_pRootNode, fRootEntryDistance, rCastedRay, pNodeBoundingVolume, pObjectBoundingVolume, pIntersectRayBoundingVolume, tResult, rStatistics);
+			return tResult;
+		}
+
+		template <typename BoundingVolume>
+		void StackRayCastIntoBVHSubtree(const BoundingVolumeHierarchy & rBVH, const BVHTreeNode * pSubtreeRootNode, float fEntryDistance, const Ray & rCastedRay,
+			BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			int(*pIntersectRayBoundingVolume)(const Ray&, const BoundingVolume&, float&), RayCastIntersectionResult & rResult, RayTraversalStatistics & rStatistics)
+		{
+			// nodes to visit, together with the distance at which the ray enters them. Once something closer was hit, they are skipped
+			struct NodeToVisit {
+				const BVHTreeNode* m_pNode;
+				float m_fEntryDistance;
+			};
+			NodeToVisit pNodesToVisit[s_uiRayTraversalStackSize];
+			size_t uiNumNodesToVisit = 0u;
+			pNodesToVisit[uiNumNodesToVisit++] = { pSubtreeRootNode, fEntryDistance };
+
+			while (uiNumNodesToVisit > 0u)
+			{
+				const NodeToVisit tCurrentNodeToVisit = pNodesToVisit[--uiNumNodesToVisit];
+
+				// nothing in this subtree can be closer than the closest hit found so far
+				if (tCurrentNodeToVisit.m_fEntryDistance > rResult.m_fIntersectionDistance)
+					continue;
+
+				const BVHTreeNode* pCurrentNode = tCurrentNodeToVisit.m_pNode;
+				rStatistics.m_uiNumVisitedNodes++;
+
+				if (!pCurrentNode->IsANode())
+				{
+					CastRayIntoBVHLeaf(rBVH, pCurrentNode, rCastedRay, pObjectBoundingVolume, pIntersectRayBoundingVolume, rResult, rStatistics);
+					continue;
+				}
+
+				// both children are tested here, so the nearer one can be visited first. The farther one waits on the stack below it
+				float fLeftEntryDistance, fRightEntryDistance;
+				const bool bIsLeftChildHit = IntersectRayBVHNode(rCastedRay, pCurrentNode->m_pLeft, pNodeBoundingVolume, pIntersectRayBoundingVolume, rResult.m_fIntersectionDistance, fLeftEntryDistance, rStatistics);
+				const bool bIsRightChildHit = IntersectRayBVHNode(rCastedRay, pCurrentNode->m_pRight, pNodeBoundingVolume, pIntersectRayBoundingVolume, rResult.m_fIntersectionDistance, fRightEntryDistance, rStatistics);
+
+				if (bIsLeftChildHit && bIsRightChildHit)
+				{
+					const bool bIsLeftChildNearer = (fLeftEntryDistance <= fRightEntryDistance);
+					const NodeToVisit tNearChild = bIsLeftChildNearer ? NodeToVisit{ pCurrentNode->m_pLeft, fLeftEntryDistance } : NodeToVisit{ pCurrentNode->m_pRight, fRightEntryDistance };
+					const NodeToVisit tFarChild = bIsLeftChildNearer ? NodeToVisit{ pCurrentNode->m_pRight, fRightEntryDistance } : NodeToVisit{ pCurrentNode->m_pLeft, fLeftEntryDistance };
+
+					pNodesToVisit[uiNumNodesToVisit++] = tFarChild;
+					// with no free slot left, the near child's subtree, which would be next anyway, is traversed right away
+					if (uiNumNodesToVisit == s_uiRayTraversalStackSize)
+						StackRayCastIntoBVHSubtree(rBVH, tNearChild.m_pNode, tNearChild.m_fEntryDistance, rCastedRay, pNodeBoundingVolume, pObjectBoundingVolume, pIntersectRayBoundingVolume, rResult, rStatistics);
+					else
+						pNodesToVisit[uiNumNodesToVisit++] = tNearChild;
+				}
+				else if (bIsLeftChildHit)
+				{
+					pNodesToVisit[uiNumNodesToVisit++] = { pCurrentNode->m_pLeft, fLeftEntryDistance };
+				}
+				else if (bIsRightChildHit)
+				{
+					pNodesToVisit[uiNumNodesToVisit++] = { pCurrentNode->m_pRight, fRightEntryDistance };
+				}
+			}
+		}
+
+		RayCastIntersectionResult StacklessRayCastIntoBVHTree(const BoundingVolumeHierarchy & rBVH, const Ray & rCastedRay, RayTraversalStatistics & rStatistics)
+		{
+			assert(rBVH.m_pRootNode);
+			assert(rBVH.m_pRootNode->m_pParent == nullptr);
+			/*
+				an explanation:
+				Without a stack, the traversal has to find its way back up the tree along the parent links. It remembers where it came from:
+				- FROM_PARENT: the node was just entered from above. Its near child is entered next. If the node is missed, its sibling is next
+				- FROM_SIBLING: the far child of a node, entered after its near sibling's subtree is done. If it is missed or done, back up to the parent
+				- FROM_CHILD: the subtree of a child is done. Coming from the near child, the far one is next. Coming from the far one, the parent is done as well
+				Which child is the near one only depends on the node and the ray, so the way up always agrees with the way down.
+			*/
+			enum eTraversalState {
+				FROM_PARENT,
+				FROM_SIBLING,
+				FROM_CHILD
+			};
+
+			RayCastIntersectionResult tResult;
+
+			const BVHTreeNode* pRootNode = rBVH.m_pRootNode;
+			if (!pRootNode->IsANode())
+			{
+				rStatistics.m_uiNumVisitedNodes++;
+				CastRayIntoBVHLeaf(rBVH, pRootNode, rCastedRay, &SceneObject::m_tWorldSpaceAABB, IntersectRayAABBDistanceOnly, tResult, rStatistics);
+				return tResult;
+			}
+
+			float fEntryDistance;
+			if (!IntersectRayBVHNode(rCastedRay, pRootNode, &BVHTreeNode::m_tAABBForNode, IntersectRayAABBDistanceOnly, tResult.m_fIntersectionDistance, fEntryDistance, rStatistics))
+				return tResult;
+			rStatistics.m_uiNumVisitedNodes++;
+
+			assert(pRootNode->m_pLeft->m_pParent == pRootNode);	// the parent links have to be set up
+			const BVHTreeNode* pCurrentNode = GetNearChildAlongRay(pRootNode, rCastedRay);
+			eTraversalState eState = FROM_PARENT;
+
+			while (true)
+			{
+				const BVHTreeNode* pParentNode = pCurrentNode->m_pParent;
+
+				if (eState == FROM_CHILD)
+				{
+					if (pCurrentNode == pRootNode)
+						break;
+
+					if (pCurrentNode == GetNearChildAlongRay(pParentNode, rCastedRay))
+					{
+						pCurrentNode = (pCurrentNode == pParentNode->m_pLeft) ? pParentNode->m_pRight : pParentNode->m_pLeft;
+						eState = FROM_SIBLING;
+					}
+					else
+					{
+						pCurrentNode = pParentNode;
+						eState = FROM_CHILD;
+					}
+					continue;
+				}
+
+				// FROM_PARENT and FROM_SIBLING both test the current node first
+				const BVHTreeNode* pSiblingNode = (pCurrentNode == pParentNode->m_pLeft) ? pParentNode->m_pRight : pParentNode->m_pLeft;
+				if (IntersectRayBVHNode(rCastedRay, pCurrentNode, &BVHTreeNode::m_tAABBForNode, IntersectRayAABBDistanceOnly, tResult.m_fIntersectionDistance, fEntryDistance, rStatistics))
+				{
+					rStatistics.m_uiNumVisitedNodes++;
+					if (pCurrentNode->IsANode())
+					{
+						pCurrentNode = GetNearChildAlongRay(pCurrentNode, rCastedRay);
+						eState = FROM_PARENT;
+						continue;
+					}
+
+					CastRayIntoBVHLeaf(rBVH, pCurrentNode, rCastedRay, &SceneObject::m_tWorldSpaceAABB, IntersectRayAABBDistanceOnly, tResult, rStatistics);
+				}
+
+				// the current node is done: a near child hands over to its sibling, a far child back to its parent
+				if (eState == FROM_PARENT)
+				{
+					pCurrentNode = pSiblingNode;
+					eState = FROM_SIBLING;
+				}
+				else
+				{
+					pCurrentNode = pParentNode;
+					eState = FROM_CHILD;
+				}
+			}
+
+			return tResult;
+		}
+
+		RayCastIntersectionResult ShortStackRayCastIntoBVHTree(const BoundingVolumeHierarchy & rBVH, const Ray & rCastedRay, RayTraversalStatistics & rStatistics)
+		{
+			assert(rBVH.m_pRootNode);
+			assert(rBVH.m_pRootNode->m_pParent == nullptr);
+			/*
+				an explanation:
+				This is the stackless traversal with a few entries of stack on the side. Going down into a node's near child pushes the far child.
+				Once a subtree is done, the far child on top of the stack is exactly where climbing along the parent links would lead next,
+				so it is popped instead of climbing. A full stack drops its oldest entry, the one that would be popped last.
+				Only when the stack runs empty does the traversal climb again, which reaches the dropped far children in the very same order.
+			*/
+			enum eTraversalState {
+				FROM_PARENT,
+				FROM_SIBLING,
+				FROM_CHILD
+			};
+
+			RayCastIntersectionResult tResult;
+
+			const BVHTreeNode* pRootNode = rBVH.m_pRootNode;
+			if (!pRootNode->IsANode())
+			{
+				rStatistics.m_uiNumVisitedNodes++;
+				CastRayIntoBVHLeaf(rBVH, pRootNode, rCastedRay, &SceneObject::m_tWorldSpaceAABB, IntersectRayAABBDistanceOnly, tResult, rStatistics);
+				return tResult;
+			}
+
+			float fEntryDistance;
+			if (!IntersectRayBVHNode(rCastedRay, pRootNode, &BVHTreeNode::m_tAABBForNode, IntersectRayAABBDistanceOnly, tResult.m_fIntersectionDistance, fEntryDistance, rStatistics))
+				return tResult;
+			rStatistics.m_uiNumVisitedNodes++;
+
+			// a ring buffer: pushing onto a full stack overwrites its oldest entry
+			const BVHTreeNode* pShortStack[s_uiRayTraversalShortStackSize];
+			size_t uiNumPushedNodes = 0u;	// minus the popped ones. Position of the next push, modulo the size of the stack
+			size_t uiNumNodesOnStack = 0u;
+			const auto PushFarChild = [&](const BVHTreeNode* pNode, const BVHTreeNode* pNearChild) {
+				pShortStack[uiNumPushedNodes % s_uiRayTraversalShortStackSize] = (pNearChild == pNode->m_pLeft) ? pNode->m_pRight : pNode->m_pLeft;
+				uiNumPushedNodes++;
+				uiNumNodesOnStack = std::min(uiNumNodesOnStack + 1u, s_uiRayTraversalShortStackSize);
+			};
+
+			assert(pRootNode->m_pLeft->m_pParent == pRootNode);	// the parent links have to be set up
+			const BVHTreeNode* pCurrentNode = GetNearChildAlongRay(pRootNode, rCastedRay);
+			PushFarChild(pRootNode, pCurrentNode);
+			eTraversalState eState = FROM_PARENT;
+
+			while (true)
+			{
+				const BVHTreeNode* pParentNode = pCurrentNode->m_pParent;
+
+				if (eState == FROM_CHILD)
+				{
+					if (pCurrentNode == pRootNode)
+						break;
+
+					// only climbing while the stack is empty, so the far sibling of a near child was dropped from it
+					if (pCurrentNode == GetNearChildAlongRay(pParentNode, rCastedRay))
+					{
+						pCurrentNode = (pCurrentNode == pParentNode->m_pLeft) ? pParentNode->m_pRight : pParentNode->m_pLeft;
+						eState = FROM_SIBLING;
+					}
+					else
+					{
+						pCurrentNode = pParentNode;
+						eState = FROM_CHILD;
+					}
+					continue;
+				}
+
+				// FROM_PARENT and FROM_SIBLING both test the current node first
+				if (IntersectRayBVHNode(rCastedRay, pCurrentNode, &BVHTreeNode::m_tAABBForNode, IntersectRayAABBDistanceOnly, tResult.m_fIntersectionDistance, fEntryDistance, rStatistics))
+				{
+					rStatistics.m_uiNumVisitedNodes++;
+					if (pCurrentNode->IsANode())
+					{
+						const BVHTreeNode* pNearChild = GetNearChildAlongRay(pCurrentNode, rCastedRay);
+						PushFarChild(pCurrentNode, pNearChild);
+						pCurrentNode = pNearChild;
+						eState = FROM_PARENT;
+						continue;
+					}
+
+					CastRayIntoBVHLeaf(rBVH, pCurrentNode, rCastedRay, &SceneObject::m_tWorldSpaceAABB, IntersectRayAABBDistanceOnly, tResult, rStatistics);
+				}
+
+				// the current node is done: the next far child is on top of the stack, unless it was dropped
+				if (uiNumNodesOnStack > 0u)
+				{
+					uiNumPushedNodes--;
+					uiNumNodesOnStack--;
+					pCurrentNode = pShortStack[uiNumPushedNodes % s_uiRayTraversalShortStackSize];
+					eState = FROM_SIBLING;
+				}
+				else if (eState == FROM_PARENT)
+				{
+					pCurrentNode = (pCurrentNode == pParentNode->m_pLeft) ? pParentNode->m_pRight : pParentNode->m_pLeft;
+					eState = FROM_SIBLING;
+				}
+				else
+				{
+					pCurrentNode = pParentNode;
+					eState = FROM_CHILD;
+				}
+			}
+
+			return tResult;
+		}
+
+		int IntersectRayMinMaxBox(const Ray & rIntersectingRay, const glm::vec3 & rvec3Min, const glm::vec3 & rvec3Max, float & rfIntersectionDistanceMin)
+		{
+			float fIntersectionDistanceMax;
+			return IntersectRayMinMaxBoxEntryExit(rIntersectingRay, rvec3Min, rvec3Max, rfIntersectionDistanceMin, fIntersectionDistanceMax);
+		}
 
-			// initializing min values to max and vice versa for definitive overwriting for the first vertex
-			float fXMin = std::numeric_limits<float>::max();
-			float fXMax = std::numeric_limits<float>::lowest();
-			float fYMin = std::numeric_limits<float>::max();
-			float fYMax = std::numeric_limits<float>::lowest();
-			float fZMin = std::numeric_limits<float>::max();
-			float fZMax = std::numeric_limits<float>::lowest();
+		int IntersectRayMinMaxBoxEntryExit(const Ray & rIntersectingRay, const glm::vec3 & rvec3Min, const glm::vec3 & rvec3Max, float & rfIntersectionDistanceMin, float & rfIntersectionDistanceMax)
+		{
+			rfIntersectionDistanceMin = std::numeric_limits<float>::lowest();
+			rfIntersectionDistanceMax = std::numeric_limits<float>::max();
+			const glm::vec3* pBoxCorners[2] = { &rvec3Min, &rvec3Max };
 
-			for (size_t uiCurrentVertex = 0u; uiCurrentVertex < uiNumberOfVertices; uiCurrentVertex++)
+			// for all three slabs of the given box
+			for (int iCurrentSlab = 0; iCurrentSlab < 3; iCurrentSlab++)
 			{
-				const size_t uiCurrentDataIndex = uiCurrentVertex * 8; // 8 is the assumed stride;
+				// the ray's sign picks the plane it enters the slab through, so no swapping is needed
+				const int iIsDirectionNegative = rIntersectingRay.m_pIsDirectionNegative[iCurrentSlab];
+				const float fNearIntersectionDistance = ((*pBoxCorners[iIsDirectionNegative])[iCurrentSlab] - rIntersectingRay.m_vec3Origin[iCurrentSlab]) * rIntersectingRay.m_vec3InverseDirection[iCurrentSlab];
+				const float fFarIntersectionDistance = ((*pBoxCorners[1 - iIsDirectionNegative])[iCurrentSlab] - rIntersectingRay.m_vec3Origin[iCurrentSlab]) * rIntersectingRay.m_vec3InverseDirection[iCurrentSlab];
+				// written so they become min and max instructions. A NaN distance fails the comparison and leaves the interval as it is,
+				// that is the case of an origin lying right on one of the planes of a slab the ray is parallel to
+				rfIntersectionDistanceMin = (fNearIntersectionDistance > rfIntersectionDistanceMin) ? fNearIntersectionDistance : rfIntersectionDistanceMin;
+				rfIntersectionDistanceMax = (fFarIntersectionDistance < rfIntersectionDistanceMax) ? fFarIntersectionDistance : rfIntersectionDistanceMax;
+			}
 
-				const float fVertexPositionX = pVertices[uiCurrentDataIndex + 0];
-				const float fVertexPositionY = pVertices[uiCurrentDataIndex + 1];
-				const float fVertexPositionZ = pVertices[uiCurrentDataIndex + 2];
+			return (rfIntersectionDistanceMin <= rfIntersectionDistanceMax) ? 1 : 0;
+		}
 
-				fXMin = std::min<float>(fXMin, fVertexPositionX);
-				fYMin = std::min<float>(fYMin, fVertexPositionY);
-				fZMin = std::min<float>(fZMin, fVertexPositionZ);
-				fXMax = std::max<float>(fXMax, fVertexPositionX);
-				fYMax = std::max<float>(fYMax, fVertexPositionY);
-				fZMax = std::max<float>(fZMax, fVertexPositionZ);
+		int IntersectRayAABBDistanceOnly(const Ray & rIntersectingRay, const AABB & rAABB, float & rfIntersectionDistanceMin)
+		{
+			return IntersectRayMinMaxBox(rIntersectingRay, rAABB.m_vec3Center - rAABB.m_vec3Radius, rAABB.m_vec3Center + rAABB.m_vec3Radius, rfIntersectionDistanceMin);
+		}
+
+		int IntersectRayBoundingSphere(const Ray & rIntersectingRay, const BoundingSphere & rBoundingSphere, float & rfIntersectionDistanceMin)
+		{
+			// the point of the line closest to the sphere's center. Measuring from there instead of subtracting squared lengths keeps far away spheres precise
+			const glm::vec3 vec3OriginToCenter = rBoundingSphere.m_vec3Center - rIntersectingRay.m_vec3Origin;
+			const float fDistanceToClosestPoint = glm::dot(vec3OriginToCenter, rIntersectingRay.m_vec3Direction);
+			const glm::vec3 vec3ClosestPointToCenter = vec3OriginToCenter - rIntersectingRay.m_vec3Direction * fDistanceToClosestPoint;
+
+			const float fSquaredHalfChord = rBoundingSphere.m_fRadius * rBoundingSphere.m_fRadius - glm::dot(vec3ClosestPointToCenter, vec3ClosestPointToCenter);
+			if (fSquaredHalfChord < 0.0f)
+				return 0;
+
+			rfIntersectionDistanceMin = fDistanceToClosestPoint - std::sqrt(fSquaredHalfChord);
+			return 1;
+		}
+
+		uint32_t IntersectRayFourMinMaxBoxes(const Ray & rRay, const float * pMinX, const float * pMinY, const float * pMinZ,
+			const float * pMaxX, const float * pMaxY, const float * pMaxZ, float fMaxEntryDistance, float * pEntryDistances)
+		{
+			const float* pBoxPlanes[2][3] = { { pMinX, pMinY, pMinZ }, { pMaxX, pMaxY, pMaxZ } };
+
+			__m128 vIntersectionDistanceMin = _mm_set1_ps(std::numeric_limits<float>::lowest());
+			__m128 vIntersectionDistanceMax = _mm_set1_ps(std::numeric_limits<float>::max());
+
+			for (int iCurrentSlab = 0; iCurrentSlab < 3; iCurrentSlab++)
+			{
+				const int iIsDirectionNegative = rRay.m_pIsDirectionNegative[iCurrentSlab];
+				const __m128 vNearPlanes = _mm_loadu_ps(pBoxPlanes[iIsDirectionNegative][iCurrentSlab]);
+				const __m128 vFarPlanes = _mm_loadu_ps(pBoxPlanes[1 - iIsDirectionNegative][iCurrentSlab]);
+				const __m128 vOrigin = _mm_set1_ps(rRay.m_vec3Origin[iCurrentSlab]);
+				const __m128 vInverseDirection = _mm_set1_ps(rRay.m_vec3InverseDirection[iCurrentSlab]);
+
+				// the same operations as the scalar slab test, so the distances are bit for bit the same.
+				// max and min return their second operand if either one is NaN, which keeps the interval as it is, just like the scalar comparisons
+				vIntersectionDistanceMin = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(vNearPlanes, vOrigin), vInverseDirection), vIntersectionDistanceMin);
+				vIntersectionDistanceMax = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(vFarPlanes, vOrigin), vInverseDirection), vIntersectionDistanceMax);
 			}
 
-			/*
-				maximum and minimum extents along current axis are now stored
-				now to determine the radius of the AABB.
-				to tightly fit the AABB for the given vertices, the absolute distance to the centre, which is assumed to be 0,0,0
-				are compared. The longer distance is the half-width for that axis.
-			*/
+			__m128 vIsHit = _mm_cmple_ps(vIntersectionDistanceMin, vIntersectionDistanceMax);
+			vIsHit = _mm_and_ps(vIsHit, _mm_cmple_ps(vIntersectionDistanceMin, _mm_set1_ps(fMaxEntryDistance)));
+			_mm_storeu_ps(pEntryDistances, vIntersectionDistanceMin);
 
-			const float fHalfWidthX = std::max(std::abs(fXMin), std::abs(fXMax));
-			const float fHalfWidthY = std::max(std::abs(fYMin), std::abs(fYMax));
-			const float fHalfWidthZ = std::max(std::abs(fZMin), std::abs(fZMax));
+			return static_cast<uint32_t>(_mm_movemask_ps(vIsHit));
+		}
 
-			tResult.m_vec3Center = glm::vec3(0.0f, 0.0f, 0.0f);		// local space center / pivot point. assumed to be 0,0,0. This is true for all of VISSAs objects
-			tResult.m_vec3Radius = glm::vec3(fHalfWidthX, fHalfWidthY, fHalfWidthZ);
+#if defined(__AVX__)
+		uint32_t IntersectRayEightMinMaxBoxes(const Ray & rRay, const float * pMinX, const float * pMinY, const float * pMinZ,
+			const float * pMaxX, const float * pMaxY, const float * pMaxZ, float fMaxEntryDistance, float * pEntryDistances)
+		{
+			const float* pBoxPlanes[2][3] = { { pMinX, pMinY, pMinZ }, { pMaxX, pMaxY, pMaxZ } };
+
+			__m256 vIntersectionDistanceMin = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+			__m256 vIntersectionDistanceMax = _mm256_set1_ps(std::numeric_limits<float>::max());
+
+			for (int iCurrentSlab = 0; iCurrentSlab < 3; iCurrentSlab++)
+			{
+				const int iIsDirectionNegative = rRay.m_pIsDirectionNegative[iCurrentSlab];
+				const __m256 vNearPlanes = _mm256_loadu_ps(pBoxPlanes[iIsDirectionNegative][iCurrentSlab]);
+				const __m256 vFarPlanes = _mm256_loadu_ps(pBoxPlanes[1 - iIsDirectionNegative][iCurrentSlab]);
+				const __m256 vOrigin = _mm256_set1_ps(rRay.m_vec3Origin[iCurrentSlab]);
+				const __m256 vInverseDirection = _mm256_set1_ps(rRay.m_vec3InverseDirection[iCurrentSlab]);
+
+				vIntersectionDistanceMin = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(vNearPlanes, vOrigin), vInverseDirection), vIntersectionDistanceMin);
+				vIntersectionDistanceMax = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(vFarPlanes, vOrigin), vInverseDirection), vIntersectionDistanceMax);
+			}
+
+			__m256 vIsHit = _mm256_cmp_ps(vIntersectionDistanceMin, vIntersectionDistanceMax, _CMP_LE_OQ);
+			vIsHit = _mm256_and_ps(vIsHit, _mm256_cmp_ps(vIntersectionDistanceMin, _mm256_set1_ps(fMaxEntryDistance), _CMP_LE_OQ));
+			_mm256_storeu_ps(pEntryDistances, vIntersectionDistanceMin);
+
+			return static_cast<uint32_t>(_mm256_movemask_ps(vIsHit));
+		}
+#endif
+
+		uint32_t IntersectRayWideBVHChildren(const Ray & rRay, const WideBVHNode<4>& rNode, float fMaxEntryDistance, float * pEntryDistances)
+		{
+			return IntersectRayFourMinMaxBoxes(rRay, rNode.m_pChildMinX, rNode.m_pChildMinY, rNode.m_pChildMinZ,
+				rNode.m_pChildMaxX, rNode.m_pChildMaxY, rNode.m_pChildMaxZ, fMaxEntryDistance, pEntryDistances);
+		}
+
+		uint32_t IntersectRayWideBVHChildren(const Ray & rRay, const WideBVHNode<8>& rNode, float fMaxEntryDistance, float * pEntryDistances)
+		{
+#if defined(__AVX__)
+			return IntersectRayEightMinMaxBoxes(rRay, rNode.m_pChildMinX, rNode.m_pChildMinY, rNode.m_pChildMinZ,
+				rNode.m_pChildMaxX, rNode.m_pChildMaxY, rNode.m_pChildMaxZ, fMaxEntryDistance, pEntryDistances);
+#else
+			const uint32_t uiLowerHalf = IntersectRayFourMinMaxBoxes(rRay, rNode.m_pChildMinX, rNode.m_pChildMinY, rNode.m_pChildMinZ,
+				rNode.m_pChildMaxX, rNode.m_pChildMaxY, rNode.m_pChildMaxZ, fMaxEntryDistance, pEntryDistances);
+			const uint32_t uiUpperHalf = IntersectRayFourMinMaxBoxes(rRay, rNode.m_pChildMinX + 4, rNode.m_pChildMinY + 4, rNode.m_pChildMinZ + 4,
+				rNode.m_pChildMaxX + 4, rNode.m_pChildMaxY + 4, rNode.m_pChildMaxZ + 4, fMaxEntryDistance, pEntryDistances + 4);
+			return uiLowerHalf | (uiUpperHalf << 4u);
+#endif
+		}
+
+		template <size_t uiWidth>
+		RayCastIntersectionResult CastRayIntoWideBVH(const WideBVH<uiWidth>& rBVH, const Ray & rCastedRay)
+		{
+			RayCastIntersectionResult tResult;
+
+			if (rBVH.m_vecNodes.empty()) // only actually cast a ray if there are objects in the scene
+				return tResult;
 
+			CastRayIntoWideBVHSubtree(rBVH, 0u, std::numeric_limits<float>::lowest(), rCastedRay, tResult);
 			return tResult;
 		}
 
-		AABB UpdateAABBFromAABB_UniformScaling(const AABB& rLocalSpaceAABB, const glm::mat4& mat4Rotation, const glm::vec3& rTranslation, const glm::vec3& rScale)
+		template <size_t uiWidth>
+		void CastRayIntoWideBVHSubtree(const WideBVH<uiWidth>& rBVH, uint32_t uiSubtreeRootIndex, float fEntryDistance, const Ray & rCastedRay, RayCastIntersectionResult & rResult)
 		{
-			assert(glm::length(rLocalSpaceAABB.m_vec3Radius) > 0.0f);	// make sure old AABB has already been constructed
+			// nodes to visit, together with the distance at which the ray enters them. Once something closer was hit, they are skipped
+			struct NodeToVisit {
+				uint32_t m_uiNodeIndex;
+				float m_fEntryDistance;
+			};
+			NodeToVisit pNodesToVisit[s_uiRayTraversalStackSize];
+			size_t uiNumNodesToVisit = 0u;
+			pNodesToVisit[uiNumNodesToVisit++] = { uiSubtreeRootIndex, fEntryDistance };
 
-			AABB tResult;
+			while (uiNumNodesToVisit > 0u)
+			{
+				const NodeToVisit tCurrentNodeToVisit = pNodesToVisit[--uiNumNodesToVisit];
 
-			for (int i = 0; i < 3; i++) // for every axis of the new AABB
+				// nothing in this subtree can be closer than the closest hit found so far
+				if (tCurrentNodeToVisit.m_fEntryDistance > rResult.m_fIntersectionDistance)
+					continue;
+
+				const WideBVHNode<uiWidth>& rCurrentNode = rBVH.m_vecNodes[tCurrentNodeToVisit.m_uiNodeIndex];
+
+				float pEntryDistances[uiWidth];
+				uint32_t uiHitChildren = IntersectRayWideBVHChildren(rCastedRay, rCurrentNode, rResult.m_fIntersectionDistance, pEntryDistances);
+				uiHitChildren &= (1u << rCurrentNode.m_uiNumChildren) - 1u;	// the unused slots hold no boxes
+
+				// leaves are tested right away, child nodes are collected sorted by descending entry distance
+				NodeToVisit pChildNodesToVisit[uiWidth];
+				size_t uiNumChildNodesToVisit = 0u;
+				for (uint32_t uiCurrentChild = 0u; uiCurrentChild < uiWidth; uiCurrentChild++)
+				{
+					if ((uiHitChildren & (1u << uiCurrentChild)) == 0u)
+						continue;
+
+					const uint32_t uiNumObjects = rCurrentNode.m_pChildNumObjects[uiCurrentChild];
+					if (uiNumObjects == 0u)
+					{
+						NodeToVisit tChildNodeToVisit = { rCurrentNode.m_pChildNodeOrFirstObject[uiCurrentChild], pEntryDistances[uiCurrentChild] };
+						size_t uiInsertionIndex = uiNumChildNodesToVisit++;
+						for (; uiInsertionIndex > 0u && pChildNodesToVisit[uiInsertionIndex - 1u].m_fEntryDistance < tChildNodeToVisit.m_fEntryDistance; uiInsertionIndex--)
+							pChildNodesToVisit[uiInsertionIndex] = pChildNodesToVisit[uiInsertionIndex - 1u];
+						pChildNodesToVisit[uiInsertionIndex] = tChildNodeToVisit;
+						continue;
+					}
+
+					const uint32_t uiFirstObject = rCurrentNode.m_pChildNodeOrFirstObject[uiCurrentChild];
+					assert(uiFirstObject + uiNumObjects <= rBVH.m_vecObjectPermutation.size());
+					SceneObject* const* ppLeafObjects = rBVH.m_vecObjectPermutation.data() + uiFirstObject;
+
+					for (uint32_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < uiNumObjects; uiCurrentSceneObject++)
+					{
+						float fIntersectionDistanceForCurrentAABB;
+						glm::vec3 vec3CurrentIntersectionPoint;
+						if (IntersectRayAABB(rCastedRay, ppLeafObjects[uiCurrentSceneObject]->m_tWorldSpaceAABB, fIntersectionDistanceForCurrentAABB, vec3CurrentIntersectionPoint))
+						{
+							if (fIntersectionDistanceForCurrentAABB < rResult.m_fIntersectionDistance)
+							{
+								rResult.m_fIntersectionDistance = fIntersectionDistanceForCurrentAABB;
+								rResult.m_vec3PointOfIntersection = vec3CurrentIntersectionPoint;
+								rResult.m_pFirstIntersectedSceneObject = ppLeafObjects[uiCurrentSceneObject];
+							}
+						}
+					}
+				}
+
+				// the nearest child ends up on top of the stack
+				size_t uiNumPushedChildNodes = 0u;
+				for (; uiNumPushedChildNodes < uiNumChildNodesToVisit && uiNumNodesToVisit < s_uiRayTraversalStackSize; uiNumPushedChildNodes++)
+					pNodesToVisit[uiNumNodesToVisit++] = pChildNodesToVisit[uiNumPushedChildNodes];
+
+				// the nearest children did not fit anymore, their subtrees are traversed right away, nearest first
+				for (size_t uiCurrentChildNode = uiNumChildNodesToVisit; uiCurrentChildNode-- > uiNumPushedChildNodes; )
+					CastRayIntoWideBVHSubtree(rBVH, pChildNodesToVisit[uiCurrentChildNode].m_uiNodeIndex, pChildNodesToVisit[uiCurrentChildNode].m_fEntryDistance, rCastedRay, rResult);
+			}
+		}
+
+		void CastRayIntoLinearBVHSubtree(const LinearBVH & rBVH, uint32_t uiSubtreeRootIndex, const Ray & rCastedRay, RayCastIntersectionResult & rResult)
+		{
+			assert(uiSubtreeRootIndex < rBVH.m_vecNodes.size());
+
+			// iterating with an explicit stack of node indices instead of recursion. Left children are visited first, right ones are put aside
+			uint32_t pNodesToVisit[s_uiRayTraversalStackSize];
+			size_t uiNumNodesToVisit = 0u;
+			pNodesToVisit[uiNumNodesToVisit++] = uiSubtreeRootIndex;
+
+			while (uiNumNodesToVisit > 0u)
 			{
-				tResult.m_vec3Center[i] = rTranslation[i];	// we assume the translation
-				tResult.m_vec3Radius[i] = 0.0f;				// and start with a radius of 0
-				for (int j = 0; j < 3; j++)		// for every axis of the old AABB
+				const uint32_t uiCurrentNodeIndex = pNodesToVisit[--uiNumNodesToVisit];
+				const LinearBVHNode& rCurrentNode = rBVH.m_vecNodes[uiCurrentNodeIndex];
+
+				float fIntersectionDistanceMin;
+				if (!IntersectRayMinMaxBox(rCastedRay, rCurrentNode.m_vec3Min, rCurrentNode.m_vec3Max, fIntersectionDistanceMin))
+					continue;
+
+				// nothing in this subtree can be closer than the closest hit found so far
+				if (fIntersectionDistanceMin > rResult.m_fIntersectionDistance)
+					continue;
+
+				if (rCurrentNode.IsANode())
 				{
-					tResult.m_vec3Center[i] += mat4Rotation[i][j] * rLocalSpaceAABB.m_vec3Center[j];				// we adjust the center. This only has an effect, when the old AABBs center was not {0,0,0}, like somewhere in world-space.	When the old AABBs centre point was in 0,0,0 local space, this will do nothing.
-					tResult.m_vec3Radius[i] += std::abs(mat4Rotation[i][j]) * rLocalSpaceAABB.m_vec3Radius[j];		// we continuosly increase the radius, starting at 0. For every axis of the old, rotated old AABB (j), we add its impact to the radius of the axis of the new AABB (i)
+					pNodesToVisit[uiNumNodesToVisit++] = rCurrentNode.m_uiRightChildOrFirstObject;
+					// with no free slot left, the left child's subtree, which would be next anyway, is traversed right away
+					if (uiNumNodesToVisit == s_uiRayTraversalStackSize)
+						CastRayIntoLinearBVHSubtree(rBVH, uiCurrentNodeIndex + 1u, rCastedRay, rResult);
+					else
+						pNodesToVisit[uiNumNodesToVisit++] = uiCurrentNodeIndex + 1u;	// the left child directly follows its parent
 				}
-				tResult.m_vec3Radius[i] *= rScale[i]; // we scale the current axis of the new AABB
+				else // is a leaf
+				{
+					assert(rCurrentNode.m_uiRightChildOrFirstObject + rCurrentNode.m_uiNumObjects <= rBVH.m_vecObjectPermutation.size());
+					SceneObject* const* ppLeafObjects = rBVH.m_vecObjectPermutation.data() + rCurrentNode.m_uiRightChildOrFirstObject;
+
+					for (uint32_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < rCurrentNode.m_uiNumObjects; uiCurrentSceneObject++)
+					{
+						float fIntersectionDistanceForCurrentAABB;
+						glm::vec3 vec3CurrentIntersectionPoint;
+						if (IntersectRayAABB(rCastedRay, ppLeafObjects[uiCurrentSceneObject]->m_tWorldSpaceAABB, fIntersectionDistanceForCurrentAABB, vec3CurrentIntersectionPoint))
+						{
+							if (fIntersectionDistanceForCurrentAABB < rResult.m_fIntersectionDistance)
+							{
+								rResult.m_fIntersectionDistance = fIntersectionDistanceForCurrentAABB;
+								rResult.m_vec3PointOfIntersection = vec3CurrentIntersectionPoint;
+								rResult.m_pFirstIntersectedSceneObject = ppLeafObjects[uiCurrentSceneObject];
+							}
+						}
+					}
+				}
+			}
+		}
+
+		void CastRayIntoDynamicAABBTreeSubtree(const DynamicAABBTree & rTree, int32_t iSubtreeRootNode, SceneObject * pSceneObjects, const Ray & rCastedRay, RayCastIntersectionResult & rResult)
+		{
+			const std::vector<DynamicAABBTree::Node>& rvecNodes = rTree.GetNodes();
+
+			int32_t pNodesToVisit[s_uiRayTraversalStackSize];
+			size_t uiNumNodesToVisit = 0u;
+			pNodesToVisit[uiNumNodesToVisit++] = iSubtreeRootNode;
+
+			while (uiNumNodesToVisit > 0u)
+			{
+				const DynamicAABBTree::Node& rCurrentNode = rvecNodes[pNodesToVisit[--uiNumNodesToVisit]];
+
+				float fIntersectionDistanceMin;
+				if (!IntersectRayMinMaxBox(rCastedRay, rCurrentNode.m_tAABB.m_vec3Center - rCurrentNode.m_tAABB.m_vec3Radius, rCurrentNode.m_tAABB.m_vec3Center + rCurrentNode.m_tAABB.m_vec3Radius, fIntersectionDistanceMin))
+					continue;
+
+				// nothing in this subtree can be closer than the closest hit found so far
+				if (fIntersectionDistanceMin > rResult.m_fIntersectionDistance)
+					continue;
+
+				if (!rCurrentNode.IsALeaf())
+				{
+					pNodesToVisit[uiNumNodesToVisit++] = rCurrentNode.m_iRight;
+					// with no free slot left, the left child's subtree, which would be next anyway, is traversed right away
+					if (uiNumNodesToVisit == s_uiRayTraversalStackSize)
+						CastRayIntoDynamicAABBTreeSubtree(rTree, rCurrentNode.m_iLeft, pSceneObjects, rCastedRay, rResult);
+					else
+						pNodesToVisit[uiNumNodesToVisit++] = rCurrentNode.m_iLeft;
+				}
+				else
+				{
+					// the leaf only holds the fat AABB, the object's own AABB decides
+					SceneObject* pLeafObject = pSceneObjects + rCurrentNode.m_uiObjectIndex;
+					float fIntersectionDistanceForCurrentAABB;
+					glm::vec3 vec3CurrentIntersectionPoint;
+					if (IntersectRayAABB(rCastedRay, pLeafObject->m_tWorldSpaceAABB, fIntersectionDistanceForCurrentAABB, vec3CurrentIntersectionPoint))
+					{
+						if (fIntersectionDistanceForCurrentAABB < rResult.m_fIntersectionDistance)
+						{
+							rResult.m_fIntersectionDistance = fIntersectionDistanceForCurrentAABB;
+							rResult.m_vec3PointOfIntersection = vec3CurrentIntersectionPoint;
+							rResult.m_pFirstIntersectedSceneObject = pLeafObject;
+						}
+					}
+				}
+			}
+		}
+
+		template <size_t uiPacketSize>
+		RayPacketSlabData<uiPacketSize> CreateRayPacketSlabData(const Ray * pRays, size_t uiNumRays)
+		{
+			assert(uiNumRays > 0u && uiNumRays <= uiPacketSize);
+
+			RayPacketSlabData<uiPacketSize> tResult;
+
+			for (size_t uiCurrentRay = 0u; uiCurrentRay < uiPacketSize; uiCurrentRay++)
+			{
+				// unused slots repeat the first ray, so they never compute anything odd. Their results are masked out anyway
+				const Ray& rRay = pRays[(uiCurrentRay < uiNumRays) ? uiCurrentRay : 0u];
+
+				for (int iCurrentSlab = 0; iCurrentSlab < 3; iCurrentSlab++)
+				{
+					tResult.m_pOrigins[iCurrentSlab][uiCurrentRay] = rRay.m_vec3Origin[iCurrentSlab];
+					tResult.m_pInverseDirections[iCurrentSlab][uiCurrentRay] = rRay.m_vec3InverseDirection[iCurrentSlab];
+					tResult.m_pIsDirectionNegative[iCurrentSlab][uiCurrentRay] = rRay.m_pIsDirectionNegative[iCurrentSlab] ? 0xFFFFFFFFu : 0u;
+				}
+				tResult.m_pMaxEntryDistances[uiCurrentRay] = std::numeric_limits<float>::max();
+			}
+
+			return tResult;
+		}
+
+		template <size_t uiPacketSize>
+		uint32_t IntersectFourRaysMinMaxBox(const RayPacketSlabData<uiPacketSize>& rPacket, size_t uiFirstRay, const glm::vec3 & rvec3Min, const glm::vec3 & rvec3Max)
+		{
+			__m128 vIntersectionDistanceMin = _mm_set1_ps(std::numeric_limits<float>::lowest());
+			__m128 vIntersectionDistanceMax = _mm_set1_ps(std::numeric_limits<float>::max());
+
+			for (int iCurrentSlab = 0; iCurrentSlab < 3; iCurrentSlab++)
+			{
+				const __m128 vOrigin = _mm_loadu_ps(&rPacket.m_pOrigins[iCurrentSlab][uiFirstRay]);
+				const __m128 vInverseDirection = _mm_loadu_ps(&rPacket.m_pInverseDirections[iCurrentSlab][uiFirstRay]);
+				const __m128 vIsDirectionNegative = _mm_loadu_ps(reinterpret_cast<const float*>(&rPacket.m_pIsDirectionNegative[iCurrentSlab][uiFirstRay]));
+
+				// every ray picks its near and far plane by its own sign, with the same operations as the scalar slab test
+				const __m128 vIntersectionDistance1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(rvec3Min[iCurrentSlab]), vOrigin), vInverseDirection);
+				const __m128 vIntersectionDistance2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(rvec3Max[iCurrentSlab]), vOrigin), vInverseDirection);
+				const __m128 vNear = _mm_or_ps(_mm_and_ps(vIsDirectionNegative, vIntersectionDistance2), _mm_andnot_ps(vIsDirectionNegative, vIntersectionDistance1));
+				const __m128 vFar = _mm_or_ps(_mm_and_ps(vIsDirectionNegative, vIntersectionDistance1), _mm_andnot_ps(vIsDirectionNegative, vIntersectionDistance2));
+				vIntersectionDistanceMin = _mm_max_ps(vNear, vIntersectionDistanceMin);
+				vIntersectionDistanceMax = _mm_min_ps(vFar, vIntersectionDistanceMax);
+			}
+
+			__m128 vIsHit = _mm_cmple_ps(vIntersectionDistanceMin, vIntersectionDistanceMax);
+			vIsHit = _mm_and_ps(vIsHit, _mm_cmple_ps(vIntersectionDistanceMin, _mm_loadu_ps(&rPacket.m_pMaxEntryDistances[uiFirstRay])));
+
+			return static_cast<uint32_t>(_mm_movemask_ps(vIsHit));
+		}
+
+#if defined(__AVX__)
+		template <size_t uiPacketSize>
+		uint32_t IntersectEightRaysMinMaxBox(const RayPacketSlabData<uiPacketSize>& rPacket, size_t uiFirstRay, const glm::vec3 & rvec3Min, const glm::vec3 & rvec3Max)
+		{
+			__m256 vIntersectionDistanceMin = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+			__m256 vIntersectionDistanceMax = _mm256_set1_ps(std::numeric_limits<float>::max());
+
+			for (int iCurrentSlab = 0; iCurrentSlab < 3; iCurrentSlab++)
+			{
+				const __m256 vOrigin = _mm256_loadu_ps(&rPacket.m_pOrigins[iCurrentSlab][uiFirstRay]);
+				const __m256 vInverseDirection = _mm256_loadu_ps(&rPacket.m_pInverseDirections[iCurrentSlab][uiFirstRay]);
+				const __m256 vIsDirectionNegative = _mm256_loadu_ps(reinterpret_cast<const float*>(&rPacket.m_pIsDirectionNegative[iCurrentSlab][uiFirstRay]));
+
+				const __m256 vIntersectionDistance1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(rvec3Min[iCurrentSlab]), vOrigin), vInverseDirection);
+				const __m256 vIntersectionDistance2 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(rvec3Max[iCurrentSlab]), vOrigin), vInverseDirection);
+				vIntersectionDistanceMin = _mm256_max_ps(_mm256_blendv_ps(vIntersectionDistance1, vIntersectionDistance2, vIsDirectionNegative), vIntersectionDistanceMin);
+				vIntersectionDistanceMax = _mm256_min_ps(_mm256_blendv_ps(vIntersectionDistance2, vIntersectionDistance1, vIsDirectionNegative), vIntersectionDistanceMax);
+			}
+
+			__m256 vIsHit = _mm256_cmp_ps(vIntersectionDistanceMin, vIntersectionDistanceMax, _CMP_LE_OQ);
+			vIsHit = _mm256_and_ps(vIsHit, _mm256_cmp_ps(vIntersectionDistanceMin, _mm256_loadu_ps(&rPacket.m_pMaxEntryDistances[uiFirstRay]), _CMP_LE_OQ));
+
+			return static_cast<uint32_t>(_mm256_movemask_ps(vIsHit));
+		}
+#endif
+
+		template <size_t uiPacketSize>
+		uint32_t IntersectRayPacketMinMaxBox(const RayPacketSlabData<uiPacketSize>& rPacket, const glm::vec3 & rvec3Min, const glm::vec3 & rvec3Max)
+		{
+			static_assert(uiPacketSize % 4u == 0u && uiPacketSize <= 32u, "packets are tested four rays at a time and their masks have to fit into 32 bits");
+
+			uint32_t uiHitRays = 0u;
+#if defined(__AVX__)
+			if (uiPacketSize % 8u == 0u)
+			{
+				for (size_t uiFirstRay = 0u; uiFirstRay < uiPacketSize; uiFirstRay += 8u)
+					uiHitRays |= IntersectEightRaysMinMaxBox(rPacket, uiFirstRay, rvec3Min, rvec3Max) << uiFirstRay;
+				return uiHitRays;
+			}
+#endif
+			for (size_t uiFirstRay = 0u; uiFirstRay < uiPacketSize; uiFirstRay += 4u)
+				uiHitRays |= IntersectFourRaysMinMaxBox(rPacket, uiFirstRay, rvec3Min, rvec3Max) << uiFirstRay;
+
+			return uiHitRays;
+		}
+
+		template <size_t uiPacketSize>
+		void CastRayPacketIntoLinearBVH(const LinearBVH & rBVH, const Ray * pRays, size_t uiNumRays, RayCastIntersectionResult * pResults)
+		{
+			assert(!rBVH.m_vecNodes.empty());
+			assert(uiNumRays > 0u && uiNumRays <= uiPacketSize);
+
+			RayPacketSlabData<uiPacketSize> tPacket = CreateRayPacketSlabData<uiPacketSize>(pRays, uiNumRays);
+
+			const uint32_t uiAllRays = (uiNumRays == 32u) ? 0xFFFFFFFFu : (1u << static_cast<uint32_t>(uiNumRays)) - 1u;
+			CastRayPacketIntoLinearBVHSubtree(rBVH, 0u, uiAllRays, tPacket, pRays, uiNumRays, pResults);
+		}
+
+		template <size_t uiPacketSize>
+		void CastRayPacketIntoLinearBVHSubtree(const LinearBVH & rBVH, uint32_t uiSubtreeRootIndex, uint32_t uiSubtreeActiveRays, RayPacketSlabData<uiPacketSize>& rPacket,
+			const Ray * pRays, size_t uiNumRays, RayCastIntersectionResult * pResults)
+		{
+			// a subtree that is entered by this few rays or less is left to them, one at a time
+			const uint32_t uiMaxNumActiveRaysForSplitting = static_cast<uint32_t>(std::max<size_t>(1u, uiPacketSize / 4u));
+
+			// nodes to visit, together with the rays that hit their parent. Their own box still has to be tested
+			struct NodeToVisit {
+				uint32_t m_uiNodeIndex;
+				uint32_t m_uiActiveRays;
+			};
+			NodeToVisit pNodesToVisit[s_uiRayTraversalStackSize];
+			size_t uiNumNodesToVisit = 0u;
+			pNodesToVisit[uiNumNodesToVisit++] = { uiSubtreeRootIndex, uiSubtreeActiveRays };
+
+			while (uiNumNodesToVisit > 0u)
+			{
+				const NodeToVisit tCurrentNodeToVisit = pNodesToVisit[--uiNumNodesToVisit];
+				const LinearBVHNode& rCurrentNode = rBVH.m_vecNodes[tCurrentNodeToVisit.m_uiNodeIndex];
+
+				// rays that miss the node, or that already hit something closer, are done with the whole subtree
+				const uint32_t uiActiveRays = tCurrentNodeToVisit.m_uiActiveRays & IntersectRayPacketMinMaxBox(rPacket, rCurrentNode.m_vec3Min, rCurrentNode.m_vec3Max);
+				if (uiActiveRays == 0u)
+					continue;
+
+				uint32_t uiNumActiveRays = 0u;
+				for (uint32_t uiRemainingRays = uiActiveRays; uiRemainingRays != 0u; uiRemainingRays &= uiRemainingRays - 1u)
+					uiNumActiveRays++;
+
+				// the rays diverged, testing the whole packet would mostly compute results nobody needs
+				if (uiNumActiveRays <= uiMaxNumActiveRaysForSplitting)
+				{
+					for (uint32_t uiCurrentRay = 0u; uiCurrentRay < uiNumRays; uiCurrentRay++)
+					{
+						if ((uiActiveRays & (1u << uiCurrentRay)) == 0u)
+							continue;
+
+						CastRayIntoLinearBVHSubtree(rBVH, tCurrentNodeToVisit.m_uiNodeIndex, pRays[uiCurrentRay], pResults[uiCurrentRay]);
+						rPacket.m_pMaxEntryDistances[uiCurrentRay] = pResults[uiCurrentRay].m_fIntersectionDistance;
+					}
+					continue;
+				}
+
+				if (rCurrentNode.IsANode())
+				{
+					// visit the child first that comes first along the direction of one of the rays. For coherent rays, it is the nearer child for most of them
+					uint32_t uiLeadingRay = 0u;
+					while ((uiActiveRays & (1u << uiLeadingRay)) == 0u)
+						uiLeadingRay++;
+
+					const uint32_t uiLeftChildIndex = tCurrentNodeToVisit.m_uiNodeIndex + 1u;	// the left child directly follows its parent
+					const uint32_t uiRightChildIndex = rCurrentNode.m_uiRightChildOrFirstObject;
+					const LinearBVHNode& rLeftChild = rBVH.m_vecNodes[uiLeftChildIndex];
+					const LinearBVHNode& rRightChild = rBVH.m_vecNodes[uiRightChildIndex];
+					const glm::vec3 vec3LeftToRight = (rRightChild.m_vec3Min + rRightChild.m_vec3Max) - (rLeftChild.m_vec3Min + rLeftChild.m_vec3Max);
+
+					const bool bIsLeftChildFirst = (glm::dot(vec3LeftToRight, pRays[uiLeadingRay].m_vec3Direction) >= 0.0f);
+					const uint32_t uiFirstChildIndex = bIsLeftChildFirst ? uiLeftChildIndex : uiRightChildIndex;
+					pNodesToVisit[uiNumNodesToVisit++] = { bIsLeftChildFirst ? uiRightChildIndex : uiLeftChildIndex, uiActiveRays };
+					// with no free slot left, the subtree of the child that would be next anyway is traversed right away
+					if (uiNumNodesToVisit == s_uiRayTraversalStackSize)
+						CastRayPacketIntoLinearBVHSubtree(rBVH, uiFirstChildIndex, uiActiveRays, rPacket, pRays, uiNumRays, pResults);
+					else
+						pNodesToVisit[uiNumNodesToVisit++] = { uiFirstChildIndex, uiActiveRays };
+				}
+				else // is a leaf
+				{
+					assert(rCurrentNode.m_uiRightChildOrFirstObject + rCurrentNode.m_uiNumObjects <= rBVH.m_vecObjectPermutation.size());
+					SceneObject* const* ppLeafObjects = rBVH.m_vecObjectPermutation.data() + rCurrentNode.m_uiRightChildOrFirstObject;
+
+					for (uint32_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < rCurrentNode.m_uiNumObjects; uiCurrentSceneObject++)
+					{
+						// the packet test only finds the rays that might hit the object, the exact result comes from the scalar test every single ray cast uses
+						const AABB& rObjectAABB = ppLeafObjects[uiCurrentSceneObject]->m_tWorldSpaceAABB;
+						const uint32_t uiHitRays = uiActiveRays & IntersectRayPacketMinMaxBox(rPacket, rObjectAABB.m_vec3Center - rObjectAABB.m_vec3Radius, rObjectAABB.m_vec3Center + rObjectAABB.m_vec3Radius);
+
+						for (uint32_t uiCurrentRay = 0u; uiCurrentRay < uiNumRays; uiCurrentRay++)
+						{
+							if ((uiHitRays & (1u << uiCurrentRay)) == 0u)
+								continue;
+
+							float fIntersectionDistanceForCurrentAABB;
+							glm::vec3 vec3CurrentIntersectionPoint;
+							if (IntersectRayAABB(pRays[uiCurrentRay], rObjectAABB, fIntersectionDistanceForCurrentAABB, vec3CurrentIntersectionPoint))
+							{
+								if (fIntersectionDistanceForCurrentAABB < pResults[uiCurrentRay].m_fIntersectionDistance)
+								{
+									pResults[uiCurrentRay].m_fIntersectionDistance = fIntersectionDistanceForCurrentAABB;
+									pResults[uiCurrentRay].m_vec3PointOfIntersection = vec3CurrentIntersectionPoint;
+									pResults[uiCurrentRay].m_pFirstIntersectedSceneObject = ppLeafObjects[uiCurrentSceneObject];
+									rPacket.m_pMaxEntryDistances[uiCurrentRay] = fIntersectionDistanceForCurrentAABB;
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		int IntersectRayAABB(const Ray & rIntersectingRay, const AABB& rAABB, float & rfIntersectionDistanceMin, glm::vec3& rvec3IntersectionPoint)
+		{
+			// assert that the direction vector of the ray is normalized. relevant for: see end of function
+			assert(rIntersectingRay.m_vec3Direction.length() == glm::normalize(rIntersectingRay.m_vec3Direction).length());
+
+			// the corners are computed once instead of once per slab and plane
+			if (!IntersectRayMinMaxBox(rIntersectingRay, rAABB.m_vec3Center - rAABB.m_vec3Radius, rAABB.m_vec3Center + rAABB.m_vec3Radius, rfIntersectionDistanceMin))
+				return 0;
+
+			// Ray intersects all 3 slabs
+			rvec3IntersectionPoint = rIntersectingRay.m_vec3Origin + rIntersectingRay.m_vec3Direction * rfIntersectionDistanceMin;
+			return 1;
+		}
+
+		//////////////////////////////////////////
+		// OVERLAPPING PAIRS
+		//////////////////////////////////////////
+
+		// pairs of subtrees are only handed to other threads this close to the root. Deeper down, a task would find too few pairs to pay off
+		const int s_iMaxDepthForOverlappingPairsTasks = 8;
+
+		template <typename BoundingVolume>
+		size_t FindOverlappingObjectPairs(const BoundingVolumeHierarchy & rBVH, const BoundingVolumeHierarchy * pOtherBVH,
+			BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			int(*pTestBoundingVolumes)(const BoundingVolume&, const BoundingVolume&), ObjectPair * pPairs, size_t uiMaxNumPairs, TaskPool * pTaskPool)
+		{
+			assert(pPairs || uiMaxNumPairs == 0u);
+
+			ObjectPairOutput tOutput;
+			tOutput.m_pPairs = pPairs;
+			tOutput.m_uiMaxNumPairs = uiMaxNumPairs;
+			tOutput.m_uiNumPairs = 0u;
+
+			OverlappingPairsQuery<BoundingVolume> tQuery;
+			tQuery.m_pBVH = &rBVH;
+			tQuery.m_pOtherBVH = pOtherBVH ? pOtherBVH : &rBVH;
+			tQuery.m_pNodeBoundingVolume = pNodeBoundingVolume;
+			tQuery.m_pObjectBoundingVolume = pObjectBoundingVolume;
+			tQuery.m_pTestBoundingVolumes = pTestBoundingVolumes;
+			tQuery.m_pTaskPool = pTaskPool;
+			tQuery.m_pOutput = &tOutput;
+
+			ObjectPairBatch tBatch;
+			if (pOtherBVH == nullptr)
+			{
+				if (rBVH.m_pRootNode)
+					FindOverlappingObjectPairsInSubtree(tQuery, rBVH.m_pRootNode, 0, tBatch);
+			}
+			else if (rBVH.m_pRootNode && pOtherBVH->m_pRootNode)
+			{
+				FindOverlappingObjectPairsBetweenSubtrees(tQuery, rBVH.m_pRootNode, pOtherBVH->m_pRootNode, 0, tBatch);
+			}
+			FlushObjectPairBatch(tOutput, tBatch);
+
+			return tOutput.m_uiNumPairs.load();
+		}
+
+		template <typename BoundingVolume>
+		void FindOverlappingObjectPairsInSubtree(const OverlappingPairsQuery<BoundingVolume>& rQuery, const BVHTreeNode * pNode, int iDepth, ObjectPairBatch & rBatch)
+		{
+			assert(pNode);
+
+			if (!pNode->IsANode())
+			{
+				SceneObject* const* ppLeafObjects = rQuery.m_pBVH->m_vecObjectPermutation.data() + pNode->m_uiFirstObject;
+				for (uint32_t uiCurrentObject = 0u; uiCurrentObject < pNode->m_uiNumOjbects; uiCurrentObject++)
+				{
+					for (uint32_t uiOtherObject = uiCurrentObject + 1u; uiOtherObject < pNode->m_uiNumOjbects; uiOtherObject++)
+					{
+						if (rQuery.m_pTestBoundingVolumes(ppLeafObjects[uiCurrentObject]->*rQuery.m_pObjectBoundingVolume, ppLeafObjects[uiOtherObject]->*rQuery.m_pObjectBoundingVolume))
+							AddObjectPair(*rQuery.m_pOutput, rBatch, ppLeafObjects[uiCurrentObject], ppLeafObjects[uiOtherObject]);
+					}
+				}
+				return;
 			}
 
-			return tResult;
+			if (rQuery.m_pTaskPool == nullptr || iDepth >= s_iMaxDepthForOverlappingPairsTasks)
+			{
+				FindOverlappingObjectPairsInSubtree(rQuery, pNode->m_pLeft, iDepth + 1, rBatch);
+				FindOverlappingObjectPairsInSubtree(rQuery, pNode->m_pRight, iDepth + 1, rBatch);
+				FindOverlappingObjectPairsBetweenSubtrees(rQuery, pNode->m_pLeft, pNode->m_pRight, iDepth + 1, rBatch);
+				return;
+			}
+
+			// both subtrees on their own are searched by other threads while this one searches between them.
+			// Every task collects its pairs in a batch of its own
+			TaskPool::TaskGroup tSubtreeTasks;
+			for (const BVHTreeNode* pCurrentChild : { pNode->m_pLeft, pNode->m_pRight })
+			{
+				rQuery.m_pTaskPool->Submit(tSubtreeTasks, [&rQuery, pCurrentChild, iDepth]() {
+					ObjectPairBatch tChildBatch;
+					FindOverlappingObjectPairsInSubtree(rQuery, pCurrentChild, iDepth + 1, tChildBatch);
+					FlushObjectPairBatch(*rQuery.m_pOutput, tChildBatch);
+				});
+			}
+			FindOverlappingObjectPairsBetweenSubtrees(rQuery, pNode->m_pLeft, pNode->m_pRight, iDepth + 1, rBatch);
+			rQuery.m_pTaskPool->Wait(tSubtreeTasks);
 		}
 
-		AABB UpdateAABBFromAABB_NonUniformScaling(const AABB & rLocalSpaceAABB, const glm::mat4 & mat4Transform)
+		template <typename BoundingVolume>
+		void FindOverlappingObjectPairsBetweenSubtrees(const OverlappingPairsQuery<BoundingVolume>& rQuery, const BVHTreeNode * pNode, const BVHTreeNode * pOtherNode, int iDepth, ObjectPairBatch & rBatch)
 		{
-			assert(glm::length(rLocalSpaceAABB.m_vec3Radius) > 0.0f);	// make sure old AABB has already been constructed
+			assert(pNode && pOtherNode);
 
-			AABB tResult;
+			const BoundingVolume& rNodeBoundingVolume = pNode->*rQuery.m_pNodeBoundingVolume;
+			const BoundingVolume& rOtherNodeBoundingVolume = pOtherNode->*rQuery.m_pNodeBoundingVolume;
+			if (!rQuery.m_pTestBoundingVolumes(rNodeBoundingVolume, rOtherNodeBoundingVolume))
+				return;
 
-			// world space AABB center by extracting the 4th colum of the transform matrix
-			const glm::vec3 vec3NewAABBCenter = mat4Transform[3];
-			tResult.m_vec3Center = vec3NewAABBCenter;
+			if (!pNode->IsANode() && !pOtherNode->IsANode())
+			{
+				SceneObject* const* ppLeafObjects = rQuery.m_pBVH->m_vecObjectPermutation.data() + pNode->m_uiFirstObject;
+				SceneObject* const* ppOtherLeafObjects = rQuery.m_pOtherBVH->m_vecObjectPermutation.data() + pOtherNode->m_uiFirstObject;
+				for (uint32_t uiCurrentObject = 0u; uiCurrentObject < pNode->m_uiNumOjbects; uiCurrentObject++)
+				{
+					const BoundingVolume& rObjectBoundingVolume = ppLeafObjects[uiCurrentObject]->*rQuery.m_pObjectBoundingVolume;
 
-			// constructing all corner points of the old AABB
-			std::vector<glm::vec4> vecOldAABBCornerPoints{
-				glm::vec4(rLocalSpaceAABB.CalcMaximumX(), rLocalSpaceAABB.CalcMaximumY(), rLocalSpaceAABB.CalcMaximumZ(), 1.0f),
-				glm::vec4(rLocalSpaceAABB.CalcMinimumX(), rLocalSpaceAABB.CalcMaximumY(), rLocalSpaceAABB.CalcMaximumZ(), 1.0f),
-				glm::vec4(rLocalSpaceAABB.CalcMaximumX(), rLocalSpaceAABB.CalcMinimumY(), rLocalSpaceAABB.CalcMaximumZ(), 1.0f),
-				glm::vec4(rLocalSpaceAABB.CalcMaximumX(), rLocalSpaceAABB.CalcMaximumY(), rLocalSpaceAABB.CalcMinimumZ(), 1.0f),
-				glm::vec4(rLocalSpaceAABB.CalcMinimumX(), rLocalSpaceAABB.CalcMinimumY(), rLocalSpaceAABB.CalcMaximumZ(), 1.0f),
-				glm::vec4(rLocalSpaceAABB.CalcMaximumX(), rLocalSpaceAABB.CalcMinimumY(), rLocalSpaceAABB.CalcMinimumZ(), 1.0f),
-				glm::vec4(rLocalSpaceAABB.CalcMinimumX(), rLocalSpaceAABB.CalcMaximumY(), rLocalSpaceAABB.CalcMinimumZ(), 1.0f),
-				glm::vec4(rLocalSpaceAABB.CalcMinimumX(), rLocalSpaceAABB.CalcMinimumY(), rLocalSpaceAABB.CalcMinimumZ(), 1.0f),
-			};
+					// objects that do not even reach into the other leaf cannot overlap any of its objects
+					if (!rQuery.m_pTestBoundingVolumes(rObjectBoundingVolume, rOtherNodeBoundingVolume))
+						continue;
 
-			for (const glm::vec4& rCurrentCornerPoint : vecOldAABBCornerPoints) // for every corner point
-			{
-				// transform it into world space
-				const glm::vec4 vec4WorldSpaceCornerPoint = mat4Transform * rCurrentCornerPoint;
+					for (uint32_t uiOtherObject = 0u; uiOtherObject < pOtherNode->m_uiNumOjbects; uiOtherObject++)
+					{
+						if (rQuery.m_pTestBoundingVolumes(rObjectBoundingVolume, ppOtherLeafObjects[uiOtherObject]->*rQuery.m_pObjectBoundingVolume))
+							AddObjectPair(*rQuery.m_pOutput, rBatch, ppLeafObjects[uiCurrentObject], ppOtherLeafObjects[uiOtherObject]);
+					}
+				}
+				return;
+			}
 
-				// world space AABB half-widths
-				const float fHalfWidthXForCurrentCornerPoint = std::abs(vec4WorldSpaceCornerPoint.x - tResult.m_vec3Center.x);
-				const float fHalfWidthYForCurrentCornerPoint = std::abs(vec4WorldSpaceCornerPoint.y - tResult.m_vec3Center.y);
-				const float fHalfWidthZForCurrentCornerPoint = std::abs(vec4WorldSpaceCornerPoint.z - tResult.m_vec3Center.z);
+			const bool bDescendIntoNode = !pOtherNode->IsANode() || (pNode->IsANode() && rNodeBoundingVolume.CalcSurfaceArea() >= rOtherNodeBoundingVolume.CalcSurfaceArea());
+			const BVHTreeNode* pFirstNode = bDescendIntoNode ? pNode->m_pLeft : pNode;
+			const BVHTreeNode* pFirstOtherNode = bDescendIntoNode ? pOtherNode : pOtherNode->m_pLeft;
+			const BVHTreeNode* pSecondNode = bDescendIntoNode ? pNode->m_pRight : pNode;
+			const BVHTreeNode* pSecondOtherNode = bDescendIntoNode ? pOtherNode : pOtherNode->m_pRight;
 
-				tResult.m_vec3Radius.x = std::max(tResult.m_vec3Radius.x, fHalfWidthXForCurrentCornerPoint);
-				tResult.m_vec3Radius.y = std::max(tResult.m_vec3Radius.y, fHalfWidthYForCurrentCornerPoint);
-				tResult.m_vec3Radius.z = std::max(tResult.m_vec3Radius.z, fHalfWidthZForCurrentCornerPoint);
+			if (rQuery.m_pTaskPool == nullptr || iDepth >= s_iMaxDepthForOverlappingPairsTasks)
+			{
+				FindOverlappingObjectPairsBetweenSubtrees(rQuery, pFirstNode, pFirstOtherNode, iDepth + 1, rBatch);
+				FindOverlappingObjectPairsBetweenSubtrees(rQuery, pSecondNode, pSecondOtherNode, iDepth + 1, rBatch);
+				return;
 			}
 
-			return tResult;
+			TaskPool::TaskGroup tSubtreePairTask;
+			rQuery.m_pTaskPool->Submit(tSubtreePairTask, [&rQuery, pFirstNode, pFirstOtherNode, iDepth]() {
+				ObjectPairBatch tTaskBatch;
+				FindOverlappingObjectPairsBetweenSubtrees(rQuery, pFirstNode, pFirstOtherNode, iDepth + 1, tTaskBatch);
+				FlushObjectPairBatch(*rQuery.m_pOutput, tTaskBatch);
+			});
+			FindOverlappingObjectPairsBetweenSubtrees(rQuery, pSecondNode, pSecondOtherNode, iDepth + 1, rBatch);
+			rQuery.m_pTaskPool->Wait(tSubtreePairTask);
 		}
 
-		BoundingSphere ConstructBoundingSphereFromVertexData_Iterative(float * pVertices, size_t uiNumberOfVertices)
+		void AddObjectPair(ObjectPairOutput & rOutput, ObjectPairBatch & rBatch, SceneObject * pObject, SceneObject * pOtherObject)
 		{
-			assert(!"not yet implemented");
-			const size_t uiNumberOfIterations = 8u;
-
-			BoundingSphere tResult;
+			if (rBatch.m_uiNumPairs == ObjectPairBatch::s_uiMaxNumPairs)
+				FlushObjectPairBatch(rOutput, rBatch);
 
-			return tResult;
+			ObjectPair& rNewPair = rBatch.m_pPairs[rBatch.m_uiNumPairs++];
+			rNewPair.m_pObject = pObject;
+			rNewPair.m_pOtherObject = pOtherObject;
 		}
 
-		BoundingSphere ConstructBoundingSphereFromVertexData(float * pVertices, size_t uiNumberOfVertices)
+		void FlushObjectPairBatch(ObjectPairOutput & rOutput, ObjectPairBatch & rBatch)
 		{
-			BoundingSphere tRitterSphere = BoundingSphereFromDistantPoints(pVertices, uiNumberOfVertices);
+			if (rBatch.m_uiNumPairs == 0u)
+				return;
 
-
-			for (size_t uiCurrentVertex = 0; uiCurrentVertex < uiNumberOfVertices; uiCurrentVertex++)
+			// a single atomic addition reserves the range of the whole batch. Pairs that do not fit anymore are only counted
+			const size_t uiFirstPair = rOutput.m_uiNumPairs.fetch_add(rBatch.m_uiNumPairs);
+			if (uiFirstPair < rOutput.m_uiMaxNumPairs)
 			{
-				glm::vec3 vec3PointToBeEncompassed(pVertices[uiCurrentVertex * 8 + 0], pVertices[uiCurrentVertex * 8 + 1], pVertices[uiCurrentVertex * 8 + 2]);
-				ConditionallyUpdateSphereToEncompassPoint(tRitterSphere, vec3PointToBeEncompassed);
+				const size_t uiNumPairsToCopy = std::min(rBatch.m_uiNumPairs, rOutput.m_uiMaxNumPairs - uiFirstPair);
+				std::copy(rBatch.m_pPairs, rBatch.m_pPairs + uiNumPairsToCopy, rOutput.m_pPairs + uiFirstPair);
 			}
 
+			rBatch.m_uiNumPairs = 0u;
+		}
 
+		//////////////////////////////////////////
+		// REGION QUERIES
+		//////////////////////////////////////////
 
-			return tRitterSphere;
-		}
+		// nodes put aside by a region query. Deep enough for any reasonably balanced hierarchy, deeper ones continue by recursion
+		const size_t s_uiRegionQueryStackSize = 64u;
 
-		BoundingSphere BoundingSphereFromDistantPoints(float * pVertices, size_t uiNumberOfVertices)
+		void FindLinearBVHSubtreeObjectsInFrustum(const LinearBVH & rBVH, uint32_t uiSubtreeRootIndex, uint32_t uiPlaneMask, const Frustum & rFrustum,
+			SceneObject ** ppObjects, size_t uiMaxNumObjects, size_t & ruiNumObjects)
 		{
-			BoundingSphere tResult;
+			assert(uiSubtreeRootIndex < rBVH.m_vecNodes.size());
 
-			MostSeperatedPointsIndices tMostSeperatedPoints = MostSeperatedPointsOnAABB(pVertices, uiNumberOfVertices);
+			// every node is put aside together with the planes its parent did not lie completely inside of
+			std::pair<uint32_t, uint32_t> pNodesToVisit[s_uiRegionQueryStackSize];
+			size_t uiNumNodesToVisit = 0u;
+			pNodesToVisit[uiNumNodesToVisit++] = std::make_pair(uiSubtreeRootIndex, uiPlaneMask);
 
-			const glm::vec3 vec3MinPoint(pVertices[tMostSeperatedPoints.m_uiMinVertexIndex * 8 + 0], pVertices[tMostSeperatedPoints.m_uiMinVertexIndex * 8 + 1], pVertices[tMostSeperatedPoints.m_uiMinVertexIndex * 8 + 2]);
-			const glm::vec3 vec3MaxPoint(pVertices[tMostSeperatedPoints.m_uiMaxVertexIndex * 8 + 0], pVertices[tMostSeperatedPoints.m_uiMaxVertexIndex * 8 + 1], pVertices[tMostSeperatedPoints.m_uiMaxVertexIndex * 8 + 2]);
+			while (uiNumNodesToVisit > 0u)
+			{
+				const uint32_t uiCurrentNodeIndex = pNodesToVisit[--uiNumNodesToVisit].first;
+				uint32_t uiCurrentPlaneMask = pNodesToVisit[uiNumNodesToVisit].second;
+				const LinearBVHNode& rCurrentNode = rBVH.m_vecNodes[uiCurrentNodeIndex];
 
-			tResult.m_vec3Center = vec3MinPoint * 0.5f + vec3MaxPoint * 0.5f;
-			tResult.m_fRadius = std::sqrtf(glm::dot(vec3MaxPoint - tResult.m_vec3Center, vec3MaxPoint - tResult.m_vec3Center));
+				// a node inside of all planes is not tested at all, and neither is anything below it
+				if (uiCurrentPlaneMask != 0u && !TestMinMaxBoxagainstFrustumPlanes(rCurrentNode.m_vec3Min, rCurrentNode.m_vec3Max, rFrustum, uiCurrentPlaneMask))
+					continue;
 
-			return tResult;
+				if (rCurrentNode.IsANode())
+				{
+					pNodesToVisit[uiNumNodesToVisit++] = std::make_pair(rCurrentNode.m_uiRightChildOrFirstObject, uiCurrentPlaneMask);
+					// with no free slot left, the left child's subtree, which would be next anyway, is culled right away
+					if (uiNumNodesToVisit == s_uiRegionQueryStackSize)
+						FindLinearBVHSubtreeObjectsInFrustum(rBVH, uiCurrentNodeIndex + 1u, uiCurrentPlaneMask, rFrustum, ppObjects, uiMaxNumObjects, ruiNumObjects);
+					else
+						pNodesToVisit[uiNumNodesToVisit++] = std::make_pair(uiCurrentNodeIndex + 1u, uiCurrentPlaneMask);	// the left child directly follows its parent
+				}
+				else // is a leaf
+				{
+					assert(rCurrentNode.m_uiRightChildOrFirstObject + rCurrentNode.m_uiNumObjects <= rBVH.m_vecObjectPermutation.size());
+					SceneObject* const* ppLeafObjects = rBVH.m_vecObjectPermutation.data() + rCurrentNode.m_uiRightChildOrFirstObject;
+
+					for (uint32_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < rCurrentNode.m_uiNumObjects; uiCurrentSceneObject++)
+					{
+						SceneObject* pCurrentSceneObject = ppLeafObjects[uiCurrentSceneObject];
+						const AABB& rCurrentAABB = pCurrentSceneObject->m_tWorldSpaceAABB;
+						uint32_t uiObjectPlaneMask = uiCurrentPlaneMask;
+						if (uiObjectPlaneMask == 0u || TestMinMaxBoxagainstFrustumPlanes(rCurrentAABB.m_vec3Center - rCurrentAABB.m_vec3Radius, rCurrentAABB.m_vec3Center + rCurrentAABB.m_vec3Radius, rFrustum, uiObjectPlaneMask))
+						{
+							// objects that do not fit anymore are only counted
+							if (ruiNumObjects < uiMaxNumObjects)
+								ppObjects[ruiNumObjects] = pCurrentSceneObject;
+							ruiNumObjects++;
+						}
+					}
+				}
+			}
 		}
 
-		void ConditionallyUpdateSphereToEncompassPoint(BoundingSphere & rSphereToBeUpdated, const glm::vec3 & rvec3PointToBeEncompassed)
+		template <typename QueryVolume>
+		bool QueryLinearBVHSubtree(const LinearBVH & rBVH, uint32_t uiSubtreeRootIndex, const QueryVolume & rQueryVolume,
+			int(*pTestMinMaxBox)(const glm::vec3&, const glm::vec3&, const QueryVolume&), ObjectQueryVisitor pVisitor, void * pUserData)
 		{
-			const glm::vec3 vec3DistanceBetweenSphereCenterAndPoint = rvec3PointToBeEncompassed - rSphereToBeUpdated.m_vec3Center;
-			const float fSquaredDistance = glm::dot(vec3DistanceBetweenSphereCenterAndPoint, vec3DistanceBetweenSphereCenterAndPoint);
+			assert(uiSubtreeRootIndex < rBVH.m_vecNodes.size());
 
-			// conditional update
-			if (fSquaredDistance > rSphereToBeUpdated.m_fRadius * rSphereToBeUpdated.m_fRadius)		// comparing squared distances because square roots are expensive
+			uint32_t pNodesToVisit[s_uiRegionQueryStackSize];
+			size_t uiNumNodesToVisit = 0u;
+			pNodesToVisit[uiNumNodesToVisit++] = uiSubtreeRootIndex;
+
+			while (uiNumNodesToVisit > 0u)
 			{
-				const float fActualDistance = std::sqrtf(fSquaredDistance);
-				const float fNewRadius = rSphereToBeUpdated.m_fRadius * 0.5f + fActualDistance * 0.5f;
-				const float fSphereCenterAdjustment = (fNewRadius - rSphereToBeUpdated.m_fRadius) / fActualDistance;
-				rSphereToBeUpdated.m_fRadius = fNewRadius;
-				rSphereToBeUpdated.m_vec3Center += vec3DistanceBetweenSphereCenterAndPoint * fSphereCenterAdjustment;
+				const uint32_t uiCurrentNodeIndex = pNodesToVisit[--uiNumNodesToVisit];
+				const LinearBVHNode& rCurrentNode = rBVH.m_vecNodes[uiCurrentNodeIndex];
+
+				if (!pTestMinMaxBox(rCurrentNode.m_vec3Min, rCurrentNode.m_vec3Max, rQueryVolume))
+					continue;
+
+				if (rCurrentNode.IsANode())
+				{
+					// with only one free slot left, the right child's subtree is queried right away
+					if (uiNumNodesToVisit + 2u > s_uiRegionQueryStackSize)
+					{
+						if (!QueryLinearBVHSubtree(rBVH, rCurrentNode.m_uiRightChildOrFirstObject, rQueryVolume, pTestMinMaxBox, pVisitor, pUserData))
+							return false;
+					}
+					else
+						pNodesToVisit[uiNumNodesToVisit++] = rCurrentNode.m_uiRightChildOrFirstObject;
+					pNodesToVisit[uiNumNodesToVisit++] = uiCurrentNodeIndex + 1u;	// the left child directly follows its parent
+				}
+				else // is a leaf
+				{
+					assert(rCurrentNode.m_uiRightChildOrFirstObject + rCurrentNode.m_uiNumObjects <= rBVH.m_vecObjectPermutation.size());
+					SceneObject* const* ppLeafObjects = rBVH.m_vecObjectPermutation.data() + rCurrentNode.m_uiRightChildOrFirstObject;
+
+					for (uint32_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < rCurrentNode.m_uiNumObjects; uiCurrentSceneObject++)
+					{
+						// the very same corners the node's box was merged from
+						const AABB& rCurrentAABB = ppLeafObjects[uiCurrentSceneObject]->m_tWorldSpaceAABB;
+						if (pTestMinMaxBox(rCurrentAABB.m_vec3Center - rCurrentAABB.m_vec3Radius, rCurrentAABB.m_vec3Center + rCurrentAABB.m_vec3Radius, rQueryVolume))
+						{
+							if (!pVisitor(ppLeafObjects[uiCurrentSceneObject], pUserData))
+								return false;
+						}
+					}
+				}
 			}
+
+			return true;
 		}
 
-		BoundingSphere UpdateBoundingSphere(const BoundingSphere & rLocalSpaceBoundingSphere, const glm::vec3 & rTranslation, const glm::vec3 & rScale)
+		template <typename QueryVolume>
+		bool QueryDynamicAABBTreeSubtree(const DynamicAABBTree & rTree, int32_t iSubtreeRootNode, SceneObject * pSceneObjects, const QueryVolume & rQueryVolume,
+			int(*pTestMinMaxBox)(const glm::vec3&, const glm::vec3&, const QueryVolume&), ObjectQueryVisitor pVisitor, void * pUserData)
 		{
-			BoundingSphere tResult;
-			tResult.m_vec3Center = rLocalSpaceBoundingSphere.m_vec3Center + rTranslation;
-
-			float fHighestScalingInAxis = rScale.x;
-			if (rScale.y > fHighestScalingInAxis)
-				fHighestScalingInAxis = rScale.y;
-			if (rScale.z > fHighestScalingInAxis)
-				fHighestScalingInAxis = rScale.z;
+			const std::vector<DynamicAABBTree::Node>& rvecNodes = rTree.GetNodes();
+			assert(iSubtreeRootNode >= 0 && static_cast<size_t>(iSubtreeRootNode) < rvecNodes.size());
 
-			tResult.m_fRadius = rLocalSpaceBoundingSphere.m_fRadius * fHighestScalingInAxis;
+			int32_t pNodesToVisit[s_uiRegionQueryStackSize];
+			size_t uiNumNodesToVisit = 0u;
+			pNodesToVisit[uiNumNodesToVisit++] = iSubtreeRootNode;
 
-			//const float fSquaredScalingDistance = glm::dot(rScale, rScale); // equivalent to: (x + y + z)
-			//const float fSquaredUnitScaling = 3.0f;							// equivalent to: (1 + 1 + 1)
+			while (uiNumNodesToVisit > 0u)
+			{
+				const DynamicAABBTree::Node& rCurrentNode = rvecNodes[pNodesToVisit[--uiNumNodesToVisit]];
 
-			//const float fSquaredRadiusScalingFactor = fSquaredScalingDistance / fSquaredUnitScaling;
-			//const float fActualRadiusScalingFactor = std::sqrtf(fSquaredRadiusScalingFactor);
+				if (!pTestMinMaxBox(rCurrentNode.m_tAABB.m_vec3Center - rCurrentNode.m_tAABB.m_vec3Radius, rCurrentNode.m_tAABB.m_vec3Center + rCurrentNode.m_tAABB.m_vec3Radius, rQueryVolume))
+					continue;
 
-			//tResult.m_fRadius = rLocalSpaceBoundingSphere.m_fRadius * fActualRadiusScalingFactor;
+				if (!rCurrentNode.IsALeaf())
+				{
+					// with only one free slot left, the right child's subtree is queried right away
+					if (uiNumNodesToVisit + 2u > s_uiRegionQueryStackSize)
+					{
+						if (!QueryDynamicAABBTreeSubtree(rTree, rCurrentNode.m_iRight, pSceneObjects, rQueryVolume, pTestMinMaxBox, pVisitor, pUserData))
+							return false;
+					}
+					else
+						pNodesToVisit[uiNumNodesToVisit++] = rCurrentNode.m_iRight;
+					pNodesToVisit[uiNumNodesToVisit++] = rCurrentNode.m_iLeft;
+				}
+				else
+				{
+					// the leaf only holds the fat AABB, the object's own AABB decides
+					SceneObject* pLeafObject = pSceneObjects + rCurrentNode.m_uiObjectIndex;
+					const AABB& rObjectAABB = pLeafObject->m_tWorldSpaceAABB;
+					if (pTestMinMaxBox(rObjectAABB.m_vec3Center - rObjectAABB.m_vec3Radius, rObjectAABB.m_vec3Center + rObjectAABB.m_vec3Radius, rQueryVolume))
+					{
+						if (!pVisitor(pLeafObject, pUserData))
+							return false;
+					}
+				}
+			}
 
-			return tResult;
+			return true;
 		}
 
-		BoundingSphere ConstructLocalSpaceBoundingSphereForCube(const SceneObject & rCurrentCube)
+		int TestMinMaxBoxagainstMinMaxBox(const glm::vec3 & rvec3Min, const glm::vec3 & rvec3Max, const MinMaxBox & rQueryBox)
 		{
-			assert(rCurrentCube.m_eType == SceneObject::eType::CUBE);
-
-			BoundingSphere tResult;
+			return (glm::all(glm::lessThanEqual(rvec3Min, rQueryBox.m_vec3Max)) && glm::all(glm::lessThanEqual(rQueryBox.m_vec3Min, rvec3Max))) ? 1 : 0;
+		}
 
-			tResult.m_vec3Center = glm::vec3(0.0f, 0.0f, 0.0f);
-			assert(std::abs(Primitives::Cube::VertexData[0]) == 50.0f); // your cheat is out of date
-			const float fSquaredDistanceToFurthestPoint = glm::dot(glm::vec3(50.0f, 50.0f, 50.0f), glm::vec3(50.0f, 50.0f, 50.0f));
-			tResult.m_fRadius = std::sqrtf(fSquaredDistanceToFurthestPoint);
+		int TestMinMaxBoxagainstBoundingSphere(const glm::vec3 & rvec3Min, const glm::vec3 & rvec3Max, const BoundingSphere & rQuerySphere)
+		{
+			// the point of the box closest to the sphere's center
+			const glm::vec3 vec3CenterToBox = glm::clamp(rQuerySphere.m_vec3Center, rvec3Min, rvec3Max) - rQuerySphere.m_vec3Center;
+			return (glm::dot(vec3CenterToBox, vec3CenterToBox) <= rQuerySphere.m_fRadius * rQuerySphere.m_fRadius) ? 1 : 0;
+		}
 
-			return tResult;
+		int TestMinMaxBoxagainstPoint(const glm::vec3 & rvec3Min, const glm::vec3 & rvec3Max, const glm::vec3 & rvec3QueryPoint)
+		{
+			return (glm::all(glm::lessThanEqual(rvec3Min, rvec3QueryPoint)) && glm::all(glm::lessThanEqual(rvec3QueryPoint, rvec3Max))) ? 1 : 0;
 		}
 
-		BoundingSphere ConstructLocalSpaceBoundingSphereForSphere(const SceneObject & rCurrentSphere)
+		bool AddObjectToQueryOutput(SceneObject * pObject, void * pUserData)
 		{
-			assert(rCurrentSphere.m_eType == SceneObject::eType::SPHERE);
-			BoundingSphere tResult;
+			ObjectQueryOutput& rOutput = *static_cast<ObjectQueryOutput*>(pUserData);
 
-			tResult.m_vec3Center = glm::vec3(0.0f, 0.0f, 0.0f);
-			tResult.m_fRadius = Primitives::Sphere::SphereDefaultRadius;
+			// objects that do not fit anymore are only counted
+			if (rOutput.m_uiNumObjects < rOutput.m_uiMaxNumObjects)
+				rOutput.m_ppObjects[rOutput.m_uiNumObjects] = pObject;
+			rOutput.m_uiNumObjects++;
 
+			return true;
+		}
+
+		MinMaxBox CreateMinMaxBox(const AABB & rAABB)
+		{
+			MinMaxBox tResult;
+			tResult.m_vec3Min = rAABB.m_vec3Center - rAABB.m_vec3Radius;
+			tResult.m_vec3Max = rAABB.m_vec3Center + rAABB.m_vec3Radius;
 			return tResult;
 		}
 
 		//////////////////////////////////////////
-		// BOUNDING VOLUME HIERARCHY
+		// NEAREST OBJECTS
 		//////////////////////////////////////////
 
-		
+		template <typename BoundingVolume>
+		size_t FindNearestObjectsInBVH(const BoundingVolumeHierarchy & rBVH, const glm::vec3 & rvec3Point, size_t uiMaxNumObjects, float fMaxDistance,
+			BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			float(*pCalcDistance)(const glm::vec3&, const BoundingVolume&), NearestObject * pNearestObjects)
+		{
+			assert(pNearestObjects || uiMaxNumObjects == 0u);
+			assert(fMaxDistance >= 0.0f);
 
-		//////////////////////////////////////////
-		// RAY CASTING
-		//////////////////////////////////////////
+			if (rBVH.m_pRootNode == nullptr || uiMaxNumObjects == 0u)
+				return 0u;
+
+			// the found objects form a max heap, the farthest of them on top. It is the first to go once a nearer object is found
+			size_t uiNumNearestObjects = 0u;
+			const auto IsNearer = [](const NearestObject& rFirst, const NearestObject& rSecond) { return rFirst.m_fDistance < rSecond.m_fDistance; };
+			// while the heap is not full yet, anything within the maximum distance qualifies. Once it is full, only what is nearer than its top
+			float fSearchDistance = fMaxDistance;
+
+			const float fRootDistance = pCalcDistance(rvec3Point, rBVH.m_pRootNode->*pNodeBoundingVolume);
+			FindNearestObjectsInBVHSubtree(rBVH, rBVH.m_pRootNode, fRootDistance, rvec3Point, uiMaxNumObjects, pNodeBoundingVolume, pObjectBoundingVolume, pCalcDistance,
+				pNearestObjects, uiNumNearestObjects, fSearchDistance);
+
+			std::sort_heap(pNearestObjects, pNearestObjects + uiNumNearestObjects, IsNearer);
+			return uiNumNearestObjects;
+		}
 
-		RayCastIntersectionResult RecursiveRayCastIntoBVHTree(const BVHTreeNode * pNode, const Ray & rCastedRay)
+		template <typename BoundingVolume>
+		void FindNearestObjectsInBVHSubtree(const BoundingVolumeHierarchy & rBVH, const BVHTreeNode * pSubtreeRootNode, float fSubtreeRootDistance, const glm::vec3 & rvec3Point, size_t uiMaxNumObjects,
+			BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			float(*pCalcDistance)(const glm::vec3&, const BoundingVolume&), NearestObject * pNearestObjects, size_t & ruiNumNearestObjects, float & rfSearchDistance)
 		{
-			assert(pNode);
+			const auto IsNearer = [](const NearestObject& rFirst, const NearestObject& rSecond) { return rFirst.m_fDistance < rSecond.m_fDistance; };
+			const auto IsWithinSearchDistance = [&](float fDistance) {
+				return (ruiNumNearestObjects < uiMaxNumObjects) ? (fDistance <= rfSearchDistance) : (fDistance < rfSearchDistance);
+			};
 
-			RayCastIntersectionResult tResultForNodeAndAllItsChilren;
+			// the nodes left to visit form a min heap, the nearest of them on top
+			typedef std::pair<float, const BVHTreeNode*> NodeToVisit;
+			const auto IsFarther = [](const NodeToVisit& rFirst, const NodeToVisit& rSecond) { return rFirst.first > rSecond.first; };
+			NodeToVisit pNodesToVisit[s_uiNearestObjectsHeapSize];
+			size_t uiNumNodesToVisit = 0u;
+			pNodesToVisit[uiNumNodesToVisit++] = NodeToVisit(fSubtreeRootDistance, pSubtreeRootNode);
 
-			if (pNode->IsANode())
+			while (uiNumNodesToVisit > 0u)
 			{
-				float fIntersectionDistanceMin;
-				glm::vec3 vec3PointOfIntersection;
-				if (IntersectRayAABB(rCastedRay, pNode->m_tAABBForNode, fIntersectionDistanceMin, vec3PointOfIntersection))
-				{
+				std::pop_heap(pNodesToVisit, pNodesToVisit + uiNumNodesToVisit, IsFarther);
+				const NodeToVisit tCurrentNode = pNodesToVisit[--uiNumNodesToVisit];
 
-					if (pNode->m_pLeft)
+				// the search distance may have shrunk since the node was put aside. All nodes left are at least as far away
+				if (!IsWithinSearchDistance(tCurrentNode.first))
+					break;
+
+				const BVHTreeNode* pCurrentNode = tCurrentNode.second;
+				if (pCurrentNode->IsANode())
+				{
+					for (const BVHTreeNode* pChild : { pCurrentNode->m_pLeft, pCurrentNode->m_pRight })
 					{
-						RayCastIntersectionResult tResultLeftChild = RecursiveRayCastIntoBVHTree(pNode->m_pLeft, rCastedRay);
-						//if (tResultLeftChild.m_fIntersectionDistance < tResultForNodeAndAllItsChilren.m_fIntersectionDistance) // this would always be true, because default intersection distance is FLT_MAX
-						tResultForNodeAndAllItsChilren = tResultLeftChild;
+						const float fChildDistance = pCalcDistance(rvec3Point, pChild->*pNodeBoundingVolume);
+						if (!IsWithinSearchDistance(fChildDistance))
+							continue;
+
+						// with the heap full, the child's subtree is searched right away. That only narrows the search distance for the nodes left
+						if (uiNumNodesToVisit == s_uiNearestObjectsHeapSize)
+						{
+							FindNearestObjectsInBVHSubtree(rBVH, pChild, fChildDistance, rvec3Point, uiMaxNumObjects, pNodeBoundingVolume, pObjectBoundingVolume, pCalcDistance,
+								pNearestObjects, ruiNumNearestObjects, rfSearchDistance);
+							continue;
+						}
+						pNodesToVisit[uiNumNodesToVisit++] = NodeToVisit(fChildDistance, pChild);
+						std::push_heap(pNodesToVisit, pNodesToVisit + uiNumNodesToVisit, IsFarther);
 					}
+				}
+				else // is a leaf
+				{
+					assert(pCurrentNode->m_uiFirstObject + pCurrentNode->m_uiNumOjbects <= rBVH.m_vecObjectPermutation.size());
+					SceneObject* const* ppLeafObjects = rBVH.m_vecObjectPermutation.data() + pCurrentNode->m_uiFirstObject;
 
-					if (pNode->m_pRight)
+					for (uint32_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < pCurrentNode->m_uiNumOjbects; uiCurrentSceneObject++)
 					{
-						RayCastIntersectionResult tResultRightchild = RecursiveRayCastIntoBVHTree(pNode->m_pRight, rCastedRay);
-						if (tResultRightchild.m_fIntersectionDistance < tResultForNodeAndAllItsChilren.m_fIntersectionDistance)
-							tResultForNodeAndAllItsChilren = tResultRightchild;
+						const float fObjectDistance = pCalcDistance(rvec3Point, ppLeafObjects[uiCurrentSceneObject]->*pObjectBoundingVolume);
+						if (!IsWithinSearchDistance(fObjectDistance))
+							continue;
+
+						if (ruiNumNearestObjects == uiMaxNumObjects)
+						{
+							// the farthest object makes room
+							std::pop_heap(pNearestObjects, pNearestObjects + ruiNumNearestObjects, IsNearer);
+							ruiNumNearestObjects--;
+						}
+						pNearestObjects[ruiNumNearestObjects].m_pObject = ppLeafObjects[uiCurrentSceneObject];
+						pNearestObjects[ruiNumNearestObjects].m_fDistance = fObjectDistance;
+						ruiNumNearestObjects++;
+						std::push_heap(pNearestObjects, pNearestObjects + ruiNumNearestObjects, IsNearer);
+
+						if (ruiNumNearestObjects == uiMaxNumObjects)
+							rfSearchDistance = pNearestObjects[0].m_fDistance;
 					}
 				}
 			}
-			else // is a leaf
+		}
+
+		float CalcDistancePointAABB(const glm::vec3 & rvec3Point, const AABB & rAABB)
+		{
+			const glm::vec3 vec3DistanceOutside = glm::max(glm::abs(rvec3Point - rAABB.m_vec3Center) - rAABB.m_vec3Radius, glm::vec3(0.0f));
+			return glm::length(vec3DistanceOutside);
+		}
+
+		float CalcDistancePointBoundingSphere(const glm::vec3 & rvec3Point, const BoundingSphere & rBoundingSphere)
+		{
+			return std::max(glm::length(rvec3Point - rBoundingSphere.m_vec3Center) - rBoundingSphere.m_fRadius, 0.0f);
+		}
+
+		//////////////////////////////////////////
+		// SWEPT VOLUMES
+		//////////////////////////////////////////
+
+		template <typename BoundingVolume>
+		TimeOfImpactResult CastSweptVolumeIntoBVH(const BoundingVolumeHierarchy & rBVH, const BoundingVolume & rMovingBoundingVolume, const glm::vec3 & rvec3Displacement,
+			const SceneObject * pIgnoredObject, BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			bool(*pCalcTimeOfImpact)(const BoundingVolume&, const glm::vec3&, const BoundingVolume&, float&))
+		{
+			TimeOfImpactResult tResult;
+
+			if (rBVH.m_pRootNode == nullptr)
+				return tResult;
+
+			float fRootTimeOfImpact;
+			if (pCalcTimeOfImpact(rMovingBoundingVolume, rvec3Displacement, rBVH.m_pRootNode->*pNodeBoundingVolume, fRootTimeOfImpact))
+				CastSweptVolumeIntoBVHSubtree(rBVH, rBVH.m_pRootNode, fRootTimeOfImpact, rMovingBoundingVolume, rvec3Displacement, pIgnoredObject, pNodeBoundingVolume, pObjectBoundingVolume, pCalcTimeOfImpact, tResult);
+
+			return tResult;
+		}
+
+		template <typename BoundingVolume>
+		void CastSweptVolumeIntoBVHSubtree(const BoundingVolumeHierarchy & rBVH, const BVHTreeNode * pSubtreeRootNode, float fSubtreeRootTimeOfImpact, const BoundingVolume & rMovingBoundingVolume,
+			const glm::vec3 & rvec3Displacement, const SceneObject * pIgnoredObject, BoundingVolume BVHTreeNode::* pNodeBoundingVolume, BoundingVolume SceneObject::* pObjectBoundingVolume,
+			bool(*pCalcTimeOfImpact)(const BoundingVolume&, const glm::vec3&, const BoundingVolume&, float&), TimeOfImpactResult & rResult)
+		{
+			// the nodes left to visit form a min heap, the one hit first on top
+			typedef std::pair<float, const BVHTreeNode*> NodeToVisit;
+			const auto IsHitLater = [](const NodeToVisit& rFirst, const NodeToVisit& rSecond) { return rFirst.first > rSecond.first; };
+			NodeToVisit pNodesToVisit[s_uiSweptVolumeHeapSize];
+			size_t uiNumNodesToVisit = 0u;
+			pNodesToVisit[uiNumNodesToVisit++] = NodeToVisit(fSubtreeRootTimeOfImpact, pSubtreeRootNode);
+
+			while (uiNumNodesToVisit > 0u)
 			{
-				assert(pNode->m_uiNumOjbects > 0u);
-				assert(pNode->m_pObjects);
+				std::pop_heap(pNodesToVisit, pNodesToVisit + uiNumNodesToVisit, IsHitLater);
+				const NodeToVisit tCurrentNode = pNodesToVisit[--uiNumNodesToVisit];
 
-				/*
-					Checking every object in the current leaf.
-					This is needed because:
-					1: There could be more that one object in the leaf
-					2: The first object to be tested might not be the closest to the ray origin, i.e. the first object hit by the ray
-				*/
-				for (uint8_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < pNode->m_uiNumOjbects; uiCurrentSceneObject++)
+				// every node left is hit at the same time or later, so none of its objects can be hit earlier than the best hit
+				if (tCurrentNode.first >= rResult.m_fTimeOfImpact)
+					break;
+
+				const BVHTreeNode* pCurrentNode = tCurrentNode.second;
+				if (pCurrentNode->IsANode())
 				{
-					float fIntersectionDistanceForCurrentAABB;
-					glm::vec3 vec3CurrentIntersectionPoint;
-					if (IntersectRayAABB(rCastedRay, pNode->m_pObjects[uiCurrentSceneObject].m_tWorldSpaceAABB, fIntersectionDistanceForCurrentAABB, vec3CurrentIntersectionPoint))
+					for (const BVHTreeNode* pChild : { pCurrentNode->m_pLeft, pCurrentNode->m_pRight })
 					{
-						// if an intersection occured with the current object's AABB...
-						// ... and the distance to the intersection point is shorter than the previously shortest intersection distance
-						if (fIntersectionDistanceForCurrentAABB < tResultForNodeAndAllItsChilren.m_fIntersectionDistance)
+						float fChildTimeOfImpact;
+						if (!pCalcTimeOfImpact(rMovingBoundingVolume, rvec3Displacement, pChild->*pNodeBoundingVolume, fChildTimeOfImpact) || fChildTimeOfImpact >= rResult.m_fTimeOfImpact)
+							continue;
+
+						// with the heap full, the child's subtree is searched right away. That only brings the best hit forward for the nodes left
+						if (uiNumNodesToVisit == s_uiSweptVolumeHeapSize)
 						{
-							// we update the current results
-							tResultForNodeAndAllItsChilren.m_fIntersectionDistance = fIntersectionDistanceForCurrentAABB;
-							tResultForNodeAndAllItsChilren.m_vec3PointOfIntersection = vec3CurrentIntersectionPoint;
-							tResultForNodeAndAllItsChilren.m_pFirstIntersectedSceneObject = pNode->m_pObjects + uiCurrentSceneObject;
+							CastSweptVolumeIntoBVHSubtree(rBVH, pChild, fChildTimeOfImpact, rMovingBoundingVolume, rvec3Displacement, pIgnoredObject, pNodeBoundingVolume, pObjectBoundingVolume, pCalcTimeOfImpact, rResult);
+							continue;
 						}
+						pNodesToVisit[uiNumNodesToVisit++] = NodeToVisit(fChildTimeOfImpact, pChild);
+						std::push_heap(pNodesToVisit, pNodesToVisit + uiNumNodesToVisit, IsHitLater);
 					}
 				}
+				else // is a leaf
+				{
+					assert(pCurrentNode->m_uiFirstObject + pCurrentNode->m_uiNumOjbects <= rBVH.m_vecObjectPermutation.size());
+					SceneObject* const* ppLeafObjects = rBVH.m_vecObjectPermutation.data() + pCurrentNode->m_uiFirstObject;
 
-				// if, at the end of all intersection tests, no object AABB was hit, the result is still defaulted (which means its intersection distance = FLT_MAX)
-			}
+					for (uint32_t uiCurrentSceneObject = 0u; uiCurrentSceneObject < pCurrentNode->m_uiNumOjbects; uiCurrentSceneObject++)
+					{
+						SceneObject* pCurrentSceneObject = ppLeafObjects[uiCurrentSceneObject];
+						if (pCurrentSceneObject == pIgnoredObject)
+							continue;
 
-			return tResultForNodeAndAllItsChilren;
+						float fObjectTimeOfImpact;
+						if (pCalcTimeOfImpact(rMovingBoundingVolume, rvec3Displacement, pCurrentSceneObject->*pObjectBoundingVolume, fObjectTimeOfImpact) && fObjectTimeOfImpact < rResult.m_fTimeOfImpact)
+						{
+							rResult.m_pFirstHitSceneObject = pCurrentSceneObject;
+							rResult.m_fTimeOfImpact = fObjectTimeOfImpact;
+						}
+					}
+				}
+			}
 		}
 
-		int IntersectRayAABB(const Ray & rIntersectingRay, const AABB& rAABB, float & rfIntersectionDistanceMin, glm::vec3& rvec3IntersectionPoint)
+		bool CalcTimeOfImpactAABBagainstAABB(const AABB & rMovingAABB, const glm::vec3 & rvec3Displacement, const AABB & rAABB, float & rfTimeOfImpact)
 		{
-			// assert that the direction vector of the ray is normalized. relevant for: see end of function
-			assert(rIntersectingRay.m_vec3Direction.length() == glm::normalize(rIntersectingRay.m_vec3Direction).length());
-
-			rfIntersectionDistanceMin = std::numeric_limits<float>::lowest();
-			//rfIntersectionDistanceMin = 0.0f;
-			float fIntersectionDistanceMax = std::numeric_limits<float>::max();
+			float fEntry = 0.0f;
+			float fExit = 1.0f;
 
-			// for all three slabs of the given AABB
-			for (int iCurrentSlab = 0u; iCurrentSlab < 3u; iCurrentSlab++)
+			for (int iAxis = 0; iAxis < 3; iAxis++)
 			{
-				if (std::abs(rIntersectingRay.m_vec3Direction[iCurrentSlab]) < std::numeric_limits<float>::epsilon()) // this tests if the ray is parallel to the current slab
-				{
-					if (rIntersectingRay.m_vec3Origin[iCurrentSlab] < rAABB.CalcMinimumForAxis(iCurrentSlab) || rIntersectingRay.m_vec3Origin[iCurrentSlab] > rAABB.CalcMaximumForAxis(iCurrentSlab))
-						return 0; // exit if ray origin is not witin slab -> no chance of intersection
-				}
-				else
+				const float fRadiusSum = rMovingAABB.m_vec3Radius[iAxis] + rAABB.m_vec3Radius[iAxis];
+				const float fSlabMin = rAABB.m_vec3Center[iAxis] - fRadiusSum;
+				const float fSlabMax = rAABB.m_vec3Center[iAxis] + fRadiusSum;
+				const float fStart = rMovingAABB.m_vec3Center[iAxis];
+
+				if (rvec3Displacement[iAxis] == 0.0f)
 				{
-					const float fPredivisonFactor = 1.0f / rIntersectingRay.m_vec3Direction[iCurrentSlab];
-					float fIntersectionDistance1 = (rAABB.CalcMinimumForAxis(iCurrentSlab) - rIntersectingRay.m_vec3Origin[iCurrentSlab]) * fPredivisonFactor;
-					float fIntersectionDistance2 = (rAABB.CalcMaximumForAxis(iCurrentSlab) - rIntersectingRay.m_vec3Origin[iCurrentSlab]) * fPredivisonFactor;
-					// make sure intersection distance 1 is the intersection distance with the near plane of the current slab
-					if (fIntersectionDistance1 > fIntersectionDistance2)
-						std::swap(fIntersectionDistance1, fIntersectionDistance2);
-					// Compute the intersection of slab intersection intervals
-					if (fIntersectionDistance1 > rfIntersectionDistanceMin) rfIntersectionDistanceMin = fIntersectionDistance1;
-					if (fIntersectionDistance2 < fIntersectionDistanceMax) fIntersectionDistanceMax = fIntersectionDistance2;
-					// Exit with no collision as soon as slab intersection becomes empty
-					if (rfIntersectionDistanceMin > fIntersectionDistanceMax)
-						return 0;
+					// not moving along this axis: has to overlap on it all the time
+					if (fStart < fSlabMin || fStart > fSlabMax)
+						return false;
+					continue;
 				}
+
+				const float fInverseDisplacement = 1.0f / rvec3Displacement[iAxis];
+				float fSlabEntry = (fSlabMin - fStart) * fInverseDisplacement;
+				float fSlabExit = (fSlabMax - fStart) * fInverseDisplacement;
+				if (fSlabEntry > fSlabExit)
+					std::swap(fSlabEntry, fSlabExit);
+
+				fEntry = std::max(fEntry, fSlabEntry);
+				fExit = std::min(fExit, fSlabExit);
+				if (fEntry > fExit)
+					return false;
 			}
 
-			// Ray intersects all 3 slabs
-			rvec3IntersectionPoint = rIntersectingRay.m_vec3Origin + rIntersectingRay.m_vec3Direction * rfIntersectionDistanceMin;
-			return 1;
+			rfTimeOfImpact = fEntry;
+			return true;
+		}
+
+		bool CalcTimeOfImpactBoundingSphereagainstBoundingSphere(const BoundingSphere & rMovingBoundingSphere, const glm::vec3 & rvec3Displacement, const BoundingSphere & rBoundingSphere, float & rfTimeOfImpact)
+		{
+			// solves |vec3CenterToCenter + t * displacement| = fRadiusSum for the smaller t
+			const glm::vec3 vec3CenterToCenter = rMovingBoundingSphere.m_vec3Center - rBoundingSphere.m_vec3Center;
+			const float fRadiusSum = rMovingBoundingSphere.m_fRadius + rBoundingSphere.m_fRadius;
+
+			const float fC = glm::dot(vec3CenterToCenter, vec3CenterToCenter) - fRadiusSum * fRadiusSum;
+			if (fC <= 0.0f)
+			{
+				// overlapping from the start
+				rfTimeOfImpact = 0.0f;
+				return true;
+			}
+
+			const float fB = glm::dot(vec3CenterToCenter, rvec3Displacement);
+			if (fB >= 0.0f)
+				return false;	// moving away from each other, or not at all
+
+			const float fA = glm::dot(rvec3Displacement, rvec3Displacement);
+			const float fDiscriminant = fB * fB - fA * fC;
+			if (fDiscriminant < 0.0f)
+				return false;	// passing by
+
+			const float fTimeOfImpact = (-fB - std::sqrt(fDiscriminant)) / fA;
+			if (fTimeOfImpact > 1.0f)
+				return false;
+
+			rfTimeOfImpact = fTimeOfImpact;
+			return true;
 		}
 	}
 }
\ No newline at end of file
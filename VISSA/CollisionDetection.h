@@ -3,10 +3,14 @@
 #include "glm/glm.hpp"
 
 #include <vector>
+#include <memory>
+#include <unordered_set>
+#include <unordered_map>
 
 class Visualization;
 struct SceneObject;
 class Scene;
+class TaskPool;
 
 
 namespace CollisionDetection {
@@ -23,6 +27,8 @@ namespace CollisionDetection {
 
 		float CalcMinimumForAxis(size_t uiAxisIndex) const;
 		float CalcMaximumForAxis(size_t uiAxisIndex) const;
+
+		float CalcSurfaceArea() const;
 	};
 
 	struct BoundingSphere {
@@ -35,19 +41,22 @@ namespace CollisionDetection {
 		float CalcMaximumX() const;
 		float CalcMaximumY() const;
 		float CalcMaximumZ() const;
+
+		float CalcSurfaceArea() const;
 	};
 
+	/*
+		A ray also carries the reciprocals and signs of its direction, so testing it against any number of boxes needs no divisions.
+		Only the constructor taking origin and direction sets them up, the direction must not be changed afterwards.
+	*/
 	struct Ray {
 		Ray() {};
-		Ray(const glm::vec3& vec3Origin, const glm::vec3& vec3Direction) : // references to avoid unnecessary copies
-			m_vec3Origin(vec3Origin),
-			m_vec3Direction(vec3Direction)
-		{
-
-		};
+		Ray(const glm::vec3& vec3Origin, const glm::vec3& vec3Direction); // references to avoid unnecessary copies
 
 		glm::vec3 m_vec3Origin;
 		glm::vec3 m_vec3Direction;
+		glm::vec3 m_vec3InverseDirection;	// +-infinity for components that are practically 0
+		bool m_pIsDirectionNegative[3];		// per axis, picks the plane of a box the ray enters it through
 	};
 
 	struct RayCastIntersectionResult {
@@ -58,18 +67,62 @@ namespace CollisionDetection {
 		bool IntersectionWithObjectOccured() const { return m_pFirstIntersectedSceneObject; }
 	};	
 
+	/*
+		Compact stand-in for a scene object during top down construction.
+		Partitioning shuffles these instead of whole SceneObjects, so the scene's objects are never reordered.
+	*/
+	struct ObjectReference {
+		glm::vec3 m_vec3Centroid;		// center of the object's world space AABB
+		uint32_t m_uiObjectIndex;		// index of the referenced object in the array the references were created from
+	};
+
 	void ConstructBoundingVolumesForScene(Scene & rScene);
 	void UpdateBoundingVolumesForScene(Scene& rScene);
+	/*
+		Updates the world space bounding volumes of a single object after its transform changed
+	*/
+	void UpdateBoundingVolumesForObject(SceneObject& rSceneObject);
+	/*
+		Same as UpdateBoundingVolumesForObject, also enclosing the object's motion from its previous transform to its current one
+		in its swept world space AABB. rPreviousWorldSpaceAABB is its world space AABB before the transform changed.
+		Only the AABBs at both ends are merged, rotations in between are not followed. UpdateBoundingVolumesForObject resets the swept AABB
+		to the current world space AABB, so objects that stopped moving do not keep their last motion.
+	*/
+	void UpdateSweptBoundingVolumesForObject(SceneObject& rSceneObject, const AABB& rPreviousWorldSpaceAABB);
+	/*
+		Constructs the local space bounding volumes of a single object, e.g. one that was just added to the scene
+	*/
+	void ConstructBoundingVolumesForObject(SceneObject& rSceneObject);
 	int StaticTestAABBagainstAABB(const AABB& rAABB, const AABB& rOtherAABB);
-	AABB CreateAABBForMultipleObjects(const SceneObject * pSceneObjects, size_t uiNumSceneObjects);
+	int StaticTestBoundingSphereagainstBoundingSphere(const BoundingSphere& rBoundingSphere, const BoundingSphere& rOtherBoundingSphere);
+
+	/*
+		The six planes bounding what a camera sees, with normals pointing inwards: points p with dot(xyz, p) + w >= 0 lie on the inner side of a plane
+	*/
+	struct Frustum {
+		glm::vec4 m_pPlanes[6];		// left, right, bottom, top, near, far
+	};
+	/*
+		Extracts the normalized frustum planes from a combined projection * camera matrix, for OpenGL's clip space
+	*/
+	Frustum CreateFrustum(const glm::mat4& rProjectionCamera);
+	/*
+		0 if the AABB lies completely on the outer side of one of the planes. Conservative: AABBs close to the frustum's edges
+		may not be rejected although they lie outside of it
+	*/
+	int StaticTestAABBagainstFrustum(const AABB& rAABB, const Frustum& rFrustum);
+	/*
+		Creates the AABB enclosing all objects referenced by the given object references
+	*/
+	AABB CreateAABBForMultipleObjects(const SceneObject * pSceneObjects, const ObjectReference* pObjectReferences, size_t uiNumObjectReferences);
 	/*
 		TODO: DOC
 	*/
 	AABB MergeTwoAABBs(const AABB& rAABB1, const AABB& rAABB2);
 	/*
-		TODO: DOC
+		Creates a Bounding Sphere enclosing all objects referenced by the given object references. Requires at least 2 references.
 	*/
-	BoundingSphere CreateBoundingSphereForMultipleObjects(const SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+	BoundingSphere CreateBoundingSphereForMultipleObjects(const SceneObject* pSceneObjects, const ObjectReference* pObjectReferences, size_t uiNumObjectReferences);
 	/*
 		TODO: DOC
 	*/
@@ -84,32 +137,253 @@ namespace CollisionDetection {
 		BoundingSphere m_tBoundingSphereForNode;
 		BVHTreeNode* m_pLeft = nullptr;
 		BVHTreeNode* m_pRight = nullptr;
-		SceneObject* m_pObjects = nullptr;
-		uint8_t m_uiNumOjbects = 0u;
+		BVHTreeNode* m_pParent = nullptr;	// only linked once the hierarchy is prepared for refitting
+		uint32_t m_uiFirstObject = 0u;	// leaves only: index of the leaf's first object in the hierarchy's object permutation
+		uint32_t m_uiNumOjbects = 0u;	// 0 for nodes
 
 		bool IsANode() const {
-			return m_pObjects == nullptr;
+			return m_uiNumOjbects == 0u;
 		}
 	};
 
-	struct BoundingVolumeHierarchy {			// todo: turn this into a class with a destructor that ensures deletion of tree
+	/*
+		Bump allocator for BVHTreeNodes. Nodes are handed out from blocks that are never moved, so their addresses never change.
+		Resetting only rewinds the allocator: the blocks are kept, so rebuilding a tree of similar size allocates no memory at all.
+		Nodes are never freed individually.
+	*/
+	struct BVHTreeNodeArena {
+		BVHTreeNode* AllocateNode();
+		BVHTreeNode* AllocateNodes(size_t uiNumNodes);	// the nodes are contiguous in memory
+		void Reset();
+
+		size_t GetNumAllocatedNodes() const { return m_uiNumAllocatedNodes; }
+		size_t GetPeakNumAllocatedNodes() const { return m_uiPeakNumAllocatedNodes; }
+		size_t GetNumReservedBytes() const;
+	private:
+		static constexpr size_t s_uiMinNumNodesPerBlock = 256u;
+
+		struct Block {
+			std::unique_ptr<BVHTreeNode[]> m_pNodes;
+			size_t m_uiNumNodes = 0u;
+		};
+
+		std::vector<Block> m_vecBlocks;
+		size_t m_uiCurrentBlock = 0u;
+		size_t m_uiNumUsedNodesInCurrentBlock = 0u;
+		size_t m_uiNumAllocatedNodes = 0u;
+		size_t m_uiPeakNumAllocatedNodes = 0u;
+	};
+
+	struct BoundingVolumeHierarchy {
 		BVHTreeNode* m_pRootNode = nullptr;
+		std::vector<SceneObject*> m_vecObjectPermutation;	// the scene's objects in leaf order. Every leaf references a contiguous range of it
 		int16_t m_iTDeepestDepthOfNodes = 0;
+		std::vector<BVHTreeNode*> m_vecLeafOfObject;		// index = index of the object in the scene. Filled when preparing the hierarchy for refitting
+		float m_fNodeSurfaceAreaAfterConstruction = 0.0f;	// summed surface area of all nodes' bounding volumes, leaves excluded
+		float m_fNodeSurfaceArea = 0.0f;					// same, kept up to date while refitting
+
+		BVHTreeNode* AllocateNode();	// nodes are owned by the hierarchy and live until the tree is deleted
+		BVHTreeNode* AllocateNodes(size_t uiNumNodes);
+		void DeleteTree();				// O(1), the node memory is kept for the next construction
+
+		size_t GetNumNodes() const { return m_tNodeArena.GetNumAllocatedNodes(); }
+		size_t GetPeakNumNodes() const { return m_tNodeArena.GetPeakNumAllocatedNodes(); }
+		size_t GetNumReservedBytes() const { return m_tNodeArena.GetNumReservedBytes(); }
 
-		void DeleteTree();
+		/*
+			How much larger the nodes' bounding volumes have grown through refitting, relative to the freshly constructed tree.
+			1 means no degradation at all.
+		*/
+		float CalcRefitDegradation() const;
 	private:
-		
-		void RecursiveDeleteTree(BVHTreeNode* pNode);
+		BVHTreeNodeArena m_tNodeArena;
 	};
 
 	/*
-		TODO: DOC
+		Node of a LinearBVH, exactly 32 bytes, so two of them share a cache line.
+		Nodes are stored in depth first order: the left child of a node always directly follows it, only the right child's index is stored.
 	*/
-	size_t PartitionSceneObjectsInPlace_AABB(SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+	struct LinearBVHNode {
+		glm::vec3 m_vec3Min;
+		uint32_t m_uiRightChildOrFirstObject;	// nodes: index of the right child. leaves: index of the first object in the object permutation
+		glm::vec3 m_vec3Max;
+		uint32_t m_uiNumObjects = 0u;			// 0 for nodes
+
+		bool IsANode() const {
+			return m_uiNumObjects == 0u;
+		}
+	};
+	static_assert(sizeof(LinearBVHNode) == 32u, "LinearBVHNode is meant to be exactly 32 bytes");
+
 	/*
-		TODO: DOC
+		Pointer free, flattened version of a BoundingVolumeHierarchy: one contiguous array of AABB nodes, no matter which bounding volume
+		the original hierarchy was built with. Meant for ray casts and other queries, not for visualizing construction.
+	*/
+	struct LinearBVH {
+		std::vector<LinearBVHNode> m_vecNodes;				// depth first order, root at index 0
+		std::vector<SceneObject*> m_vecObjectPermutation;	// the scene's objects in leaf order. Every leaf references a contiguous range of it
+	};
+
+	/*
+		Flattens the given hierarchy into a LinearBVH. Node AABBs are computed bottom up from the leaves' objects,
+		so this works for Bounding Sphere hierarchies as well.
+	*/
+	LinearBVH CreateLinearBVH(const BoundingVolumeHierarchy& rBVH);
+
+	/*
+		Node of a WideBVH with up to uiWidth children. The children's AABBs are stored as structure of arrays,
+		so a single sequence of SIMD instructions tests a ray against all of them at once.
 	*/
-	size_t PartitionSceneObjectsInPlace_BoundingSphere(SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+	template <size_t uiWidth>
+	struct WideBVHNode {
+		float m_pChildMinX[uiWidth];
+		float m_pChildMinY[uiWidth];
+		float m_pChildMinZ[uiWidth];
+		float m_pChildMaxX[uiWidth];
+		float m_pChildMaxY[uiWidth];
+		float m_pChildMaxZ[uiWidth];
+		uint32_t m_pChildNodeOrFirstObject[uiWidth];	// child nodes: index of the child. child leaves: index of the first object in the object permutation
+		uint32_t m_pChildNumObjects[uiWidth];			// 0 for child nodes
+		uint32_t m_uiNumChildren = 0u;					// the children occupy the first slots, the remaining slots are never tested
+	};
+
+	/*
+		A binary hierarchy collapsed into a uiWidth-ary one: every node adopts the children of its children until it has uiWidth of them.
+		Like LinearBVH, it only holds AABBs and is meant for ray casts, no matter which bounding volume the original hierarchy was built with.
+	*/
+	template <size_t uiWidth>
+	struct WideBVH {
+		std::vector<WideBVHNode<uiWidth>> m_vecNodes;		// root at index 0. Even a hierarchy that is a single leaf gets a root node
+		std::vector<SceneObject*> m_vecObjectPermutation;	// the scene's objects in leaf order. Every leaf references a contiguous range of it
+	};
+	typedef WideBVH<4> BVH4;	// tested with SSE
+	typedef WideBVH<8> BVH8;	// tested with AVX if the build targets it, with two SSE halves otherwise
+
+	/*
+		Collapses the given hierarchy into a 4-wide BVH. Of all children that could still be opened, the one with the largest surface area is opened first.
+	*/
+	BVH4 CreateBVH4(const BoundingVolumeHierarchy& rBVH);
+	/*
+		Same as CreateBVH4, collapsing into an 8-wide BVH
+	*/
+	BVH8 CreateBVH8(const BoundingVolumeHierarchy& rBVH);
+
+	/*
+		Node of a KDTree, exactly 16 bytes. Nodes split space at an axis aligned plane instead of partitioning objects.
+		Nodes are stored in depth first order: the child below the plane always directly follows its parent, only the index of the child above is stored.
+	*/
+	struct KDTreeNode {
+		float m_fSplitPosition;					// nodes: coordinate of the splitting plane on m_uiSplitAxis
+		uint32_t m_uiAboveChildOrFirstObject;	// nodes: index of the child above the plane. leaves: index of the first object in the tree's object references
+		uint32_t m_uiNumObjects;				// leaves: number of objects overlapping the leaf, may be 0
+		uint32_t m_uiSplitAxis;					// 0, 1 or 2 for nodes, 3 for leaves
+
+		bool IsALeaf() const {
+			return m_uiSplitAxis == 3u;
+		}
+	};
+	static_assert(sizeof(KDTreeNode) == 16u, "KDTreeNode is meant to be exactly 16 bytes");
+
+	/*
+		Spatial subdivision of the scene's object AABBs. Unlike the hierarchies above, the cells of a k-d tree never overlap, so a ray visits them
+		strictly front to back and can stop at the first cell that holds a hit. In return, objects straddling a splitting plane are referenced by both sides.
+	*/
+	struct KDTree {
+		static constexpr int s_iMaxDepthLimit = 64;		// bounds the stack of the ray traversal
+
+		std::vector<KDTreeNode> m_vecNodes;				// depth first order, root at index 0
+		std::vector<SceneObject*> m_vecObjectReferences;	// the objects of every leaf, one contiguous range per leaf. Objects appear once per leaf they overlap
+		glm::vec3 m_vec3Min;	// bounds of all objects, the root's cell
+		glm::vec3 m_vec3Max;
+	};
+
+	/*
+		Parameters of the k-d tree construction. The costs are relative to each other, just like for the SAH of the hierarchies.
+	*/
+	struct KDTreeParameters {
+		float m_fNodeTraversalCost = 1.0f;			// estimated cost of visiting one node
+		float m_fObjectIntersectionCost = 2.0f;		// estimated cost of testing one object in a leaf
+		float m_fEmptyBonus = 0.5f;					// share of the cost a split saves when one of its sides is empty, cuts off empty space early
+		size_t m_uiMaxObjectsPerLeaf = 1u;			// sets of at most this many objects are never split. Larger ones still end up in a leaf when no split pays off
+		int m_iMaxDepth = 0;						// 0 picks 8 + 1.3 * log2(number of objects), at most KDTree::s_iMaxDepthLimit
+	};
+
+	/*
+		Constructs a k-d tree over the objects' world space AABBs. Every node is split at the plane with the lowest Surface Area Heuristic cost,
+		found by sweeping the sorted minima and maxima of the node's objects along all three axes. The empty bonus favours planes that cut off
+		empty space. A node becomes a leaf once it reaches the maximum depth, or when splitting it did not pay off for three levels in a row.
+	*/
+	KDTree ConstructKDTree(SceneObject* pSceneObjects, size_t uiNumSceneObjects, const KDTreeParameters& rParameters);
+
+	/*
+		Creates one object reference per given object, in the same order
+	*/
+	std::vector<ObjectReference> CreateObjectReferences(const SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+	/*
+		Translates the order of the given object references into pointers to the objects they reference
+	*/
+	std::vector<SceneObject*> CreateObjectPermutation(SceneObject* pSceneObjects, const std::vector<ObjectReference>& rvecObjectReferences);
+
+	/*
+		Partitions the given object references IN PLACE at the object mean of the longest axis of the referenced objects' AABBs.
+		pSceneObjects is the array the references were created from. Returns the number of references in the "left" partition.
+	*/
+	size_t PartitionObjectReferencesInPlace_AABB(const SceneObject* pSceneObjects, ObjectReference* pObjectReferences, size_t uiNumObjectReferences);
+	/*
+		Same as PartitionObjectReferencesInPlace_AABB, but choosing the axis by the extent of the referenced objects' Bounding Spheres
+	*/
+	size_t PartitionObjectReferencesInPlace_BoundingSphere(const SceneObject* pSceneObjects, ObjectReference* pObjectReferences, size_t uiNumObjectReferences);
+	/*
+		Same as PartitionObjectReferencesInPlace_AABB, but large sets are measured and partitioned in chunks that run in parallel on the given task pool.
+		The result is identical to the serial version, down to the order of the references.
+	*/
+	size_t PartitionObjectReferencesInPlace_AABB(const SceneObject* pSceneObjects, ObjectReference* pObjectReferences, size_t uiNumObjectReferences, TaskPool& rTaskPool);
+	/*
+		Parallel version of PartitionObjectReferencesInPlace_BoundingSphere, see above
+	*/
+	size_t PartitionObjectReferencesInPlace_BoundingSphere(const SceneObject* pSceneObjects, ObjectReference* pObjectReferences, size_t uiNumObjectReferences, TaskPool& rTaskPool);
+
+	/*
+		Parameters for the binned Surface Area Heuristic (SAH).
+		The costs are relative to each other: traversing one node of the tree vs. testing one object in a leaf.
+	*/
+	struct SAHParameters {
+		size_t m_uiNumBins = 16u;					// number of equally sized bins the centroid extent is divided into, per axis
+		float m_fNodeTraversalCost = 1.0f;			// estimated cost of visiting one node
+		float m_fObjectIntersectionCost = 1.0f;		// estimated cost of testing one object in a leaf. Together with the traversal cost, this decides when a leaf is terminated
+		size_t m_uiMaxObjectsPerLeaf = 4u;			// a leaf is never allowed to hold more objects than this, no matter how cheap the SAH considers it
+	};
+
+	/*
+		Partitions the given object references IN PLACE using a binned Surface Area Heuristic on all three axes.
+		Object centroids are sorted into rParameters.m_uiNumBins bins per axis, and every bin boundary is evaluated as a splitting plane.
+		The split with the lowest estimated cost is chosen.
+
+		Returns the number of references in the "left" partition.
+		Returns 0 if the SAH considers a leaf holding all given objects cheaper than any split. This only happens when
+		uiNumObjectReferences <= rParameters.m_uiMaxObjectsPerLeaf.
+	*/
+	size_t PartitionObjectReferencesInPlace_SAH(const SceneObject* pSceneObjects, ObjectReference* pObjectReferences, size_t uiNumObjectReferences, const SAHParameters& rParameters);
+
+	/*
+		Leaf parameters for the top down trees that partition at the object mean.
+	*/
+	struct ObjectMeanLeafParameters {
+		size_t m_uiMaxObjectsPerLeaf = 1u;			// sets with more objects than this are always partitioned
+		bool m_bTerminateBySAH = false;				// when set, smaller sets only become a leaf if the SAH considers that cheaper than their partitioning
+		float m_fNodeTraversalCost = 1.0f;			// estimated cost of visiting one node
+		float m_fObjectIntersectionCost = 1.0f;		// estimated cost of testing one object in a leaf
+	};
+
+	/*
+		Estimates with the Surface Area Heuristic whether a single leaf holding all given objects is cheaper to traverse than the given split.
+		The references are expected to be partitioned already: the first uiNumLeftObjectReferences of them form the "left" side, the rest the "right" side.
+	*/
+	bool IsLeafCheaperThanSplit_AABB(const SceneObject* pSceneObjects, const ObjectReference* pObjectReferences, size_t uiNumObjectReferences, size_t uiNumLeftObjectReferences, const ObjectMeanLeafParameters& rParameters);
+	/*
+		Same as IsLeafCheaperThanSplit_AABB, but measuring the surface areas of the Bounding Spheres enclosing each side
+	*/
+	bool IsLeafCheaperThanSplit_BoundingSphere(const SceneObject* pSceneObjects, const ObjectReference* pObjectReferences, size_t uiNumObjectReferences, size_t uiNumLeftObjectReferences, const ObjectMeanLeafParameters& rParameters);
 	/*
 		TODO: DOC
 	*/
@@ -119,6 +393,569 @@ namespace CollisionDetection {
 	*/
 	void FindBottomUpNodesToMerge_BoundingSphere(BVHTreeNode** pNode, size_t uiNumNodes, size_t& rNodeIndex1, size_t& rNodeIndex2);
 
+	/*
+		One merge step of a bottom up construction.
+		Indices smaller than the number of scene objects refer to the leaf of the scene object with that very index.
+		Every other index refers to the node created by an earlier merge step: index - number of scene objects = index of that merge step.
+	*/
+	struct BottomUpMerge {
+		size_t m_uiMergePartnerIndex1;
+		size_t m_uiMergePartnerIndex2;
+	};
+	/*
+		Determines the complete order of merges of a bottom up AABB tree: always merging the two nodes resulting in the smallest AABB.
+		Makes the same greedy choices as repeatedly calling FindBottomUpNodesToMerge_AABB, but every node caches its best merge partner
+		in a priority queue, so only nodes whose partner got merged away have to search again.
+		Merges of equal cost are broken deterministically by the smaller node index, then the smaller partner index. Leaves are numbered
+		like the objects, merged nodes in the order they were created. Where costs tie, this can pick a different pair than the all pairs search.
+		Returns uiNumSceneObjects - 1 merges, in order of construction.
+	*/
+	std::vector<BottomUpMerge> CalcBottomUpMergeOrder_AABB(const SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+	/*
+		Same as CalcBottomUpMergeOrder_AABB, but merging the two nodes resulting in the smallest Bounding Sphere.
+	*/
+	std::vector<BottomUpMerge> CalcBottomUpMergeOrder_BoundingSphere(const SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+	/*
+		Parameters of the parallel locally-ordered clustering (PLOC)
+	*/
+	struct PLOCParameters {
+		size_t m_uiSearchRadius = 16u;	// how many clusters before and after a cluster in Morton order are candidates for its nearest neighbor
+	};
+	/*
+		Determines the merge order of a bottom up AABB tree by parallel locally-ordered clustering:
+		the objects are sorted along a Morton curve, then every cluster searches its nearest neighbor, the one resulting in the smallest AABB,
+		among the clusters within the search radius in that order. All pairs of clusters that are each other's nearest neighbor are merged at once,
+		round after round, until a single cluster is left. Approaches the quality of CalcBottomUpMergeOrder_AABB at a fraction of its cost.
+		Searching and merging run in parallel on the given task pool, if any. The merge order does not depend on it.
+		Returns uiNumSceneObjects - 1 merges, indexed the same way as the ones of CalcBottomUpMergeOrder_AABB.
+	*/
+	std::vector<BottomUpMerge> CalcPLOCMergeOrder_AABB(const SceneObject* pSceneObjects, size_t uiNumSceneObjects, const PLOCParameters& rParameters, TaskPool* pTaskPool);
+	/*
+		Same as CalcPLOCMergeOrder_AABB, but nearest neighbors are the ones resulting in the smallest Bounding Sphere.
+	*/
+	std::vector<BottomUpMerge> CalcPLOCMergeOrder_BoundingSphere(const SceneObject* pSceneObjects, size_t uiNumSceneObjects, const PLOCParameters& rParameters, TaskPool* pTaskPool);
+
+	/*
+		Parameters of the linear BVH (LBVH) construction
+	*/
+	struct LBVHParameters {
+		bool m_bUse63BitMortonCodes = false;	// 21 instead of 10 bits per axis. Tells apart objects that lie closer together, but sorting takes twice as many passes
+	};
+	/*
+		Constructs a linear BVH (LBVH): the objects' centroids are quantized to Morton codes and radix sorted along that Z-order curve,
+		then the hierarchy is emitted by splitting every range of sorted codes at the highest bit in which they differ.
+		Ranges of identical codes are split in the middle. Every leaf holds a single object, node AABBs are merged bottom up.
+		Much faster to construct than any other strategy, at the cost of tree quality.
+		Sorting and emitting run in parallel on the given task pool, if any. The hierarchy has to be empty.
+	*/
+	void ConstructLBVH_AABB(BoundingVolumeHierarchy& rBVH, SceneObject* pSceneObjects, size_t uiNumSceneObjects, const LBVHParameters& rParameters, TaskPool* pTaskPool);
+	/*
+		Same as ConstructLBVH_AABB, merging the Bounding Spheres of the nodes instead
+	*/
+	void ConstructLBVH_BoundingSphere(BoundingVolumeHierarchy& rBVH, SceneObject* pSceneObjects, size_t uiNumSceneObjects, const LBVHParameters& rParameters, TaskPool* pTaskPool);
+	/*
+		Same as ConstructLBVH_AABB, over the objects' swept world space AABBs: the node AABBs enclose the motion of all of their objects
+		since the previous frame. Broadphase for fast objects, see FindOverlappingObjectPairs_SweptAABB.
+	*/
+	void ConstructLBVH_SweptAABB(BoundingVolumeHierarchy& rBVH, SceneObject* pSceneObjects, size_t uiNumSceneObjects, const LBVHParameters& rParameters, TaskPool* pTaskPool);
+
+	/*
+		Prepares a constructed hierarchy for refitting: links every node to its parent, remembers the leaf of every object
+		and measures the nodes' AABBs as the reference for CalcRefitDegradation.
+		pSceneObjects is the array the hierarchy was built from.
+	*/
+	void PrepareBVHForRefitting_AABB(BoundingVolumeHierarchy& rBVH, const SceneObject* pSceneObjects);
+	/*
+		Same as PrepareBVHForRefitting_AABB, measuring the nodes' Bounding Spheres
+	*/
+	void PrepareBVHForRefitting_BoundingSphere(BoundingVolumeHierarchy& rBVH, const SceneObject* pSceneObjects);
+	/*
+		Refits a prepared hierarchy after the world space AABB of the given object changed. Only the AABBs of the object's leaf and
+		its ancestors are recomputed, bottom up, until one of them stays the same. The structure of the tree is kept as it is.
+	*/
+	void RefitBVHForObject_AABB(BoundingVolumeHierarchy& rBVH, const SceneObject* pSceneObjects, size_t uiObjectIndex);
+	/*
+		Same as RefitBVHForObject_AABB, for hierarchies of Bounding Spheres. Parents are refitted by merging their children's spheres,
+		which is not as tight as enclosing all of their objects.
+	*/
+	void RefitBVHForObject_BoundingSphere(BoundingVolumeHierarchy& rBVH, const SceneObject* pSceneObjects, size_t uiObjectIndex);
+	/*
+		Refits the flattened copy of a prepared hierarchy after the world space AABB of the given object changed, without flattening it anew.
+		The object's path from its leaf up to the root is taken from the hierarchy's parent links, and only the nodes along it are recomputed.
+		rLinearBVH has to be created from rBVH by CreateLinearBVH, and the structure of rBVH may not have changed since.
+	*/
+	void RefitLinearBVHForObject(LinearBVH& rLinearBVH, const BoundingVolumeHierarchy& rBVH, size_t uiObjectIndex);
+
+	/*
+		Bounding volume hierarchy of AABBs that is updated incrementally instead of being constructed anew, like the dynamic trees of Box2D and Bullet.
+		Every leaf holds exactly one object, identified by its index in the scene. Nodes refer to each other by index into a single array.
+
+		Objects are inserted next to the sibling that grows the summed surface area of the tree the least, found by a branch and bound search.
+		After every insertion and removal, the ancestors of the changed leaf are refitted and rotated locally whenever swapping a child with
+		a grandchild shrinks the tree. Leaves store "fat" AABBs, so objects that only move a little do not have to be reinserted at all.
+	*/
+	class DynamicAABBTree {
+	public:
+		static constexpr int32_t s_iNullNode = -1;
+
+		struct Node {
+			AABB m_tAABB;										// leaves: fat AABB of the object. nodes: encloses both children
+			int32_t m_iParentOrNextFreeNode = s_iNullNode;		// free nodes are chained into a list
+			int32_t m_iLeft = s_iNullNode;
+			int32_t m_iRight = s_iNullNode;
+			int32_t m_iHeight = 0;								// 0 for leaves, -1 for free nodes
+			uint32_t m_uiObjectIndex = 0u;						// only valid for leaves
+
+			bool IsALeaf() const {
+				return m_iLeft == s_iNullNode;
+			}
+		};
+
+		/*
+			fFatAABBMargin is the fraction of an object's extent its fat AABB is enlarged by, on every axis
+		*/
+		explicit DynamicAABBTree(float fFatAABBMargin = 0.1f);
+
+		void InsertObject(const SceneObject* pSceneObjects, uint32_t uiObjectIndex);
+		void RemoveObject(uint32_t uiObjectIndex);
+		/*
+			Has to be called after the world space AABB of the object changed. The object is only reinserted if its AABB left its fat AABB,
+			or shrank so much that the fat AABB is far too loose. Returns whether it was reinserted.
+		*/
+		bool UpdateObject(const SceneObject* pSceneObjects, uint32_t uiObjectIndex);
+		/*
+			Lets the leaf of an object refer to the object's new index, e.g. after the object was moved within the scene's array
+		*/
+		void ChangeObjectIndex(uint32_t uiOldObjectIndex, uint32_t uiNewObjectIndex);
+		void Clear();
+
+		const std::vector<Node>& GetNodes() const { return m_vecNodes; }
+		int32_t GetRootNode() const { return m_iRootNode; }
+		size_t GetNumObjects() const { return m_uiNumObjects; }
+		size_t GetNumNodes() const { return m_uiNumObjects > 0u ? 2u * m_uiNumObjects - 1u : 0u; }
+		int32_t GetHeight() const;
+		float CalcNodeSurfaceArea() const;	// summed surface area of all nodes' AABBs, leaves excluded. The smaller, the better the tree
+
+	private:
+		int32_t AllocateNode();
+		void FreeNode(int32_t iNode);
+		AABB CreateFatAABB(const AABB& rObjectAABB) const;
+
+		void InsertLeaf(int32_t iLeaf);
+		void RemoveLeaf(int32_t iLeaf);
+		int32_t FindBestSibling(const AABB& rLeafAABB) const;
+		void RefitAndRotateAncestors(int32_t iNode);	// starting with the given node itself, all the way up to the root
+		void RotateNode(int32_t iNode);
+		void SwapChildWithGrandchild(int32_t iNode, int32_t iChild, int32_t iGrandchild);
+
+		std::vector<Node> m_vecNodes;
+		std::vector<int32_t> m_vecLeafOfObject;	// index = index of the object in the scene. s_iNullNode for objects that are not in the tree
+		int32_t m_iRootNode;
+		int32_t m_iFreeList;
+		size_t m_uiNumObjects;
+		float m_fFatAABBMargin;
+	};
+
 	RayCastIntersectionResult CastRayIntoBVH(const BoundingVolumeHierarchy& rBVH, const Ray& rCastedRay);
+	/*
+		Ways of traversing a BoundingVolumeHierarchy with a ray
+	*/
+	enum eRayTraversal {
+		RECURSIVE_TRAVERSAL = 0,	// left child before right child, no child is ever skipped
+		STACK_TRAVERSAL,			// explicit stack, nearer child first, skips children the ray enters beyond the closest hit so far
+		STACKLESS_TRAVERSAL,		// same order and skipping, but backtracks along the nodes' parent links. Needs a hierarchy prepared for refitting
+		SHORT_STACK_TRAVERSAL,		// stackless, but remembers the last few far children on a small stack instead of climbing back to them. Needs parent links too
+		NUM_RAYTRAVERSALS
+	};
+	/*
+		What a single ray cast cost, to compare traversals with each other
+	*/
+	struct RayTraversalStatistics {
+		size_t m_uiNumVisitedNodes = 0u;			// nodes and leaves the traversal went into
+		size_t m_uiNumBoundingVolumeTests = 0u;		// ray tests against the bounding volumes of nodes and leaves
+		size_t m_uiNumObjectTests = 0u;				// ray tests against the AABBs of the leaves' objects
+	};
+	/*
+		Same as above, with the given traversal. Every traversal finds the same closest intersection distance.
+		The statistics of this ray cast are added to pStatistics, if given.
+	*/
+	RayCastIntersectionResult CastRayIntoBVH(const BoundingVolumeHierarchy& rBVH, const Ray& rCastedRay, eRayTraversal eTraversal, RayTraversalStatistics* pStatistics = nullptr);
+	/*
+		Casts a ray into a hierarchy built with Bounding Spheres, visiting the nearer child first like STACK_TRAVERSAL. The nodes' AABBs are not needed.
+		Objects are hit by their world space Bounding Spheres: their AABBs may reach beyond the spheres enclosing them, so the tree could not find every AABB hit.
+	*/
+	RayCastIntersectionResult CastRayIntoBVH_BoundingSphere(const BoundingVolumeHierarchy& rBVH, const Ray& rCastedRay, RayTraversalStatistics* pStatistics = nullptr);
+	/*
+		Same as above, but iterating over the flattened node array instead of recursing through the tree.
+		Subtrees that are entered further away than the closest hit so far are skipped.
+	*/
+	RayCastIntersectionResult CastRayIntoBVH(const LinearBVH& rBVH, const Ray& rCastedRay);
+	/*
+		Same as above, for wide hierarchies. All children of a node are tested at once, the ones that were hit are visited nearest first.
+	*/
+	RayCastIntersectionResult CastRayIntoBVH(const BVH4& rBVH, const Ray& rCastedRay);
+	RayCastIntersectionResult CastRayIntoBVH(const BVH8& rBVH, const Ray& rCastedRay);
+	/*
+		Same as above, for a k-d tree. The ray's line is clipped to the tree's bounds, and its interval is split at every plane it crosses.
+		Leaves are visited strictly front to back, the traversal ends at the first leaf whose interval begins beyond the closest hit so far.
+	*/
+	RayCastIntersectionResult CastRayIntoBVH(const KDTree& rKDTree, const Ray& rCastedRay);
+	/*
+		Same as above, for a dynamic tree. pSceneObjects is the array the tree's object indices refer to.
+	*/
+	RayCastIntersectionResult CastRayIntoBVH(const DynamicAABBTree& rTree, SceneObject* pSceneObjects, const Ray& rCastedRay);
+	/*
+		Casts uiNumRays rays into the hierarchy, uiPacketSize (4, 8 or 16) consecutive ones of them together as a packet.
+		A node is tested against all rays of a packet at once with SIMD slab tests, rays that miss it are masked out for its whole subtree.
+		Once only a quarter of a packet's rays are left in a subtree, they split off and finish it one by one.
+		Packets pay off for coherent rays, such as the rays through neighbouring pixels, so those should be consecutive in pRays.
+		Writes the same result for every ray into pResults as CastRayIntoBVH(rBVH, rCastedRay) would.
+	*/
+	void CastRayPacketsIntoBVH(const LinearBVH& rBVH, const Ray* pRays, size_t uiNumRays, size_t uiPacketSize, RayCastIntersectionResult* pResults);
 	RayCastIntersectionResult BruteForceRayIntoObjects(std::vector<SceneObject>& rvecObjects, const Ray& rCastedRay);
+	/*
+		Finds the objects of the hierarchy whose world space AABBs pass StaticTestAABBagainstFrustum, so everything the camera cannot see is culled.
+		Every node only tests the planes its parent did not lie completely inside of, and subtrees inside of all six planes are taken without any further tests.
+		Writes at most uiMaxNumObjects of the visible objects into ppObjects, in no particular order, and returns the number of all of them.
+	*/
+	size_t FindObjectsInFrustum(const LinearBVH& rBVH, const Frustum& rFrustum, SceneObject** ppObjects, size_t uiMaxNumObjects);
+
+	/*
+		Called for every object a region query finds, with the pUserData given to the query. Returning false ends the query right away.
+	*/
+	typedef bool(*ObjectQueryVisitor)(SceneObject* pObject, void* pUserData);
+	/*
+		Region queries: visit the objects whose world space AABBs overlap the given box or sphere, or contain the given point. Touching counts.
+		Objects are visited in no particular order. Nothing is allocated: the traversal keeps a fixed stack, and only hierarchies too deep for it
+		continue by recursion. Return false if the visitor ended the query early.
+	*/
+	bool QueryAABB(const LinearBVH& rBVH, const AABB& rAABB, ObjectQueryVisitor pVisitor, void* pUserData);
+	bool QuerySphere(const LinearBVH& rBVH, const BoundingSphere& rSphere, ObjectQueryVisitor pVisitor, void* pUserData);
+	bool QueryPoint(const LinearBVH& rBVH, const glm::vec3& rvec3Point, ObjectQueryVisitor pVisitor, void* pUserData);
+	/*
+		Same as above, for a dynamic tree. pSceneObjects is the array the tree's object indices refer to.
+	*/
+	bool QueryAABB(const DynamicAABBTree& rTree, SceneObject* pSceneObjects, const AABB& rAABB, ObjectQueryVisitor pVisitor, void* pUserData);
+	bool QuerySphere(const DynamicAABBTree& rTree, SceneObject* pSceneObjects, const BoundingSphere& rSphere, ObjectQueryVisitor pVisitor, void* pUserData);
+	bool QueryPoint(const DynamicAABBTree& rTree, SceneObject* pSceneObjects, const glm::vec3& rvec3Point, ObjectQueryVisitor pVisitor, void* pUserData);
+	/*
+		Same as above, writing at most uiMaxNumObjects of the found objects into ppObjects and returning the number of all of them, like FindObjectsInFrustum
+	*/
+	size_t QueryAABB(const LinearBVH& rBVH, const AABB& rAABB, SceneObject** ppObjects, size_t uiMaxNumObjects);
+	size_t QuerySphere(const LinearBVH& rBVH, const BoundingSphere& rSphere, SceneObject** ppObjects, size_t uiMaxNumObjects);
+	size_t QueryPoint(const LinearBVH& rBVH, const glm::vec3& rvec3Point, SceneObject** ppObjects, size_t uiMaxNumObjects);
+	size_t QueryAABB(const DynamicAABBTree& rTree, SceneObject* pSceneObjects, const AABB& rAABB, SceneObject** ppObjects, size_t uiMaxNumObjects);
+	size_t QuerySphere(const DynamicAABBTree& rTree, SceneObject* pSceneObjects, const BoundingSphere& rSphere, SceneObject** ppObjects, size_t uiMaxNumObjects);
+	size_t QueryPoint(const DynamicAABBTree& rTree, SceneObject* pSceneObjects, const glm::vec3& rvec3Point, SceneObject** ppObjects, size_t uiMaxNumObjects);
+
+	/*
+		An object found by a nearest object query
+	*/
+	struct NearestObject {
+		SceneObject* m_pObject = nullptr;
+		float m_fDistance = std::numeric_limits<float>::max();	// from the query point to the object's bounding volume, 0 for points inside of it
+	};
+	/*
+		Finds the uiMaxNumObjects objects whose world space AABBs are closest to the given point, no farther away than fMaxDistance.
+		Best first: nodes are visited in the order of their distance to the point, and the found objects are kept in a bounded priority queue.
+		Once it is full, nodes farther away than the farthest object in it are pruned, and the query ends when the nearest node left is one of them.
+		Writes the objects into pNearestObjects, nearest first, and returns their number. Of equally distant objects, the first found is kept.
+	*/
+	size_t FindNearestObjects_AABB(const BoundingVolumeHierarchy& rBVH, const glm::vec3& rvec3Point, size_t uiMaxNumObjects, float fMaxDistance, NearestObject* pNearestObjects);
+	/*
+		Same as above, for hierarchies of Bounding Spheres. Distances are measured to the objects' world space Bounding Spheres.
+	*/
+	size_t FindNearestObjects_BoundingSphere(const BoundingVolumeHierarchy& rBVH, const glm::vec3& rvec3Point, size_t uiMaxNumObjects, float fMaxDistance, NearestObject* pNearestObjects);
+	/*
+		The single nearest object, m_pObject is null if there is none within fMaxDistance
+	*/
+	NearestObject FindClosestObject_AABB(const BoundingVolumeHierarchy& rBVH, const glm::vec3& rvec3Point, float fMaxDistance = std::numeric_limits<float>::max());
+	NearestObject FindClosestObject_BoundingSphere(const BoundingVolumeHierarchy& rBVH, const glm::vec3& rvec3Point, float fMaxDistance = std::numeric_limits<float>::max());
+
+	/*
+		Result of casting a moving volume into a hierarchy
+	*/
+	struct TimeOfImpactResult {
+		SceneObject* m_pFirstHitSceneObject = nullptr;
+		float m_fTimeOfImpact = std::numeric_limits<float>::max();	// fraction of the displacement in [0, 1] at which the volumes first touch, 0 if they overlap from the start
+
+		bool ImpactOccured() const { return m_pFirstHitSceneObject; }
+	};
+	/*
+		Continuous counterpart of StaticTestAABBagainstAABB: moves the AABB along rvec3Displacement and finds the object whose world space AABB it hits first.
+		The objects of the hierarchy are taken to be at rest. Nodes are visited in the order of their time of impact, so the cast ends
+		as soon as no node left can be hit before the earliest hit found. pIgnoredObject, if given, is never hit, e.g. the moving object itself.
+	*/
+	TimeOfImpactResult CastAABBIntoBVH(const BoundingVolumeHierarchy& rBVH, const AABB& rMovingAABB, const glm::vec3& rvec3Displacement, const SceneObject* pIgnoredObject = nullptr);
+	/*
+		Same as CastAABBIntoBVH, for hierarchies of Bounding Spheres: the moving sphere is tested against the nodes' and the objects' world space Bounding Spheres
+	*/
+	TimeOfImpactResult CastBoundingSphereIntoBVH(const BoundingVolumeHierarchy& rBVH, const BoundingSphere& rMovingBoundingSphere, const glm::vec3& rvec3Displacement, const SceneObject* pIgnoredObject = nullptr);
+
+	/*
+		Two objects whose bounding volumes overlap
+	*/
+	struct ObjectPair {
+		SceneObject* m_pObject = nullptr;
+		SceneObject* m_pOtherObject = nullptr;
+	};
+	/*
+		Finds all pairs of objects of the hierarchy whose world space AABBs overlap, by testing the hierarchy against itself.
+		At most uiMaxNumPairs pairs are written into pPairs, but all of them are counted: if the returned number is larger, the caller can grow its buffer and query again.
+		Every pair is reported once, in no particular order. With a task pool, pairs of subtrees close to the root are searched in parallel.
+	*/
+	size_t FindOverlappingObjectPairs_AABB(const BoundingVolumeHierarchy& rBVH, ObjectPair* pPairs, size_t uiMaxNumPairs, TaskPool* pTaskPool);
+	/*
+		Same as above, for hierarchies of Bounding Spheres. The objects' world space Bounding Spheres have to overlap.
+	*/
+	size_t FindOverlappingObjectPairs_BoundingSphere(const BoundingVolumeHierarchy& rBVH, ObjectPair* pPairs, size_t uiMaxNumPairs, TaskPool* pTaskPool);
+	/*
+		Same as above, for the objects of two different hierarchies built with the same bounding volume.
+		m_pObject of every pair is an object of rBVH, m_pOtherObject one of rOtherBVH.
+	*/
+	size_t FindOverlappingObjectPairs_AABB(const BoundingVolumeHierarchy& rBVH, const BoundingVolumeHierarchy& rOtherBVH, ObjectPair* pPairs, size_t uiMaxNumPairs, TaskPool* pTaskPool);
+	size_t FindOverlappingObjectPairs_BoundingSphere(const BoundingVolumeHierarchy& rBVH, const BoundingVolumeHierarchy& rOtherBVH, ObjectPair* pPairs, size_t uiMaxNumPairs, TaskPool* pTaskPool);
+	/*
+		Same as FindOverlappingObjectPairs_AABB for a hierarchy built by ConstructLBVH_SweptAABB: finds the pairs whose swept world space AABBs overlap,
+		the candidates that may have collided on their way, even if they tunneled through each other and their current AABBs are apart.
+	*/
+	size_t FindOverlappingObjectPairs_SweptAABB(const BoundingVolumeHierarchy& rBVH, ObjectPair* pPairs, size_t uiMaxNumPairs, TaskPool* pTaskPool);
+	/*
+		Tests every object's world space AABB against every other one, in the order of the array
+	*/
+	size_t BruteForceOverlappingObjectPairs(std::vector<SceneObject>& rvecObjects, ObjectPair* pPairs, size_t uiMaxNumPairs);
+
+	/*
+		Sweep and prune broadphase: the minimum and maximum of every object's world space AABB are kept in one sorted list per axis.
+		Objects mostly move a little from frame to frame, so their endpoints are moved to their new places with insertion sort, which is close to linear then.
+		Every swap of a minimum with a maximum of another object is where the two start or stop overlapping on that axis,
+		so the set of overlapping pairs is kept up to date by the swaps alone.
+	*/
+	class SweepAndPrune {
+	public:
+		static constexpr uint32_t s_uiNotInserted = 0xFFFFFFFFu;
+
+		struct Endpoint {
+			float m_fValue = 0.0f;
+			uint32_t m_uiObjectIndex = 0u;
+			bool m_bIsMinimum = false;
+		};
+
+		SweepAndPrune();
+
+		/*
+			Replaces all objects by the given ones: sorts each axis once and sweeps along the x axis to find the overlapping pairs
+		*/
+		void Build(const SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+		void InsertObject(const SceneObject* pSceneObjects, uint32_t uiObjectIndex);
+		void RemoveObject(uint32_t uiObjectIndex);
+		/*
+			Has to be called after the world space AABB of the object changed. Returns how many endpoints its endpoints were swapped with
+		*/
+		size_t UpdateObject(const SceneObject* pSceneObjects, uint32_t uiObjectIndex);
+		/*
+			Lets the endpoints and pairs of an object refer to the object's new index, e.g. after the object was moved within the scene's array
+		*/
+		void ChangeObjectIndex(uint32_t uiOldObjectIndex, uint32_t uiNewObjectIndex);
+		void Clear();
+
+		/*
+			Writes at most uiMaxNumPairs of the overlapping pairs into pPairs and returns the number of all of them, like FindOverlappingObjectPairs_AABB
+		*/
+		size_t GetOverlappingObjectPairs(SceneObject* pSceneObjects, ObjectPair* pPairs, size_t uiMaxNumPairs) const;
+		const std::vector<Endpoint>& GetEndpoints(size_t uiAxisIndex) const;
+		size_t GetNumObjects() const { return m_uiNumObjects; }
+		size_t GetNumOverlappingPairs() const { return m_setOverlappingPairs.size(); }
+
+	private:
+		struct ObjectEndpoints {
+			uint32_t m_pMinimumEndpoint[3] = { s_uiNotInserted, s_uiNotInserted, s_uiNotInserted };	// positions within the sorted list of each axis
+			uint32_t m_pMaximumEndpoint[3] = { s_uiNotInserted, s_uiNotInserted, s_uiNotInserted };
+		};
+
+		static uint64_t CreatePairKey(uint32_t uiObjectIndex, uint32_t uiOtherObjectIndex);
+		static bool IsEndpointLess(const Endpoint& rEndpoint, const Endpoint& rOtherEndpoint);	// minima go before maxima of the same value, so touching AABBs overlap
+		bool AreOverlapping(uint32_t uiObjectIndex, uint32_t uiOtherObjectIndex) const;
+
+		void SetEndpointValues(const SceneObject* pSceneObjects, uint32_t uiObjectIndex);
+		void SwapEndpointWithNext(size_t uiAxisIndex, uint32_t uiEndpoint);
+		size_t SortEndpointDown(size_t uiAxisIndex, uint32_t uiEndpoint);
+		size_t SortEndpointUp(size_t uiAxisIndex, uint32_t uiEndpoint);
+		uint32_t& GetEndpointPosition(const Endpoint& rEndpoint, size_t uiAxisIndex);
+
+		std::vector<Endpoint> m_pvecEndpoints[3];
+		std::vector<ObjectEndpoints> m_vecEndpointsOfObject;	// index = index of the object in the scene
+		std::unordered_set<uint64_t> m_setOverlappingPairs;		// the smaller object index in the upper 32 bits
+		size_t m_uiNumObjects;
+	};
+
+	/*
+		Uniform grid broadphase: space is divided into cubic cells of one size, and every object is entered into all cells its world space AABB touches.
+		Only the cells that hold objects are stored, in a hash map. With objects of similar size, each of them touches only a few cells,
+		so inserting, removing and updating an object takes constant time, independent of the number of objects.
+	*/
+	class SpatialHashGrid {
+	public:
+		struct CellRange {
+			int32_t m_pMinimumCell[3] = { 0, 0, 0 };	// per axis, the first and the last cell an AABB touches
+			int32_t m_pMaximumCell[3] = { -1, -1, -1 };
+		};
+
+		SpatialHashGrid();
+
+		/*
+			Replaces all objects by the given ones, with a cell size picked by CalcCellSizeForObjects
+		*/
+		void Build(const SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+		void InsertObject(const SceneObject* pSceneObjects, uint32_t uiObjectIndex);
+		void RemoveObject(uint32_t uiObjectIndex);
+		/*
+			Has to be called after the world space AABB of the object changed. Returns whether the object moved into other cells
+		*/
+		bool UpdateObject(const SceneObject* pSceneObjects, uint32_t uiObjectIndex);
+		/*
+			Lets the cells of an object refer to the object's new index, e.g. after the object was moved within the scene's array
+		*/
+		void ChangeObjectIndex(uint32_t uiOldObjectIndex, uint32_t uiNewObjectIndex);
+		void Clear();	// the cell size is kept
+		void SetCellSize(float fCellSize);	// only while the grid is empty
+
+		/*
+			Writes at most uiMaxNumPairs of the pairs whose world space AABBs overlap into pPairs and returns the number of all of them, like FindOverlappingObjectPairs_AABB.
+			Only objects sharing a cell are tested. A pair sharing several cells is only reported by the first of them.
+		*/
+		size_t FindOverlappingObjectPairs(SceneObject* pSceneObjects, ObjectPair* pPairs, size_t uiMaxNumPairs) const;
+		/*
+			The indices of the objects touching the given cell, nullptr for empty cells.
+			Cells that are far apart can share a hash map entry, so they may also hold objects that lie somewhere else entirely.
+		*/
+		const std::vector<uint32_t>* GetObjectsInCell(const int32_t* pCell) const;
+		const CellRange& GetCellRangeOfObject(uint32_t uiObjectIndex) const;
+		/*
+			Encloses the cells of all objects. Only grows while objects move, until the grid is built anew or cleared
+		*/
+		const CellRange& GetOccupiedCells() const { return m_tOccupiedCells; }
+		float GetCellSize() const { return m_fCellSize; }
+		size_t GetNumObjects() const { return m_uiNumObjects; }
+		size_t GetNumOccupiedCells() const { return m_mapCells.size(); }
+
+		/*
+			The median of the objects' largest AABB extents. Most objects then touch at most two cells along each axis,
+			while cells stay small enough to hold only a few objects each
+		*/
+		static float CalcCellSizeForObjects(const SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+
+	private:
+		struct ObjectCells {
+			CellRange m_tCellRange;
+			bool m_bIsInserted = false;
+		};
+
+		static uint64_t CreateCellKey(int32_t iCellX, int32_t iCellY, int32_t iCellZ);	// 21 bits per axis, cells 2^21 apart share a key
+		CellRange CalcCellRange(const AABB& rAABB) const;
+		void AddObjectToCells(uint32_t uiObjectIndex, const CellRange& rCellRange);
+		void RemoveObjectFromCells(uint32_t uiObjectIndex, const CellRange& rCellRange);
+
+		std::unordered_map<uint64_t, std::vector<uint32_t>> m_mapCells;	// only cells that hold objects
+		std::vector<ObjectCells> m_vecCellsOfObject;	// index = index of the object in the scene
+		CellRange m_tOccupiedCells;
+		float m_fCellSize;
+		float m_fInverseCellSize;
+		size_t m_uiNumObjects;
+	};
+	/*
+		Walks the ray through the grid cell by cell (3D-DDA) and tests the objects of every cell. Finds the same closest intersection
+		distance as CastRayIntoBVH: like the slab tests, it follows the ray's whole line through the occupied cells, also behind the origin.
+		Stops as soon as no later cell can hold a closer hit. Visited cells are counted as nodes in pStatistics, if given.
+	*/
+	RayCastIntersectionResult CastRayIntoSpatialHashGrid(const SpatialHashGrid& rGrid, SceneObject* pSceneObjects, const Ray& rCastedRay, RayTraversalStatistics* pStatistics = nullptr);
+
+	/*
+		Loose octree: the root's cube is subdivided into eight child cubes, recursively, and the bounds of every node are its cube enlarged to twice its width.
+		An object belongs to the deepest level whose cubes are at least as wide as the object, into the node whose cube holds the object's center,
+		and always fits into that node's loose bounds. Inserting or removing an object therefore only walks down from the root once,
+		no other object is touched, and nodes are created and freed on demand. Objects that are larger than the root's cube,
+		or whose centers lie outside of it, are kept in the root, which every query visits.
+	*/
+	class LooseOctree {
+	public:
+		static constexpr int32_t s_iNullNode = -1;
+		static constexpr int32_t s_iMaxDepthLimit = 16;
+
+		struct Node {
+			AABB m_tLooseAABB;						// the node's cube enlarged to twice its width, holds the objects of the whole subtree
+			std::vector<uint32_t> m_vecObjects;		// indices of the objects in the scene
+			int32_t m_pChildren[8] = { s_iNullNode, s_iNullNode, s_iNullNode, s_iNullNode, s_iNullNode, s_iNullNode, s_iNullNode, s_iNullNode };	// index = octant, bit 0/1/2 set for the upper half along x/y/z
+			int32_t m_iParentOrNextFreeNode = s_iNullNode;	// free nodes are chained into a list
+			int32_t m_iDepth = 0;					// 0 for the root, -1 for free nodes
+		};
+
+		/*
+			The root's cube is centered at rvec3Center and extends by fHalfWidth along every axis. Levels deeper than iMaxDepth are never created
+		*/
+		explicit LooseOctree(const glm::vec3& rvec3Center = glm::vec3(0.0f), float fHalfWidth = 1000.0f, int32_t iMaxDepth = 8);
+
+		/*
+			Replaces all objects by the given ones, with a root cube around all of their centers
+		*/
+		void Build(const SceneObject* pSceneObjects, size_t uiNumSceneObjects);
+		void InsertObject(const SceneObject* pSceneObjects, uint32_t uiObjectIndex);
+		void RemoveObject(uint32_t uiObjectIndex);
+		/*
+			Has to be called after the world space AABB of the object changed. The object stays in its node as long as it still fits
+			the node's loose bounds and the node's level still suits its size. Returns whether it moved to another node
+		*/
+		bool UpdateObject(const SceneObject* pSceneObjects, uint32_t uiObjectIndex);
+		/*
+			Lets the node of an object refer to the object's new index, e.g. after the object was moved within the scene's array
+		*/
+		void ChangeObjectIndex(uint32_t uiOldObjectIndex, uint32_t uiNewObjectIndex);
+		void Clear();	// the root's cube and the maximum depth are kept
+		void SetBounds(const glm::vec3& rvec3Center, float fHalfWidth);	// only while the octree is empty
+
+		/*
+			Writes at most uiMaxNumObjects indices of the objects whose world space AABBs overlap rAABB into pObjectIndices, and returns the number of all of them
+		*/
+		size_t FindObjectsOverlappingAABB(const SceneObject* pSceneObjects, const AABB& rAABB, uint32_t* pObjectIndices, size_t uiMaxNumObjects) const;
+		/*
+			Same as FindObjectsOverlappingAABB, for the objects whose world space AABBs pass StaticTestAABBagainstFrustum
+		*/
+		size_t FindObjectsInFrustum(const SceneObject* pSceneObjects, const Frustum& rFrustum, uint32_t* pObjectIndices, size_t uiMaxNumObjects) const;
+
+		const std::vector<Node>& GetNodes() const { return m_vecNodes; }
+		int32_t GetRootNode() const { return m_iRootNode; }
+		int32_t GetNodeOfObject(uint32_t uiObjectIndex) const;
+		size_t GetNumObjects() const { return m_uiNumObjects; }
+		size_t GetNumNodes() const { return m_uiNumNodes; }
+		int32_t GetMaxDepth() const { return m_iMaxDepth; }
+		const glm::vec3& GetCenter() const { return m_vec3Center; }
+		float GetHalfWidth() const { return m_fHalfWidth; }
+
+	private:
+		int32_t AllocateNode(int32_t iParent, int32_t iDepth, const glm::vec3& rvec3CubeCenter, float fCubeHalfWidth);
+		void FreeNode(int32_t iNode);
+		int32_t CalcDepthForAABB(const AABB& rAABB) const;	// deepest level whose cubes are at least as wide as the AABB, 0 for AABBs that do not fit below the root
+		int32_t FindOrCreateNodeForAABB(const AABB& rAABB);	// creates the missing nodes on the way down
+		void FreeEmptyNodes(int32_t iNode);	// starting with the given node, frees nodes without objects and children all the way up to the root
+		/*
+			The query behind FindObjectsOverlappingAABB and FindObjectsInFrustum. pTestAABB is applied to both the nodes' loose bounds and the objects
+		*/
+		template <typename QueryVolume>
+		size_t FindObjects(const SceneObject* pSceneObjects, const QueryVolume& rQueryVolume, int(*pTestAABB)(const AABB&, const QueryVolume&), uint32_t* pObjectIndices, size_t uiMaxNumObjects) const;
+
+		std::vector<Node> m_vecNodes;
+		std::vector<int32_t> m_vecNodeOfObject;	// index = index of the object in the scene. s_iNullNode for objects that are not in the octree
+		int32_t m_iRootNode;
+		int32_t m_iFreeList;
+		size_t m_uiNumObjects;
+		size_t m_uiNumNodes;
+		glm::vec3 m_vec3Center;
+		float m_fHalfWidth;
+		int32_t m_iMaxDepth;
+	};
+	/*
+		Visits the root and then the children whose loose bounds the ray's line passes through, nearer ones first, skipping nodes entered beyond the closest hit so far.
+		Finds the same closest intersection distance as CastRayIntoBVH. Visited nodes and tested objects are counted in pStatistics, if given.
+	*/
+	RayCastIntersectionResult CastRayIntoLooseOctree(const LooseOctree& rOctree, SceneObject* pSceneObjects, const Ray& rCastedRay, RayTraversalStatistics* pStatistics = nullptr);
 }
\ No newline at end of file
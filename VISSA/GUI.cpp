@@ -6,6 +6,9 @@
 #include <stdio.h>
 
 #include "BVHVisualization.h"
+#include "SweepAndPruneVisualization.h"
+#include "SpatialHashGridVisualization.h"
+#include "OctreeVisualization.h"
 
 GUI::GUI() :
 	m_bShowMainMenu(true)
@@ -178,6 +181,42 @@ void GUI::ConditionallyRenderVisualizationSelectionMenu(Engine& rEngine)
 			m_bShowMainMenu = false;
 		}
 
+		if (ImGui::Button("SWEEP AND PRUNE", ImVec2(0, 0)))
+		{
+			// Visualization relevant
+			delete rEngine.m_pVisualization;
+			rEngine.m_pVisualization = new SweepAndPruneVisualization(Engine::GetMainWindow());
+			rEngine.m_pVisualization->Load();
+
+			// UI relevant
+			ImGui::CloseCurrentPopup();
+			m_bShowMainMenu = false;
+		}
+
+		if (ImGui::Button("SPATIAL HASH GRID", ImVec2(0, 0)))
+		{
+			// Visualization relevant
+			delete rEngine.m_pVisualization;
+			rEngine.m_pVisualization = new SpatialHashGridVisualization(Engine::GetMainWindow());
+			rEngine.m_pVisualization->Load();
+
+			// UI relevant
+			ImGui::CloseCurrentPopup();
+			m_bShowMainMenu = false;
+		}
+
+		if (ImGui::Button("LOOSE OCTREE", ImVec2(0, 0)))
+		{
+			// Visualization relevant
+			delete rEngine.m_pVisualization;
+			rEngine.m_pVisualization = new OctreeVisualization(Engine::GetMainWindow());
+			rEngine.m_pVisualization->Load();
+
+			// UI relevant
+			ImGui::CloseCurrentPopup();
+			m_bShowMainMenu = false;
+		}
+
 		if (ImGui::Button("BACK", ImVec2(0, 0)))
 		{
 			ImGui::CloseCurrentPopup();
@@ -0,0 +1,804 @@
+#include "OctreeVisualization.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <chrono>
+
+#include "Engine.h"
+#include "GeometricPrimitiveData.h"
+#include "Renderer.h"
+
+namespace {
+	// blends from the root's color to the deepest level's color
+	glm::vec4 InterpolateRenderColorForDepth(const glm::vec4& rColor1, const glm::vec4& rColor2, int32_t iDepth, int32_t iMaxDepth)
+	{
+		assert(iDepth >= 0);
+
+		if (iMaxDepth == 0)
+			return rColor1;
+
+		const float fWeightColor2 = static_cast<float>(iDepth) / static_cast<float>(iMaxDepth);
+		return rColor1 * (1.0f - fWeightColor2) + rColor2 * fWeightColor2;
+	}
+}
+
+OctreeVisualization::OctreeVisualization(Window* pMainWindow) :
+	Visualization(pMainWindow),	// caling the base constructor
+	m_tScene(),
+	m_tRandomNumberGenerator(1u),	// the same objects every time the visualization is opened
+	m_tLooseOctree(),
+	m_iSelectedObject(-1),
+	m_tRebuiltBVH(),
+	m_tLBVHParameters(),
+	m_uiNumObjectsOfLastEdit(0u),
+	m_fLastEditOctreeMicroseconds(0.0f),
+	m_fLastEditRebuildMicroseconds(0.0f),
+	m_tQueryAABB(),
+	m_vecQueryResults(),
+	m_vecIsObjectInQueryAABB(),
+	m_uiNumObjectsInQueryAABB(0u),
+	m_fLastAABBQueryMicroseconds(0.0f),
+	m_tFrustum(),
+	m_vecVisibleObjects(),
+	m_uiNumVisibleObjects(0u),
+	m_fLastFrustumQueryMicroseconds(0.0f),
+	m_tLastRayStatistics(),
+	m_iNumObjects(5000),
+	m_iNumObjectsPerEdit(100),
+	m_iMaxDepth(8),
+	m_fSceneExtent(1500.0f),
+	m_tCamera(glm::vec3(0.0f, 0.0f, 0.0f)),
+	m_mat4Camera(glm::mat4(1.0f)),
+	m_mat4PerspectiveProjection3DWindow(glm::mat4(1.0f)),
+	m_fRenderDistance(10000.0f),
+	m_bRenderObjects(true),
+	m_bRenderObjectAABBs(true),
+	m_bRenderOctreeNodes(true),
+	m_bRenderLooseBounds(false),
+	m_bRenderQueryAABB(true),
+	m_bFreezeFrustum(false),
+	m_bGUICaptureMouse(true),
+	m_bShowHelpWindow(true)
+{
+	glfwSetWindowTitle(m_pMainWindow->m_pGLFWwindow, "Loose Octree Visualization");
+
+	m_tQueryAABB.m_vec3Center = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_tQueryAABB.m_vec3Radius = glm::vec3(300.0f, 300.0f, 300.0f);
+
+	InitRenderColors();
+}
+
+OctreeVisualization::~OctreeVisualization()
+{
+	FreeGPUResources();
+}
+
+void OctreeVisualization::Load()
+{
+	SetInitialRenderStates();
+	glAssert();
+	LoadShaders();
+	glAssert();
+	LoadTextures();
+	glAssert();
+	InitUniformBuffers();
+	glAssert();
+	LoadPrimitivesToGPU();
+	glAssert();
+
+	SpawnObjects();
+
+	m_tCamera.SetToPosition(glm::vec3(0.0f, 0.0f, 4000.0f));
+}
+
+void OctreeVisualization::Render()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	UpdateFrameConstants();
+	glAssert();
+	UpdateProjectionMatrices();
+	glAssert();
+	RunQueries();
+	Render3DVisualization();
+	glAssert();
+	glUseProgram(0);
+}
+
+void OctreeVisualization::Update(float fDeltaTime)
+{
+	m_fDeltaTime = fDeltaTime;
+}
+
+void OctreeVisualization::MouseMoveCallback(GLFWwindow * pWindow, double dXPosition, double dYPosition)
+{
+	if (pWindow == m_pMainWindow->m_pGLFWwindow) // in the main window
+	{
+		const float fXPosition = static_cast<float>(dXPosition);
+		const float fYPosition = static_cast<float>(dYPosition);
+
+		if (m_pMainWindow->IsMouseCaptured()) // Control the camera only when mouse is captured
+		{
+			if (m_pMainWindow->m_bFirstMouse)
+			{
+				m_pMainWindow->m_fLastXOfMouse = fXPosition;
+				m_pMainWindow->m_fLastYOfMouse = fYPosition;
+				m_pMainWindow->m_bFirstMouse = false;
+			}
+
+			float xoffset = fXPosition - m_pMainWindow->m_fLastXOfMouse;
+			float yoffset = m_pMainWindow->m_fLastYOfMouse - fYPosition; // reversed since y-coordinates go from bottom to top
+
+			m_pMainWindow->m_fLastXOfMouse = fXPosition;
+			m_pMainWindow->m_fLastYOfMouse = fYPosition;
+
+
+			m_tCamera.ProcessMouseMovement(xoffset, yoffset);
+		}
+	}
+	else
+	{
+		assert(!"it's a disastah");
+	}
+}
+
+void OctreeVisualization::MouseClickCallback(GLFWwindow * pWindow, int iButton, int iAction, int iModifiers)
+{
+	if (pWindow == m_pMainWindow->m_pGLFWwindow) // in the main window
+	{
+		if (iButton == GLFW_MOUSE_BUTTON_LEFT && iAction == GLFW_PRESS) // single click of left mouse button
+		{
+			// only allow non GUI mouse clicks of a freely moving cursor, when the help window is not visible
+			if (!m_bShowHelpWindow && !m_pMainWindow->IsMouseCaptured())
+				CursorClick();
+		}
+	}
+	else
+	{
+		assert(!"it's a disastah");
+	}
+}
+
+void OctreeVisualization::WindowResizeCallBack(GLFWwindow * pWindow, int iNewWidth, int iNewHeight)
+{
+	// the main window is resized by the engine, there is no other window
+}
+
+void OctreeVisualization::ProcessKeyboardInput()
+{
+	// continuous inputs
+	{
+		// camera control
+		{
+
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_W) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(FORWARD, m_fDeltaTime);
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_S) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(BACKWARD, m_fDeltaTime);
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_A) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(LEFT, m_fDeltaTime);
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_D) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(RIGHT, m_fDeltaTime);
+
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_Q) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(UP, m_fDeltaTime);
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_E) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(DOWN, m_fDeltaTime);
+		}
+	}
+
+	// discrete inputs
+	{
+		if (Engine::IsDiscreteKeyReadyForWindow(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_H))
+		{
+			ToggleHelpWindow();
+		}
+
+		if (Engine::IsDiscreteKeyReadyForWindow(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_M))
+		{
+			m_pMainWindow->SetHardCaptureMouse(!m_pMainWindow->IsMouseCaptured());	// toggle between captured mouse or a cursor
+			SetGUICaptureMouse(!m_pMainWindow->IsMouseCaptured());	// control GUI behaviour
+		}
+
+		if (Engine::IsDiscreteKeyReadyForWindow(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_F))
+		{
+			m_bFreezeFrustum = !m_bFreezeFrustum;
+		}
+
+		if (Engine::IsDiscreteKeyReadyForWindow(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_DELETE))
+		{
+			DeleteSelectedObject();
+		}
+	}
+}
+
+void OctreeVisualization::SpawnObjects()
+{
+	assert(m_iNumObjects >= 0);
+	const size_t uiNumObjects = static_cast<size_t>(m_iNumObjects);
+
+	m_tScene.m_vecObjects.clear();
+	m_tScene.m_vecObjects.reserve(uiNumObjects);
+	for (size_t uiCurrentNewObject = 0u; uiCurrentNewObject < uiNumObjects; uiCurrentNewObject++)
+		m_tScene.m_vecObjects.push_back(CreateRandomObject());
+
+	// the root's cube is fixed from here on, objects inserted later outside of it stay in the root
+	m_tLooseOctree = CollisionDetection::LooseOctree(glm::vec3(0.0f, 0.0f, 0.0f), m_fSceneExtent, m_iMaxDepth);
+	m_tLooseOctree.Build(m_tScene.m_vecObjects.data(), m_tScene.m_vecObjects.size());
+
+	m_iSelectedObject = -1;
+	m_uiNumObjectsOfLastEdit = 0u;
+	m_fLastEditOctreeMicroseconds = 0.0f;
+	m_fLastEditRebuildMicroseconds = 0.0f;
+}
+
+SceneObject OctreeVisualization::CreateRandomObject()
+{
+	std::uniform_real_distribution<float> tPositionDistribution(-m_fSceneExtent, m_fSceneExtent);
+	std::uniform_real_distribution<float> tAngleDistribution(0.0f, 90.0f);
+	// mostly small objects and a few large ones, so the objects end up on different levels
+	std::exponential_distribution<float> tScaleDistribution(2.0f);
+
+	SceneObject tNewObject;
+	tNewObject.m_eType = SceneObject::eType::CUBE;
+	tNewObject.m_tTransform.m_vec3Position = glm::vec3(tPositionDistribution(m_tRandomNumberGenerator), tPositionDistribution(m_tRandomNumberGenerator), tPositionDistribution(m_tRandomNumberGenerator));
+	tNewObject.m_tTransform.m_vec3Scale = glm::vec3(0.2f + tScaleDistribution(m_tRandomNumberGenerator));
+	tNewObject.m_tTransform.m_tRotation.m_fAngle = tAngleDistribution(m_tRandomNumberGenerator);
+	CollisionDetection::ConstructBoundingVolumesForObject(tNewObject);
+	CollisionDetection::UpdateBoundingVolumesForObject(tNewObject);
+
+	return tNewObject;
+}
+
+void OctreeVisualization::InsertObjects()
+{
+	assert(m_iNumObjectsPerEdit > 0);
+	const size_t uiNumNewObjects = static_cast<size_t>(m_iNumObjectsPerEdit);
+	assert(m_tScene.m_vecObjects.size() + uiNumNewObjects < std::numeric_limits<uint32_t>::max());
+
+	const size_t uiFirstNewObject = m_tScene.m_vecObjects.size();
+	for (size_t uiCurrentNewObject = 0u; uiCurrentNewObject < uiNumNewObjects; uiCurrentNewObject++)
+		m_tScene.m_vecObjects.push_back(CreateRandomObject());
+
+	const std::chrono::high_resolution_clock::time_point tUpdateStart = std::chrono::high_resolution_clock::now();
+	for (size_t uiCurrentObject = uiFirstNewObject; uiCurrentObject < m_tScene.m_vecObjects.size(); uiCurrentObject++)
+		m_tLooseOctree.InsertObject(m_tScene.m_vecObjects.data(), static_cast<uint32_t>(uiCurrentObject));
+	m_fLastEditOctreeMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - tUpdateStart).count();
+
+	m_uiNumObjectsOfLastEdit = uiNumNewObjects;
+	RebuildComparisonBVH();
+}
+
+void OctreeVisualization::RemoveObjects()
+{
+	const size_t uiNumRemovedObjects = std::min(static_cast<size_t>(m_iNumObjectsPerEdit), m_tScene.m_vecObjects.size());
+
+	// picked up front, so only the octree's work is timed
+	std::vector<size_t> vecRemovedObjects(uiNumRemovedObjects);
+	for (size_t uiCurrentRemovedObject = 0u; uiCurrentRemovedObject < uiNumRemovedObjects; uiCurrentRemovedObject++)
+	{
+		std::uniform_int_distribution<size_t> tIndexDistribution(0u, m_tScene.m_vecObjects.size() - 1u - uiCurrentRemovedObject);
+		vecRemovedObjects[uiCurrentRemovedObject] = tIndexDistribution(m_tRandomNumberGenerator);
+	}
+
+	const std::chrono::high_resolution_clock::time_point tUpdateStart = std::chrono::high_resolution_clock::now();
+	for (size_t uiRemovedObject : vecRemovedObjects)
+		RemoveObject(uiRemovedObject);
+	m_fLastEditOctreeMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - tUpdateStart).count();
+
+	m_iSelectedObject = -1;
+	m_uiNumObjectsOfLastEdit = uiNumRemovedObjects;
+	RebuildComparisonBVH();
+}
+
+void OctreeVisualization::DeleteSelectedObject()
+{
+	if (m_iSelectedObject < 0)
+		return;
+
+	const std::chrono::high_resolution_clock::time_point tUpdateStart = std::chrono::high_resolution_clock::now();
+	RemoveObject(static_cast<size_t>(m_iSelectedObject));
+	m_fLastEditOctreeMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - tUpdateStart).count();
+
+	m_iSelectedObject = -1;
+	m_uiNumObjectsOfLastEdit = 1u;
+	RebuildComparisonBVH();
+}
+
+void OctreeVisualization::RemoveObject(size_t uiObjectIndex)
+{
+	assert(uiObjectIndex < m_tScene.m_vecObjects.size());
+	const size_t uiLastObjectIndex = m_tScene.m_vecObjects.size() - 1u;
+
+	// the last object fills the gap, so no other object changes its index
+	m_tLooseOctree.RemoveObject(static_cast<uint32_t>(uiObjectIndex));
+	if (uiObjectIndex != uiLastObjectIndex)
+	{
+		m_tLooseOctree.ChangeObjectIndex(static_cast<uint32_t>(uiLastObjectIndex), static_cast<uint32_t>(uiObjectIndex));
+		m_tScene.m_vecObjects[uiObjectIndex] = m_tScene.m_vecObjects[uiLastObjectIndex];
+	}
+	m_tScene.m_vecObjects.pop_back();
+}
+
+void OctreeVisualization::RebuildComparisonBVH()
+{
+	m_tRebuiltBVH.DeleteTree();
+	if (m_tScene.m_vecObjects.empty())
+	{
+		m_fLastEditRebuildMicroseconds = 0.0f;
+		return;
+	}
+
+	const std::chrono::high_resolution_clock::time_point tRebuildStart = std::chrono::high_resolution_clock::now();
+	CollisionDetection::ConstructLBVH_AABB(m_tRebuiltBVH, m_tScene.m_vecObjects.data(), m_tScene.m_vecObjects.size(), m_tLBVHParameters, nullptr);
+	m_fLastEditRebuildMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - tRebuildStart).count();
+}
+
+void OctreeVisualization::CursorClick()
+{
+	glm::vec3 vec3RayDirection = Renderer::ConstructRayDirectionFromMousePosition(*m_pMainWindow, m_mat4PerspectiveProjection3DWindow, m_mat4Camera);
+
+	// construct ray
+	CollisionDetection::Ray tRay(m_tCamera.GetCurrentPosition(), vec3RayDirection);
+
+	// check for intersections with ray
+	m_tLastRayStatistics = CollisionDetection::RayTraversalStatistics();
+	CollisionDetection::RayCastIntersectionResult tResult = CollisionDetection::CastRayIntoLooseOctree(m_tLooseOctree, m_tScene.m_vecObjects.data(), tRay, &m_tLastRayStatistics);
+
+	m_iSelectedObject = tResult.IntersectionWithObjectOccured() ? static_cast<int>(tResult.m_pFirstIntersectedSceneObject - m_tScene.m_vecObjects.data()) : -1;
+}
+
+void OctreeVisualization::RunQueries()
+{
+	const size_t uiNumObjects = m_tScene.m_vecObjects.size();
+
+	// a first query that does not fit sizes the buffer, the second one fills it
+	const std::chrono::high_resolution_clock::time_point tAABBQueryStart = std::chrono::high_resolution_clock::now();
+	m_uiNumObjectsInQueryAABB = m_tLooseOctree.FindObjectsOverlappingAABB(m_tScene.m_vecObjects.data(), m_tQueryAABB, m_vecQueryResults.data(), m_vecQueryResults.size());
+	m_fLastAABBQueryMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - tAABBQueryStart).count();
+	if (m_uiNumObjectsInQueryAABB > m_vecQueryResults.size())
+	{
+		m_vecQueryResults.resize(m_uiNumObjectsInQueryAABB);
+		m_tLooseOctree.FindObjectsOverlappingAABB(m_tScene.m_vecObjects.data(), m_tQueryAABB, m_vecQueryResults.data(), m_vecQueryResults.size());
+	}
+
+	m_vecIsObjectInQueryAABB.assign(uiNumObjects, 0u);
+	for (size_t uiCurrentResult = 0u; uiCurrentResult < m_uiNumObjectsInQueryAABB; uiCurrentResult++)
+		m_vecIsObjectInQueryAABB[m_vecQueryResults[uiCurrentResult]] = 1u;
+
+	// a frozen frustum stays where it is, while the camera can look at it from the outside
+	if (!m_bFreezeFrustum)
+		m_tFrustum = CollisionDetection::CreateFrustum(m_mat4PerspectiveProjection3DWindow * m_mat4Camera);
+
+	const std::chrono::high_resolution_clock::time_point tFrustumQueryStart = std::chrono::high_resolution_clock::now();
+	m_uiNumVisibleObjects = m_tLooseOctree.FindObjectsInFrustum(m_tScene.m_vecObjects.data(), m_tFrustum, m_vecVisibleObjects.data(), m_vecVisibleObjects.size());
+	m_fLastFrustumQueryMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - tFrustumQueryStart).count();
+	if (m_uiNumVisibleObjects > m_vecVisibleObjects.size())
+	{
+		m_vecVisibleObjects.resize(m_uiNumVisibleObjects);
+		m_tLooseOctree.FindObjectsInFrustum(m_tScene.m_vecObjects.data(), m_tFrustum, m_vecVisibleObjects.data(), m_vecVisibleObjects.size());
+	}
+}
+
+void OctreeVisualization::InitRenderColors()
+{
+	m_vec4fClearColor3DSceneWindow = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
+	m_vec4AABBColor = glm::vec4(0.0f, 0.6f, 0.0f, 1.0f);
+	m_vec4FoundAABBColor = glm::vec4(0.9f, 0.1f, 0.1f, 1.0f);
+	m_vec4SelectedAABBColor = glm::vec4(1.0f, 0.9f, 0.0f, 1.0f);
+	m_vec4QueryAABBColor = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
+	m_vec4NodeRenderColor = glm::vec4(0.1f, 0.1f, 0.6f, 1.0f);
+	m_vec4NodeRenderColor_Gradient = glm::vec4(0.3f, 0.8f, 1.0f, 1.0f);
+}
+
+void OctreeVisualization::LoadTextures()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	m_uiObjectDiffuseTexture = Renderer::LoadTextureFromFile("resources/textures/cobblestone_floor_13_diff_1k.jpg");
+}
+
+void OctreeVisualization::LoadShaders()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	// A simple color shader
+	Shader tColorShader("resources/shaders/Color.vs", "resources/shaders/Color.frag");
+	m_tColorShader = tColorShader;
+	assert(m_tColorShader.IsInitialized());
+
+	// A flat texture shader
+	Shader tTextureShader("resources/shaders/FlatTexture.vs", "resources/shaders/FlatTexture.frag");
+	m_tFlatTextureShader = tTextureShader;
+	assert(m_tFlatTextureShader.IsInitialized());
+}
+
+void OctreeVisualization::LoadPrimitivesToGPU()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	// textured cube
+	{
+		GLuint &rTexturedCubeVBO = m_uiTexturedCubeVBO, &rTexturedCubeVAO = m_uiTexturedCubeVAO, &rTexturedCubeEBO = m_uiTexturedCubeEBO;
+		glGenVertexArrays(1, &rTexturedCubeVAO);
+		glGenBuffers(1, &rTexturedCubeVBO);
+		glGenBuffers(1, &rTexturedCubeEBO);
+
+		glBindVertexArray(rTexturedCubeVAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, rTexturedCubeVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Primitives::Cube::VertexData), Primitives::Cube::VertexData, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rTexturedCubeEBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Primitives::Cube::IndexData), Primitives::Cube::IndexData, GL_STATIC_DRAW);
+
+		// position attribute
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		// normals attribute
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		// texture coord attribute
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+		glEnableVertexAttribArray(2);
+	}
+
+	// colored cube
+	{
+		GLuint &rColoredCubeVBO = m_uiColoredCubeVBO, &rColoredCubeVAO = m_uiColoredCubeVAO, &rColoredCubeEBO = m_uiColoredCubeEBO;
+		glGenVertexArrays(1, &rColoredCubeVAO);
+		glGenBuffers(1, &rColoredCubeVBO);
+		glGenBuffers(1, &rColoredCubeEBO);
+
+		glBindVertexArray(rColoredCubeVAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, rColoredCubeVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Primitives::Cube::SimpleVertexData), Primitives::Cube::SimpleVertexData, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rColoredCubeEBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Primitives::Cube::SimpleIndexData), Primitives::Cube::SimpleIndexData, GL_STATIC_DRAW);
+
+		// position attribute
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+	}
+}
+
+void OctreeVisualization::InitUniformBuffers()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	assert(m_tColorShader.IsInitialized() && m_tFlatTextureShader.IsInitialized()); // need constructed shaders to link
+
+	GLuint& rCameraProjectionUBO = m_uiCameraProjectionUBO;
+	glGenBuffers(1, &rCameraProjectionUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, rCameraProjectionUBO);
+	glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);	// dynamic draw because the camera matrix will change every frame
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	// defining the range of the buffer, which is 2 mat4s
+	glBindBufferRange(GL_UNIFORM_BUFFER, 0, rCameraProjectionUBO, 0, 2 * sizeof(glm::mat4));
+}
+
+void OctreeVisualization::SetInitialRenderStates()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	// configure global opengl state
+	glEnable(GL_DEPTH_TEST);
+
+	glEnable(GL_CULL_FACE);
+
+	glEnable(GL_MULTISAMPLE);
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glLineWidth(2.0f);
+	glEnable(GL_LINE_SMOOTH);
+}
+
+void OctreeVisualization::UpdateFrameConstants()
+{
+	m_mat4Camera = m_tCamera.GetViewMatrix();
+}
+
+void OctreeVisualization::UpdateProjectionMatrices()
+{
+	if (!m_pMainWindow->IsMinimized())
+	{
+		// perspective projection matrix for 3D window
+		m_mat4PerspectiveProjection3DWindow = glm::perspective(glm::radians(m_tCamera.Zoom), static_cast<float>(m_pMainWindow->m_iWindowWidth) / static_cast<float>(m_pMainWindow->m_iWindowHeight), 0.1f, m_fRenderDistance);
+	}
+}
+
+void OctreeVisualization::Render3DVisualization()
+{
+	assert(glfwGetCurrentContext() == m_pMainWindow->m_pGLFWwindow); // set the right context before calling this funtion
+
+	if (m_pMainWindow->IsMinimized()) // hot fix to stop crashes when minimizing the window. needs proper handling in the future: https://www.glfw.org/docs/3.3/window_guide.html
+		return;
+
+	glAssert();
+
+	// start by updating the uniform buffer containing the camera and projection matrices
+	glBindBuffer(GL_UNIFORM_BUFFER, m_uiCameraProjectionUBO);
+	// camera
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(m_mat4Camera), glm::value_ptr(m_mat4Camera));
+	// perspective projection
+	glBufferSubData(GL_UNIFORM_BUFFER, sizeof(m_mat4Camera), sizeof(m_mat4PerspectiveProjection3DWindow), glm::value_ptr(m_mat4PerspectiveProjection3DWindow));
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glClearColor(m_vec4fClearColor3DSceneWindow.r, m_vec4fClearColor3DSceneWindow.g, m_vec4fClearColor3DSceneWindow.b, m_vec4fClearColor3DSceneWindow.a);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glAssert();
+
+	if (m_bRenderObjects)
+		RenderRealObjects();
+	RenderDataStructureObjects();
+	RenderVisualizationGUI();
+}
+
+void OctreeVisualization::RenderVisualizationGUI()
+{
+	assert(glfwGetCurrentContext() == m_pMainWindow->m_pGLFWwindow); // set the right context before calling this funtion
+
+	RenderOptionsWindow();
+
+	if (m_bShowHelpWindow)
+		RenderHelpWindow();
+}
+
+void OctreeVisualization::RenderRealObjects() const
+{
+	assert(glfwGetCurrentContext() == m_pMainWindow->m_pGLFWwindow); // set the right context before calling this funtion
+
+	glAssert();
+	m_tFlatTextureShader.use();
+	glAssert();
+	m_tFlatTextureShader.setInt("texture1", 0);
+
+	// bind textures on corresponding texture units
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, m_uiObjectDiffuseTexture);
+
+	glBindVertexArray(m_uiTexturedCubeVAO);
+	// only what the frustum query found is drawn
+	for (size_t uiCurrentVisibleObject = 0u; uiCurrentVisibleObject < m_uiNumVisibleObjects; uiCurrentVisibleObject++)
+	{
+		const SceneObject::Transform& rCurrentTransform = m_tScene.m_vecObjects[m_vecVisibleObjects[uiCurrentVisibleObject]].m_tTransform;
+
+		// calculate the model matrix for each object and pass it to shader before drawing
+		glm::mat4 world = glm::mat4(1.0f); // starting with identity matrix
+		// translation
+		world = glm::translate(world, rCurrentTransform.m_vec3Position);
+		// rotation
+		world = glm::rotate(world, glm::radians(rCurrentTransform.m_tRotation.m_fAngle), rCurrentTransform.m_tRotation.m_vec3Axis);
+		// scale
+		world = glm::scale(world, rCurrentTransform.m_vec3Scale);
+		m_tFlatTextureShader.setMat4("world", world);
+
+		// render, all objects are cubes
+		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(sizeof(Primitives::Cube::IndexData) / sizeof(GLuint)), GL_UNSIGNED_INT, 0);
+	}
+
+	glAssert();
+}
+
+void OctreeVisualization::RenderDataStructureObjects() const
+{
+	const Shader& rCurrentShader = m_tColorShader;
+	rCurrentShader.use();
+	glAssert();
+
+	glDisable(GL_CULL_FACE);
+
+	// nodes, the deeper the lighter
+	if (m_bRenderOctreeNodes)
+	{
+		for (const CollisionDetection::LooseOctree::Node& rCurrentNode : m_tLooseOctree.GetNodes())
+		{
+			if (rCurrentNode.m_iDepth < 0)	// free node
+				continue;
+
+			CollisionDetection::AABB tNodeBounds = rCurrentNode.m_tLooseAABB;
+			if (!m_bRenderLooseBounds)
+				tNodeBounds.m_vec3Radius *= 0.5f;
+
+			rCurrentShader.setVec4("color", InterpolateRenderColorForDepth(m_vec4NodeRenderColor, m_vec4NodeRenderColor_Gradient, rCurrentNode.m_iDepth, m_tLooseOctree.GetMaxDepth()));
+			RenderAABB(tNodeBounds, rCurrentShader);
+		}
+	}
+
+	// AABBs of the visible objects, colored by whether the query box found them
+	if (m_bRenderObjectAABBs)
+	{
+		for (size_t uiCurrentVisibleObject = 0u; uiCurrentVisibleObject < m_uiNumVisibleObjects; uiCurrentVisibleObject++)
+		{
+			const uint32_t uiCurrentObject = m_vecVisibleObjects[uiCurrentVisibleObject];
+			rCurrentShader.setVec4("color", m_vecIsObjectInQueryAABB[uiCurrentObject] ? m_vec4FoundAABBColor : m_vec4AABBColor);
+			RenderAABB(m_tScene.m_vecObjects[uiCurrentObject].m_tWorldSpaceAABB, rCurrentShader);
+		}
+	}
+
+	if (m_iSelectedObject >= 0)
+	{
+		rCurrentShader.setVec4("color", m_vec4SelectedAABBColor);
+		RenderAABB(m_tScene.m_vecObjects[m_iSelectedObject].m_tWorldSpaceAABB, rCurrentShader);
+	}
+
+	if (m_bRenderQueryAABB)
+	{
+		rCurrentShader.setVec4("color", m_vec4QueryAABBColor);
+		RenderAABB(m_tQueryAABB, rCurrentShader);
+	}
+
+	glEnable(GL_CULL_FACE);
+}
+
+void OctreeVisualization::RenderAABB(const CollisionDetection::AABB & rAABB, const Shader & rShader) const
+{
+	// calc world matrix
+	glm::mat4 world = glm::mat4(1.0f); // starting with identity matrix
+	// translation
+	world = glm::translate(world, rAABB.m_vec3Center);
+	// scale
+	world = glm::scale(world, rAABB.m_vec3Radius / Primitives::Cube::DefaultCubeHalfWidth);
+
+	rShader.setMat4("world", world);
+
+	glAssert();
+
+	glBindVertexArray(m_uiColoredCubeVAO);
+	glDrawElements(GL_LINE_STRIP, static_cast<GLsizei>(sizeof(Primitives::Cube::SimpleIndexData) / sizeof(GLuint)), GL_UNSIGNED_INT, 0);
+
+	glAssert();
+}
+
+void OctreeVisualization::FreeGPUResources()
+{
+	// Vertex Buffers and Vertey Arrays
+	glDeleteVertexArrays(1, &m_uiTexturedCubeVAO);
+	glDeleteBuffers(1, &m_uiTexturedCubeVBO);
+	glDeleteBuffers(1, &m_uiTexturedCubeEBO);
+
+	glDeleteVertexArrays(1, &m_uiColoredCubeVAO);
+	glDeleteBuffers(1, &m_uiColoredCubeVBO);
+	glDeleteBuffers(1, &m_uiColoredCubeEBO);
+
+	// Uniform Buffers
+	glDeleteBuffers(1, &m_uiCameraProjectionUBO);
+
+	// Textures
+	glDeleteTextures(1, &m_uiObjectDiffuseTexture);
+}
+
+void OctreeVisualization::ToggleHelpWindow()
+{
+	m_bShowHelpWindow = !m_bShowHelpWindow;
+}
+
+void OctreeVisualization::RenderOptionsWindow()
+{
+	const ImGuiViewport* main_viewport = ImGui::GetMainViewport();
+
+	// configure window
+	ImVec2 optionsWindowSize(300, main_viewport->WorkSize.y);
+
+	ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
+	ImGui::SetNextWindowSize(optionsWindowSize, ImGuiCond_Always);
+
+	ImGuiWindowFlags window_flags = 0;
+	window_flags |= ImGuiWindowFlags_NoMove;
+	window_flags |= ImGuiWindowFlags_NoResize;
+	window_flags |= ImGuiWindowFlags_NoCollapse;
+	if (m_bGUICaptureMouse == false)
+		window_flags |= ImGuiWindowFlags_NoMouseInputs;
+
+	ImGui::Begin("Loose Octree", nullptr, window_flags);
+
+	ImGui::Text("Scene");
+	ImGui::SliderInt("Objects", &m_iNumObjects, 1, 100000); ImGui::SameLine(); GUI::HelpMarker("Takes effect when the objects are spawned anew.");
+	ImGui::SliderFloat("Extent", &m_fSceneExtent, 100.0f, 5000.0f, "%.0f"); ImGui::SameLine(); GUI::HelpMarker("Half the width of the cube the objects are spawned in, and of the octree's root. Takes effect when the objects are spawned anew.");
+	ImGui::SliderInt("Max Depth", &m_iMaxDepth, 0, CollisionDetection::LooseOctree::s_iMaxDepthLimit); ImGui::SameLine(); GUI::HelpMarker("Takes effect when the objects are spawned anew.");
+	if (ImGui::Button("Spawn Objects"))
+		SpawnObjects();
+	ImGui::Text("%zu objects, %zu nodes", m_tScene.m_vecObjects.size(), m_tLooseOctree.GetNumNodes());
+
+	ImGui::Separator();
+	ImGui::Text("Editing");
+	ImGui::SliderInt("Per Edit", &m_iNumObjectsPerEdit, 1, 10000);
+	if (ImGui::Button("Insert Objects"))
+		InsertObjects();
+	ImGui::SameLine();
+	if (ImGui::Button("Remove Objects"))
+		RemoveObjects();
+	if (m_iSelectedObject >= 0)
+	{
+		if (ImGui::Button("Delete Selected [DEL]"))
+			DeleteSelectedObject();
+	}
+	if (m_uiNumObjectsOfLastEdit > 0u)
+	{
+		ImGui::Text("Last edit, %zu objects:", m_uiNumObjectsOfLastEdit);
+		ImGui::Text("Octree: %.1f us", m_fLastEditOctreeMicroseconds);
+		ImGui::Text("LBVH constructed anew: %.1f us", m_fLastEditRebuildMicroseconds); ImGui::SameLine(); GUI::HelpMarker("What the edit costs when every change constructs a hierarchy over the whole scene anew.");
+	}
+
+	ImGui::Separator();
+	ImGui::Text("Queries");
+	ImGui::DragFloat3("Box Center", &m_tQueryAABB.m_vec3Center[0], 10.0f);
+	ImGui::DragFloat3("Box Radius", &m_tQueryAABB.m_vec3Radius[0], 5.0f, 0.0f, 10000.0f);
+	ImGui::Text("In box: %zu (%.1f us)", m_uiNumObjectsInQueryAABB, m_fLastAABBQueryMicroseconds); ImGui::SameLine(); GUI::HelpMarker("Objects whose AABBs overlap the box are red.");
+	ImGui::Checkbox("Freeze Frustum [F]", &m_bFreezeFrustum); ImGui::SameLine(); GUI::HelpMarker("Only objects within the frustum are drawn. Freeze it and move the camera to see which objects it holds.");
+	ImGui::Text("Visible: %zu, culled: %zu (%.1f us)", m_uiNumVisibleObjects, m_tScene.m_vecObjects.size() - m_uiNumVisibleObjects, m_fLastFrustumQueryMicroseconds);
+	if (m_iSelectedObject >= 0)
+		ImGui::Text("Last click: %zu nodes, %zu objects tested", m_tLastRayStatistics.m_uiNumVisitedNodes, m_tLastRayStatistics.m_uiNumObjectTests);
+
+	ImGui::Separator();
+	ImGui::Text("Rendering");
+	ImGui::Checkbox("Objects", &m_bRenderObjects);
+	ImGui::Checkbox("AABBs", &m_bRenderObjectAABBs);
+	ImGui::Checkbox("Nodes", &m_bRenderOctreeNodes);
+	ImGui::Checkbox("Loose Bounds", &m_bRenderLooseBounds); ImGui::SameLine(); GUI::HelpMarker("Draws the nodes' loose bounds, twice as wide as their cubes, instead of the cubes themselves.");
+	ImGui::Checkbox("Query Box", &m_bRenderQueryAABB);
+
+	ImGui::Separator();
+	if (ImGui::Button("Help [H]"))
+		ToggleHelpWindow();
+
+	ImGui::End();
+}
+
+void OctreeVisualization::RenderHelpWindow()
+{
+	const ImGuiViewport* main_viewport = ImGui::GetMainViewport();
+
+	// configure window
+	ImVec2 helpWindowSize(450, 400);
+
+	ImGui::SetNextWindowPos(main_viewport->GetWorkCenter(), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+	ImGui::SetNextWindowSize(helpWindowSize, ImGuiCond_Always);
+
+	ImGuiWindowFlags window_flags = 0;
+	window_flags |= ImGuiWindowFlags_NoResize;
+	window_flags |= ImGuiWindowFlags_NoCollapse;
+	if (m_bGUICaptureMouse == false)
+		window_flags |= ImGuiWindowFlags_NoMouseInputs;
+
+	ImGui::Begin("Help", &m_bShowHelpWindow, window_flags);
+
+	ImGui::TextWrapped("Visualization for Loose Octrees: In the main window, objects are inserted and removed the way a level editor would do it, while a loose octree keeps track of them.");
+	ImGui::Separator();
+	ImGui::Text("Controls");
+	ImGui::Text("[ESC] : Opens Main Menu");
+	ImGui::Text("[W][A][S][D] : Move Camera [FORWARD][LEFT][BACK][RIGHT]");
+	ImGui::Text("[Q],[E] : Move Camera [UP][DOWN]");
+	ImGui::Text("[M] : Toggle between mouse cursor and camera control mode");
+	ImGui::Text("[MOVE MOUSE] : Look around (in camera control mode)");
+	ImGui::Text("[LEFT CLICK] : Select an object (in mouse cursor mode)");
+	ImGui::Text("[DEL] : Delete the selected object");
+	ImGui::Text("[F] : Freeze or release the frustum");
+	ImGui::Text("[H] : Show this Help Window");
+	ImGui::Separator();
+	ImGui::Text("Context");
+	ImGui::TextWrapped("An octree divides a cube into eight smaller cubes, again and again. In a loose octree, each node's bounds are twice as wide as its cube, so an object only has to fit by its size: it goes to the level whose cubes are about as wide as the object, into the cube that holds its center.");
+	ImGui::TextWrapped("Inserting or removing an object thereby walks down a single path, and no other object is touched. A hierarchy that is constructed anew after every edit has to look at all objects instead.");
+	ImGui::TextWrapped("Queries descend into the nodes whose loose bounds overlap the queried box, the camera's frustum or the clicked ray.");
+	ImGui::Separator();
+	ImGui::TextWrapped("Have Fun and Good Learning!");
+
+	if (ImGui::Button("OK"))
+	{
+		m_bShowHelpWindow = false;
+	}
+
+	ImGui::End();
+}
+
+void OctreeVisualization::SetGUICaptureMouse(bool bIsCapturedNow)
+{
+	m_bGUICaptureMouse = bIsCapturedNow;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Visualization.h"
+#include "Scene.h"
+
+#include <vector>
+#include <random>
+
+/*
+	Shows a loose octree at work, the way a level editor would use it: objects are inserted and deleted all the time, and each edit only
+	touches the octree nodes along one path instead of constructing a hierarchy anew. Clicks cast rays into the octree,
+	a box selects the objects it overlaps, and only the objects within the camera's frustum are drawn.
+*/
+class OctreeVisualization final : public Visualization {
+public:
+	OctreeVisualization() = delete;				// pointer to main window is right now 100% required -> no default ctor
+	OctreeVisualization(Window* pMainWindow);	// pointer to main window is right now 100% required
+	OctreeVisualization(OctreeVisualization& rOther) = delete;			// class is not meant to be copy constructed
+	OctreeVisualization& operator= (OctreeVisualization other) = delete;	// same goes for assignment
+	~OctreeVisualization();
+private:
+	/*
+		Members
+	*/
+	Scene m_tScene;
+	std::mt19937 m_tRandomNumberGenerator;
+
+	CollisionDetection::LooseOctree m_tLooseOctree;	// built once per spawn, every edit after that updates it incrementally
+	int m_iSelectedObject;		// index of the object hit by the last click, -1 for none
+
+	// edits
+	CollisionDetection::BoundingVolumeHierarchy m_tRebuiltBVH;	// constructed anew after every edit, for comparison
+	CollisionDetection::LBVHParameters m_tLBVHParameters;
+	size_t m_uiNumObjectsOfLastEdit;
+	float m_fLastEditOctreeMicroseconds;		// inserting or removing the objects of the last edit
+	float m_fLastEditRebuildMicroseconds;		// constructing an LBVH over the whole scene after the last edit
+
+	// queries
+	CollisionDetection::AABB m_tQueryAABB;
+	std::vector<uint32_t> m_vecQueryResults;	// only grown when the results do not fit anymore
+	std::vector<uint8_t> m_vecIsObjectInQueryAABB;	// index = index of the object in the scene
+	size_t m_uiNumObjectsInQueryAABB;
+	float m_fLastAABBQueryMicroseconds;
+	CollisionDetection::Frustum m_tFrustum;		// of the camera, unless frozen
+	std::vector<uint32_t> m_vecVisibleObjects;	// result of the last frustum query, only grown when the results do not fit anymore
+	size_t m_uiNumVisibleObjects;
+	float m_fLastFrustumQueryMicroseconds;
+	CollisionDetection::RayTraversalStatistics m_tLastRayStatistics;
+
+	// scene options
+	int m_iNumObjects;
+	int m_iNumObjectsPerEdit;
+	int m_iMaxDepth;
+	float m_fSceneExtent;		// objects are spawned within a cube of twice this size, centered at the origin
+
+	/*
+		Members related to the 3D Window
+	*/
+	// camera
+	Camera m_tCamera;
+	// Transformation Matrices
+	mutable glm::mat4 m_mat4Camera;
+	mutable glm::mat4 m_mat4PerspectiveProjection3DWindow;
+	// Uniform Buffers
+	GLuint m_uiCameraProjectionUBO;
+	// Shaders
+	Shader m_tColorShader, m_tFlatTextureShader;
+	// Vertex Buffer, Element Buffer and Vertex Array Object Handles
+	GLuint m_uiTexturedCubeVBO, m_uiTexturedCubeVAO, m_uiTexturedCubeEBO;
+	GLuint m_uiColoredCubeVBO, m_uiColoredCubeVAO, m_uiColoredCubeEBO;
+	// Textures
+	GLuint m_uiObjectDiffuseTexture;
+	// Colors
+	glm::vec4 m_vec4fClearColor3DSceneWindow;
+	glm::vec4 m_vec4AABBColor;
+	glm::vec4 m_vec4FoundAABBColor;
+	glm::vec4 m_vec4SelectedAABBColor;
+	glm::vec4 m_vec4QueryAABBColor;
+	glm::vec4 m_vec4NodeRenderColor;
+	glm::vec4 m_vec4NodeRenderColor_Gradient;
+	// other options
+	float m_fRenderDistance;
+	bool m_bRenderObjects;
+	bool m_bRenderObjectAABBs;
+	bool m_bRenderOctreeNodes;
+	bool m_bRenderLooseBounds;	// instead of the nodes' cubes
+	bool m_bRenderQueryAABB;
+	bool m_bFreezeFrustum;
+
+	// GUI members
+	bool m_bGUICaptureMouse;
+	bool m_bShowHelpWindow;
+
+public:
+	/*
+		Member Functions
+	*/
+	// interface required by the engine
+	void Load() override;
+	void Render() override;
+	void Update(float fDeltaTime) override;
+	// callbacks
+	virtual void MouseMoveCallback(GLFWwindow* pWindow, double dXPosition, double dYPosition) override;
+	virtual void MouseClickCallback(GLFWwindow * pWindow, int iButton, int iAction, int iModifiers) override;
+	virtual void WindowResizeCallBack(GLFWwindow* pWindow, int iNewWidth, int iNewHeight) override;
+	virtual void ProcessKeyboardInput() override;
+private:
+	// scene
+	void SpawnObjects();	// replaces the scene by m_iNumObjects objects at random places, and builds the octree for them
+	SceneObject CreateRandomObject();
+	void InsertObjects();	// adds m_iNumObjectsPerEdit new objects, like a level editor would
+	void RemoveObjects();	// deletes m_iNumObjectsPerEdit random objects
+	void DeleteSelectedObject();
+	void RemoveObject(size_t uiObjectIndex);	// the last object takes its place
+	void RebuildComparisonBVH();	// what every edit costs without incremental updates
+	void CursorClick();
+	void RunQueries();		// box and frustum query, after the camera matrices were updated
+
+	// loading and setup
+	void InitRenderColors();
+	void LoadTextures();
+	void LoadShaders();
+	void LoadPrimitivesToGPU();
+	void InitUniformBuffers();
+	void SetInitialRenderStates();
+
+	// rendering
+	void UpdateFrameConstants();
+	void UpdateProjectionMatrices();
+	void Render3DVisualization();
+	void RenderVisualizationGUI();
+	void RenderRealObjects() const;
+	void RenderDataStructureObjects() const;
+	void RenderAABB(const CollisionDetection::AABB& rAABB, const Shader& rShader) const;
+	void FreeGPUResources();
+
+	// GUI
+	void ToggleHelpWindow();
+	void RenderOptionsWindow();
+	void RenderHelpWindow();
+	void SetGUICaptureMouse(bool bIsCapturedNow);
+};
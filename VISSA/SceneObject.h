@@ -32,4 +32,5 @@ struct SceneObject {
 	CollisionDetection::AABB m_tWorldSpaceAABB;
 	CollisionDetection::BoundingSphere m_tLocalSpaceBoundingSphere;
 	CollisionDetection::BoundingSphere m_tWorldSpaceBoundingSphere;
+	CollisionDetection::AABB m_tSweptWorldSpaceAABB;	// encloses the world space AABBs at the previous and the current transform, the current one alone for objects that did not move
 };
\ No newline at end of file
@@ -0,0 +1,808 @@
+#include "SpatialHashGridVisualization.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <chrono>
+
+#include "Engine.h"
+#include "GeometricPrimitiveData.h"
+#include "Renderer.h"
+
+namespace {
+	// lets the objects bounce off the walls of the cube they move in
+	void MoveObjectsWithinCube(std::vector<SceneObject>& rvecObjects, std::vector<glm::vec3>& rvecVelocities, float fCubeExtent, float fDeltaTime)
+	{
+		assert(rvecObjects.size() == rvecVelocities.size());
+
+		for (size_t uiCurrentObject = 0u; uiCurrentObject < rvecObjects.size(); uiCurrentObject++)
+		{
+			glm::vec3& rPosition = rvecObjects[uiCurrentObject].m_tTransform.m_vec3Position;
+			glm::vec3& rVelocity = rvecVelocities[uiCurrentObject];
+
+			rPosition += rVelocity * fDeltaTime;
+			for (glm::vec3::length_type iCurrentAxis = 0; iCurrentAxis < 3; iCurrentAxis++)
+			{
+				if (rPosition[iCurrentAxis] > fCubeExtent)
+				{
+					rPosition[iCurrentAxis] = fCubeExtent;
+					rVelocity[iCurrentAxis] = -std::abs(rVelocity[iCurrentAxis]);
+				}
+				else if (rPosition[iCurrentAxis] < -fCubeExtent)
+				{
+					rPosition[iCurrentAxis] = -fCubeExtent;
+					rVelocity[iCurrentAxis] = std::abs(rVelocity[iCurrentAxis]);
+				}
+			}
+
+			CollisionDetection::UpdateBoundingVolumesForObject(rvecObjects[uiCurrentObject]);
+		}
+	}
+}
+
+SpatialHashGridVisualization::SpatialHashGridVisualization(Window* pMainWindow) :
+	Visualization(pMainWindow),	// caling the base constructor
+	m_tScene(),
+	m_vecObjectVelocities(),
+	m_tRandomNumberGenerator(1u),	// the same objects every time the visualization is opened
+	m_tSpatialHashGrid(),
+	m_vecOverlappingObjectPairs(),
+	m_uiNumOverlappingObjectPairs(0u),
+	m_vecIsObjectInAPair(),
+	m_uiNumCellChangesOfLastUpdate(0u),
+	m_fLastUpdateTimeInMilliseconds(0.0f),
+	m_tBenchmarkBVH(),
+	m_tLBVHParameters(),
+	m_tTaskPool(),
+	m_iNumBenchmarkFrames(60),
+	m_pPairsBenchmarkMilliseconds{ 0.0f, 0.0f, 0.0f, 0.0f },
+	m_uiNumBenchmarkCellChangesPerFrame(0u),
+	m_pRayBenchmarkRaysPerSecond{ 0.0f, 0.0f },
+	m_iNumObjects(1000),
+	m_fSceneExtent(1500.0f),
+	m_fMaximumSpeed(100.0f),
+	m_fCellSizeScale(1.0f),
+	m_bIsMoving(true),
+	m_tCamera(glm::vec3(0.0f, 0.0f, 0.0f)),
+	m_mat4Camera(glm::mat4(1.0f)),
+	m_mat4PerspectiveProjection3DWindow(glm::mat4(1.0f)),
+	m_fRenderDistance(10000.0f),
+	m_bRenderObjects(true),
+	m_bRenderObjectAABBs(true),
+	m_bRenderGridCells(true),
+	m_bGUICaptureMouse(true),
+	m_bShowHelpWindow(true)
+{
+	glfwSetWindowTitle(m_pMainWindow->m_pGLFWwindow, "Spatial Hash Grid Visualization");
+
+	InitRenderColors();
+}
+
+SpatialHashGridVisualization::~SpatialHashGridVisualization()
+{
+	FreeGPUResources();
+}
+
+void SpatialHashGridVisualization::Load()
+{
+	SetInitialRenderStates();
+	glAssert();
+	LoadShaders();
+	glAssert();
+	LoadTextures();
+	glAssert();
+	InitUniformBuffers();
+	glAssert();
+	LoadPrimitivesToGPU();
+	glAssert();
+
+	SpawnObjects();
+
+	m_tCamera.SetToPosition(glm::vec3(0.0f, 0.0f, 4000.0f));
+}
+
+void SpatialHashGridVisualization::Render()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	UpdateFrameConstants();
+	glAssert();
+	UpdateProjectionMatrices();
+	glAssert();
+	Render3DVisualization();
+	glAssert();
+	glUseProgram(0);
+}
+
+void SpatialHashGridVisualization::Update(float fDeltaTime)
+{
+	m_fDeltaTime = fDeltaTime;
+
+	if (m_bIsMoving)
+	{
+		MoveObjects(m_fDeltaTime);
+		UpdateSpatialHashGrid();
+	}
+}
+
+void SpatialHashGridVisualization::MouseMoveCallback(GLFWwindow * pWindow, double dXPosition, double dYPosition)
+{
+	if (pWindow == m_pMainWindow->m_pGLFWwindow) // in the main window
+	{
+		const float fXPosition = static_cast<float>(dXPosition);
+		const float fYPosition = static_cast<float>(dYPosition);
+
+		if (m_pMainWindow->IsMouseCaptured()) // Control the camera only when mouse is captured
+		{
+			if (m_pMainWindow->m_bFirstMouse)
+			{
+				m_pMainWindow->m_fLastXOfMouse = fXPosition;
+				m_pMainWindow->m_fLastYOfMouse = fYPosition;
+				m_pMainWindow->m_bFirstMouse = false;
+			}
+
+			float xoffset = fXPosition - m_pMainWindow->m_fLastXOfMouse;
+			float yoffset = m_pMainWindow->m_fLastYOfMouse - fYPosition; // reversed since y-coordinates go from bottom to top
+
+			m_pMainWindow->m_fLastXOfMouse = fXPosition;
+			m_pMainWindow->m_fLastYOfMouse = fYPosition;
+
+
+			m_tCamera.ProcessMouseMovement(xoffset, yoffset);
+		}
+	}
+	else
+	{
+		assert(!"it's a disastah");
+	}
+}
+
+void SpatialHashGridVisualization::MouseClickCallback(GLFWwindow * pWindow, int iButton, int iAction, int iModifiers)
+{
+	// objects cannot be selected in this visualization, clicks only go to the GUI
+}
+
+void SpatialHashGridVisualization::WindowResizeCallBack(GLFWwindow * pWindow, int iNewWidth, int iNewHeight)
+{
+	// the main window is resized by the engine, there is no other window
+}
+
+void SpatialHashGridVisualization::ProcessKeyboardInput()
+{
+	// continuous inputs
+	{
+		// camera control
+		{
+
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_W) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(FORWARD, m_fDeltaTime);
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_S) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(BACKWARD, m_fDeltaTime);
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_A) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(LEFT, m_fDeltaTime);
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_D) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(RIGHT, m_fDeltaTime);
+
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_Q) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(UP, m_fDeltaTime);
+			if (glfwGetKey(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_E) == GLFW_PRESS)
+				m_tCamera.ProcessKeyboard(DOWN, m_fDeltaTime);
+		}
+	}
+
+	// discrete inputs
+	{
+		if (Engine::IsDiscreteKeyReadyForWindow(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_H))
+		{
+			ToggleHelpWindow();
+		}
+
+		if (Engine::IsDiscreteKeyReadyForWindow(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_M))
+		{
+			m_pMainWindow->SetHardCaptureMouse(!m_pMainWindow->IsMouseCaptured());	// toggle between captured mouse or a cursor
+			SetGUICaptureMouse(!m_pMainWindow->IsMouseCaptured());	// control GUI behaviour
+		}
+
+		if (Engine::IsDiscreteKeyReadyForWindow(m_pMainWindow->m_pGLFWwindow, GLFW_KEY_SPACE))
+		{
+			m_bIsMoving = !m_bIsMoving;
+		}
+	}
+}
+
+void SpatialHashGridVisualization::SpawnObjects()
+{
+	assert(m_iNumObjects >= 0);
+	const size_t uiNumObjects = static_cast<size_t>(m_iNumObjects);
+
+	std::uniform_real_distribution<float> tPositionDistribution(-m_fSceneExtent, m_fSceneExtent);
+	std::uniform_real_distribution<float> tVelocityDistribution(-m_fMaximumSpeed, m_fMaximumSpeed);
+	std::uniform_real_distribution<float> tScaleDistribution(0.2f, 0.8f);
+	std::uniform_real_distribution<float> tAngleDistribution(0.0f, 90.0f);
+
+	m_tScene.m_vecObjects.clear();
+	m_tScene.m_vecObjects.reserve(uiNumObjects);
+	m_vecObjectVelocities.clear();
+	m_vecObjectVelocities.reserve(uiNumObjects);
+
+	for (size_t uiCurrentNewObject = 0u; uiCurrentNewObject < uiNumObjects; uiCurrentNewObject++)
+	{
+		SceneObject tNewObject;
+		tNewObject.m_eType = SceneObject::eType::CUBE;
+		tNewObject.m_tTransform.m_vec3Position = glm::vec3(tPositionDistribution(m_tRandomNumberGenerator), tPositionDistribution(m_tRandomNumberGenerator), tPositionDistribution(m_tRandomNumberGenerator));
+		tNewObject.m_tTransform.m_vec3Scale = glm::vec3(tScaleDistribution(m_tRandomNumberGenerator));
+		// rotated cubes, so the AABBs do not just trace the objects' edges
+		tNewObject.m_tTransform.m_tRotation.m_fAngle = tAngleDistribution(m_tRandomNumberGenerator);
+		CollisionDetection::ConstructBoundingVolumesForObject(tNewObject);
+
+		m_tScene.m_vecObjects.push_back(tNewObject);
+		m_vecObjectVelocities.push_back(glm::vec3(tVelocityDistribution(m_tRandomNumberGenerator), tVelocityDistribution(m_tRandomNumberGenerator), tVelocityDistribution(m_tRandomNumberGenerator)));
+	}
+
+	BuildSpatialHashGrid(m_tSpatialHashGrid, m_tScene.m_vecObjects);
+	m_uiNumCellChangesOfLastUpdate = 0u;
+	m_fLastUpdateTimeInMilliseconds = 0.0f;
+
+	m_uiNumOverlappingObjectPairs = m_tSpatialHashGrid.FindOverlappingObjectPairs(m_tScene.m_vecObjects.data(), m_vecOverlappingObjectPairs.data(), m_vecOverlappingObjectPairs.size());
+	CollectOverlappingObjectPairs();
+}
+
+void SpatialHashGridVisualization::BuildSpatialHashGrid(CollisionDetection::SpatialHashGrid& rGrid, const std::vector<SceneObject>& rvecObjects) const
+{
+	assert(rvecObjects.size() <= std::numeric_limits<uint32_t>::max());
+
+	rGrid.Clear();
+	if (rvecObjects.empty())
+		return;
+
+	rGrid.SetCellSize(CollisionDetection::SpatialHashGrid::CalcCellSizeForObjects(rvecObjects.data(), rvecObjects.size()) * m_fCellSizeScale);
+	for (size_t uiCurrentObject = 0u; uiCurrentObject < rvecObjects.size(); uiCurrentObject++)
+		rGrid.InsertObject(rvecObjects.data(), static_cast<uint32_t>(uiCurrentObject));
+}
+
+void SpatialHashGridVisualization::MoveObjects(float fDeltaTime)
+{
+	MoveObjectsWithinCube(m_tScene.m_vecObjects, m_vecObjectVelocities, m_fSceneExtent, fDeltaTime);
+}
+
+void SpatialHashGridVisualization::UpdateSpatialHashGrid()
+{
+	assert(m_tScene.m_vecObjects.size() <= std::numeric_limits<uint32_t>::max());
+
+	// unlike sweep and prune, the grid does not keep its pairs, so finding them is part of its update
+	const std::chrono::high_resolution_clock::time_point tUpdateStart = std::chrono::high_resolution_clock::now();
+	m_uiNumCellChangesOfLastUpdate = 0u;
+	for (size_t uiCurrentObject = 0u; uiCurrentObject < m_tScene.m_vecObjects.size(); uiCurrentObject++)
+	{
+		if (m_tSpatialHashGrid.UpdateObject(m_tScene.m_vecObjects.data(), static_cast<uint32_t>(uiCurrentObject)))
+			m_uiNumCellChangesOfLastUpdate++;
+	}
+	m_uiNumOverlappingObjectPairs = m_tSpatialHashGrid.FindOverlappingObjectPairs(m_tScene.m_vecObjects.data(), m_vecOverlappingObjectPairs.data(), m_vecOverlappingObjectPairs.size());
+	m_fLastUpdateTimeInMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - tUpdateStart).count();
+
+	CollectOverlappingObjectPairs();
+}
+
+void SpatialHashGridVisualization::CollectOverlappingObjectPairs()
+{
+	if (m_uiNumOverlappingObjectPairs > m_vecOverlappingObjectPairs.size())
+	{
+		m_vecOverlappingObjectPairs.resize(m_uiNumOverlappingObjectPairs);
+		m_tSpatialHashGrid.FindOverlappingObjectPairs(m_tScene.m_vecObjects.data(), m_vecOverlappingObjectPairs.data(), m_vecOverlappingObjectPairs.size());
+	}
+
+	m_vecIsObjectInAPair.assign(m_tScene.m_vecObjects.size(), 0u);
+	for (size_t uiCurrentPair = 0u; uiCurrentPair < m_uiNumOverlappingObjectPairs; uiCurrentPair++)
+	{
+		m_vecIsObjectInAPair[m_vecOverlappingObjectPairs[uiCurrentPair].m_pObject - m_tScene.m_vecObjects.data()] = 1u;
+		m_vecIsObjectInAPair[m_vecOverlappingObjectPairs[uiCurrentPair].m_pOtherObject - m_tScene.m_vecObjects.data()] = 1u;
+	}
+}
+
+void SpatialHashGridVisualization::RunPairFindingBenchmark()
+{
+	assert(m_iNumBenchmarkFrames > 0);
+	const float fFrameTime = 1.0f / 60.0f;
+
+	// the visible objects stay where they are
+	std::vector<SceneObject> vecObjects = m_tScene.m_vecObjects;
+	std::vector<glm::vec3> vecVelocities = m_vecObjectVelocities;
+	const size_t uiNumObjects = vecObjects.size();
+	std::vector<CollisionDetection::ObjectPair> vecPairs(std::max<size_t>(m_uiNumOverlappingObjectPairs * 2u, 1024u));
+
+	CollisionDetection::SpatialHashGrid tIncrementalSpatialHashGrid;
+	BuildSpatialHashGrid(tIncrementalSpatialHashGrid, vecObjects);
+	CollisionDetection::SpatialHashGrid tSpatialHashGridBuiltAnew;
+
+	double pTotalMilliseconds[4] = { 0.0, 0.0, 0.0, 0.0 };
+	size_t uiTotalNumCellChanges = 0u;
+	for (int iCurrentFrame = 0; iCurrentFrame < m_iNumBenchmarkFrames; iCurrentFrame++)
+	{
+		MoveObjectsWithinCube(vecObjects, vecVelocities, m_fSceneExtent, fFrameTime);
+
+		// spatial hash grid, moving only the objects that touch other cells than before
+		const std::chrono::high_resolution_clock::time_point tIncrementalStart = std::chrono::high_resolution_clock::now();
+		for (size_t uiCurrentObject = 0u; uiCurrentObject < uiNumObjects; uiCurrentObject++)
+		{
+			if (tIncrementalSpatialHashGrid.UpdateObject(vecObjects.data(), static_cast<uint32_t>(uiCurrentObject)))
+				uiTotalNumCellChanges++;
+		}
+		const size_t uiNumPairs = tIncrementalSpatialHashGrid.FindOverlappingObjectPairs(vecObjects.data(), vecPairs.data(), vecPairs.size());
+		pTotalMilliseconds[0] += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - tIncrementalStart).count();
+
+		// none of the timed queries below should have to allocate
+		if (uiNumPairs > vecPairs.size())
+			vecPairs.resize(uiNumPairs * 2u);
+
+		// spatial hash grid, inserting all objects from scratch
+		const std::chrono::high_resolution_clock::time_point tBuiltAnewStart = std::chrono::high_resolution_clock::now();
+		BuildSpatialHashGrid(tSpatialHashGridBuiltAnew, vecObjects);
+		tSpatialHashGridBuiltAnew.FindOverlappingObjectPairs(vecObjects.data(), vecPairs.data(), vecPairs.size());
+		pTotalMilliseconds[1] += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - tBuiltAnewStart).count();
+
+		// a hierarchy constructed anew every frame and tested against itself, on one thread and on all cores
+		for (size_t uiCurrentRun = 0u; uiCurrentRun < 2u; uiCurrentRun++)
+		{
+			TaskPool* pTaskPool = (uiCurrentRun == 0u) ? nullptr : &m_tTaskPool;
+
+			const std::chrono::high_resolution_clock::time_point tHierarchyStart = std::chrono::high_resolution_clock::now();
+			m_tBenchmarkBVH.DeleteTree();
+			CollisionDetection::ConstructLBVH_AABB(m_tBenchmarkBVH, vecObjects.data(), uiNumObjects, m_tLBVHParameters, pTaskPool);
+			CollisionDetection::FindOverlappingObjectPairs_AABB(m_tBenchmarkBVH, vecPairs.data(), vecPairs.size(), pTaskPool);
+			pTotalMilliseconds[2u + uiCurrentRun] += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - tHierarchyStart).count();
+		}
+	}
+
+	for (size_t uiCurrentMeasurement = 0u; uiCurrentMeasurement < 4u; uiCurrentMeasurement++)
+		m_pPairsBenchmarkMilliseconds[uiCurrentMeasurement] = static_cast<float>(pTotalMilliseconds[uiCurrentMeasurement] / m_iNumBenchmarkFrames);
+	m_uiNumBenchmarkCellChangesPerFrame = uiTotalNumCellChanges / static_cast<size_t>(m_iNumBenchmarkFrames);
+}
+
+void SpatialHashGridVisualization::RunRayCastBenchmark()
+{
+	// the scene moves, so the hierarchy is constructed for the objects' current places
+	m_tBenchmarkBVH.DeleteTree();
+	CollisionDetection::ConstructLBVH_AABB(m_tBenchmarkBVH, m_tScene.m_vecObjects.data(), m_tScene.m_vecObjects.size(), m_tLBVHParameters, &m_tTaskPool);
+	const CollisionDetection::LinearBVH tLinearBVH = CollisionDetection::CreateLinearBVH(m_tBenchmarkBVH);
+
+	// rays through a grid over the whole 3D window
+	const int iGridSize = 256;
+	const glm::mat4 mat4InverseProjection = glm::inverse(m_mat4PerspectiveProjection3DWindow);
+	const glm::mat4 mat4InverseCamera = glm::inverse(m_mat4Camera);
+	const glm::vec3 vec3RayOrigin = m_tCamera.GetCurrentPosition();
+
+	std::vector<CollisionDetection::Ray> vecRays;
+	vecRays.reserve(iGridSize * iGridSize);
+	for (int iY = 0; iY < iGridSize; iY++)
+	{
+		for (int iX = 0; iX < iGridSize; iX++)
+		{
+			const glm::vec4 vec4RayClipSpace(2.0f * (iX + 0.5f) / iGridSize - 1.0f, 1.0f - 2.0f * (iY + 0.5f) / iGridSize, -1.0f, 1.0f);
+			const glm::vec4 vec4RayEyeSpace = mat4InverseProjection * vec4RayClipSpace;
+			const glm::vec3 vec3RayDirection = glm::normalize(glm::vec3(mat4InverseCamera * glm::vec4(vec4RayEyeSpace.x, vec4RayEyeSpace.y, -1.0f, 0.0f)));
+			vecRays.push_back(CollisionDetection::Ray(vec3RayOrigin, vec3RayDirection));
+		}
+	}
+
+	std::vector<CollisionDetection::RayCastIntersectionResult> vecResults(vecRays.size());
+
+	const std::chrono::high_resolution_clock::time_point tGridStart = std::chrono::high_resolution_clock::now();
+	for (size_t uiCurrentRay = 0u; uiCurrentRay < vecRays.size(); uiCurrentRay++)
+		vecResults[uiCurrentRay] = CollisionDetection::CastRayIntoSpatialHashGrid(m_tSpatialHashGrid, m_tScene.m_vecObjects.data(), vecRays[uiCurrentRay]);
+	const float fGridSeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - tGridStart).count();
+	m_pRayBenchmarkRaysPerSecond[0] = static_cast<float>(vecRays.size()) / std::max(fGridSeconds, std::numeric_limits<float>::min());
+
+	const std::chrono::high_resolution_clock::time_point tHierarchyStart = std::chrono::high_resolution_clock::now();
+	for (size_t uiCurrentRay = 0u; uiCurrentRay < vecRays.size(); uiCurrentRay++)
+		vecResults[uiCurrentRay] = CollisionDetection::CastRayIntoBVH(tLinearBVH, vecRays[uiCurrentRay]);
+	const float fHierarchySeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - tHierarchyStart).count();
+	m_pRayBenchmarkRaysPerSecond[1] = static_cast<float>(vecRays.size()) / std::max(fHierarchySeconds, std::numeric_limits<float>::min());
+}
+
+void SpatialHashGridVisualization::InitRenderColors()
+{
+	m_vec4fClearColor3DSceneWindow = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
+	m_vec4AABBColor = glm::vec4(0.0f, 0.6f, 0.0f, 1.0f);
+	m_vec4OverlappingAABBColor = glm::vec4(0.9f, 0.1f, 0.1f, 1.0f);
+	m_vec4SceneBoundsColor = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
+	m_vec4GridCellsColor = glm::vec4(0.1f, 0.3f, 0.9f, 1.0f);
+}
+
+void SpatialHashGridVisualization::LoadTextures()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	m_uiObjectDiffuseTexture = Renderer::LoadTextureFromFile("resources/textures/cobblestone_floor_13_diff_1k.jpg");
+}
+
+void SpatialHashGridVisualization::LoadShaders()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	// A simple color shader
+	Shader tColorShader("resources/shaders/Color.vs", "resources/shaders/Color.frag");
+	m_tColorShader = tColorShader;
+	assert(m_tColorShader.IsInitialized());
+
+	// A flat texture shader
+	Shader tTextureShader("resources/shaders/FlatTexture.vs", "resources/shaders/FlatTexture.frag");
+	m_tFlatTextureShader = tTextureShader;
+	assert(m_tFlatTextureShader.IsInitialized());
+}
+
+void SpatialHashGridVisualization::LoadPrimitivesToGPU()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	// textured cube
+	{
+		GLuint &rTexturedCubeVBO = m_uiTexturedCubeVBO, &rTexturedCubeVAO = m_uiTexturedCubeVAO, &rTexturedCubeEBO = m_uiTexturedCubeEBO;
+		glGenVertexArrays(1, &rTexturedCubeVAO);
+		glGenBuffers(1, &rTexturedCubeVBO);
+		glGenBuffers(1, &rTexturedCubeEBO);
+
+		glBindVertexArray(rTexturedCubeVAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, rTexturedCubeVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Primitives::Cube::VertexData), Primitives::Cube::VertexData, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rTexturedCubeEBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Primitives::Cube::IndexData), Primitives::Cube::IndexData, GL_STATIC_DRAW);
+
+		// position attribute
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		// normals attribute
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		// texture coord attribute
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+		glEnableVertexAttribArray(2);
+	}
+
+	// colored cube
+	{
+		GLuint &rColoredCubeVBO = m_uiColoredCubeVBO, &rColoredCubeVAO = m_uiColoredCubeVAO, &rColoredCubeEBO = m_uiColoredCubeEBO;
+		glGenVertexArrays(1, &rColoredCubeVAO);
+		glGenBuffers(1, &rColoredCubeVBO);
+		glGenBuffers(1, &rColoredCubeEBO);
+
+		glBindVertexArray(rColoredCubeVAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, rColoredCubeVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Primitives::Cube::SimpleVertexData), Primitives::Cube::SimpleVertexData, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rColoredCubeEBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Primitives::Cube::SimpleIndexData), Primitives::Cube::SimpleIndexData, GL_STATIC_DRAW);
+
+		// position attribute
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+	}
+}
+
+void SpatialHashGridVisualization::InitUniformBuffers()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	assert(m_tColorShader.IsInitialized() && m_tFlatTextureShader.IsInitialized()); // need constructed shaders to link
+
+	GLuint& rCameraProjectionUBO = m_uiCameraProjectionUBO;
+	glGenBuffers(1, &rCameraProjectionUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, rCameraProjectionUBO);
+	glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);	// dynamic draw because the camera matrix will change every frame
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	// defining the range of the buffer, which is 2 mat4s
+	glBindBufferRange(GL_UNIFORM_BUFFER, 0, rCameraProjectionUBO, 0, 2 * sizeof(glm::mat4));
+}
+
+void SpatialHashGridVisualization::SetInitialRenderStates()
+{
+	m_pMainWindow->SetAsCurrentRenderContext();
+
+	// configure global opengl state
+	glEnable(GL_DEPTH_TEST);
+
+	glEnable(GL_CULL_FACE);
+
+	glEnable(GL_MULTISAMPLE);
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glLineWidth(2.0f);
+	glEnable(GL_LINE_SMOOTH);
+}
+
+void SpatialHashGridVisualization::UpdateFrameConstants()
+{
+	m_mat4Camera = m_tCamera.GetViewMatrix();
+}
+
+void SpatialHashGridVisualization::UpdateProjectionMatrices()
+{
+	if (!m_pMainWindow->IsMinimized())
+	{
+		// perspective projection matrix for 3D window
+		m_mat4PerspectiveProjection3DWindow = glm::perspective(glm::radians(m_tCamera.Zoom), static_cast<float>(m_pMainWindow->m_iWindowWidth) / static_cast<float>(m_pMainWindow->m_iWindowHeight), 0.1f, m_fRenderDistance);
+	}
+}
+
+void SpatialHashGridVisualization::Render3DVisualization()
+{
+	assert(glfwGetCurrentContext() == m_pMainWindow->m_pGLFWwindow); // set the right context before calling this funtion
+
+	if (m_pMainWindow->IsMinimized()) // hot fix to stop crashes when minimizing the window. needs proper handling in the future: https://www.glfw.org/docs/3.3/window_guide.html
+		return;
+
+	glAssert();
+
+	// start by updating the uniform buffer containing the camera and projection matrices
+	glBindBuffer(GL_UNIFORM_BUFFER, m_uiCameraProjectionUBO);
+	// camera
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(m_mat4Camera), glm::value_ptr(m_mat4Camera));
+	// perspective projection
+	glBufferSubData(GL_UNIFORM_BUFFER, sizeof(m_mat4Camera), sizeof(m_mat4PerspectiveProjection3DWindow), glm::value_ptr(m_mat4PerspectiveProjection3DWindow));
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	glClearColor(m_vec4fClearColor3DSceneWindow.r, m_vec4fClearColor3DSceneWindow.g, m_vec4fClearColor3DSceneWindow.b, m_vec4fClearColor3DSceneWindow.a);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glAssert();
+
+	if (m_bRenderObjects)
+		RenderRealObjects();
+	RenderDataStructureObjects();
+	RenderVisualizationGUI();
+}
+
+void SpatialHashGridVisualization::RenderVisualizationGUI()
+{
+	assert(glfwGetCurrentContext() == m_pMainWindow->m_pGLFWwindow); // set the right context before calling this funtion
+
+	RenderOptionsWindow();
+
+	if (m_bShowHelpWindow)
+		RenderHelpWindow();
+}
+
+void SpatialHashGridVisualization::RenderRealObjects() const
+{
+	assert(glfwGetCurrentContext() == m_pMainWindow->m_pGLFWwindow); // set the right context before calling this funtion
+
+	glAssert();
+	m_tFlatTextureShader.use();
+	glAssert();
+	m_tFlatTextureShader.setInt("texture1", 0);
+
+	// bind textures on corresponding texture units
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, m_uiObjectDiffuseTexture);
+
+	glBindVertexArray(m_uiTexturedCubeVAO);
+	for (const SceneObject& rCurrentSceneObject : m_tScene.m_vecObjects)
+	{
+		const SceneObject::Transform& rCurrentTransform = rCurrentSceneObject.m_tTransform;
+
+		// calculate the model matrix for each object and pass it to shader before drawing
+		glm::mat4 world = glm::mat4(1.0f); // starting with identity matrix
+		// translation
+		world = glm::translate(world, rCurrentTransform.m_vec3Position);
+		// rotation
+		world = glm::rotate(world, glm::radians(rCurrentTransform.m_tRotation.m_fAngle), rCurrentTransform.m_tRotation.m_vec3Axis);
+		// scale
+		world = glm::scale(world, rCurrentTransform.m_vec3Scale);
+		m_tFlatTextureShader.setMat4("world", world);
+
+		// render, all objects are cubes
+		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(sizeof(Primitives::Cube::IndexData) / sizeof(GLuint)), GL_UNSIGNED_INT, 0);
+	}
+
+	glAssert();
+}
+
+void SpatialHashGridVisualization::RenderDataStructureObjects() const
+{
+	const Shader& rCurrentShader = m_tColorShader;
+	rCurrentShader.use();
+	glAssert();
+
+	glDisable(GL_CULL_FACE);
+
+	// the cube the objects move in
+	CollisionDetection::AABB tSceneBounds;
+	tSceneBounds.m_vec3Center = glm::vec3(0.0f, 0.0f, 0.0f);
+	tSceneBounds.m_vec3Radius = glm::vec3(m_fSceneExtent, m_fSceneExtent, m_fSceneExtent);
+	rCurrentShader.setVec4("color", m_vec4SceneBoundsColor);
+	RenderAABB(tSceneBounds, rCurrentShader);
+
+	// AABBs, colored by whether they overlap any other one
+	if (m_bRenderObjectAABBs)
+	{
+		for (size_t uiCurrentObject = 0u; uiCurrentObject < m_tScene.m_vecObjects.size(); uiCurrentObject++)
+		{
+			rCurrentShader.setVec4("color", m_vecIsObjectInAPair[uiCurrentObject] ? m_vec4OverlappingAABBColor : m_vec4AABBColor);
+			RenderAABB(m_tScene.m_vecObjects[uiCurrentObject].m_tWorldSpaceAABB, rCurrentShader);
+		}
+	}
+
+	// per object, the block of grid cells it was inserted into
+	if (m_bRenderGridCells)
+	{
+		const float fCellSize = m_tSpatialHashGrid.GetCellSize();
+		rCurrentShader.setVec4("color", m_vec4GridCellsColor);
+		for (size_t uiCurrentObject = 0u; uiCurrentObject < m_tScene.m_vecObjects.size(); uiCurrentObject++)
+		{
+			const CollisionDetection::SpatialHashGrid::CellRange& rCellRange = m_tSpatialHashGrid.GetCellRangeOfObject(static_cast<uint32_t>(uiCurrentObject));
+			const glm::vec3 vec3Minimum = glm::vec3(rCellRange.m_pMinimumCell[0], rCellRange.m_pMinimumCell[1], rCellRange.m_pMinimumCell[2]) * fCellSize;
+			const glm::vec3 vec3Maximum = glm::vec3(rCellRange.m_pMaximumCell[0] + 1, rCellRange.m_pMaximumCell[1] + 1, rCellRange.m_pMaximumCell[2] + 1) * fCellSize;
+
+			CollisionDetection::AABB tCells;
+			tCells.m_vec3Center = 0.5f * (vec3Minimum + vec3Maximum);
+			tCells.m_vec3Radius = 0.5f * (vec3Maximum - vec3Minimum);
+			RenderAABB(tCells, rCurrentShader);
+		}
+	}
+
+	glEnable(GL_CULL_FACE);
+}
+
+void SpatialHashGridVisualization::RenderAABB(const CollisionDetection::AABB & rAABB, const Shader & rShader) const
+{
+	// calc world matrix
+	glm::mat4 world = glm::mat4(1.0f); // starting with identity matrix
+	// translation
+	world = glm::translate(world, rAABB.m_vec3Center);
+	// scale
+	world = glm::scale(world, rAABB.m_vec3Radius / Primitives::Cube::DefaultCubeHalfWidth);
+
+	rShader.setMat4("world", world);
+
+	glAssert();
+
+	glBindVertexArray(m_uiColoredCubeVAO);
+	glDrawElements(GL_LINE_STRIP, static_cast<GLsizei>(sizeof(Primitives::Cube::SimpleIndexData) / sizeof(GLuint)), GL_UNSIGNED_INT, 0);
+
+	glAssert();
+}
+
+void SpatialHashGridVisualization::FreeGPUResources()
+{
+	// Vertex Buffers and Vertey Arrays
+	glDeleteVertexArrays(1, &m_uiTexturedCubeVAO);
+	glDeleteBuffers(1, &m_uiTexturedCubeVBO);
+	glDeleteBuffers(1, &m_uiTexturedCubeEBO);
+
+	glDeleteVertexArrays(1, &m_uiColoredCubeVAO);
+	glDeleteBuffers(1, &m_uiColoredCubeVBO);
+	glDeleteBuffers(1, &m_uiColoredCubeEBO);
+
+	// Uniform Buffers
+	glDeleteBuffers(1, &m_uiCameraProjectionUBO);
+
+	// Textures
+	glDeleteTextures(1, &m_uiObjectDiffuseTexture);
+}
+
+void SpatialHashGridVisualization::ToggleHelpWindow()
+{
+	m_bShowHelpWindow = !m_bShowHelpWindow;
+}
+
+void SpatialHashGridVisualization::RenderOptionsWindow()
+{
+	const ImGuiViewport* main_viewport = ImGui::GetMainViewport();
+
+	// configure window
+	ImVec2 optionsWindowSize(300, main_viewport->WorkSize.y);
+
+	ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
+	ImGui::SetNextWindowSize(optionsWindowSize, ImGuiCond_Always);
+
+	ImGuiWindowFlags window_flags = 0;
+	window_flags |= ImGuiWindowFlags_NoMove;
+	window_flags |= ImGuiWindowFlags_NoResize;
+	window_flags |= ImGuiWindowFlags_NoCollapse;
+	if (m_bGUICaptureMouse == false)
+		window_flags |= ImGuiWindowFlags_NoMouseInputs;
+
+	ImGui::Begin("Spatial Hash Grid", nullptr, window_flags);
+
+	ImGui::Text("Scene");
+	ImGui::SliderInt("Objects", &m_iNumObjects, 2, 20000); ImGui::SameLine(); GUI::HelpMarker("Takes effect when the objects are spawned anew.");
+	ImGui::SliderFloat("Speed", &m_fMaximumSpeed, 0.0f, 1000.0f, "%.0f"); ImGui::SameLine(); GUI::HelpMarker("The largest speed of an object along each axis, in units per second. Takes effect when the objects are spawned anew.");
+	ImGui::SliderFloat("Extent", &m_fSceneExtent, 100.0f, 5000.0f, "%.0f"); ImGui::SameLine(); GUI::HelpMarker("Half the width of the cube the objects move in. The fewer objects an extent holds, the fewer of them share a cell.");
+	ImGui::SliderFloat("Cell Size Scale", &m_fCellSizeScale, 0.25f, 8.0f, "%.2f"); ImGui::SameLine(); GUI::HelpMarker("Scales the cell size picked for the objects, the median of their largest AABB extents. Smaller cells list every object in more of them, larger cells hold more objects that do not overlap. Takes effect when the objects are spawned anew.");
+	if (ImGui::Button("Spawn Objects"))
+		SpawnObjects();
+	ImGui::Checkbox("Moving [SPACE]", &m_bIsMoving);
+
+	ImGui::Separator();
+	ImGui::Text("Rendering");
+	ImGui::Checkbox("Objects", &m_bRenderObjects);
+	ImGui::Checkbox("AABBs", &m_bRenderObjectAABBs); ImGui::SameLine(); GUI::HelpMarker("AABBs that overlap at least one other AABB are red.");
+	ImGui::Checkbox("Grid Cells", &m_bRenderGridCells); ImGui::SameLine(); GUI::HelpMarker("The block of grid cells each object is listed in.");
+
+	ImGui::Separator();
+	ImGui::Text("Spatial Hash Grid");
+	ImGui::Text("Cell size: %.1f", m_tSpatialHashGrid.GetCellSize());
+	ImGui::Text("Occupied cells: %zu", m_tSpatialHashGrid.GetNumOccupiedCells());
+	ImGui::Text("Overlapping pairs: %zu", m_uiNumOverlappingObjectPairs);
+	ImGui::Text("Objects changing cells last frame: %zu", m_uiNumCellChangesOfLastUpdate);
+	ImGui::Text("Update last frame: %.3f ms", m_fLastUpdateTimeInMilliseconds); ImGui::SameLine(); GUI::HelpMarker("Moving the objects that touch other cells than before into their new cells, plus testing the objects that share a cell against each other.");
+
+	ImGui::Separator();
+	ImGui::Text("Benchmark");
+	ImGui::SliderInt("Frames", &m_iNumBenchmarkFrames, 1, 600);
+	if (ImGui::Button("Pair Finding Benchmark"))
+		RunPairFindingBenchmark();
+	ImGui::SameLine(); GUI::HelpMarker("Moves copies of the objects for the given number of frames. Every frame, their overlapping pairs are found by updating the grid incrementally, by inserting all objects into a grid from scratch, and by constructing an LBVH and testing it against itself, on one thread and on all cores.");
+	if (m_pPairsBenchmarkMilliseconds[0] > 0.0f)
+	{
+		ImGui::Text("Per frame, %zu objects:", m_tScene.m_vecObjects.size());
+		ImGui::Text("Incremental: %.3f ms (%zu cell changes)", m_pPairsBenchmarkMilliseconds[0], m_uiNumBenchmarkCellChangesPerFrame);
+		ImGui::Text("Built anew: %.3f ms", m_pPairsBenchmarkMilliseconds[1]);
+		ImGui::Text("LBVH / parallel LBVH: %.3f / %.3f ms", m_pPairsBenchmarkMilliseconds[2], m_pPairsBenchmarkMilliseconds[3]);
+	}
+	if (ImGui::Button("Ray Cast Benchmark"))
+		RunRayCastBenchmark();
+	ImGui::SameLine(); GUI::HelpMarker("Casts a grid of 256 x 256 rays from the camera through the 3D window, by marching through the spatial hash grid cell by cell and by traversing a flattened LBVH of the objects' current places.");
+	if (m_pRayBenchmarkRaysPerSecond[0] > 0.0f)
+		ImGui::Text("Rays/s grid / LBVH: %.2fM / %.2fM", m_pRayBenchmarkRaysPerSecond[0] * 1e-6f, m_pRayBenchmarkRaysPerSecond[1] * 1e-6f);
+
+	ImGui::Separator();
+	if (ImGui::Button("Help [H]"))
+		ToggleHelpWindow();
+
+	ImGui::End();
+}
+
+void SpatialHashGridVisualization::RenderHelpWindow()
+{
+	const ImGuiViewport* main_viewport = ImGui::GetMainViewport();
+
+	// configure window
+	ImVec2 helpWindowSize(450, 400);
+
+	ImGui::SetNextWindowPos(main_viewport->GetWorkCenter(), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+	ImGui::SetNextWindowSize(helpWindowSize, ImGuiCond_Always);
+
+	ImGuiWindowFlags window_flags = 0;
+	window_flags |= ImGuiWindowFlags_NoResize;
+	window_flags |= ImGuiWindowFlags_NoCollapse;
+	if (m_bGUICaptureMouse == false)
+		window_flags |= ImGuiWindowFlags_NoMouseInputs;
+
+	ImGui::Begin("Help", &m_bShowHelpWindow, window_flags);
+
+	ImGui::TextWrapped("Visualization for a Spatial Hash Grid: In the main window, objects move around in a cube. A spatial hash grid keeps track of which cells they touch, and finds the pairs whose AABBs overlap.");
+	ImGui::Separator();
+	ImGui::Text("Controls");
+	ImGui::Text("[ESC] : Opens Main Menu");
+	ImGui::Text("[W][A][S][D] : Move Camera [FORWARD][LEFT][BACK][RIGHT]");
+	ImGui::Text("[Q],[E] : Move Camera [UP][DOWN]");
+	ImGui::Text("[M] : Toggle between mouse cursor and camera control mode");
+	ImGui::Text("[MOVE MOUSE] : Look around (in camera control mode)");
+	ImGui::Text("[SPACE] : Stop or resume the objects' movement");
+	ImGui::Text("[H] : Show this Help Window");
+	ImGui::Separator();
+	ImGui::Text("Context");
+	ImGui::TextWrapped("A spatial hash grid lists every object in all cells its AABB touches, and only objects sharing a cell are tested against each other. Only the cells holding objects are stored, in a hash map, so the grid has no bounds.");
+	ImGui::TextWrapped("From one frame to the next, most objects still touch the very same cells, and nothing has to be done for them. Try different cell sizes: too small, and every object is listed in many cells; too large, and every cell holds many objects that do not overlap.");
+	ImGui::TextWrapped("Rays march through the grid cell by cell. Compare them and the pairs with a hierarchy in the benchmarks, and see how well the grid does as long as the objects are spread evenly and about as large as the cells.");
+	ImGui::Separator();
+	ImGui::TextWrapped("Have Fun and Good Learning!");
+
+	if (ImGui::Button("OK"))
+	{
+		m_bShowHelpWindow = false;
+	}
+
+	ImGui::End();
+}
+
+void SpatialHashGridVisualization::SetGUICaptureMouse(bool bIsCapturedNow)
+{
+	m_bGUICaptureMouse = bIsCapturedNow;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Visualization.h"
+#include "Scene.h"
+#include "TaskPool.h"
+
+#include <vector>
+#include <random>
+
+/*
+	Shows a spatial hash grid broadphase at work: a box full of moving objects, each listed in all cells its AABB touches.
+	Only objects sharing a cell are tested against each other, and rays march through the grid cell by cell.
+*/
+class SpatialHashGridVisualization final : public Visualization {
+public:
+	SpatialHashGridVisualization() = delete;				// pointer to main window is right now 100% required -> no default ctor
+	SpatialHashGridVisualization(Window* pMainWindow);	// pointer to main window is right now 100% required
+	SpatialHashGridVisualization(SpatialHashGridVisualization& rOther) = delete;			// class is not meant to be copy constructed
+	SpatialHashGridVisualization& operator= (SpatialHashGridVisualization other) = delete;	// same goes for assignment
+	~SpatialHashGridVisualization();
+private:
+	/*
+		Members
+	*/
+	Scene m_tScene;
+	std::vector<glm::vec3> m_vecObjectVelocities;	// index = index of the object in the scene
+	std::mt19937 m_tRandomNumberGenerator;
+
+	CollisionDetection::SpatialHashGrid m_tSpatialHashGrid;	// built once per spawn, every frame's movement updates it incrementally
+	std::vector<CollisionDetection::ObjectPair> m_vecOverlappingObjectPairs;	// only grown when the pairs do not fit anymore
+	size_t m_uiNumOverlappingObjectPairs;
+	std::vector<uint8_t> m_vecIsObjectInAPair;		// index = index of the object in the scene
+	size_t m_uiNumCellChangesOfLastUpdate;			// objects that touch other cells than before
+	float m_fLastUpdateTimeInMilliseconds;			// spatial hash grid update of all objects plus its pair query, without moving them
+
+	// benchmark
+	CollisionDetection::BoundingVolumeHierarchy m_tBenchmarkBVH;
+	CollisionDetection::LBVHParameters m_tLBVHParameters;
+	TaskPool m_tTaskPool;
+	int m_iNumBenchmarkFrames;
+	float m_pPairsBenchmarkMilliseconds[4];		// per frame: incremental update, grid built anew, LBVH constructed anew and tested against itself, same in parallel. 0 until the benchmark was run
+	size_t m_uiNumBenchmarkCellChangesPerFrame;
+	float m_pRayBenchmarkRaysPerSecond[2];		// spatial hash grid, flattened LBVH. 0 until the benchmark was run
+
+	// scene options
+	int m_iNumObjects;
+	float m_fSceneExtent;		// objects move within a cube of twice this size, centered at the origin
+	float m_fMaximumSpeed;		// in units per second, on each axis
+	float m_fCellSizeScale;		// the cell size is the one picked by SpatialHashGrid::CalcCellSizeForObjects, times this
+	bool m_bIsMoving;
+
+	/*
+		Members related to the 3D Window
+	*/
+	// camera
+	Camera m_tCamera;
+	// Transformation Matrices
+	mutable glm::mat4 m_mat4Camera;
+	mutable glm::mat4 m_mat4PerspectiveProjection3DWindow;
+	// Uniform Buffers
+	GLuint m_uiCameraProjectionUBO;
+	// Shaders
+	Shader m_tColorShader, m_tFlatTextureShader;
+	// Vertex Buffer, Element Buffer and Vertex Array Object Handles
+	GLuint m_uiTexturedCubeVBO, m_uiTexturedCubeVAO, m_uiTexturedCubeEBO;
+	GLuint m_uiColoredCubeVBO, m_uiColoredCubeVAO, m_uiColoredCubeEBO;
+	// Textures
+	GLuint m_uiObjectDiffuseTexture;
+	// Colors
+	glm::vec4 m_vec4fClearColor3DSceneWindow;
+	glm::vec4 m_vec4AABBColor;
+	glm::vec4 m_vec4OverlappingAABBColor;
+	glm::vec4 m_vec4SceneBoundsColor;
+	glm::vec4 m_vec4GridCellsColor;
+	// other options
+	float m_fRenderDistance;
+	bool m_bRenderObjects;
+	bool m_bRenderObjectAABBs;
+	bool m_bRenderGridCells;
+
+	// GUI members
+	bool m_bGUICaptureMouse;
+	bool m_bShowHelpWindow;
+
+public:
+	/*
+		Member Functions
+	*/
+	// interface required by the engine
+	void Load() override;
+	void Render() override;
+	void Update(float fDeltaTime) override;
+	// callbacks
+	virtual void MouseMoveCallback(GLFWwindow* pWindow, double dXPosition, double dYPosition) override;
+	virtual void MouseClickCallback(GLFWwindow * pWindow, int iButton, int iAction, int iModifiers) override;
+	virtual void WindowResizeCallBack(GLFWwindow* pWindow, int iNewWidth, int iNewHeight) override;
+	virtual void ProcessKeyboardInput() override;
+private:
+	// scene
+	void SpawnObjects();	// replaces the scene by m_iNumObjects objects at random places, and builds the spatial hash grid for them
+	void BuildSpatialHashGrid(CollisionDetection::SpatialHashGrid& rGrid, const std::vector<SceneObject>& rvecObjects) const;	// with the cell size scaled by m_fCellSizeScale
+	void MoveObjects(float fDeltaTime);
+	void UpdateSpatialHashGrid();	// after the objects moved
+	void CollectOverlappingObjectPairs();
+	// moves copies of the objects for m_iNumBenchmarkFrames frames, and measures how long finding their pairs took per frame, by the grid and by a hierarchy
+	void RunPairFindingBenchmark();
+	// casts a grid of rays from the camera through the 3D window into the spatial hash grid and into a flattened LBVH, and measures their rays per second
+	void RunRayCastBenchmark();
+
+	// loading and setup
+	void InitRenderColors();
+	void LoadTextures();
+	void LoadShaders();
+	void LoadPrimitivesToGPU();
+	void InitUniformBuffers();
+	void SetInitialRenderStates();
+
+	// rendering
+	void UpdateFrameConstants();
+	void UpdateProjectionMatrices();
+	void Render3DVisualization();
+	void RenderVisualizationGUI();
+	void RenderRealObjects() const;
+	void RenderDataStructureObjects() const;
+	void RenderAABB(const CollisionDetection::AABB& rAABB, const Shader& rShader) const;
+	void FreeGPUResources();
+
+	// GUI
+	void ToggleHelpWindow();
+	void RenderOptionsWindow();
+	void RenderHelpWindow();
+	void SetGUICaptureMouse(bool bIsCapturedNow);
+};
@@ -0,0 +1,160 @@
+#include "TaskPool.h"
+
+#include <assert.h>
+
+namespace
+{
+	// identifies the queue of a worker thread. Threads outside of any pool keep the defaults
+	thread_local const TaskPool* s_pTaskPoolOfCurrentThread = nullptr;
+	thread_local size_t s_uiQueueIndexOfCurrentThread = 0u;
+}
+
+TaskPool::TaskPool(size_t uiNumWorkerThreads) :
+	m_vecTaskQueues(),
+	m_vecWorkerThreads(),
+	m_uiNumQueuedTasks(0u),
+	m_bShutDown(false),
+	m_tSleepMutex(),
+	m_tWakeUpCondition()
+{
+	if (uiNumWorkerThreads == 0u)
+	{
+		const size_t uiNumHardwareThreads = static_cast<size_t>(std::thread::hardware_concurrency());
+		uiNumWorkerThreads = (uiNumHardwareThreads > 1u) ? uiNumHardwareThreads - 1u : 1u;
+	}
+
+	// all queues have to exist before the first worker starts stealing from them
+	m_vecTaskQueues.reserve(uiNumWorkerThreads + 1u);
+	for (size_t uiCurrentQueue = 0u; uiCurrentQueue < uiNumWorkerThreads + 1u; uiCurrentQueue++)
+		m_vecTaskQueues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue()));
+
+	m_vecWorkerThreads.reserve(uiNumWorkerThreads);
+	for (size_t uiCurrentWorker = 0u; uiCurrentWorker < uiNumWorkerThreads; uiCurrentWorker++)
+		m_vecWorkerThreads.emplace_back(&TaskPool::WorkerThreadMain, this, uiCurrentWorker + 1u);
+}
+
+TaskPool::~TaskPool()
+{
+	{
+		std::lock_guard<std::mutex> tLock(m_tSleepMutex);
+		m_bShutDown = true;
+	}
+	m_tWakeUpCondition.notify_all();
+
+	for (std::thread& rCurrentWorkerThread : m_vecWorkerThreads)
+		rCurrentWorkerThread.join();
+
+	// every submitted task has to be waited for before the pool is destroyed
+	assert(m_uiNumQueuedTasks == 0u);
+}
+
+void TaskPool::Submit(TaskGroup & rTaskGroup, std::function<void()> fnTask)
+{
+	rTaskGroup.m_uiNumPendingTasks.fetch_add(1u, std::memory_order_relaxed);
+
+	Task tNewTask;
+	tNewTask.m_fnTask = std::move(fnTask);
+	tNewTask.m_pTaskGroup = &rTaskGroup;
+
+	TaskQueue& rQueue = *m_vecTaskQueues[GetQueueIndexOfCurrentThread()];
+	{
+		std::lock_guard<std::mutex> tLock(rQueue.m_tMutex);
+		rQueue.m_dequeTasks.push_back(std::move(tNewTask));
+	}
+	m_uiNumQueuedTasks.fetch_add(1u);
+
+	// going through the mutex ensures a worker that is about to fall asleep sees the new task
+	{
+		std::lock_guard<std::mutex> tLock(m_tSleepMutex);
+	}
+	m_tWakeUpCondition.notify_one();
+}
+
+void TaskPool::Wait(TaskGroup & rTaskGroup)
+{
+	// instead of blocking, help out until every task of the group is done. Those tasks might be waiting for their own tasks
+	while (rTaskGroup.m_uiNumPendingTasks.load(std::memory_order_acquire) > 0u)
+	{
+		if (!TryExecuteOneTask())
+			std::this_thread::yield();
+	}
+}
+
+size_t TaskPool::GetNumWorkerThreads() const
+{
+	return m_vecWorkerThreads.size();
+}
+
+size_t TaskPool::GetQueueIndexOfCurrentThread() const
+{
+	return (s_pTaskPoolOfCurrentThread == this) ? s_uiQueueIndexOfCurrentThread : 0u;
+}
+
+bool TaskPool::TryPopTask(size_t uiQueueIndex, Task & rTask)
+{
+	TaskQueue& rQueue = *m_vecTaskQueues[uiQueueIndex];
+	std::lock_guard<std::mutex> tLock(rQueue.m_tMutex);
+
+	if (rQueue.m_dequeTasks.empty())
+		return false;
+
+	rTask = std::move(rQueue.m_dequeTasks.back());
+	rQueue.m_dequeTasks.pop_back();
+
+	return true;
+}
+
+bool TaskPool::TryStealTask(size_t uiThiefQueueIndex, Task & rTask)
+{
+	const size_t uiNumQueues = m_vecTaskQueues.size();
+
+	for (size_t uiCurrentOffset = 1u; uiCurrentOffset < uiNumQueues; uiCurrentOffset++)
+	{
+		TaskQueue& rVictimQueue = *m_vecTaskQueues[(uiThiefQueueIndex + uiCurrentOffset) % uiNumQueues];
+		std::lock_guard<std::mutex> tLock(rVictimQueue.m_tMutex);
+
+		if (rVictimQueue.m_dequeTasks.empty())
+			continue;
+
+		// the oldest tasks are stolen: during recursive work, those are the biggest ones
+		rTask = std::move(rVictimQueue.m_dequeTasks.front());
+		rVictimQueue.m_dequeTasks.pop_front();
+
+		return true;
+	}
+
+	return false;
+}
+
+bool TaskPool::TryExecuteOneTask()
+{
+	const size_t uiQueueIndex = GetQueueIndexOfCurrentThread();
+
+	Task tTask;
+	if (!TryPopTask(uiQueueIndex, tTask) && !TryStealTask(uiQueueIndex, tTask))
+		return false;
+
+	m_uiNumQueuedTasks.fetch_sub(1u);
+
+	tTask.m_fnTask();
+	tTask.m_pTaskGroup->m_uiNumPendingTasks.fetch_sub(1u, std::memory_order_release);
+
+	return true;
+}
+
+void TaskPool::WorkerThreadMain(size_t uiQueueIndex)
+{
+	s_pTaskPoolOfCurrentThread = this;
+	s_uiQueueIndexOfCurrentThread = uiQueueIndex;
+
+	while (!m_bShutDown)
+	{
+		if (TryExecuteOneTask())
+			continue;
+
+		std::unique_lock<std::mutex> tLock(m_tSleepMutex);
+		m_tWakeUpCondition.wait(tLock, [this]() {
+			return m_bShutDown || m_uiNumQueuedTasks > 0u;
+		});
+	}
+}
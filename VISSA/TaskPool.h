@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+	A pool of worker threads executing small tasks.
+	Every worker owns a queue: tasks spawned by a worker are put into its own queue and are taken back in LIFO order,
+	idle workers steal the oldest tasks from the queues of the others. Threads outside of the pool share one extra queue.
+
+	Tasks are submitted into a TaskGroup. Waiting for a group does not block: the waiting thread executes pending tasks
+	until every task of the group has finished. This is what allows tasks to spawn and wait for tasks themselves.
+*/
+class TaskPool {
+public:
+	struct TaskGroup {
+		std::atomic<size_t> m_uiNumPendingTasks { 0u };
+	};
+
+	/*
+		A uiNumWorkerThreads of 0 creates one worker per hardware thread, minus the calling thread that helps out while waiting.
+	*/
+	explicit TaskPool(size_t uiNumWorkerThreads = 0u);
+	~TaskPool();
+
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+
+	void Submit(TaskGroup& rTaskGroup, std::function<void()> fnTask);
+	void Wait(TaskGroup& rTaskGroup);
+
+	size_t GetNumWorkerThreads() const;
+
+private:
+	struct Task {
+		std::function<void()> m_fnTask;
+		TaskGroup* m_pTaskGroup = nullptr;
+	};
+
+	struct TaskQueue {
+		std::mutex m_tMutex;
+		std::deque<Task> m_dequeTasks;
+	};
+
+	size_t GetQueueIndexOfCurrentThread() const;
+	bool TryPopTask(size_t uiQueueIndex, Task& rTask);		// takes the newest task from the thread's own queue
+	bool TryStealTask(size_t uiThiefQueueIndex, Task& rTask);	// takes the oldest task from any other queue
+	bool TryExecuteOneTask();
+	void WorkerThreadMain(size_t uiQueueIndex);
+
+	std::vector<std::unique_ptr<TaskQueue>> m_vecTaskQueues;	// index 0 is shared by all threads outside of the pool, worker i owns index i + 1
+	std::vector<std::thread> m_vecWorkerThreads;
+
+	std::atomic<size_t> m_uiNumQueuedTasks;
+	std::atomic<bool> m_bShutDown;
+	std::mutex m_tSleepMutex;
+	std::condition_variable m_tWakeUpCondition;
+};